@@ -0,0 +1,420 @@
+/*
+ * Copyright (c) 2011-2012, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * hwspinlock_sim.c
+ *
+ * Host simulation of the HwSpinlock_enter wait policies.
+ *
+ * Each simulated core is a process, each of its tasks a thread. The
+ * hardware lock register is an atomic word in memory shared by all the
+ * cores: a read is an atomic exchange with 1, which returns 0 when it
+ * takes the lock, and leave stores 0. Every read also busy waits
+ * <read_ns> to stand for the L4 interconnect access. Like the firmware,
+ * each core has a local mutex in front of the register.
+ *
+ * The policies run in turn on the same load:
+ *   legacy  enter the mutex, read, leave the mutex again on failure
+ *   spin    same, with exponential backoff between reads (budget 64
+ *           reads, delay doubling up to 512 loops), then keep spinning at
+ *           the max backoff
+ *   yield   same, but sched_yield() between reads past the budget
+ *   sleep   same, but sleep one 1 ms tick between reads past the budget
+ *
+ * As in the firmware, the mutex is left for the wait between reads. For
+ * each policy the acquisitions per second, the lock register reads and
+ * local mutex operations per acquisition and the mean and maximum waits
+ * are printed. An acquisition is contended when it found the register
+ * taken or the mutex owned by another task of its core, and its wait
+ * includes the time queued on the mutex.
+ *
+ * Usage:
+ * ------
+ * hwspinlock_sim [<cores> [<tasks> [<hold_us> [<think_us> [<seconds>
+ *                [<read_ns>]]]]]]
+ *
+ * Build:
+ * ------
+ * gcc -O2 hwspinlock_sim.c -o hwspinlock_sim -lpthread
+ */
+
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#define MAX_CORES       8
+#define MAX_TASKS       16
+
+#define SPIN_BUDGET     64      /* HwSpinlock_DEFAULT_SPINBUDGET */
+#define MAX_BACKOFF     512     /* HwSpinlock_DEFAULT_MAXBACKOFF */
+#define TICK_NS         1000000
+
+enum policy {
+    POLICY_LEGACY,
+    POLICY_SPIN,
+    POLICY_YIELD,
+    POLICY_SLEEP,
+    NUM_POLICIES
+};
+
+static const char *policy_names[NUM_POLICIES] = {
+    "legacy", "spin", "yield", "sleep"
+};
+
+/* per core statistics, HwSpinlock_Stats plus the mutex operations */
+struct core_stats {
+    uint64_t acquisitions;
+    uint64_t contentions;
+    uint64_t spins;
+    uint64_t mutex_ops;
+    uint64_t total_wait_ns;
+    uint64_t max_wait_ns;
+};
+
+/* in memory shared by the cores */
+struct shared {
+    uint32_t lock_reg;
+    volatile int stop;
+    struct core_stats stats[MAX_CORES];
+};
+
+/* per core, private to its process */
+struct core {
+    struct shared *shm;
+    int id;
+    enum policy policy;
+    pthread_mutex_t mutex;
+    struct core_stats stats;    /* updated with mutex held */
+};
+
+static int num_cores = 2;
+static int num_tasks = 2;
+static long hold_ns = 2000;
+static long think_ns = 10000;
+static int seconds = 2;
+static long read_ns = 100;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void busy_ns(long ns)
+{
+    uint64_t end = now_ns() + ns;
+
+    while (now_ns() < end) {
+    }
+}
+
+/* a read of the lock register, returns 0 if it took the lock */
+static uint32_t lock_read(struct shared *shm)
+{
+    busy_ns(read_ns);
+    return __atomic_exchange_n(&shm->lock_reg, 1, __ATOMIC_ACQUIRE);
+}
+
+static void lock_write(struct shared *shm)
+{
+    __atomic_store_n(&shm->lock_reg, 0, __ATOMIC_RELEASE);
+}
+
+/* enter the core mutex, returns 1 if another task had it */
+static int mutex_enter(struct core *core)
+{
+    int busy = 0;
+
+    if (pthread_mutex_trylock(&core->mutex) != 0) {
+        busy = 1;
+        pthread_mutex_lock(&core->mutex);
+    }
+    core->stats.mutex_ops++;
+
+    return busy;
+}
+
+static void mutex_leave(struct core *core)
+{
+    core->stats.mutex_ops++;
+    pthread_mutex_unlock(&core->mutex);
+}
+
+static void stats_add(struct core_stats *s, unsigned spins, int queued,
+                      uint64_t start)
+{
+    uint64_t waited;
+
+    s->acquisitions++;
+    if (spins || queued) {
+        waited = now_ns() - start;
+        s->contentions++;
+        s->spins += spins;
+        s->total_wait_ns += waited;
+        if (waited > s->max_wait_ns) {
+            s->max_wait_ns = waited;
+        }
+    }
+}
+
+/* HwSpinlock_enter before backoff was added */
+static void enter_legacy(struct core *core)
+{
+    uint64_t start = now_ns();
+    unsigned spins = 0;
+    int queued = 0;
+
+    while (1) {
+        queued |= mutex_enter(core);
+
+        if (lock_read(core->shm) == 0) {
+            stats_add(&core->stats, spins, queued, start);
+            return;
+        }
+
+        mutex_leave(core);
+        spins++;
+    }
+}
+
+/* HwSpinlock_enter with backoff */
+static void enter_backoff(struct core *core)
+{
+    struct timespec tick = { 0, TICK_NS };
+    uint64_t start = now_ns();
+    unsigned spins = 0;
+    unsigned backoff = 1;
+    int queued;
+    volatile unsigned delay;
+
+    queued = mutex_enter(core);
+
+    while (lock_read(core->shm) != 0) {
+        spins++;
+
+        /* other tasks of the core get their turn meanwhile */
+        mutex_leave(core);
+
+        if (spins >= SPIN_BUDGET && core->policy == POLICY_YIELD) {
+            sched_yield();
+        }
+        else if (spins >= SPIN_BUDGET && core->policy == POLICY_SLEEP) {
+            nanosleep(&tick, NULL);
+        }
+        else {
+            for (delay = 0; delay < backoff; delay++) {
+            }
+            if (backoff < MAX_BACKOFF) {
+                backoff <<= 1;
+            }
+        }
+
+        queued |= mutex_enter(core);
+    }
+
+    stats_add(&core->stats, spins, queued, start);
+}
+
+static void leave(struct core *core)
+{
+    lock_write(core->shm);
+    mutex_leave(core);
+}
+
+static void *task_fxn(void *arg)
+{
+    struct core *core = arg;
+
+    while (!core->shm->stop) {
+        if (core->policy == POLICY_LEGACY) {
+            enter_legacy(core);
+        }
+        else {
+            enter_backoff(core);
+        }
+        busy_ns(hold_ns);
+        leave(core);
+
+        busy_ns(think_ns);
+    }
+
+    return NULL;
+}
+
+static void core_fxn(struct shared *shm, int id, enum policy policy)
+{
+    pthread_t tasks[MAX_TASKS];
+    struct core core;
+    int i;
+
+    memset(&core, 0, sizeof(core));
+    core.shm = shm;
+    core.id = id;
+    core.policy = policy;
+    pthread_mutex_init(&core.mutex, NULL);
+
+    for (i = 0; i < num_tasks; i++) {
+        pthread_create(&tasks[i], NULL, task_fxn, &core);
+    }
+    for (i = 0; i < num_tasks; i++) {
+        pthread_join(tasks[i], NULL);
+    }
+
+    shm->stats[id] = core.stats;
+}
+
+static int run(struct shared *shm, enum policy policy)
+{
+    struct core_stats total;
+    pid_t pids[MAX_CORES];
+    uint64_t max_wait = 0;
+    int i;
+
+    memset(shm, 0, sizeof(*shm));
+
+    for (i = 0; i < num_cores; i++) {
+        pids[i] = fork();
+        if (pids[i] < 0) {
+            perror("fork");
+            return -1;
+        }
+        if (pids[i] == 0) {
+            core_fxn(shm, i, policy);
+            _exit(0);
+        }
+    }
+
+    sleep(seconds);
+    shm->stop = 1;
+
+    for (i = 0; i < num_cores; i++) {
+        waitpid(pids[i], NULL, 0);
+    }
+
+    memset(&total, 0, sizeof(total));
+    for (i = 0; i < num_cores; i++) {
+        total.acquisitions += shm->stats[i].acquisitions;
+        total.contentions += shm->stats[i].contentions;
+        total.spins += shm->stats[i].spins;
+        total.mutex_ops += shm->stats[i].mutex_ops;
+        total.total_wait_ns += shm->stats[i].total_wait_ns;
+        if (shm->stats[i].max_wait_ns > max_wait) {
+            max_wait = shm->stats[i].max_wait_ns;
+        }
+    }
+
+    if (total.acquisitions == 0) {
+        printf("%-7s no acquisitions\n", policy_names[policy]);
+        return 0;
+    }
+
+    printf("%-7s %10llu %9.1f %9.2f %9.2f %10.1f %10.1f\n",
+           policy_names[policy],
+           (unsigned long long)(total.acquisitions / seconds),
+           100.0 * total.contentions / total.acquisitions,
+           (double)(total.acquisitions + total.spins) / total.acquisitions,
+           (double)total.mutex_ops / total.acquisitions,
+           total.contentions ?
+               total.total_wait_ns / 1000.0 / total.contentions : 0.0,
+           max_wait / 1000.0);
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    struct shared *shm;
+    int p;
+
+    if (argc >= 2) {
+        num_cores = atoi(argv[1]);
+    }
+    if (argc >= 3) {
+        num_tasks = atoi(argv[2]);
+    }
+    if (argc >= 4) {
+        hold_ns = atol(argv[3]) * 1000;
+    }
+    if (argc >= 5) {
+        think_ns = atol(argv[4]) * 1000;
+    }
+    if (argc >= 6) {
+        seconds = atoi(argv[5]);
+    }
+    if (argc >= 7) {
+        read_ns = atol(argv[6]);
+    }
+
+    if (num_cores < 1 || num_cores > MAX_CORES || num_tasks < 1 ||
+        num_tasks > MAX_TASKS || seconds < 1) {
+        printf("Usage: hwspinlock_sim [<cores> [<tasks> [<hold_us> "
+               "[<think_us> [<seconds> [<read_ns>]]]]]]\n"
+               "    up to %d cores and %d tasks per core\n",
+               MAX_CORES, MAX_TASKS);
+        return 1;
+    }
+
+    shm = mmap(NULL, sizeof(*shm), PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shm == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+
+    printf("hwspinlock_sim: %d cores x %d tasks, hold %ld us, think %ld us, "
+           "register read %ld ns, %d s per policy\n", num_cores, num_tasks,
+           hold_ns / 1000, think_ns / 1000, read_ns, seconds);
+    printf("%-7s %10s %9s %9s %9s %10s %10s\n", "policy", "acq/s",
+           "contend%", "reads/acq", "mutex/acq", "mean wait", "max wait");
+    printf("%-7s %10s %9s %9s %9s %10s %10s\n", "", "", "", "", "",
+           "(us)", "(us)");
+
+    for (p = 0; p < NUM_POLICIES; p++) {
+        if (run(shm, p) < 0) {
+            return 1;
+        }
+    }
+
+    munmap(shm, sizeof(*shm));
+    return 0;
+}
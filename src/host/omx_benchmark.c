@@ -34,6 +34,9 @@
  *
  * Benchmark average round trip time for equivalent of SysLink 2 RcmClient_exec.
  *
+ * If a batch size is given, also benchmark the call rate when the same calls
+ * are sent <batch_size> at a time in OMX_DESC_MULTI packets.
+ *
  * This calls the fxnDouble RcmServer function, similar to the SysLink 2 ducati
  * rcm/singletest.
  *
@@ -72,6 +75,7 @@
 #include "../../include/linux/rpmsg_omx.h"
 
 #include "omx_packet.h"
+#include "omx_fxntab.h"
 
 
 typedef struct {
@@ -90,11 +94,19 @@ typedef enum {
     RPC_OMX_MAP_INFO_MAX        = 0x7FFFFFFF
 } map_info_type;
 
-/* Note: Set bit 31 to indicate static function indicies:
- * This function order will be hardcoded on BIOS side, hence preconfigured:
- * See src/examples/srvmgr/test_omx.c.
+/* Largest packet which fits in a 512 byte rpmsg buffer, after the rpmsg
+ * header (16 bytes) and the rpmsg_omx header (12 bytes).
  */
-#define FXN_IDX_FXNDOUBLE            (3 | 0x80000000)
+#define MAX_PACKET_SIZE              (512 - 16 - 12)
+
+/* Size of one fxnDouble record in a batched packet */
+#define FXNDOUBLE_REC_SIZE           (sizeof(omx_multi_rec) + \
+                                      sizeof(map_info_type) + \
+                                      sizeof(fxn_double_args))
+
+#define MAX_BATCH_SIZE               ((MAX_PACKET_SIZE - sizeof(omx_packet) - \
+                                      2 * sizeof(uint32_t)) / \
+                                      FXNDOUBLE_REC_SIZE)
 
 long diff(struct timespec start, struct timespec end)
 {
@@ -108,7 +120,7 @@ long diff(struct timespec start, struct timespec end)
         temp.tv_sec = end.tv_sec-start.tv_sec;
         temp.tv_nsec = end.tv_nsec-start.tv_nsec;
     }
-    usecs = temp.tv_sec * 1000 + temp.tv_nsec / 1000;
+    usecs = temp.tv_sec * 1000000 + temp.tv_nsec / 1000;
     return usecs;
 }
 
@@ -199,6 +211,77 @@ void test_exec_call(int fd, int num_iterations)
 
     }
     printf("exec_cmd avg time: %ld usecs\n", elapsed/num_iterations);
+    if (elapsed) {
+        printf("exec_cmd rate: %lld calls/sec\n",
+                (long long)num_iterations * 1000000 / elapsed);
+    }
+}
+
+void test_batch_call(int fd, int num_iterations, int batch_size)
+{
+    int               i, j;
+    int               calls = 0;
+    uint16_t          server_status;
+    int               packet_len;
+    int               reply_len;
+    char              packet_buf[512] = {0};
+    char              return_buf[512] = {0};
+    omx_packet        *packet = (omx_packet *)packet_buf;
+    omx_packet        *rtn_packet = (omx_packet *)return_buf;
+    omx_multi_rec     *rec;
+    fxn_double_args   *fxn_args;
+    struct timespec   start, end;
+    long              elapsed = 0, delta;
+    map_info_type     map_info = RPC_OMX_MAP_INFO_NONE;
+
+    for (i = 1; i <= num_iterations; i += batch_size) {
+
+        /* Set Packet Header for the RCMServer, batched execution: */
+        init_omx_packet(packet, OMX_DESC_MULTI);
+
+        /* The driver reads data[0] as map info, the count follows it: */
+        packet->data[0] = map_info;
+        packet->data[1] = 0;
+        rec = (omx_multi_rec *)&packet->data[2];
+        for (j = i; (j < i + batch_size) && (j <= num_iterations); j++) {
+            rec->fxn_idx = FXN_IDX_FXNDOUBLE;
+            rec->result = 0;
+            rec->data_size = sizeof(map_info) + sizeof(fxn_double_args);
+            memcpy(rec->data, &map_info, sizeof(map_info));
+            fxn_args = (fxn_double_args *)((char *)rec->data +
+                    sizeof(map_info));
+            fxn_args->a = j;
+            packet->data[1]++;
+            rec = (omx_multi_rec *)((char *)rec + FXNDOUBLE_REC_SIZE);
+        }
+        packet->data_size = (char *)rec - (char *)packet->data;
+
+        /* Exec command: */
+        packet_len = sizeof(omx_packet) + packet->data_size;
+        clock_gettime(CLOCK_REALTIME, &start);
+        exec_cmd(fd, (char *)packet, packet_len, (char *)rtn_packet, &reply_len);
+        clock_gettime(CLOCK_REALTIME, &end);
+        delta = diff(start,end);
+        elapsed += delta;
+
+        /* Decode reply: */
+        server_status = (OMX_DESC_TYPE_MASK & rtn_packet->desc) >>
+                OMX_DESC_TYPE_SHIFT;
+        if (server_status == OMXSERVER_STATUS_SUCCESS)  {
+           calls += rtn_packet->result;
+        }
+        else {
+           printf("omx_benchmark: Failed to execute batch: server status: %d, "
+                "%d of %d calls executed\n", server_status, rtn_packet->result,
+                packet->data[1]);
+        }
+    }
+
+    printf("batch of %d: %d calls in %ld usecs\n", batch_size, calls, elapsed);
+    if (elapsed) {
+        printf("batch of %d rate: %lld calls/sec\n", batch_size,
+                (long long)calls * 1000000 / elapsed);
+    }
 }
 
 int main(int argc, char *argv[])
@@ -206,11 +289,17 @@ int main(int argc, char *argv[])
     int fd;
     int ret = 0;
     int num_iterations = 1;
+    int batch_size = 0;
     struct omx_conn_req connreq = { .name = "OMX" };
     int rproc = 0;
     char rpmsg_dev[20];
 
     switch (argc) {
+    case 4:
+        rproc = atoi(argv[1]);
+        num_iterations = atoi(argv[2]);
+        batch_size = atoi(argv[3]);
+        break;
     case 3:
         rproc = atoi(argv[1]);
         num_iterations = atoi(argv[2]);
@@ -230,8 +319,15 @@ int main(int argc, char *argv[])
         ret = 1;
     }
 
+    if (batch_size < 0 || batch_size > (int)MAX_BATCH_SIZE) {
+        printf("Incorrect input argument for batch size, should be 0 - %d\n",
+                (int)MAX_BATCH_SIZE);
+        ret = 1;
+    }
+
     if (ret) {
-       printf("Usage: omx_sample [<processor> [<num_iterations>]]\n");
+       printf("Usage: omx_benchmark [<processor> [<num_iterations> "
+              "[<batch_size>]]]\n");
        return ret;
     }
 
@@ -255,6 +351,9 @@ int main(int argc, char *argv[])
 
     printf("omx_sample: Connected to %s\n", connreq.name);
     test_exec_call(fd, num_iterations);
+    if (batch_size > 0) {
+        test_batch_call(fd, num_iterations, batch_size);
+    }
 
     /* Terminate connection and destroy OMX instance */
     ret = close(fd);
@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2011-2012, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * omx_connect.c
+ *
+ * Measure how long it takes to connect to, and disconnect from, an OMX
+ * service instance.
+ *
+ * Each iteration opens the rpmsg-omx device, connects to the "OMX"
+ * service (the ServiceMgr creates, or hands out a prewarmed, RcmServer
+ * instance on the remote core) and closes the device again, which
+ * deletes the instance. <delay_ms> is slept between iterations; with a
+ * delay long enough for the remote core to build a replacement, every
+ * connect is served from the prewarmed instances, with 0 the connects
+ * soon fall back to creating instances on demand.
+ *
+ * Usage:
+ * ------
+ * omx_connect [<processor> [<num_iterations> [<delay_ms>]]]
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "../../include/linux/rpmsg_omx.h"
+
+#define MAX_ITERATIONS      100000
+
+long diff(struct timespec start, struct timespec end)
+{
+    struct timespec temp;
+
+    if ((end.tv_nsec - start.tv_nsec) < 0) {
+        temp.tv_sec = end.tv_sec - start.tv_sec - 1;
+        temp.tv_nsec = 1000000000UL + end.tv_nsec - start.tv_nsec;
+    } else {
+        temp.tv_sec = end.tv_sec - start.tv_sec;
+        temp.tv_nsec = end.tv_nsec - start.tv_nsec;
+    }
+
+    return (temp.tv_sec * 1000000UL + temp.tv_nsec / 1000);
+}
+
+static int compare(const void *a, const void *b)
+{
+    long va = *(const long *)a;
+    long vb = *(const long *)b;
+
+    return (va > vb) - (va < vb);
+}
+
+/* Value below which pct percent of the sorted samples fall */
+static long percentile(long *sorted, int n, int pct)
+{
+    int i = (n * pct + 99) / 100 - 1;
+
+    return sorted[i < 0 ? 0 : i];
+}
+
+static void report(const char *what, long *samples, int n)
+{
+    long sum = 0;
+    int i;
+
+    for (i = 0; i < n; i++) {
+        sum += samples[i];
+    }
+    qsort(samples, n, sizeof(long), compare);
+
+    printf("  %s:\n", what);
+    printf("    avg: %ld usecs\n", sum / n);
+    printf("    min: %ld usecs\n", samples[0]);
+    printf("    p50: %ld usecs\n", percentile(samples, n, 50));
+    printf("    p90: %ld usecs\n", percentile(samples, n, 90));
+    printf("    p99: %ld usecs\n", percentile(samples, n, 99));
+    printf("    max: %ld usecs\n", samples[n - 1]);
+}
+
+int main(int argc, char *argv[])
+{
+    int ret = 0;
+    int fd;
+    int i;
+    int rproc = 1;
+    int num_iterations = 100;
+    int delay_ms = 100;
+    long *conn;
+    long *disc;
+    struct omx_conn_req connreq = { .name = "OMX" };
+    char rpmsg_dev[20];
+    struct timespec start, end;
+
+    switch (argc) {
+    case 4:
+        delay_ms = atoi(argv[3]);
+        /* fall through */
+    case 3:
+        num_iterations = atoi(argv[2]);
+        /* fall through */
+    case 2:
+        rproc = atoi(argv[1]);
+        break;
+    case 1:
+        break;
+    default:
+        ret = 1;
+        break;
+    }
+
+    if (rproc < 0 || rproc > 2) {
+        printf("Incorrect input argument for processor, should be 0, 1 or 2\n");
+        ret = 1;
+    }
+    if (num_iterations <= 0 || num_iterations > MAX_ITERATIONS) {
+        printf("Incorrect input argument for num_iterations, should be "
+               "1 to %d\n", MAX_ITERATIONS);
+        ret = 1;
+    }
+    if (delay_ms < 0) {
+        printf("Incorrect input argument for delay_ms\n");
+        ret = 1;
+    }
+
+    if (ret) {
+        printf("Usage: omx_connect [<processor> [<num_iterations> "
+               "[<delay_ms>]]]\n");
+        return ret;
+    }
+
+    conn = malloc(num_iterations * sizeof(long));
+    disc = malloc(num_iterations * sizeof(long));
+    if (conn == NULL || disc == NULL) {
+        printf("omx_connect: out of memory\n");
+        return 1;
+    }
+
+    sprintf(rpmsg_dev, "/dev/rpmsg-omx%d", rproc);
+
+    for (i = 0; i < num_iterations; i++) {
+        clock_gettime(CLOCK_REALTIME, &start);
+
+        fd = open(rpmsg_dev, O_RDWR);
+        if (fd < 0) {
+            perror("Can't open OMX device");
+            ret = 1;
+            break;
+        }
+
+        if (ioctl(fd, OMX_IOCCONNECT, &connreq) < 0) {
+            perror("Can't connect to OMX instance");
+            close(fd);
+            ret = 1;
+            break;
+        }
+
+        clock_gettime(CLOCK_REALTIME, &end);
+        conn[i] = diff(start, end);
+
+        clock_gettime(CLOCK_REALTIME, &start);
+
+        if (close(fd) < 0) {
+            perror("Can't close OMX fd ??");
+            ret = 1;
+            break;
+        }
+
+        clock_gettime(CLOCK_REALTIME, &end);
+        disc[i] = diff(start, end);
+
+        if (delay_ms) {
+            usleep(delay_ms * 1000);
+        }
+    }
+
+    if (i > 0) {
+        printf("omx_connect: %d connections to %s, %d ms apart\n",
+               i, connreq.name, delay_ms);
+        report("connect", conn, i);
+        report("disconnect", disc, i);
+    }
+
+    free(conn);
+    free(disc);
+
+    return ret;
+}
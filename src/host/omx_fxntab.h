@@ -0,0 +1,64 @@
+/*
+ *  ======== omx_fxntab.h ========
+ *
+ *  Generated from test_omx.fxn by ti/grcm/FxnTab.xs, do not edit.
+ */
+
+#ifndef OMX_FXNTAB_H_
+#define OMX_FXNTAB_H_
+
+#include <stdint.h>
+#include <string.h>
+
+/* static function indices, bit 31 marks the static table */
+#define FXN_IDX_RPC_SKEL_GETHANDLE       (0 | 0x80000000)
+#define FXN_IDX_RPC_SKEL_SETPARAMETER    (1 | 0x80000000)
+#define FXN_IDX_RPC_SKEL_GETPARAMETER    (2 | 0x80000000)
+#define FXN_IDX_FXNDOUBLE                (3 | 0x80000000)
+#define FXN_IDX_FXNBUSY                  (4 | 0x80000000)
+
+#define FXN_COUNT 5
+
+static const char * const fxn_names[] = {
+    "RPC_SKEL_GetHandle",
+    "RPC_SKEL_SetParameter",
+    "RPC_SKEL_GetParameter",
+    "fxnDouble",
+    "fxnBusy",
+};
+
+/* perfect hash of the names, 0xff marks an empty slot */
+#define FXN_SEED 1u
+#define FXN_SLOTS 16
+
+static const uint8_t fxn_slot[FXN_SLOTS] = {
+    0xff, 0x03, 0x00, 0x02, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x04, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01,
+};
+
+/*
+ *  ======== fxn_idx ========
+ *
+ *  Return the function index for the given name, or 0 if the name
+ *  is not in the table.
+ */
+static inline uint32_t fxn_idx(const char *name)
+{
+    const unsigned char *cp = (const unsigned char *)name;
+    uint32_t h = 2166136261u ^ FXN_SEED;
+    uint8_t i;
+
+    while (*cp) {
+        h = (h ^ *cp++) * 16777619u;
+    }
+
+    i = fxn_slot[h & (FXN_SLOTS - 1)];
+
+    if ((i == 0xff) || strcmp(fxn_names[i], name)) {
+        return (0);
+    }
+
+    return (i | 0x80000000);
+}
+
+#endif
@@ -0,0 +1,363 @@
+/*
+ * Copyright (c) 2011-2012, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * omx_latency.c
+ *
+ * Measure the latency of prioritized OMX calls while the server is loaded.
+ *
+ * A background thread keeps <load_depth> fxnBusy calls (see test_omx.c)
+ * outstanding on the server's worker pool, at normal priority. The main
+ * thread then issues <num_calls> fxnDouble calls to the same pool, one at
+ * a time, with message priority <priority> set in the packet descriptor,
+ * and reports the latency distribution of those calls.
+ *
+ * Running once with priority 0 and once with a higher priority shows how
+ * much of the queueing delay behind the background load is removed.
+ *
+ * Usage:
+ * ------
+ * omx_latency [<processor> [<num_calls> [<priority> [<load_depth>
+ *             [<busy_loops>]]]]]
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "../../include/linux/rpmsg_omx.h"
+
+#include "omx_packet.h"
+#include "omx_fxntab.h"
+
+/* First worker pool declared by test_omx.c */
+#define OMX_WORKER_POOLID   (0x00008001)
+
+/* The data portion of an OMX function call starts with this word */
+#define RPC_OMX_MAP_INFO_NONE 0
+
+/* Replies with msg_id at or above this value belong to the load thread */
+#define LOAD_MSG_ID         0x8000
+
+#define MAX_CALLS           100000
+
+static int fd;
+static int load_depth = 8;
+static uint32_t busy_loops = 100000;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+static int outstanding = 0;     /* load calls in flight */
+static int stopping = 0;        /* load thread should stop issuing */
+static int probe_done = 0;      /* reply to current probe received */
+static int errors = 0;
+
+long diff(struct timespec start, struct timespec end)
+{
+    struct timespec temp;
+
+    if ((end.tv_nsec - start.tv_nsec) < 0) {
+        temp.tv_sec = end.tv_sec - start.tv_sec - 1;
+        temp.tv_nsec = 1000000000UL + end.tv_nsec - start.tv_nsec;
+    } else {
+        temp.tv_sec = end.tv_sec - start.tv_sec;
+        temp.tv_nsec = end.tv_nsec - start.tv_nsec;
+    }
+
+    return (temp.tv_sec * 1000000UL + temp.tv_nsec / 1000);
+}
+
+static int send_call(uint16_t msg_id, uint16_t priority, uint32_t fxn_idx,
+        uint32_t arg)
+{
+    char              packet_buf[512] = {0};
+    omx_packet        *packet = (omx_packet *)packet_buf;
+
+    packet->desc = (OMX_DESC_MSG << OMX_DESC_TYPE_SHIFT) |
+        ((priority << OMX_DESC_PRI_SHIFT) & OMX_DESC_PRI_MASK);
+    packet->msg_id = msg_id;
+    packet->flags = OMX_WORKER_POOLID;
+    packet->fxn_idx = fxn_idx;
+    packet->result = 0;
+    packet->data_size = 2 * sizeof(uint32_t);
+    packet->data[0] = RPC_OMX_MAP_INFO_NONE;
+    packet->data[1] = arg;
+
+    if (write(fd, packet, sizeof(omx_packet) + packet->data_size) < 0) {
+        perror("Can't write to OMX instance");
+        return -1;
+    }
+    return 0;
+}
+
+/* Keep load_depth fxnBusy calls outstanding until told to stop */
+void *load_thread(void *arg)
+{
+    uint16_t msg_id = LOAD_MSG_ID;
+
+    (void)arg;
+
+    pthread_mutex_lock(&lock);
+    while (!stopping) {
+        if (outstanding >= load_depth) {
+            pthread_cond_wait(&cond, &lock);
+            continue;
+        }
+        outstanding++;
+        pthread_mutex_unlock(&lock);
+
+        if (send_call(msg_id, 0, FXN_IDX_FXNBUSY, busy_loops) < 0) {
+            pthread_mutex_lock(&lock);
+            outstanding--;
+            errors++;
+            break;
+        }
+        msg_id = (msg_id == 0xFFFF) ? LOAD_MSG_ID : msg_id + 1;
+
+        pthread_mutex_lock(&lock);
+    }
+    pthread_mutex_unlock(&lock);
+
+    return NULL;
+}
+
+/* Demux replies: load replies free a slot, probe replies wake main */
+void *reply_thread(void *arg)
+{
+    char              return_buf[512] = {0};
+    omx_packet        *rtn_packet = (omx_packet *)return_buf;
+    uint16_t          server_status;
+
+    (void)arg;
+
+    for (;;) {
+        if (read(fd, rtn_packet, sizeof(return_buf)) < 0) {
+            perror("Can't read from OMX instance");
+            pthread_mutex_lock(&lock);
+            errors++;
+            probe_done = 1;
+            pthread_cond_broadcast(&cond);
+            pthread_mutex_unlock(&lock);
+            break;
+        }
+
+        server_status = (OMX_DESC_TYPE_MASK & rtn_packet->desc) >>
+                OMX_DESC_TYPE_SHIFT;
+
+        pthread_mutex_lock(&lock);
+        if (server_status != OMXSERVER_STATUS_SUCCESS) {
+            printf("omx_latency: server status: %d\n", server_status);
+            errors++;
+        }
+        if (rtn_packet->msg_id >= LOAD_MSG_ID) {
+            outstanding--;
+        }
+        else {
+            probe_done = 1;
+        }
+        pthread_cond_broadcast(&cond);
+        pthread_mutex_unlock(&lock);
+    }
+
+    return NULL;
+}
+
+static int compare(const void *a, const void *b)
+{
+    long va = *(const long *)a;
+    long vb = *(const long *)b;
+
+    return (va > vb) - (va < vb);
+}
+
+/* Value below which pct percent of the sorted samples fall */
+static long percentile(long *sorted, int n, int pct)
+{
+    int i = (n * pct + 99) / 100 - 1;
+
+    return sorted[i < 0 ? 0 : i];
+}
+
+int main(int argc, char *argv[])
+{
+    int ret = 0;
+    int i;
+    int rproc = 0;
+    int num_calls = 1000;
+    int priority = 3;
+    long sum = 0;
+    long *samples;
+    struct omx_conn_req connreq = { .name = "OMX" };
+    char rpmsg_dev[20];
+    struct timespec start, end;
+    pthread_t loader, reader;
+
+    switch (argc) {
+    case 6:
+        busy_loops = atoi(argv[5]);
+        /* fall through */
+    case 5:
+        load_depth = atoi(argv[4]);
+        /* fall through */
+    case 4:
+        priority = atoi(argv[3]);
+        /* fall through */
+    case 3:
+        num_calls = atoi(argv[2]);
+        /* fall through */
+    case 2:
+        rproc = atoi(argv[1]);
+        break;
+    case 1:
+        break;
+    default:
+        ret = 1;
+        break;
+    }
+
+    if (rproc < 0 || rproc > 2) {
+        printf("Incorrect input argument for processor, should be 0, 1 or 2\n");
+        ret = 1;
+    }
+    if (num_calls <= 0 || num_calls > MAX_CALLS) {
+        printf("Incorrect input argument for num_calls, should be 1 to %d\n",
+               MAX_CALLS);
+        ret = 1;
+    }
+    if (priority < 0 || priority > 3) {
+        printf("Incorrect input argument for priority, should be 0 to 3\n");
+        ret = 1;
+    }
+    if (load_depth < 0) {
+        printf("Incorrect input argument for load_depth\n");
+        ret = 1;
+    }
+
+    if (ret) {
+        printf("Usage: omx_latency [<processor> [<num_calls> [<priority> "
+               "[<load_depth> [<busy_loops>]]]]]\n");
+        return ret;
+    }
+
+    samples = malloc(num_calls * sizeof(long));
+    if (samples == NULL) {
+        printf("omx_latency: out of memory\n");
+        return 1;
+    }
+
+    sprintf(rpmsg_dev, "/dev/rpmsg-omx%d", rproc);
+
+    fd = open(rpmsg_dev, O_RDWR);
+    if (fd < 0) {
+        perror("Can't open OMX device");
+        return 1;
+    }
+
+    ret = ioctl(fd, OMX_IOCCONNECT, &connreq);
+    if (ret < 0) {
+        perror("Can't connect to OMX instance");
+        return 1;
+    }
+
+    pthread_create(&reader, NULL, reply_thread, NULL);
+    pthread_create(&loader, NULL, load_thread, NULL);
+
+    /* let the load build up before the first probe */
+    usleep(100000);
+
+    for (i = 0; i < num_calls && !errors; i++) {
+        pthread_mutex_lock(&lock);
+        probe_done = 0;
+        pthread_mutex_unlock(&lock);
+
+        clock_gettime(CLOCK_REALTIME, &start);
+
+        if (send_call(i % LOAD_MSG_ID, priority, FXN_IDX_FXNDOUBLE, i) < 0) {
+            errors++;
+            break;
+        }
+
+        pthread_mutex_lock(&lock);
+        while (!probe_done) {
+            pthread_cond_wait(&cond, &lock);
+        }
+        pthread_mutex_unlock(&lock);
+
+        clock_gettime(CLOCK_REALTIME, &end);
+        samples[i] = diff(start, end);
+        sum += samples[i];
+    }
+    num_calls = i;
+
+    /* stop the load and wait for its calls to drain */
+    pthread_mutex_lock(&lock);
+    stopping = 1;
+    pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&lock);
+    pthread_join(loader, NULL);
+
+    pthread_mutex_lock(&lock);
+    while (outstanding > 0 && !errors) {
+        pthread_cond_wait(&cond, &lock);
+    }
+    pthread_mutex_unlock(&lock);
+
+    pthread_cancel(reader);
+    pthread_join(reader, NULL);
+
+    if (num_calls > 0) {
+        qsort(samples, num_calls, sizeof(long), compare);
+
+        printf("omx_latency: %d calls at priority %d, load depth %d "
+               "(%u loops)\n", num_calls, priority, load_depth, busy_loops);
+        printf("  avg: %ld usecs\n", sum / num_calls);
+        printf("  min: %ld usecs\n", samples[0]);
+        printf("  p50: %ld usecs\n", percentile(samples, num_calls, 50));
+        printf("  p90: %ld usecs\n", percentile(samples, num_calls, 90));
+        printf("  p99: %ld usecs\n", percentile(samples, num_calls, 99));
+        printf("  max: %ld usecs\n", samples[num_calls - 1]);
+    }
+
+    free(samples);
+    close(fd);
+
+    return errors ? 1 : 0;
+}
@@ -49,7 +49,7 @@
  *
  *  Bits    Description
  *  --------------------------------------------------------------------
- *  [15:12] reserved
+ *  [15:12] message priority, 0 (normal) to 3 (highest), worker pools only
  *  [11:8]  omx message type
  *  [7:0]   omx client protocol version
  *
@@ -68,8 +68,12 @@
 #define OMX_DESC_SYM_ADD    0x3       // symbol add message
 #define OMX_DESC_SYM_IDX    0x4       // query symbox index
 #define OMX_DESC_CMD        0x5       // exec non-blocking command.
+#define OMX_DESC_MULTI      0x8       // exec batch of sync commands.
+#define OMX_DESC_BULK       0x9       // exec sync, args by reference.
 #define OMX_DESC_TYPE_MASK  0x0F00    // field mask
 #define OMX_DESC_TYPE_SHIFT 8         // field shift width
+#define OMX_DESC_PRI_MASK   0xF000    // field mask
+#define OMX_DESC_PRI_SHIFT  12        // field shift width
 
 /* omx server status codes must be 0 - 15, it has to fit in a 4-bit field */
 #define OMXSERVER_STATUS_SUCCESS          ((uint16_t)0) // success
@@ -79,6 +83,9 @@
 #define OMXSERVER_STATUS_MSG_FXN_ERR      ((uint16_t)4) // msg function error
 #define OMXSERVER_STATUS_ERROR            ((uint16_t)5) // general failure
 #define OMXSERVER_STATUS_UNPROCESSED      ((uint16_t)6) // unprocessed message
+#define OMXSERVER_STATUS_JOB_NOT_FOUND    ((uint16_t)7) // job id not found
+#define OMXSERVER_STATUS_POOL_NOT_FOUND   ((uint16_t)8) // pool id not found
+#define OMXSERVER_STATUS_INVALID_BULK     ((uint16_t)9) // bad bulk buffer
 
 /* the packet structure (actual message sent to omx service) */
 typedef struct {
@@ -91,7 +98,70 @@ typedef struct {
     uint32_t      data[0];     // Payload of data_size char's passed to fxn.
 } omx_packet;
 
+/*
+ * An OMX_DESC_MULTI packet carries a batch of calls in one message. The
+ * packet's fxn_idx is ignored. data[0] is the map info word the rpmsg_omx
+ * driver reads from every packet and must be RPC_OMX_MAP_INFO_NONE, as the
+ * driver would otherwise translate buffers in the records. data[1] holds the
+ * record count, followed by that many omx_multi_rec records packed
+ * back-to-back, each padded to a word boundary. The server executes the
+ * records in order, returns each call's result in its record, and returns
+ * the number of records executed in the packet's result field.
+ */
+typedef struct {
+    uint32_t      fxn_idx;     // Index into OMX service's fxn table.
+    int32_t       result;      // The OMX function's return value is here.
+    uint32_t      data_size;   // Size of this record's payload in bytes.
+    uint32_t      data[0];     // Payload of data_size char's passed to fxn.
+} omx_multi_rec;
+
+/*
+ * An OMX_DESC_BULK packet passes the function arguments by reference. The
+ * packet data holds an omx_bulk_desc describing a buffer in a shared
+ * carveout, by device address (or physical address with OMX_BULK_PHYS).
+ * The remote function is called with the buffer instead of the packet
+ * data, and only the descriptor comes back in the reply.
+ */
+typedef struct {
+    uint32_t      addr;        // buffer device (or physical) address
+    uint32_t      size;        // buffer size in bytes
+    uint32_t      flags;       // OMX_BULK_* flags
+} omx_bulk_desc;
+
+#define OMX_BULK_IN         0x1       // remote reads the buffer
+#define OMX_BULK_OUT        0x2       // remote writes the buffer
+#define OMX_BULK_PHYS       0x4       // addr is a physical address
+
 #define OMX_POOLID_JOBID_NONE (0x00008000)
 #define OMX_INVALIDFXNIDX ((uint32_t)(0xFFFFFFFF))
 
+/*
+ * Reserved function index which returns the server's per-function profile.
+ * The packet payload starts with an omx_stats_hdr, with 'first' set to the
+ * index of the first entry wanted. The reply fills the payload with the
+ * header followed by as many omx_stats_rec entries as fit in data_size.
+ * Ticks are in target Timestamp units, 'freq' is the tick rate in Hz.
+ */
+#define OMX_FXNIDX_STATS ((uint32_t)(0x8000FFFF))
+#define OMX_STATS_NAMELEN 16
+
+typedef struct {
+    uint32_t      first;       // in: index of first entry to return
+    uint32_t      total;       // out: number of entries on the server
+    uint32_t      count;       // out: number of entries in this reply
+    uint32_t      freq;        // out: timestamp frequency (Hz)
+} omx_stats_hdr;
+
+typedef struct {
+    uint32_t      fxn_idx;     // function index
+    uint32_t      calls;       // number of calls
+    uint32_t      min_ticks;   // shortest execution time
+    uint32_t      max_ticks;   // longest execution time
+    uint32_t      exec_lo;     // total execution time (low word)
+    uint32_t      exec_hi;     // total execution time (high word)
+    uint32_t      wait_lo;     // total queue wait time (low word)
+    uint32_t      wait_hi;     // total queue wait time (high word)
+    char          name[OMX_STATS_NAMELEN]; // truncated function name
+} omx_stats_rec;
+
 #endif /* OMX_PACKET_H */
@@ -0,0 +1,437 @@
+/*
+ * Copyright (c) 2011-2012, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * omx_place.c
+ *
+ * Query the load of the remote cores and pick one for a new service
+ * instance, or simulate the placement policy of omx_place.h.
+ *
+ * "query" connects to the load service of each core, prints each core's
+ * load for the service type and the core omx_place_pick() chooses, and
+ * the round trip time of the queries.
+ *
+ * "sim" runs a simulation of CORE0, CORE1 and the DSP, with instances
+ * coming and going and sending messages at random, and places the
+ * instances with each of these policies in turn:
+ *   fixed       all on CORE1, as when the client picks the core by hand
+ *   roundrobin  cores in turn
+ *   least       omx_place_pick() on the loads of the last query
+ *   least+acct  as least, counting the instances placed since the query
+ * Every policy sees the same instances and messages. Loads are queried
+ * every <refresh_ms> simulated ms. The message latencies and queue depths
+ * of each policy are printed, and the cost of a placement decision.
+ *
+ * Usage:
+ * ------
+ * omx_place query [<service>]
+ * omx_place sim [<num_instances> [<refresh_ms>]]
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "../../include/linux/rpmsg_omx.h"
+
+#include "omx_place.h"
+
+#define NUM_CORES           OMX_PLACE_MAX_CORES
+#define QUEUE_LEN           65536       /* messages per simulated core */
+#define MAX_SAMPLES         (1 << 20)
+#define PICK_ITERATIONS     10000000
+
+static const char *core_names[NUM_CORES] = { "CORE0", "CORE1", "DSP" };
+
+/* Work units a simulated core runs per ms, and its background load */
+static const uint32_t core_capacity[NUM_CORES] = { 100, 100, 60 };
+static const uint32_t core_background[NUM_CORES] = { 30, 0, 0 };
+
+enum { FIXED, ROUNDROBIN, LEAST, LEAST_ACCT, NUM_POLICIES };
+
+static const char *policy_names[NUM_POLICIES] = {
+    "fixed", "roundrobin", "least", "least+acct"
+};
+
+struct instance {
+    uint32_t arrive;            /* ms */
+    uint32_t leave;             /* ms */
+    uint32_t rate;              /* messages per 1000 ms */
+    uint32_t cost;              /* work units per message */
+    uint32_t seed;              /* drives the message arrivals */
+    int core;                   /* where it was placed, -1 if not yet */
+};
+
+struct msg {
+    uint32_t left;              /* work units left */
+    uint32_t enqueued;          /* ms */
+};
+
+struct core {
+    struct msg queue[QUEUE_LEN];
+    uint32_t head, tail;
+    uint32_t busy_units;        /* since the last load sample */
+    uint32_t instances;
+    uint32_t placed;
+    uint32_t max_depth;
+    uint32_t dropped;
+};
+
+static struct core cores[NUM_CORES];
+static uint32_t latencies[MAX_SAMPLES];
+
+long diff(struct timespec start, struct timespec end)
+{
+    struct timespec temp;
+
+    if ((end.tv_nsec - start.tv_nsec) < 0) {
+        temp.tv_sec = end.tv_sec - start.tv_sec - 1;
+        temp.tv_nsec = 1000000000UL + end.tv_nsec - start.tv_nsec;
+    } else {
+        temp.tv_sec = end.tv_sec - start.tv_sec;
+        temp.tv_nsec = end.tv_nsec - start.tv_nsec;
+    }
+
+    return (temp.tv_sec * 1000000UL + temp.tv_nsec / 1000);
+}
+
+static int compare(const void *a, const void *b)
+{
+    uint32_t va = *(const uint32_t *)a;
+    uint32_t vb = *(const uint32_t *)b;
+
+    return (va > vb) - (va < vb);
+}
+
+/* xorshift32, never returns 0 for a non-zero state */
+static uint32_t rnd(uint32_t *state)
+{
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+
+    return x;
+}
+
+static uint32_t rnd_range(uint32_t *state, uint32_t lo, uint32_t hi)
+{
+    return lo + rnd(state) % (hi - lo + 1);
+}
+
+static int query(const char *name)
+{
+    struct omx_load loads[NUM_CORES];
+    int valid[NUM_CORES];
+    struct timespec start, end;
+    int fd;
+    int i;
+    int pick;
+
+    printf("%-6s %9s %9s %7s %6s %7s %8s\n", "core", "instances", "of type",
+           "queued", "idle%", "score", "usecs");
+
+    for (i = 0; i < NUM_CORES; i++) {
+        valid[i] = 0;
+
+        fd = omx_place_open(i);
+        if (fd < 0) {
+            printf("%-6s not available\n", core_names[i]);
+            continue;
+        }
+
+        clock_gettime(CLOCK_REALTIME, &start);
+        if (omx_place_query(fd, name, &loads[i]) == 0) {
+            clock_gettime(CLOCK_REALTIME, &end);
+            valid[i] = 1;
+            printf("%-6s %9u %9u %7u %6u %7u %8ld\n", core_names[i],
+                   loads[i].instances, loads[i].type_instances,
+                   loads[i].queue_depth, loads[i].idle_percent,
+                   omx_place_score(&loads[i]), diff(start, end));
+        }
+        else {
+            printf("%-6s load query failed\n", core_names[i]);
+        }
+
+        close(fd);
+    }
+
+    pick = omx_place_pick(loads, valid, NUM_CORES);
+    if (pick < 0) {
+        printf("no core to place %s on\n", name);
+        return 1;
+    }
+
+    printf("place %s on %s (rpmsg-omx%d)\n", name, core_names[pick], pick);
+
+    return 0;
+}
+
+/* Build the instances the same way for every policy */
+static void make_instances(struct instance *inst, int n, uint32_t *duration)
+{
+    uint32_t state = 0x2545F491;
+    uint32_t t = 0;
+    int i;
+
+    for (i = 0; i < n; i++) {
+        t += rnd_range(&state, 0, 20);
+        inst[i].arrive = t;
+        inst[i].leave = t + rnd_range(&state, 200, 3000);
+        inst[i].rate = rnd_range(&state, 1, 25);
+        inst[i].cost = rnd_range(&state, 10, 150);
+        inst[i].seed = rnd(&state);
+        if (inst[i].leave > *duration) {
+            *duration = inst[i].leave;
+        }
+    }
+}
+
+static void sim(struct instance *inst, int n, uint32_t duration,
+        uint32_t refresh, int policy)
+{
+    struct omx_load loads[NUM_CORES];
+    int valid[NUM_CORES] = { 1, 1, 1 };
+    uint32_t num_lat = 0;
+    uint32_t sum_lat = 0;
+    uint32_t units, now, i;
+    uint32_t depth, max_depth = 0;
+    uint32_t next = 0;
+    struct core *c;
+    struct msg *m;
+    int rr = 0;
+    int k;
+
+    memset(cores, 0, sizeof(cores));
+    memset(loads, 0, sizeof(loads));
+    for (k = 0; k < NUM_CORES; k++) {
+        loads[k].idle_percent = 100;
+    }
+    for (i = 0; i < (uint32_t)n; i++) {
+        inst[i].core = -1;
+    }
+
+    for (now = 0; now < duration; now++) {
+        /* load query: what ServiceMgr_getLoad would report */
+        if (now % refresh == 0) {
+            for (k = 0; k < NUM_CORES; k++) {
+                c = &cores[k];
+                loads[k].instances = c->instances;
+                loads[k].type_instances = c->instances;
+                loads[k].queue_depth = c->tail - c->head;
+                loads[k].idle_percent = now == 0 ? 100 :
+                    100 - c->busy_units * 100 / (core_capacity[k] * refresh);
+                c->busy_units = 0;
+            }
+        }
+
+        /* place the instances arriving now */
+        while (next < (uint32_t)n && inst[next].arrive == now) {
+            switch (policy) {
+            case FIXED:
+                k = 1;
+                break;
+            case ROUNDROBIN:
+                k = rr;
+                rr = (rr + 1) % NUM_CORES;
+                break;
+            default:
+                k = omx_place_pick(loads, valid, NUM_CORES);
+                if (policy == LEAST_ACCT) {
+                    omx_place_account(&loads[k]);
+                }
+                break;
+            }
+            inst[next].core = k;
+            cores[k].instances++;
+            cores[k].placed++;
+            next++;
+        }
+
+        /* messages from the live instances */
+        for (i = 0; i < next; i++) {
+            if (inst[i].core < 0) {
+                continue;
+            }
+            if (inst[i].leave <= now) {
+                cores[inst[i].core].instances--;
+                inst[i].core = -1;
+                continue;
+            }
+            if (rnd(&inst[i].seed) % 1000 < inst[i].rate) {
+                c = &cores[inst[i].core];
+                if (c->tail - c->head >= QUEUE_LEN) {
+                    c->dropped++;
+                    continue;
+                }
+                m = &c->queue[c->tail++ % QUEUE_LEN];
+                m->left = inst[i].cost;
+                m->enqueued = now;
+            }
+        }
+
+        /* each core runs its messages in order */
+        for (k = 0; k < NUM_CORES; k++) {
+            c = &cores[k];
+            units = core_capacity[k] - core_background[k];
+            c->busy_units += core_background[k];
+
+            while (units > 0 && c->head != c->tail) {
+                m = &c->queue[c->head % QUEUE_LEN];
+                if (m->left > units) {
+                    m->left -= units;
+                    c->busy_units += units;
+                    units = 0;
+                    break;
+                }
+                units -= m->left;
+                c->busy_units += m->left;
+                c->head++;
+
+                if (num_lat < MAX_SAMPLES) {
+                    latencies[num_lat++] = now + 1 - m->enqueued;
+                }
+                sum_lat += now + 1 - m->enqueued;
+            }
+
+            depth = c->tail - c->head;
+            if (depth > c->max_depth) {
+                c->max_depth = depth;
+            }
+            if (depth > max_depth) {
+                max_depth = depth;
+            }
+        }
+    }
+
+    qsort(latencies, num_lat, sizeof(uint32_t), compare);
+
+    printf("%-11s %8u %8u %8u %8u  %u/%u/%u", policy_names[policy],
+           num_lat ? sum_lat / num_lat : 0,
+           num_lat ? latencies[num_lat / 2] : 0,
+           num_lat ? latencies[(num_lat * 99) / 100] : 0,
+           max_depth, cores[0].placed, cores[1].placed, cores[2].placed);
+    if (cores[0].dropped + cores[1].dropped + cores[2].dropped) {
+        printf("  (%u dropped)",
+               cores[0].dropped + cores[1].dropped + cores[2].dropped);
+    }
+    printf("\n");
+}
+
+static int simulate(int num_instances, uint32_t refresh)
+{
+    struct instance *inst;
+    struct omx_load loads[NUM_CORES];
+    int valid[NUM_CORES] = { 1, 1, 1 };
+    struct timespec start, end;
+    uint32_t duration = 0;
+    volatile int sink = 0;
+    long i;
+    int p;
+
+    inst = malloc(num_instances * sizeof(struct instance));
+    if (inst == NULL) {
+        printf("omx_place: out of memory\n");
+        return 1;
+    }
+
+    make_instances(inst, num_instances, &duration);
+
+    printf("omx_place: %d instances over %u ms, loads queried every %u ms\n",
+           num_instances, duration, refresh);
+    printf("%-11s %8s %8s %8s %8s  %s\n", "policy", "avg ms", "p50 ms",
+           "p99 ms", "maxqueue", "CORE0/CORE1/DSP");
+
+    for (p = 0; p < NUM_POLICIES; p++) {
+        sim(inst, num_instances, duration, refresh, p);
+    }
+
+    /* cost of one decision, on the last loads of the simulation */
+    for (p = 0; p < NUM_CORES; p++) {
+        loads[p].instances = cores[p].instances + p;
+        loads[p].type_instances = cores[p].instances;
+        loads[p].queue_depth = cores[p].tail - cores[p].head;
+        loads[p].idle_percent = 50;
+    }
+
+    clock_gettime(CLOCK_REALTIME, &start);
+    for (i = 0; i < PICK_ITERATIONS; i++) {
+        loads[i % NUM_CORES].queue_depth ^= sink & 1;
+        sink += omx_place_pick(loads, valid, NUM_CORES);
+    }
+    clock_gettime(CLOCK_REALTIME, &end);
+
+    printf("omx_place_pick: %ld nsecs per decision\n",
+           diff(start, end) * 1000 / (PICK_ITERATIONS / 1000) / 1000);
+
+    free(inst);
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    int num_instances = 2000;
+    int refresh = 50;
+
+    if (argc >= 2 && !strcmp(argv[1], "query")) {
+        return query(argc >= 3 ? argv[2] : "OMX");
+    }
+
+    if (argc >= 2 && !strcmp(argv[1], "sim")) {
+        if (argc >= 3) {
+            num_instances = atoi(argv[2]);
+        }
+        if (argc >= 4) {
+            refresh = atoi(argv[3]);
+        }
+        if (num_instances <= 0 || refresh <= 0) {
+            printf("Incorrect input argument for num_instances or "
+                   "refresh_ms\n");
+            return 1;
+        }
+        return simulate(num_instances, refresh);
+    }
+
+    printf("Usage: omx_place query [<service>]\n"
+           "       omx_place sim [<num_instances> [<refresh_ms>]]\n");
+
+    return 1;
+}
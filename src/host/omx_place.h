@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2011-2012, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * omx_place.h
+ *
+ * Placement of new service instances across the remote cores.
+ *
+ * Each core's ServiceMgr runs a "ServiceMgr_Load" service. Function 0 of
+ * that service takes the name of a service type and returns the load of
+ * the core: its service instances, instances of that type, messages
+ * waiting for a worker thread and an idle percentage estimate.
+ *
+ * omx_place_open() connects to the load service of a core, and
+ * omx_place_query() asks it for its load. omx_place_pick() compares the
+ * loads of the cores and returns the one to create the next instance on.
+ * omx_place_account() adds a placed instance to the cached load, so that
+ * instances placed before the next query are spread out rather than all
+ * going to the core which was least loaded at query time.
+ */
+#ifndef OMX_PLACE_H
+#define OMX_PLACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define OMX_PLACE_SERVICE   "ServiceMgr_Load"
+#define OMX_PLACE_MAX_CORES 3
+
+/* must match ServiceMgr_Load */
+struct omx_load {
+    uint32_t instances;         // service instances of all types
+    uint32_t type_instances;    // instances of the service type asked about
+    uint32_t queue_depth;       // messages waiting for a worker thread
+    uint32_t idle_percent;      // estimated idle time, 0 to 100
+};
+
+/* must match ServiceMgr_LoadArgs */
+struct omx_load_args {
+    char            name[48];
+    struct omx_load load;
+};
+
+/*
+ * Weights of the placement score, lower scores win. A busy percent point
+ * counts as much as a queued message; instances count for their expected
+ * future load, those of the same type more, since they compete for the
+ * same worker pool.
+ */
+#define OMX_PLACE_BUSY_WEIGHT       1
+#define OMX_PLACE_QUEUE_WEIGHT      1
+#define OMX_PLACE_INST_WEIGHT       2
+#define OMX_PLACE_TYPE_WEIGHT       8
+
+static inline uint32_t omx_place_score(const struct omx_load *load)
+{
+    uint32_t idle = load->idle_percent > 100 ? 100 : load->idle_percent;
+
+    return (100 - idle) * OMX_PLACE_BUSY_WEIGHT +
+        load->queue_depth * OMX_PLACE_QUEUE_WEIGHT +
+        load->instances * OMX_PLACE_INST_WEIGHT +
+        load->type_instances * OMX_PLACE_TYPE_WEIGHT;
+}
+
+/*
+ * Return the index of the core to place a new instance on, among the n
+ * cores whose valid[] entry is set, or -1 if there is none. Ties go to
+ * the core with fewer instances of the type, then to the lower index.
+ */
+static inline int omx_place_pick(const struct omx_load *loads,
+        const int *valid, int n)
+{
+    int best = -1;
+    uint32_t best_score = 0;
+    uint32_t score;
+    int i;
+
+    for (i = 0; i < n; i++) {
+        if (!valid[i]) {
+            continue;
+        }
+
+        score = omx_place_score(&loads[i]);
+
+        if (best < 0 || score < best_score ||
+            (score == best_score &&
+             loads[i].type_instances < loads[best].type_instances)) {
+            best = i;
+            best_score = score;
+        }
+    }
+
+    return best;
+}
+
+/* Count an instance just placed on a core, until its next query */
+static inline void omx_place_account(struct omx_load *load)
+{
+    load->instances++;
+    load->type_instances++;
+}
+
+#ifdef OMX_IOCCONNECT
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include "omx_packet.h"
+
+/* Connect to the load service of core rproc, returns the fd or -1 */
+static inline int omx_place_open(int rproc)
+{
+    struct omx_conn_req connreq;
+    char rpmsg_dev[20];
+    int fd;
+
+    sprintf(rpmsg_dev, "/dev/rpmsg-omx%d", rproc);
+
+    fd = open(rpmsg_dev, O_RDWR);
+    if (fd < 0) {
+        return -1;
+    }
+
+    memset(&connreq, 0, sizeof(connreq));
+    strncpy(connreq.name, OMX_PLACE_SERVICE, sizeof(connreq.name) - 1);
+
+    if (ioctl(fd, OMX_IOCCONNECT, &connreq) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/* Get the load of the core behind fd for service type name (or NULL) */
+static inline int omx_place_query(int fd, const char *name,
+        struct omx_load *load)
+{
+    char packet_buf[sizeof(omx_packet) + sizeof(struct omx_load_args)];
+    char return_buf[512];
+    omx_packet *packet = (omx_packet *)packet_buf;
+    omx_packet *rtn_packet = (omx_packet *)return_buf;
+    struct omx_load_args *args = (struct omx_load_args *)packet->data;
+
+    memset(packet_buf, 0, sizeof(packet_buf));
+    packet->desc = OMX_DESC_MSG << OMX_DESC_TYPE_SHIFT;
+    packet->msg_id = 0;
+    packet->flags = OMX_POOLID_JOBID_NONE;
+    packet->fxn_idx = 0;
+    packet->data_size = sizeof(struct omx_load_args);
+    if (name != NULL) {
+        strncpy(args->name, name, sizeof(args->name) - 1);
+    }
+
+    if (write(fd, packet, sizeof(packet_buf)) < 0) {
+        return -1;
+    }
+
+    if (read(fd, rtn_packet, sizeof(return_buf)) < 0) {
+        return -1;
+    }
+
+    if (((rtn_packet->desc & OMX_DESC_TYPE_MASK) >> OMX_DESC_TYPE_SHIFT) !=
+        OMXSERVER_STATUS_SUCCESS || rtn_packet->result != 0) {
+        return -1;
+    }
+
+    args = (struct omx_load_args *)rtn_packet->data;
+    *load = args->load;
+
+    return 0;
+}
+
+#endif /* OMX_IOCCONNECT */
+
+#endif /* OMX_PLACE_H */
@@ -53,6 +53,7 @@
 #include "../../include/linux/rpmsg_omx.h"
 
 #include "omx_packet.h"
+#include "omx_fxntab.h"
 
 #define CALLBACK_DATA       "OMX_Callback"
 #define SUCCESS             0
@@ -61,13 +62,6 @@
 /* Some Example OMX Application stuff: */
 #define H264_DECODER_NAME   "H264_decoder"
 
-/* Note: Set bit 31 to indicate static function indicies:
- * This function order will be hardcoded on BIOS side, hence preconfigured:
- */
-#define FXN_IDX_OMX_GETHANDLE        (0 | 0x80000000)
-#define FXN_IDX_OMX_SETPARAMETER     (1 | 0x80000000)
-#define FXN_IDX_OMX_GETPARAMETER     (2 | 0x80000000)
-
 /* OMX_HANDLETYPE defined elsewhere, but for this example ... */
 typedef uint32_t OMX_HANDLETYPE;
 
@@ -154,7 +148,7 @@ int test_h264_decoder(int fd, int i)
     init_omx_packet(packet, OMX_DESC_MSG);
 
     /* Set OMX Function Index to call, with data: */
-    packet->fxn_idx = FXN_IDX_OMX_GETHANDLE;
+    packet->fxn_idx = FXN_IDX_RPC_SKEL_GETHANDLE;
     /* Set data for the OMX function: */
     packet->data_size = strlen(H264_DECODER_NAME) + sizeof(map_info) + 1;
     memcpy(packet->data, &map_info, sizeof(map_info));
@@ -184,7 +178,7 @@ int test_h264_decoder(int fd, int i)
 
     /* now call SetParameter, passing back omx_handle...*/
     init_omx_packet(packet, OMX_DESC_MSG);
-    packet->fxn_idx = FXN_IDX_OMX_SETPARAMETER;
+    packet->fxn_idx = FXN_IDX_RPC_SKEL_SETPARAMETER;
     packet->data_size = sizeof(OMX_HANDLETYPE) + sizeof(map_info);
     memcpy(packet->data, &map_info, sizeof(map_info));
     memcpy(packet->data + sizeof(map_info), &omx_handle, sizeof(OMX_HANDLETYPE));
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2011-2012, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * omx_stress.c
+ *
+ * Connect/disconnect stress test for the ServiceMgr instance registry.
+ *
+ * Each round connects <num_instances> OMX service instances, holding all
+ * of them open at once, and then closes them all back to back, the way an
+ * application tearing down a large graph does. The time of each connect
+ * and of each disconnect is recorded, together with the time for the
+ * whole burst, so lookups that slow down as the number of live instances
+ * grows show up directly in the numbers.
+ *
+ * Usage:
+ * ------
+ * omx_stress [<processor> [<num_instances> [<num_rounds>]]]
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "../../include/linux/rpmsg_omx.h"
+
+#define MAX_INSTANCES       1024
+
+long diff(struct timespec start, struct timespec end)
+{
+    struct timespec temp;
+
+    if ((end.tv_nsec - start.tv_nsec) < 0) {
+        temp.tv_sec = end.tv_sec - start.tv_sec - 1;
+        temp.tv_nsec = 1000000000UL + end.tv_nsec - start.tv_nsec;
+    } else {
+        temp.tv_sec = end.tv_sec - start.tv_sec;
+        temp.tv_nsec = end.tv_nsec - start.tv_nsec;
+    }
+
+    return (temp.tv_sec * 1000000UL + temp.tv_nsec / 1000);
+}
+
+static int compare(const void *a, const void *b)
+{
+    long va = *(const long *)a;
+    long vb = *(const long *)b;
+
+    return (va > vb) - (va < vb);
+}
+
+/* Value below which pct percent of the sorted samples fall */
+static long percentile(long *sorted, int n, int pct)
+{
+    int i = (n * pct + 99) / 100 - 1;
+
+    return sorted[i < 0 ? 0 : i];
+}
+
+static void report(const char *what, long *samples, int n, long total)
+{
+    long sum = 0;
+    long first, last;
+    int i;
+
+    for (i = 0; i < n; i++) {
+        sum += samples[i];
+    }
+
+    /* registry growth shows as the last instances being slower */
+    first = samples[0];
+    last = samples[n - 1];
+
+    qsort(samples, n, sizeof(long), compare);
+
+    printf("  %s: %d in %ld usecs\n", what, n, total);
+    printf("    avg: %ld usecs\n", sum / n);
+    printf("    min: %ld usecs\n", samples[0]);
+    printf("    p50: %ld usecs\n", percentile(samples, n, 50));
+    printf("    p99: %ld usecs\n", percentile(samples, n, 99));
+    printf("    max: %ld usecs\n", samples[n - 1]);
+    printf("    first/last: %ld/%ld usecs\n", first, last);
+}
+
+int main(int argc, char *argv[])
+{
+    int ret = 0;
+    int i, n, round;
+    int rproc = 1;
+    int num_instances = 256;
+    int num_rounds = 4;
+    int *fds;
+    long *conn;
+    long *disc;
+    long total;
+    struct omx_conn_req connreq = { .name = "OMX" };
+    char rpmsg_dev[20];
+    struct timespec start, end, burst;
+
+    switch (argc) {
+    case 4:
+        num_rounds = atoi(argv[3]);
+        /* fall through */
+    case 3:
+        num_instances = atoi(argv[2]);
+        /* fall through */
+    case 2:
+        rproc = atoi(argv[1]);
+        break;
+    case 1:
+        break;
+    default:
+        ret = 1;
+        break;
+    }
+
+    if (rproc < 0 || rproc > 2) {
+        printf("Incorrect input argument for processor, should be 0, 1 or 2\n");
+        ret = 1;
+    }
+    if (num_instances <= 0 || num_instances > MAX_INSTANCES) {
+        printf("Incorrect input argument for num_instances, should be "
+               "1 to %d\n", MAX_INSTANCES);
+        ret = 1;
+    }
+    if (num_rounds <= 0) {
+        printf("Incorrect input argument for num_rounds\n");
+        ret = 1;
+    }
+
+    if (ret) {
+        printf("Usage: omx_stress [<processor> [<num_instances> "
+               "[<num_rounds>]]]\n");
+        return ret;
+    }
+
+    fds = malloc(num_instances * sizeof(int));
+    conn = malloc(num_instances * sizeof(long));
+    disc = malloc(num_instances * sizeof(long));
+    if (fds == NULL || conn == NULL || disc == NULL) {
+        printf("omx_stress: out of memory\n");
+        return 1;
+    }
+
+    sprintf(rpmsg_dev, "/dev/rpmsg-omx%d", rproc);
+
+    for (round = 0; round < num_rounds && !ret; round++) {
+        /* connect storm */
+        clock_gettime(CLOCK_REALTIME, &burst);
+        for (n = 0; n < num_instances; n++) {
+            clock_gettime(CLOCK_REALTIME, &start);
+
+            fds[n] = open(rpmsg_dev, O_RDWR);
+            if (fds[n] < 0) {
+                perror("Can't open OMX device");
+                ret = 1;
+                break;
+            }
+
+            if (ioctl(fds[n], OMX_IOCCONNECT, &connreq) < 0) {
+                perror("Can't connect to OMX instance");
+                close(fds[n]);
+                ret = 1;
+                break;
+            }
+
+            clock_gettime(CLOCK_REALTIME, &end);
+            conn[n] = diff(start, end);
+        }
+        clock_gettime(CLOCK_REALTIME, &end);
+        total = diff(burst, end);
+
+        if (n == 0) {
+            break;
+        }
+
+        printf("omx_stress: round %d, %d instances of %s\n", round, n,
+               connreq.name);
+        report("connect", conn, n, total);
+
+        /* disconnect storm, oldest instance first */
+        clock_gettime(CLOCK_REALTIME, &burst);
+        for (i = 0; i < n; i++) {
+            clock_gettime(CLOCK_REALTIME, &start);
+
+            if (close(fds[i]) < 0) {
+                perror("Can't close OMX fd ??");
+                ret = 1;
+            }
+
+            clock_gettime(CLOCK_REALTIME, &end);
+            disc[i] = diff(start, end);
+        }
+        clock_gettime(CLOCK_REALTIME, &end);
+        total = diff(burst, end);
+
+        report("disconnect", disc, n, total);
+    }
+
+    free(fds);
+    free(conn);
+    free(disc);
+
+    return ret;
+}
@@ -0,0 +1,334 @@
+/*
+ * Copyright (c) 2011-2012, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * rcm_profile.c
+ *
+ * Print the per-function profile kept by an OMX RcmServer instance.
+ *
+ * Connects to the OMX ServiceMgr, reads the function profile table through
+ * the reserved OMX_FXNIDX_STATS function index, and prints it sorted by the
+ * chosen column. Functions which have never been called are not shown.
+ * The server only keeps the profile when created with
+ * RcmServer_Params.profile set, as test_omx.c does.
+ *
+ * Each connection creates a new RcmServer instance, so the profile covers
+ * only the calls made over this connection. The tool first issues
+ * <num_calls> fxnDouble calls (see test_omx.c) as a workload.
+ *
+ * Usage:
+ * ------
+ * rcm_profile [<processor> [<num_calls> [total|calls|avg|max|wait]]]
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include "../../include/linux/rpmsg_omx.h"
+
+#include "omx_packet.h"
+#include "omx_fxntab.h"
+
+/* Largest packet which fits in a 512 byte rpmsg buffer, after the rpmsg
+ * header (16 bytes) and the rpmsg_omx header (12 bytes).
+ */
+#define MAX_PACKET_SIZE     (512 - 16 - 12)
+
+#define MAX_ENTRIES         1024
+
+/* The data portion of an OMX function call starts with this word */
+#define RPC_OMX_MAP_INFO_NONE 0
+
+enum sort_key {
+    SORT_TOTAL,
+    SORT_CALLS,
+    SORT_AVG,
+    SORT_MAX,
+    SORT_WAIT
+};
+
+typedef struct {
+    uint32_t    fxn_idx;
+    uint32_t    calls;
+    uint32_t    min_ticks;
+    uint32_t    max_ticks;
+    uint64_t    exec_ticks;
+    uint64_t    wait_ticks;
+    char        name[OMX_STATS_NAMELEN];
+} fxn_profile;
+
+static enum sort_key sort_by = SORT_TOTAL;
+
+static uint64_t sort_value(const fxn_profile *p)
+{
+    switch (sort_by) {
+    case SORT_CALLS:
+        return p->calls;
+    case SORT_AVG:
+        return p->calls ? p->exec_ticks / p->calls : 0;
+    case SORT_MAX:
+        return p->max_ticks;
+    case SORT_WAIT:
+        return p->wait_ticks;
+    case SORT_TOTAL:
+    default:
+        return p->exec_ticks;
+    }
+}
+
+static int compare(const void *a, const void *b)
+{
+    uint64_t va = sort_value((const fxn_profile *)a);
+    uint64_t vb = sort_value((const fxn_profile *)b);
+
+    /* descending order */
+    return (va < vb) - (va > vb);
+}
+
+/* Issue fxnDouble calls to give the profile something to show */
+int run_workload(int fd, int num_calls)
+{
+    char              packet_buf[512] = {0};
+    char              return_buf[512] = {0};
+    omx_packet        *packet = (omx_packet *)packet_buf;
+    int               i;
+
+    for (i = 0; i < num_calls; i++) {
+        packet->desc = OMX_DESC_MSG << OMX_DESC_TYPE_SHIFT;
+        packet->msg_id = 0;
+        packet->flags = OMX_POOLID_JOBID_NONE;
+        packet->fxn_idx = FXN_IDX_FXNDOUBLE;
+        packet->result = 0;
+        packet->data_size = 2 * sizeof(uint32_t);
+        packet->data[0] = RPC_OMX_MAP_INFO_NONE;
+        packet->data[1] = i;
+
+        if (write(fd, packet, sizeof(omx_packet) + packet->data_size) < 0) {
+            perror("Can't write to OMX instance");
+            return -1;
+        }
+        if (read(fd, return_buf, sizeof(return_buf)) < 0) {
+            perror("Can't read from OMX instance");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Read the whole profile table, one packet at a time */
+int read_profile(int fd, fxn_profile *table, int max, uint32_t *freq)
+{
+    char              packet_buf[512] = {0};
+    char              return_buf[512] = {0};
+    omx_packet        *packet = (omx_packet *)packet_buf;
+    omx_packet        *rtn_packet = (omx_packet *)return_buf;
+    omx_stats_hdr     *hdr;
+    omx_stats_rec     *rec;
+    uint16_t          server_status;
+    uint32_t          first = 0;
+    uint32_t          i;
+    int               n = 0;
+    int               ret;
+
+    do {
+        packet->desc = OMX_DESC_MSG << OMX_DESC_TYPE_SHIFT;
+        packet->msg_id = 0;
+        packet->flags = OMX_POOLID_JOBID_NONE;
+        packet->fxn_idx = OMX_FXNIDX_STATS;
+        packet->result = 0;
+        packet->data_size = MAX_PACKET_SIZE - sizeof(omx_packet);
+
+        hdr = (omx_stats_hdr *)packet->data;
+        memset(hdr, 0, sizeof(*hdr));
+        hdr->first = first;
+
+        ret = write(fd, packet, sizeof(omx_packet) + packet->data_size);
+        if (ret < 0) {
+            perror("Can't write to OMX instance");
+            return -1;
+        }
+
+        ret = read(fd, rtn_packet, sizeof(return_buf));
+        if (ret < 0) {
+            perror("Can't read from OMX instance");
+            return -1;
+        }
+
+        server_status = (OMX_DESC_TYPE_MASK & rtn_packet->desc) >>
+                OMX_DESC_TYPE_SHIFT;
+        if (server_status != OMXSERVER_STATUS_SUCCESS) {
+            printf("rcm_profile: server status: %d\n", server_status);
+            return -1;
+        }
+
+        hdr = (omx_stats_hdr *)rtn_packet->data;
+        rec = (omx_stats_rec *)(hdr + 1);
+        *freq = hdr->freq;
+
+        for (i = 0; i < hdr->count; i++, rec++) {
+            if (rec->calls == 0 || n >= max) {
+                continue;
+            }
+            table[n].fxn_idx = rec->fxn_idx;
+            table[n].calls = rec->calls;
+            table[n].min_ticks = rec->min_ticks;
+            table[n].max_ticks = rec->max_ticks;
+            table[n].exec_ticks = ((uint64_t)rec->exec_hi << 32) | rec->exec_lo;
+            table[n].wait_ticks = ((uint64_t)rec->wait_hi << 32) | rec->wait_lo;
+            memcpy(table[n].name, rec->name, OMX_STATS_NAMELEN);
+            table[n].name[OMX_STATS_NAMELEN - 1] = '\0';
+            n++;
+        }
+        first += hdr->count;
+
+    } while (hdr->count > 0 && first < hdr->total);
+
+    return n;
+}
+
+/* Convert ticks to usecs */
+static double usecs(uint64_t ticks, uint32_t freq)
+{
+    return freq ? (double)ticks * 1000000.0 / freq : 0.0;
+}
+
+void print_profile(fxn_profile *table, int n, uint32_t freq)
+{
+    int i;
+
+    printf("%-16s %10s %10s %12s %10s %10s %10s %12s\n", "function",
+            "index", "calls", "total(us)", "avg(us)", "min(us)", "max(us)",
+            "avgwait(us)");
+
+    for (i = 0; i < n; i++) {
+        printf("%-16s 0x%08x %10u %12.1f %10.2f %10.2f %10.2f %12.2f\n",
+                table[i].name[0] ? table[i].name : "?",
+                table[i].fxn_idx, table[i].calls,
+                usecs(table[i].exec_ticks, freq),
+                usecs(table[i].exec_ticks / table[i].calls, freq),
+                usecs(table[i].min_ticks, freq),
+                usecs(table[i].max_ticks, freq),
+                usecs(table[i].wait_ticks / table[i].calls, freq));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int fd;
+    int ret = 0;
+    int n;
+    int rproc = 0;
+    int num_calls = 0;
+    uint32_t freq = 0;
+    struct omx_conn_req connreq = { .name = "OMX" };
+    char rpmsg_dev[20];
+    static fxn_profile table[MAX_ENTRIES];
+
+    switch (argc) {
+    case 4:
+        if (!strcmp(argv[3], "total")) {
+            sort_by = SORT_TOTAL;
+        }
+        else if (!strcmp(argv[3], "calls")) {
+            sort_by = SORT_CALLS;
+        }
+        else if (!strcmp(argv[3], "avg")) {
+            sort_by = SORT_AVG;
+        }
+        else if (!strcmp(argv[3], "max")) {
+            sort_by = SORT_MAX;
+        }
+        else if (!strcmp(argv[3], "wait")) {
+            sort_by = SORT_WAIT;
+        }
+        else {
+            ret = 1;
+        }
+        /* fall through */
+    case 3:
+        num_calls = atoi(argv[2]);
+        /* fall through */
+    case 2:
+        rproc = atoi(argv[1]);
+        break;
+    case 1:
+        break;
+    default:
+        ret = 1;
+        break;
+    }
+
+    if (rproc < 0 || rproc > 2) {
+        printf("Incorrect input argument for processor, should be 0, 1 or 2\n");
+        ret = 1;
+    }
+
+    if (ret) {
+        printf("Usage: rcm_profile [<processor> [<num_calls> "
+               "[total|calls|avg|max|wait]]]\n");
+        return ret;
+    }
+
+    sprintf(rpmsg_dev, "/dev/rpmsg-omx%d", rproc);
+
+    fd = open(rpmsg_dev, O_RDWR);
+    if (fd < 0) {
+        perror("Can't open OMX device");
+        return 1;
+    }
+
+    ret = ioctl(fd, OMX_IOCCONNECT, &connreq);
+    if (ret < 0) {
+        perror("Can't connect to OMX instance");
+        return 1;
+    }
+
+    n = run_workload(fd, num_calls);
+    if (n == 0) {
+        n = read_profile(fd, table, MAX_ENTRIES, &freq);
+    }
+    if (n >= 0) {
+        qsort(table, n, sizeof(fxn_profile), compare);
+        print_profile(table, n, freq);
+    }
+
+    close(fd);
+
+    return n < 0 ? 1 : 0;
+}
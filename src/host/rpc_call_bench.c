@@ -0,0 +1,496 @@
+/*
+ * Copyright (c) 2011-2012, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * rpc_call_bench.c
+ *
+ * Compare the two ways an OmapRpc client can call a remote function:
+ *
+ *   rcm     the RCM packet (OmapRpc_Packet) carrying OmapRpc_Parameter
+ *           (size, data) pairs; buffer pointers, including the ones
+ *           stored inside buffers, are translated on the host before
+ *           sending. The reply echoes the whole packet.
+ *   direct  the RcmServer_CallMsg (rpmsg header type RcmServer_HDR_CALL,
+ *           see ti/grcm/RcmTypes.h) with typed parameters and a pointer
+ *           translation table; the remote core translates through its
+ *           resource table. The reply is the call header only.
+ *
+ * The rpmsg-omx driver only sends OMX_RAW_MSG messages, so the direct
+ * call cannot be driven from user space with it yet. This benchmark runs
+ * both message formats through the same steps on the host instead: the
+ * client encodes the call, the server side decodes and validates it,
+ * maps the buffers (address lookups against a three entry carveout table
+ * like the one IpcMemory searches), calls the function and builds the
+ * reply. It prints the bytes each call puts on the link in both
+ * directions and the time per call.
+ *
+ * Usage:
+ * ------
+ * rpc_call_bench [<num_params> [<num_xlts> [<iterations>]]]
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#define MAX_PARAMS          10
+#define MAX_XLTS            16
+#define MSG_SIZE            512
+#define BUF_SIZE            256
+
+/* rpmsg_omx / OmapRpc message header */
+struct msg_hdr {
+    uint32_t type;
+    uint32_t flags;
+    uint32_t len;
+};
+
+/* OmapRpc_Packet, followed by OmapRpc_Parameter pairs */
+struct rcm_packet {
+    uint16_t desc;
+    uint16_t msg_id;
+    uint16_t pool_id;
+    uint16_t job_id;
+    uint32_t fxn_idx;
+    int32_t  result;
+    uint32_t data_size;
+};
+
+struct rcm_param {
+    uint32_t size;
+    uint32_t data;
+};
+
+/* RcmServer_CallMsg, RcmServer_CallParam and RcmServer_CallXlt */
+struct call_msg {
+    uint16_t msg_id;
+    uint8_t  num_params;
+    uint8_t  num_xlts;
+    uint32_t fxn_idx;
+    int32_t  result;
+};
+
+struct call_param {
+    uint32_t desc;
+    uint32_t data;
+};
+
+struct call_xlt {
+    uint16_t index;
+    uint16_t offset;
+};
+
+#define HDR_RAW             5
+#define HDR_CALL            11
+#define HDR_CALL_RETURN     12
+#define DESC_EXEC_SYNC      0x0100
+#define POOLID_DEFAULT      0x8000
+#define PARAM_VALUE         0x0
+#define PARAM_IN            0x1
+#define PARAM_OUT           0x2
+#define PARAM_DESC(t, s)    (((t) << 28) | ((s) & 0x0FFFFFFF))
+#define PARAM_TYPE(d)       ((d) >> 28)
+#define PARAM_SIZE(d)       ((d) & 0x0FFFFFFF)
+
+/* carveouts: physical base, device address, size */
+struct region {
+    uint32_t pa;
+    uint32_t da;
+    uint32_t size;
+};
+
+static const struct region regions[] = {
+    { 0xB3A00000, 0x00000000, 0x00100000 },     /* text */
+    { 0xB3B00000, 0x80000000, 0x00600000 },     /* data */
+    { 0xB4100000, 0xA0000000, 0x09000000 },     /* io buffers */
+};
+
+#define NUM_REGIONS (sizeof(regions) / sizeof(regions[0]))
+
+/* a client call: parameters and the pointers stored in its buffers */
+struct call {
+    int num_params;
+    int num_xlts;
+    uint32_t type[MAX_PARAMS];
+    uint32_t size[MAX_PARAMS];
+    uint32_t data[MAX_PARAMS];          /* value or physical address */
+    uint16_t xlt_index[MAX_XLTS];
+    uint16_t xlt_offset[MAX_XLTS];
+};
+
+/* the buffers, as seen by the server (by device address) */
+static uint8_t buffers[MAX_PARAMS][BUF_SIZE];
+
+static volatile int32_t sink;
+
+long diff(struct timespec start, struct timespec end)
+{
+    struct timespec temp;
+
+    if ((end.tv_nsec - start.tv_nsec) < 0) {
+        temp.tv_sec = end.tv_sec - start.tv_sec - 1;
+        temp.tv_nsec = 1000000000UL + end.tv_nsec - start.tv_nsec;
+    } else {
+        temp.tv_sec = end.tv_sec - start.tv_sec;
+        temp.tv_nsec = end.tv_nsec - start.tv_nsec;
+    }
+
+    return (temp.tv_sec * 1000000UL + temp.tv_nsec / 1000);
+}
+
+/* IpcMemory_physToVirt */
+static int phys_to_virt(uint32_t pa, uint32_t *da)
+{
+    unsigned i;
+
+    for (i = 0; i < NUM_REGIONS; i++) {
+        if (pa >= regions[i].pa && pa - regions[i].pa < regions[i].size) {
+            *da = pa - regions[i].pa + regions[i].da;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/* a whole buffer must be in one carveout (RcmServer_mapBulk_P) */
+static int map_buffer(uint32_t pa, uint32_t size, uint32_t *da)
+{
+    uint32_t last;
+
+    if (size == 0 || phys_to_virt(pa, da) < 0 ||
+        phys_to_virt(pa + size - 1, &last) < 0 || last - *da != size - 1) {
+        return -1;
+    }
+    return 0;
+}
+
+/* the remote function, in the OmapRpc_Parameter convention */
+static int32_t remote_fxn(uint32_t size, uint32_t *data)
+{
+    uint32_t n = size / (2 * sizeof(uint32_t));
+    int32_t sum = 0;
+    uint32_t i;
+
+    for (i = 0; i < n; i++) {
+        sum += data[2 * i + 1];
+    }
+    return sum;
+}
+
+/* ---- RCM path ---- */
+
+static int rcm_encode(const struct call *c, uint8_t *msg)
+{
+    struct msg_hdr *hdr = (struct msg_hdr *)msg;
+    struct rcm_packet *pkt = (struct rcm_packet *)(hdr + 1);
+    struct rcm_param *param = (struct rcm_param *)(pkt + 1);
+    uint32_t *ptr;
+    int i;
+
+    pkt->desc = DESC_EXEC_SYNC;
+    pkt->msg_id = 1;
+    pkt->pool_id = POOLID_DEFAULT;
+    pkt->job_id = 0;
+    pkt->fxn_idx = 0x80000001;
+    pkt->result = 0;
+    pkt->data_size = c->num_params * sizeof(struct rcm_param);
+
+    /* the host driver translates every pointer before sending */
+    for (i = 0; i < c->num_params; i++) {
+        param[i].size = c->size[i];
+        if (c->type[i] == PARAM_VALUE) {
+            param[i].data = c->data[i];
+        }
+        else if (map_buffer(c->data[i], c->size[i], &param[i].data) < 0) {
+            return -1;
+        }
+    }
+    for (i = 0; i < c->num_xlts; i++) {
+        ptr = (uint32_t *)&buffers[c->xlt_index[i]][c->xlt_offset[i]];
+        if (phys_to_virt(*ptr, ptr) < 0) {
+            return -1;
+        }
+    }
+
+    hdr->type = HDR_RAW;
+    hdr->flags = 0;
+    hdr->len = sizeof(struct rcm_packet) + pkt->data_size;
+
+    return sizeof(struct msg_hdr) + hdr->len;
+}
+
+static int rcm_serve(uint8_t *msg, int len)
+{
+    struct msg_hdr *hdr = (struct msg_hdr *)msg;
+    struct rcm_packet *pkt = (struct rcm_packet *)(hdr + 1);
+
+    if (len < (int)(sizeof(*hdr) + sizeof(*pkt)) || hdr->type != HDR_RAW ||
+        (pkt->desc & 0x0F00) != DESC_EXEC_SYNC ||
+        pkt->pool_id != POOLID_DEFAULT ||
+        len < (int)(sizeof(*hdr) + sizeof(*pkt) + pkt->data_size) ||
+        (pkt->fxn_idx & 0x7FFFFFFF) != 1) {
+        return -1;
+    }
+
+    pkt->result = remote_fxn(pkt->data_size, (uint32_t *)(pkt + 1));
+
+    /* the whole packet goes back */
+    return sizeof(struct msg_hdr) + sizeof(struct rcm_packet) +
+        pkt->data_size;
+}
+
+/* the host driver translates the stored pointers back */
+static void rcm_complete(const struct call *c)
+{
+    uint32_t *ptr;
+    int i;
+
+    for (i = 0; i < c->num_xlts; i++) {
+        ptr = (uint32_t *)&buffers[c->xlt_index[i]][c->xlt_offset[i]];
+        *ptr = *ptr - regions[2].da + regions[2].pa;
+    }
+}
+
+/* ---- direct call path ---- */
+
+static int direct_encode(const struct call *c, uint8_t *msg)
+{
+    struct msg_hdr *hdr = (struct msg_hdr *)msg;
+    struct call_msg *cm = (struct call_msg *)(hdr + 1);
+    struct call_param *param = (struct call_param *)(cm + 1);
+    struct call_xlt *xlt = (struct call_xlt *)(param + c->num_params);
+    int i;
+
+    cm->msg_id = 1;
+    cm->num_params = c->num_params;
+    cm->num_xlts = c->num_xlts;
+    cm->fxn_idx = 0x80000001;
+    cm->result = 0;
+
+    for (i = 0; i < c->num_params; i++) {
+        param[i].desc = PARAM_DESC(c->type[i], c->size[i]);
+        param[i].data = c->data[i];
+    }
+    for (i = 0; i < c->num_xlts; i++) {
+        xlt[i].index = c->xlt_index[i];
+        xlt[i].offset = c->xlt_offset[i];
+    }
+
+    hdr->type = HDR_CALL;
+    hdr->flags = 0;
+    hdr->len = sizeof(struct call_msg) +
+        c->num_params * sizeof(struct call_param) +
+        c->num_xlts * sizeof(struct call_xlt);
+
+    return sizeof(struct msg_hdr) + hdr->len;
+}
+
+/* RcmServer_msgCall_P */
+static int direct_serve(uint8_t *msg, int len)
+{
+    struct msg_hdr *hdr = (struct msg_hdr *)msg;
+    struct call_msg *cm = (struct call_msg *)(hdr + 1);
+    struct call_param *param = (struct call_param *)(cm + 1);
+    struct call_xlt *xlt;
+    uint32_t args[2 * MAX_PARAMS];
+    uint32_t saved[MAX_XLTS];
+    uint32_t *ptr;
+    uint32_t da;
+    int i, n;
+
+    if (len < (int)(sizeof(*hdr) + sizeof(*cm)) ||
+        cm->num_params > MAX_PARAMS || cm->num_xlts > MAX_XLTS ||
+        len < (int)(sizeof(*hdr) + sizeof(*cm) +
+                    cm->num_params * sizeof(struct call_param) +
+                    cm->num_xlts * sizeof(struct call_xlt)) ||
+        (cm->fxn_idx & 0x7FFFFFFF) != 1) {
+        return -1;
+    }
+
+    xlt = (struct call_xlt *)(param + cm->num_params);
+
+    for (i = 0; i < cm->num_params; i++) {
+        args[2 * i] = PARAM_SIZE(param[i].desc);
+        args[2 * i + 1] = param[i].data;
+        if (PARAM_TYPE(param[i].desc) != PARAM_VALUE &&
+            map_buffer(param[i].data, args[2 * i], &args[2 * i + 1]) < 0) {
+            return -1;
+        }
+    }
+
+    for (n = 0; n < cm->num_xlts; n++) {
+        i = xlt[n].index;
+        if (i >= cm->num_params || (xlt[n].offset & 3) ||
+            xlt[n].offset + sizeof(uint32_t) > args[2 * i]) {
+            return -1;
+        }
+        ptr = (uint32_t *)&buffers[i][xlt[n].offset];
+        if (phys_to_virt(*ptr, &da) < 0) {
+            return -1;
+        }
+        saved[n] = *ptr;
+        *ptr = da;
+    }
+
+    cm->result = remote_fxn(cm->num_params * 2 * sizeof(uint32_t), args);
+
+    while (n-- > 0) {
+        i = xlt[n].index;
+        *(uint32_t *)&buffers[i][xlt[n].offset] = saved[n];
+    }
+
+    /* only the header goes back */
+    hdr->type = HDR_CALL_RETURN;
+    hdr->len = sizeof(struct call_msg);
+
+    return sizeof(struct msg_hdr) + sizeof(struct call_msg);
+}
+
+/* ---- benchmark ---- */
+
+static void make_call(struct call *c, int num_params, int num_xlts)
+{
+    uint32_t pa = regions[2].pa + 0x1000;
+    int buf = 0;
+    int i;
+
+    memset(c, 0, sizeof(*c));
+    c->num_params = num_params;
+
+    /* alternate scalars and in/out buffers */
+    for (i = 0; i < num_params; i++) {
+        if (i % 2 == 0) {
+            c->type[i] = PARAM_VALUE;
+            c->size[i] = sizeof(uint32_t);
+            c->data[i] = i;
+        }
+        else {
+            c->type[i] = (i % 4 == 1) ? PARAM_IN : (PARAM_IN | PARAM_OUT);
+            c->size[i] = BUF_SIZE;
+            c->data[i] = pa + i * 0x1000;
+        }
+    }
+
+    /* pointers stored in the buffers, spread over them */
+    for (i = 0; i < num_xlts; i++) {
+        do {
+            buf = (buf + 1) % num_params;
+        } while (c->type[buf] == PARAM_VALUE);
+
+        c->xlt_index[i] = buf;
+        c->xlt_offset[i] = (i * sizeof(uint32_t)) % BUF_SIZE;
+        *(uint32_t *)&buffers[buf][c->xlt_offset[i]] = pa + 0x100000 + i * 64;
+    }
+    c->num_xlts = num_xlts;
+}
+
+int main(int argc, char *argv[])
+{
+    struct call c;
+    uint8_t msg[MSG_SIZE];
+    struct timespec start, end;
+    int num_params = 4;
+    int num_xlts = 2;
+    long iterations = 1000000;
+    int req, rsp;
+    long i;
+    long usecs;
+
+    if (argc >= 2) {
+        num_params = atoi(argv[1]);
+    }
+    if (argc >= 3) {
+        num_xlts = atoi(argv[2]);
+    }
+    if (argc >= 4) {
+        iterations = atol(argv[3]);
+    }
+
+    if (num_params < 0 || num_params > MAX_PARAMS || num_xlts < 0 ||
+        num_xlts > MAX_XLTS || (num_xlts > 0 && num_params < 2) ||
+        iterations <= 0) {
+        printf("Usage: rpc_call_bench [<num_params> [<num_xlts> "
+               "[<iterations>]]]\n"
+               "    num_params 0 to %d, num_xlts 0 to %d (needs "
+               "num_params >= 2)\n", MAX_PARAMS, MAX_XLTS);
+        return 1;
+    }
+
+    make_call(&c, num_params, num_xlts);
+
+    printf("rpc_call_bench: %d params, %d pointer translations, "
+           "%ld calls\n", num_params, num_xlts, iterations);
+    printf("%-7s %9s %9s %12s\n", "path", "req bytes", "rsp bytes",
+           "nsecs/call");
+
+    req = rcm_encode(&c, msg);
+    rsp = rcm_serve(msg, req);
+    rcm_complete(&c);
+    if (req < 0 || rsp < 0) {
+        printf("rcm: call rejected\n");
+        return 1;
+    }
+
+    clock_gettime(CLOCK_REALTIME, &start);
+    for (i = 0; i < iterations; i++) {
+        req = rcm_encode(&c, msg);
+        rsp = rcm_serve(msg, req);
+        rcm_complete(&c);
+        sink += ((struct rcm_packet *)(msg + sizeof(struct msg_hdr)))->result;
+    }
+    clock_gettime(CLOCK_REALTIME, &end);
+    usecs = diff(start, end);
+    printf("%-7s %9d %9d %12ld\n", "rcm", req, rsp,
+           usecs * 1000 / iterations);
+
+    req = direct_encode(&c, msg);
+    rsp = direct_serve(msg, req);
+    if (req < 0 || rsp < 0) {
+        printf("direct: call rejected\n");
+        return 1;
+    }
+
+    clock_gettime(CLOCK_REALTIME, &start);
+    for (i = 0; i < iterations; i++) {
+        req = direct_encode(&c, msg);
+        rsp = direct_serve(msg, req);
+        sink += ((struct call_msg *)(msg + sizeof(struct msg_hdr)))->result;
+    }
+    clock_gettime(CLOCK_REALTIME, &end);
+    usecs = diff(start, end);
+    printf("%-7s %9d %9d %12ld\n", "direct", req, rsp,
+           usecs * 1000 / iterations);
+
+    return 0;
+}
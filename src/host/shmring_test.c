@@ -0,0 +1,415 @@
+/*
+ * Copyright (c) 2011-2012, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * shmring_test.c
+ *
+ * Host test and benchmark of the ShmRing single producer, single consumer
+ * ring (see ti/ipc/rpmsg/ShmRing.h).
+ *
+ * The producer and consumer cores are two processes sharing an anonymous
+ * mapping that holds the ring header and slots, laid out like the
+ * firmware's. The put and get paths are those of ShmRing.c, with
+ * __sync_synchronize() as the barrier, and the mailbox doorbell is a
+ * process shared semaphore posted only while the consumer says it is
+ * waiting.
+ *
+ * Every message carries a sequence number, its send time and a payload
+ * derived from the sequence number, with a length varying from 8 bytes to
+ * the slot payload size. The consumer checks all three, so lost, repeated,
+ * reordered or torn messages are counted as errors.
+ *
+ * The consumer modes run in turn:
+ *   spin      get with a zero timeout in a loop, yielding the CPU in
+ *             between so that it also works on a single CPU host
+ *   doorbell  block until the producer rings
+ *   tick      no doorbell, sleep one 1 ms tick while empty (only
+ *             <messages> / 100 messages are sent)
+ *
+ * For each one the messages per second, the times the producer found the
+ * ring full and the doorbells rung per message, the mean and maximum
+ * latency and the errors are printed. The exit status is 1 on errors.
+ *
+ * Usage:
+ * ------
+ * shmring_test [<messages> [<slots> [<slot_size>]]]
+ *
+ * Build:
+ * ------
+ * gcc -O2 shmring_test.c -o shmring_test -lpthread
+ */
+
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <semaphore.h>
+#include <sched.h>
+#include <time.h>
+
+#define HEADER_SIZE     192     /* ShmRing_HEADER_SIZE */
+#define MAX_SLOTS       4096
+#define MAX_SLOT_SIZE   4096
+#define TICK_NS         1000000
+
+#define barrier()       __sync_synchronize()
+
+enum mode {
+    MODE_SPIN,
+    MODE_DOORBELL,
+    MODE_TICK,
+    NUM_MODES
+};
+
+static const char *mode_names[NUM_MODES] = {
+    "spin", "doorbell", "tick"
+};
+
+/* ShmRing_Header */
+struct ring_header {
+    volatile uint32_t magic;
+    volatile uint32_t num_slots;
+    volatile uint32_t slot_size;
+    uint32_t pad0[13];
+
+    volatile uint32_t write_idx;
+    uint32_t pad1[15];
+
+    volatile uint32_t read_idx;
+    volatile uint32_t waiting;
+    uint32_t pad2[14];
+};
+
+/* message layout used by the test */
+struct test_msg {
+    uint32_t seq;
+    uint32_t pad;
+    uint64_t sent_ns;
+    uint8_t data[];
+};
+
+/* in memory shared by the two processes, ahead of the ring */
+struct shared {
+    sem_t doorbell;
+    uint64_t full;
+    uint64_t rung;
+    uint64_t received;
+    uint64_t errors;
+    uint64_t total_latency_ns;
+    uint64_t max_latency_ns;
+    uint64_t elapsed_ns;
+};
+
+static unsigned num_msgs = 100000;
+static unsigned num_slots = 8;              /* ShmRing_DEFAULT_NUMSLOTS */
+static unsigned slot_size = 96;             /* ShmRing_DEFAULT_SLOTSIZE */
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint8_t *slot_of(struct ring_header *hdr, uint32_t idx)
+{
+    return (uint8_t *)hdr + HEADER_SIZE +
+           (idx & (hdr->num_slots - 1)) * hdr->slot_size;
+}
+
+/* ShmRing_put; returns 0, or -1 if the ring is full */
+static int ring_put(struct ring_header *hdr, struct shared *shm, int doorbell,
+                    const void *data, uint32_t len)
+{
+    uint32_t w = hdr->write_idx;
+    uint8_t *slot;
+
+    if (w - hdr->read_idx > hdr->num_slots - 1) {
+        return -1;
+    }
+    barrier();
+
+    slot = slot_of(hdr, w);
+    *(uint32_t *)slot = len;
+    memcpy(slot + sizeof(uint32_t), data, len);
+
+    barrier();
+    hdr->write_idx = w + 1;
+
+    if (doorbell) {
+        barrier();
+        if (hdr->waiting) {
+            shm->rung++;
+            sem_post(&shm->doorbell);
+        }
+    }
+
+    return 0;
+}
+
+/* ShmRing_get without a timeout; returns the message length */
+static uint32_t ring_get(struct ring_header *hdr, struct shared *shm,
+                         enum mode mode, void *data)
+{
+    struct timespec tick = { 0, TICK_NS };
+    uint32_t r = hdr->read_idx;
+    uint32_t len;
+    uint8_t *slot;
+
+    while (hdr->write_idx == r) {
+        if (mode == MODE_SPIN) {
+            sched_yield();
+            continue;
+        }
+        if (mode == MODE_TICK) {
+            nanosleep(&tick, NULL);
+            continue;
+        }
+
+        hdr->waiting = 1;
+        barrier();
+        if (hdr->write_idx != r) {
+            hdr->waiting = 0;
+            break;
+        }
+        while (sem_wait(&shm->doorbell) < 0 && errno == EINTR) {
+        }
+        /* the firmware semaphore is binary: drop extra posts */
+        while (sem_trywait(&shm->doorbell) == 0) {
+        }
+        hdr->waiting = 0;
+    }
+    barrier();
+
+    slot = slot_of(hdr, r);
+    len = *(uint32_t *)slot;
+    memcpy(data, slot + sizeof(uint32_t), len);
+
+    barrier();
+    hdr->read_idx = r + 1;
+
+    return len;
+}
+
+static uint32_t msg_len(uint32_t seq)
+{
+    uint32_t max = slot_size - sizeof(uint32_t);
+    uint32_t min = sizeof(struct test_msg);
+
+    return min + seq % (max - min + 1);
+}
+
+static void producer(struct ring_header *hdr, struct shared *shm,
+                     enum mode mode, unsigned count)
+{
+    uint8_t buf[MAX_SLOT_SIZE];
+    struct test_msg *msg = (struct test_msg *)buf;
+    uint32_t seq;
+    uint32_t len;
+    uint32_t i;
+
+    /* wait for the consumer to publish the ring */
+    while (hdr->magic == 0) {
+        sched_yield();
+    }
+    barrier();
+
+    for (seq = 0; seq < count; seq++) {
+        len = msg_len(seq);
+        msg->seq = seq;
+        for (i = 0; i < len - sizeof(*msg); i++) {
+            msg->data[i] = (uint8_t)(seq + i);
+        }
+        msg->sent_ns = now_ns();
+        while (ring_put(hdr, shm, mode == MODE_DOORBELL, buf, len) < 0) {
+            shm->full++;
+            sched_yield();
+        }
+    }
+}
+
+static void consumer(struct ring_header *hdr, struct shared *shm,
+                     enum mode mode, unsigned count)
+{
+    uint8_t buf[MAX_SLOT_SIZE];
+    struct test_msg *msg = (struct test_msg *)buf;
+    uint64_t start = 0;
+    uint64_t latency;
+    uint32_t seq;
+    uint32_t len;
+    uint32_t i;
+
+    /* ShmRing_create on the consumer side */
+    hdr->magic = 0;
+    barrier();
+    hdr->write_idx = 0;
+    hdr->read_idx = 0;
+    hdr->waiting = 0;
+    hdr->num_slots = num_slots;
+    hdr->slot_size = slot_size;
+    barrier();
+    hdr->magic = 0x52494E47;
+
+    for (seq = 0; seq < count; seq++) {
+        len = ring_get(hdr, shm, mode, buf);
+        latency = now_ns() - msg->sent_ns;
+        if (seq == 0) {
+            start = msg->sent_ns;
+        }
+
+        if (msg->seq != seq || len != msg_len(seq)) {
+            shm->errors++;
+            continue;
+        }
+        for (i = 0; i < len - sizeof(*msg); i++) {
+            if (msg->data[i] != (uint8_t)(seq + i)) {
+                shm->errors++;
+                break;
+            }
+        }
+
+        shm->received++;
+        shm->total_latency_ns += latency;
+        if (latency > shm->max_latency_ns) {
+            shm->max_latency_ns = latency;
+        }
+    }
+
+    shm->elapsed_ns = now_ns() - start;
+}
+
+static int run(struct shared *shm, struct ring_header *hdr, enum mode mode)
+{
+    unsigned count = mode == MODE_TICK ? num_msgs / 100 : num_msgs;
+    pid_t pid;
+
+    memset((uint8_t *)shm + sizeof(sem_t), 0,
+           sizeof(*shm) - sizeof(sem_t));
+    memset(hdr, 0, HEADER_SIZE);
+    if (count == 0) {
+        count = 1;
+    }
+
+    pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return -1;
+    }
+    if (pid == 0) {
+        producer(hdr, shm, mode, count);
+        _exit(0);
+    }
+    consumer(hdr, shm, mode, count);
+    waitpid(pid, NULL, 0);
+
+    printf("%-9s %9u %11.0f %9llu %9.3f %10.2f %10.1f %7llu\n",
+           mode_names[mode], count,
+           shm->elapsed_ns ? count * 1e9 / shm->elapsed_ns : 0.0,
+           (unsigned long long)shm->full,
+           (double)shm->rung / count,
+           shm->received ?
+               shm->total_latency_ns / 1000.0 / shm->received : 0.0,
+           shm->max_latency_ns / 1000.0,
+           (unsigned long long)shm->errors);
+
+    return shm->errors ? 1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    struct shared *shm;
+    struct ring_header *hdr;
+    size_t size;
+    int errors = 0;
+    int m;
+    int ret;
+
+    if (argc >= 2) {
+        num_msgs = atoi(argv[1]);
+    }
+    if (argc >= 3) {
+        num_slots = atoi(argv[2]);
+    }
+    if (argc >= 4) {
+        slot_size = atoi(argv[3]);
+    }
+
+    if (num_msgs < 1 || num_slots < 1 || num_slots > MAX_SLOTS ||
+        (num_slots & (num_slots - 1)) != 0 || (slot_size & 3) != 0 ||
+        slot_size < sizeof(uint32_t) + sizeof(struct test_msg) ||
+        slot_size > MAX_SLOT_SIZE) {
+        printf("Usage: shmring_test [<messages> [<slots> [<slot_size>]]]\n"
+               "    slots a power of 2 up to %d, slot_size a multiple of 4 "
+               "from %d to %d\n", MAX_SLOTS,
+               (int)(sizeof(uint32_t) + sizeof(struct test_msg)),
+               MAX_SLOT_SIZE);
+        return 1;
+    }
+
+    size = sizeof(*shm) + HEADER_SIZE + num_slots * slot_size;
+    shm = mmap(NULL, size, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shm == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    hdr = (struct ring_header *)(((uintptr_t)(shm + 1) + 63) & ~63UL);
+    if (sem_init(&shm->doorbell, 1, 0) < 0) {
+        perror("sem_init");
+        return 1;
+    }
+
+    printf("shmring_test: %u messages, %u slots x %u bytes\n",
+           num_msgs, num_slots, slot_size);
+    printf("%-9s %9s %11s %9s %9s %10s %10s %7s\n", "mode", "messages",
+           "msgs/s", "full", "rung/msg", "mean lat", "max lat", "errors");
+    printf("%-9s %9s %11s %9s %9s %10s %10s %7s\n", "", "", "", "", "",
+           "(us)", "(us)", "");
+
+    for (m = 0; m < NUM_MODES; m++) {
+        ret = run(shm, hdr, m);
+        if (ret < 0) {
+            return 1;
+        }
+        errors += ret;
+    }
+
+    sem_destroy(&shm->doorbell);
+    munmap(shm, size);
+    return errors ? 1 : 0;
+}
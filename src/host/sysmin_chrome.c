@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2011-2012, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * sysmin_chrome.c
+ *
+ * Convert the event records in SysMin trace buffers (SysMin.events =
+ * true) to the Chrome trace event JSON format. The result can be opened
+ * in chrome://tracing or ui.perfetto.dev.
+ *
+ * Each core is a process, and each Hwi, Swi and Task an event ran in is a
+ * thread track of it. All Hwis share one track per core; Swis and Tasks
+ * are named by their handles. Begin and end records become "B" and "E"
+ * events. An end with no begin, whose begin was overwritten by the wrap,
+ * is dropped. SysMin_trace records become instant events on a "trace"
+ * track of the core. Text lines are left out, their timestamps come from
+ * the Clock ticks rather than the Timestamp counter.
+ *
+ * The trace files are raw copies of the whole buffers, one per core on
+ * SMP, as for sysmin_decode.
+ *
+ * Usage:
+ * ------
+ * sysmin_chrome [-f <freq_hz>] <elf_image> <trace_file>... > trace.json
+ *
+ * Build:
+ * ------
+ * gcc -O2 sysmin_chrome.c -o sysmin_chrome
+ */
+
+#include "sysmin_trace.h"
+
+/* the trace track of a core */
+#define TRACK_TRACE     (SYSMIN_THREAD_MAIN + 1)
+
+#define MAX_TRACKS      256
+
+struct track {
+    unsigned core;
+    unsigned type;      /* SYSMIN_THREAD_*, or TRACK_TRACE */
+    uint32_t handle;
+    unsigned depth;     /* events begun and not ended yet */
+};
+
+static struct track tracks[MAX_TRACKS];
+static int numTracks;
+static int numEvents;
+
+/* the track of a thread, numbered from 1, or 0 if there are too many */
+static int track_id(unsigned core, unsigned type, uint32_t handle)
+{
+    int i;
+
+    for (i = 0; i < numTracks; i++) {
+        if (tracks[i].core == core && tracks[i].type == type &&
+            tracks[i].handle == handle) {
+            return i + 1;
+        }
+    }
+    if (numTracks == MAX_TRACKS) {
+        return 0;
+    }
+
+    tracks[numTracks].core = core;
+    tracks[numTracks].type = type;
+    tracks[numTracks].handle = handle;
+    tracks[numTracks].depth = 0;
+    return ++numTracks;
+}
+
+/* print a JSON string, without the trailing newline of a line */
+static void json_string(const char *str)
+{
+    putchar('"');
+    for (; *str; str++) {
+        if (*str == '\n' && str[1] == '\0') {
+            break;
+        }
+        if (*str == '"' || *str == '\\') {
+            printf("\\%c", *str);
+        }
+        else if ((unsigned char)*str < ' ') {
+            printf("\\u%04x", *str);
+        }
+        else {
+            putchar(*str);
+        }
+    }
+    putchar('"');
+}
+
+static void json_event_start(void)
+{
+    printf(numEvents++ ? ",\n" : "\n");
+}
+
+/* emit the events of the queued lines of a buffer */
+static void convert(const struct sysmin_elf *elf, struct sysmin_queue *q)
+{
+    const struct sysmin_qline *ql;
+    const struct sysmin_rec *rec;
+    struct track *track;
+    char name[128];
+    unsigned core;
+    unsigned type;
+    double us;
+    int begin;
+    int id;
+    size_t i;
+
+    for (i = 0; i < q->num; i++) {
+        ql = &q->lines[i];
+        rec = &ql->line.rec;
+        if (!ql->line.record ||
+            (rec->type != SYSMIN_REC_EVENT && rec->type != SYSMIN_REC_TRACE)) {
+            continue;
+        }
+
+        /* microseconds, or counts if the frequency is not known */
+        us = q->freq ? ql->ns / 1000.0 : (double)rec->ts;
+        core = rec->core ? rec->core - 1 : 0;
+
+        if (rec->type == SYSMIN_REC_TRACE) {
+            id = track_id(core, TRACK_TRACE, 0);
+            if (id == 0) {
+                continue;
+            }
+            json_event_start();
+            printf("{\"name\":");
+            json_string(ql->line.text);
+            printf(",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,"
+                   "\"pid\":%u,\"tid\":%d}", us, core, id);
+            continue;
+        }
+
+        type = (rec->w[1] >> 8) & 0xFF;
+        begin = (rec->w[1] & 0xFF) == SYSMIN_EVENT_BEGIN;
+        id = track_id(core, type, rec->w[2]);
+        if (id == 0) {
+            continue;
+        }
+        track = &tracks[id - 1];
+        if (begin) {
+            track->depth++;
+        }
+        else if (track->depth == 0) {
+            continue;
+        }
+        else {
+            track->depth--;
+        }
+
+        sysmin_event_name(elf, rec, name, sizeof(name));
+        json_event_start();
+        printf("{\"name\":");
+        json_string(name);
+        printf(",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":%u,\"tid\":%d}",
+               begin ? "B" : "E", us, core, id);
+    }
+}
+
+/* name the processes and tracks, Hwis first */
+static void metadata(void)
+{
+    unsigned core = ~0U;
+    int i;
+
+    for (i = 0; i < numTracks; i++) {
+        if (tracks[i].core != core) {
+            core = tracks[i].core;
+            json_event_start();
+            printf("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,"
+                   "\"args\":{\"name\":\"core %u\"}}", core, core);
+        }
+
+        json_event_start();
+        printf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,"
+               "\"tid\":%d,\"args\":{\"name\":", tracks[i].core, i + 1);
+        if (tracks[i].type == TRACK_TRACE) {
+            printf("\"trace\"");
+        }
+        else if (tracks[i].handle) {
+            printf("\"%s 0x%08x\"", sysmin_thread_name(tracks[i].type),
+                   tracks[i].handle);
+        }
+        else {
+            printf("\"%s\"", sysmin_thread_name(tracks[i].type));
+        }
+        printf("}}");
+
+        json_event_start();
+        printf("{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":%u,"
+               "\"tid\":%d,\"args\":{\"sort_index\":%u}}", tracks[i].core,
+               i + 1, tracks[i].type);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    struct sysmin_elf elf;
+    struct sysmin_queue q;
+    uint64_t freq = 0;
+    size_t i;
+    int opt;
+    int n;
+
+    while ((opt = getopt(argc, argv, "f:")) != -1) {
+        switch (opt) {
+            case 'f':
+                freq = strtoull(optarg, NULL, 0);
+                break;
+            default:
+                argc = 0;
+                break;
+        }
+    }
+
+    if (argc - optind < 2) {
+        printf("Usage: sysmin_chrome [-f <freq_hz>] <elf_image> "
+               "<trace_file>... > trace.json\n");
+        return 1;
+    }
+
+    if (sysmin_elf_load(argv[optind], &elf) < 0) {
+        return 1;
+    }
+
+    printf("{\"traceEvents\":[");
+    for (n = optind + 1; n < argc; n++) {
+        memset(&q, 0, sizeof(q));
+        if (sysmin_read_buffer(argv[n], &elf, freq, &q) < 0) {
+            return 1;
+        }
+        convert(&elf, &q);
+
+        for (i = 0; i < q.num; i++) {
+            free((char *)q.lines[i].line.text);
+        }
+        free(q.lines);
+    }
+    metadata();
+    printf("\n]}\n");
+
+    if (numTracks == MAX_TRACKS) {
+        fprintf(stderr, "more than %d tracks, events dropped\n", MAX_TRACKS);
+    }
+
+    munmap(elf.data, elf.size);
+    return 0;
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2011-2012, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * sysmin_decode.c
+ *
+ * Print a SysMin trace buffer that holds binary SysMin_trace records
+ * (SysMin.binaryMode = true), resolving the format strings from the ELF
+ * image of the remote core. Plain text lines are printed as they are.
+ *
+ * Each trace file is a raw copy of a whole buffer, writeidx and readidx
+ * included, e.g. read from the trace carveout. Output starts at the oldest
+ * data after writeidx. Timestamps are converted with the frequency found
+ * in the buffer's SYNC records, or <freq_hz> if given.
+ *
+ * SMP builds have one buffer per core, each exposed by its own trace
+ * resource entry. Given several trace files, the lines of each are merged
+ * by time. A line without a timestamp stays after the line before it in
+ * its own buffer.
+ *
+ * Usage:
+ * ------
+ * sysmin_decode [-f <freq_hz>] <elf_image> <trace_file>...
+ *
+ * Build:
+ * ------
+ * gcc -O2 sysmin_decode.c -o sysmin_decode
+ */
+
+#include "sysmin_trace.h"
+
+int main(int argc, char *argv[])
+{
+    struct sysmin_elf elf;
+    struct sysmin_queue *queues;
+    uint64_t freq = 0;
+    int num;
+    int opt;
+    int i;
+
+    while ((opt = getopt(argc, argv, "f:")) != -1) {
+        switch (opt) {
+            case 'f':
+                freq = strtoull(optarg, NULL, 0);
+                break;
+            default:
+                argc = 0;
+                break;
+        }
+    }
+
+    if (argc - optind < 2) {
+        printf("Usage: sysmin_decode [-f <freq_hz>] <elf_image> "
+               "<trace_file>...\n");
+        return 1;
+    }
+
+    if (sysmin_elf_load(argv[optind], &elf) < 0) {
+        return 1;
+    }
+
+    num = argc - optind - 1;
+    queues = calloc(num, sizeof(*queues));
+    if (queues == NULL) {
+        perror("calloc");
+        return 1;
+    }
+    for (i = 0; i < num; i++) {
+        if (sysmin_read_buffer(argv[optind + 1 + i], &elf, freq,
+                               &queues[i]) < 0) {
+            return 1;
+        }
+    }
+
+    sysmin_queue_merge(queues, num, stdout);
+
+    for (i = 0; i < num; i++) {
+        free(queues[i].lines);
+    }
+    free(queues);
+    munmap(elf.data, elf.size);
+    return 0;
+}
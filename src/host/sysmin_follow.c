@@ -0,0 +1,383 @@
+/*
+ * Copyright (c) 2011-2012, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * sysmin_follow.c
+ *
+ * Stream a SysMin trace buffer while the remote core writes it, for
+ * captures longer than the buffer holds. Text lines and binary
+ * SysMin_trace records are decoded as in sysmin_decode.
+ *
+ * The buffer is either mapped from /dev/mem at the physical address of
+ * the trace carveout (-m), or read from a file: a raw copy of the whole
+ * buffer, writeidx and readidx included. A file is decoded once, oldest
+ * data first, unless -F asks to keep re-reading it.
+ *
+ * Every <interval> ms the bytes written since the last poll, up to the
+ * buffer's writeidx, are decoded and printed, and readidx is set to
+ * writeidx in the mapped buffer. The 32 bytes before the last position
+ * read are kept: if they changed, the writer got around the whole buffer
+ * and an overrun is reported, the lost data cannot be recovered. Shorten
+ * the interval or enlarge SysMin.bufSize if that happens.
+ *
+ * SMP builds have one buffer per core, following each other (-c). The
+ * new lines of all of them are merged by time at each poll.
+ *
+ * Lines, bytes and overruns are counted on stderr at the end, on SIGINT
+ * when following. The exit status is 2 after an overrun.
+ *
+ * Usage:
+ * ------
+ * sysmin_follow [options] -m <phys_addr> -s <buf_size>
+ * sysmin_follow [options] [-F] <trace_file>
+ *
+ * -e <elf_image>  resolve the records' format strings from it
+ * -f <freq_hz>    timestamp frequency if the buffer has no SYNC record
+ * -c <count>      number of buffers, one per core on SMP (default 1)
+ * -s <buf_size>   size of each buffer (default: the file size / count)
+ * -i <interval>   poll interval in ms (default 100)
+ * -n              only print what is written from now on
+ *
+ * Build:
+ * ------
+ * gcc -O2 sysmin_follow.c -o sysmin_follow
+ */
+
+#include <errno.h>
+#include <signal.h>
+
+#include "sysmin_trace.h"
+
+/* compared before the last position read to detect overruns */
+#define CANARY_BYTES    32
+
+struct ring {
+    const uint8_t *base;        /* in the mapping or the file copy */
+    size_t rd;                  /* index after the last byte read */
+    int started;
+    uint8_t canary[CANARY_BYTES];
+    struct sysmin_stream st;
+    uint64_t bytes;
+    uint64_t overruns;
+};
+
+static volatile sig_atomic_t stop;
+
+static const struct sysmin_elf *elf;
+static struct ring *rings;
+static struct sysmin_queue *queues;
+static int count = 1;
+static size_t size;             /* of each buffer, indices included */
+static uint8_t *copy;           /* new bytes of a buffer */
+static int newOnly;
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    stop = 1;
+}
+
+/* copy 'len' bytes of the ring from index 'idx' on, wrapping */
+static void ring_copy(const struct ring *r, size_t idx, size_t len,
+                      uint8_t *dst)
+{
+    size_t end = size - SYSMIN_IDX_BYTES;
+    size_t n;
+
+    while (len) {
+        n = end - idx < len ? end - idx : len;
+        memcpy(dst, r->base + idx, n);
+        dst += n;
+        len -= n;
+        idx = 0;
+    }
+}
+
+/* has the writer been over the bytes before the last position read */
+static int ring_overrun(const struct ring *r)
+{
+    size_t end = size - SYSMIN_IDX_BYTES;
+    uint8_t now[CANARY_BYTES];
+
+    ring_copy(r, (r->rd + end - CANARY_BYTES) % end, CANARY_BYTES, now);
+    return memcmp(now, r->canary, CANARY_BYTES) != 0;
+}
+
+/* decode what was written to a ring since the last poll */
+static void ring_poll(struct ring *r, struct sysmin_queue *q, int live)
+{
+    size_t end = size - SYSMIN_IDX_BYTES;
+    struct sysmin_line line;
+    int first = !r->started;
+    size_t widx;
+    size_t len;
+
+    widx = sysmin_word(r->base + end);
+    if (widx >= end) {
+        return;
+    }
+
+    if (first) {
+        r->started = 1;
+        r->rd = widx;
+        len = newOnly ? 0 : end;
+    }
+    else {
+        len = (widx + end - r->rd) % end;
+    }
+
+    ring_copy(r, r->rd, len, copy);
+
+    /* checked after the copy, so that it covers the copy too */
+    if (len && !first && ring_overrun(r)) {
+        r->overruns++;
+        sysmin_stream_text(&r->st);
+        memset(&line, 0, sizeof(line));
+        line.text = "--- trace overrun, data lost ---\n";
+        r->st.fxn(r->st.arg, &line);
+
+        /* start over from the oldest data */
+        r->rd = widx;
+        len = end;
+        ring_copy(r, r->rd, len, copy);
+    }
+
+    if (r->rd + len <= end) {
+        sysmin_stream_feed(&r->st, copy, len, r->rd);
+    }
+    else {
+        sysmin_stream_feed(&r->st, copy, end - r->rd, r->rd);
+        sysmin_stream_feed(&r->st, copy + end - r->rd,
+                           len - (end - r->rd), 0);
+    }
+    r->bytes += len;
+    if (r->st.freq) {
+        q->freq = r->st.freq;
+    }
+
+    r->rd = widx;
+    ring_copy(r, (r->rd + end - CANARY_BYTES) % end, CANARY_BYTES,
+              r->canary);
+
+    /* tell the target how far the stream got */
+    if (live) {
+        *(volatile uint32_t *)(r->base + end + 4) = (uint32_t)widx;
+    }
+}
+
+/* read the whole file into 'buf', returns 0 on success */
+static int read_file(const char *path, uint8_t *buf, size_t len)
+{
+    ssize_t n;
+    size_t got = 0;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+    while (got < len) {
+        n = pread(fd, buf + got, len - got, got);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            fprintf(stderr, "%s: shorter than %zu bytes\n", path, len);
+            close(fd);
+            return -1;
+        }
+        got += n;
+    }
+    close(fd);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    struct sysmin_elf image;
+    const char *path = NULL;
+    uint8_t *mem;
+    uint64_t phys = 0;
+    uint64_t freq = 0;
+    uint64_t lines = 0;
+    uint64_t bytes = 0;
+    uint64_t overruns = 0;
+    unsigned interval = 100;
+    int follow = 0;
+    int live = 0;
+    struct stat sb;
+    long page;
+    int opt;
+    int fd;
+    int i;
+
+    while ((opt = getopt(argc, argv, "e:f:c:s:i:m:nF")) != -1) {
+        switch (opt) {
+            case 'e':
+                if (sysmin_elf_load(optarg, &image) < 0) {
+                    return 1;
+                }
+                elf = &image;
+                break;
+            case 'f':
+                freq = strtoull(optarg, NULL, 0);
+                break;
+            case 'c':
+                count = atoi(optarg);
+                break;
+            case 's':
+                size = strtoul(optarg, NULL, 0);
+                break;
+            case 'i':
+                interval = strtoul(optarg, NULL, 0);
+                break;
+            case 'm':
+                phys = strtoull(optarg, NULL, 0);
+                live = 1;
+                break;
+            case 'n':
+                newOnly = 1;
+                break;
+            case 'F':
+                follow = 1;
+                break;
+            default:
+                count = 0;
+                break;
+        }
+    }
+
+    if (!live && optind < argc) {
+        path = argv[optind];
+        if (size == 0 && count > 0) {
+            if (stat(path, &sb) < 0) {
+                perror(path);
+                return 1;
+            }
+            size = sb.st_size / count;
+        }
+    }
+
+    if (count <= 0 || (!live && path == NULL) || (live && size == 0)) {
+        printf("Usage: sysmin_follow [options] -m <phys_addr> -s <buf_size>\n"
+               "       sysmin_follow [options] [-F] <trace_file>\n"
+               "  -e <elf_image>  resolve format strings from it\n"
+               "  -f <freq_hz>    timestamp frequency\n"
+               "  -c <count>      number of buffers, one per core on SMP\n"
+               "  -s <buf_size>   size of each buffer\n"
+               "  -i <interval>   poll interval in ms (default 100)\n"
+               "  -n              only print what is written from now on\n");
+        return 1;
+    }
+
+    if (size <= SYSMIN_IDX_BYTES + CANARY_BYTES || size % 4) {
+        fprintf(stderr, "bad buffer size %zu\n", size);
+        return 1;
+    }
+
+    if (live) {
+        /* mmap wants a page aligned offset */
+        page = sysconf(_SC_PAGESIZE);
+        fd = open("/dev/mem", O_RDWR | O_SYNC);
+        if (fd < 0) {
+            perror("/dev/mem");
+            return 1;
+        }
+        mem = mmap(NULL, size * count + phys % page, PROT_READ | PROT_WRITE,
+                   MAP_SHARED, fd, phys - phys % page);
+        close(fd);
+        if (mem == MAP_FAILED) {
+            perror("mmap");
+            return 1;
+        }
+        mem += phys % page;
+        follow = 1;
+    }
+    else {
+        mem = malloc(size * count);
+        if (mem == NULL || read_file(path, mem, size * count) < 0) {
+            return 1;
+        }
+    }
+
+    rings = calloc(count, sizeof(*rings));
+    queues = calloc(count, sizeof(*queues));
+    copy = malloc(size);
+    if (rings == NULL || queues == NULL || copy == NULL) {
+        perror("malloc");
+        return 1;
+    }
+    for (i = 0; i < count; i++) {
+        rings[i].base = mem + i * size;
+        queues[i].freq = freq ? freq :
+            sysmin_find_freq(rings[i].base, size - SYSMIN_IDX_BYTES);
+        sysmin_stream_init(&rings[i].st, elf, sysmin_queue_add, &queues[i]);
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    for (;;) {
+        for (i = 0; i < count; i++) {
+            ring_poll(&rings[i], &queues[i], live);
+        }
+        lines += sysmin_queue_merge(queues, count, stdout);
+        fflush(stdout);
+
+        if (!follow || stop) {
+            break;
+        }
+        usleep(interval * 1000);
+        if (stop) {
+            break;
+        }
+        if (!live && read_file(path, mem, size * count) < 0) {
+            break;
+        }
+    }
+
+    /* what is left of an unterminated line */
+    for (i = 0; i < count; i++) {
+        sysmin_stream_text(&rings[i].st);
+        bytes += rings[i].bytes;
+        overruns += rings[i].overruns;
+    }
+    lines += sysmin_queue_merge(queues, count, stdout);
+    fflush(stdout);
+
+    fprintf(stderr, "%llu lines, %llu bytes, %llu overruns\n",
+            (unsigned long long)lines, (unsigned long long)bytes,
+            (unsigned long long)overruns);
+
+    return overruns ? 2 : 0;
+}
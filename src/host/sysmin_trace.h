@@ -0,0 +1,706 @@
+/*
+ * Copyright (c) 2011-2012, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * sysmin_trace.h
+ *
+ * Decoding of the SysMin trace buffer on the host.
+ *
+ * The buffer holds text lines written by System_printf and, when
+ * SysMin.binaryMode is set, binary records written by SysMin_trace. The
+ * records hold the address of the format string rather than the text, so
+ * the ELF image the remote core runs is needed to print them.
+ *
+ * sysmin_elf_load() maps that image, sysmin_elf_string() returns the
+ * string at a target address. sysmin_stream_feed() takes bytes from the
+ * buffer in the order they were written and passes each complete line,
+ * text or formatted record, to a callback.
+ *
+ * With SysMin.events set, the buffer also holds begin and end event
+ * records, passed as lines too, along with the record.
+ *
+ * SMP builds write one buffer per core. sysmin_queue_add() can be the
+ * callback of each buffer's stream; sysmin_queue_merge() then prints the
+ * queued lines of all of them in time order.
+ */
+#ifndef SYSMIN_TRACE_H
+#define SYSMIN_TRACE_H
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* must match the record layout in ti/trace/SysMin.c */
+#define SYSMIN_REC_MARKER       0x1E
+#define SYSMIN_REC_SYNC         0
+#define SYSMIN_REC_TRACE        1
+#define SYSMIN_REC_EVENT        2
+#define SYSMIN_REC_HDRWORDS     3
+#define SYSMIN_REC_MAXWORDS     5
+#define SYSMIN_REC_MAXARGS      4
+
+/* EVENT record phases and thread types */
+#define SYSMIN_EVENT_BEGIN      0
+#define SYSMIN_EVENT_END        1
+#define SYSMIN_THREAD_HWI       0
+#define SYSMIN_THREAD_SWI       1
+#define SYSMIN_THREAD_TASK      2
+#define SYSMIN_THREAD_MAIN      3
+
+/* writeidx and readidx follow the buffer */
+#define SYSMIN_IDX_BYTES        8
+
+#define SYSMIN_LINE_MAX         512
+
+struct sysmin_elf {
+    uint8_t *data;
+    size_t size;
+    const Elf32_Shdr *sh;
+    int shnum;
+};
+
+struct sysmin_rec {
+    unsigned type;
+    unsigned core;      /* 0 if not SMP, else core id + 1 */
+    unsigned words;     /* after the header */
+    uint64_t ts;
+    uint32_t w[SYSMIN_REC_MAXWORDS];
+};
+
+/* a line of output, passed to the stream callback */
+struct sysmin_line {
+    int record;         /* formatted from a record, else text */
+    unsigned core;      /* as in sysmin_rec, records only */
+    uint64_t ts;        /* timestamp counts, records only */
+    const char *text;   /* NUL terminated, ends with '\n' */
+    struct sysmin_rec rec;  /* records only */
+};
+
+typedef void (*sysmin_line_fxn)(void *arg, const struct sysmin_line *line);
+
+struct sysmin_stream {
+    const struct sysmin_elf *elf;   /* NULL: print format addresses */
+    uint64_t freq;                  /* timestamp Hz, 0 until a SYNC */
+    sysmin_line_fxn fxn;
+    void *arg;
+    char text[SYSMIN_LINE_MAX];     /* text line being assembled */
+    size_t len;
+};
+
+/* a queued line and its time */
+struct sysmin_qline {
+    uint64_t ns;
+    struct sysmin_line line;
+};
+
+/* lines of a buffer waiting to be merged with those of the others */
+struct sysmin_queue {
+    uint64_t freq;                  /* of the buffer's records */
+    uint64_t ns;                    /* time of the last line that had one */
+    struct sysmin_qline *lines;
+    size_t num;
+    size_t max;
+    size_t next;                    /* next line to print */
+};
+
+static inline uint32_t sysmin_word(const uint8_t *p)
+{
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/* map an ELF32 little endian image, returns 0 on success */
+static inline int sysmin_elf_load(const char *path, struct sysmin_elf *elf)
+{
+    const Elf32_Ehdr *eh;
+    struct stat st;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        perror(path);
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+
+    elf->size = st.st_size;
+    elf->data = mmap(NULL, elf->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (elf->data == MAP_FAILED) {
+        perror(path);
+        return -1;
+    }
+
+    eh = (const Elf32_Ehdr *)elf->data;
+    if (elf->size < sizeof(*eh) || memcmp(eh->e_ident, ELFMAG, SELFMAG) ||
+        eh->e_ident[EI_CLASS] != ELFCLASS32 ||
+        eh->e_ident[EI_DATA] != ELFDATA2LSB ||
+        eh->e_shoff + (size_t)eh->e_shnum * sizeof(Elf32_Shdr) > elf->size) {
+        fprintf(stderr, "%s: not a little endian ELF32 image\n", path);
+        munmap(elf->data, elf->size);
+        return -1;
+    }
+
+    elf->sh = (const Elf32_Shdr *)(elf->data + eh->e_shoff);
+    elf->shnum = eh->e_shnum;
+    return 0;
+}
+
+/* the NUL terminated string at a target address, or NULL */
+static inline const char *sysmin_elf_string(const struct sysmin_elf *elf,
+                                            uint32_t addr)
+{
+    const Elf32_Shdr *sh;
+    const char *str;
+    int i;
+
+    for (i = 0; i < elf->shnum; i++) {
+        sh = &elf->sh[i];
+        if (!(sh->sh_flags & SHF_ALLOC) || sh->sh_type == SHT_NOBITS ||
+            addr < sh->sh_addr || addr - sh->sh_addr >= sh->sh_size ||
+            sh->sh_offset + sh->sh_size > elf->size) {
+            continue;
+        }
+        str = (const char *)elf->data + sh->sh_offset + (addr - sh->sh_addr);
+        if (memchr(str, '\0', sh->sh_size - (addr - sh->sh_addr)) == NULL) {
+            return NULL;
+        }
+        return str;
+    }
+
+    return NULL;
+}
+
+/*
+ * Parse the record at p, 'avail' bytes long. Returns its length in bytes,
+ * or 0 if p does not hold a plausible record.
+ */
+static inline size_t sysmin_rec_parse(const struct sysmin_elf *elf,
+                                      const uint8_t *p, size_t avail,
+                                      struct sysmin_rec *rec)
+{
+    uint32_t w0;
+    size_t len;
+    unsigned i;
+
+    if (avail < SYSMIN_REC_HDRWORDS * 4 || p[0] != SYSMIN_REC_MARKER) {
+        return 0;
+    }
+
+    w0 = sysmin_word(p);
+    rec->type = (w0 >> 8) & 0xFF;
+    rec->words = (w0 >> 16) & 0xFF;
+    rec->core = w0 >> 24;
+    len = (SYSMIN_REC_HDRWORDS + rec->words) * 4;
+
+    if (len > avail || rec->words > SYSMIN_REC_MAXWORDS ||
+        (rec->type == SYSMIN_REC_SYNC && rec->words != 2) ||
+        (rec->type == SYSMIN_REC_TRACE && rec->words < 1) ||
+        (rec->type == SYSMIN_REC_EVENT && rec->words != 3) ||
+        rec->type > SYSMIN_REC_EVENT) {
+        return 0;
+    }
+
+    rec->ts = sysmin_word(p + 4) | (uint64_t)sysmin_word(p + 8) << 32;
+    for (i = 0; i < rec->words; i++) {
+        rec->w[i] = sysmin_word(p + 12 + i * 4);
+    }
+
+    /* the format string or event name */
+    if (rec->type != SYSMIN_REC_SYNC && elf != NULL &&
+        sysmin_elf_string(elf, rec->w[0]) == NULL) {
+        return 0;
+    }
+
+    return len;
+}
+
+/*
+ * printf the record's arguments with its format string. The arguments are
+ * 32-bit words; "%s" ones are looked up in the ELF image too.
+ */
+static inline void sysmin_format(const struct sysmin_elf *elf,
+                                 const struct sysmin_rec *rec,
+                                 char *out, size_t size)
+{
+    const char *fmt = elf ? sysmin_elf_string(elf, rec->w[0]) : NULL;
+    unsigned nargs = rec->words - 1;
+    unsigned arg = 0;
+    char spec[32];
+    size_t n = 0;
+    size_t s;
+    uint32_t val;
+    const char *str;
+    char conv;
+
+    if (fmt == NULL) {
+        snprintf(out, size, "<fmt 0x%08x> %08x %08x %08x %08x\n", rec->w[0],
+                 rec->w[1], rec->w[2], rec->w[3], rec->w[4]);
+        return;
+    }
+
+    while (*fmt && n + 1 < size) {
+        if (*fmt != '%') {
+            out[n++] = *fmt++;
+            continue;
+        }
+
+        /* copy flags, width and precision; drop length modifiers */
+        s = 0;
+        spec[s++] = *fmt++;
+        while (*fmt && strchr("-+ #0123456789.", *fmt) && s < sizeof(spec) - 3) {
+            spec[s++] = *fmt++;
+        }
+        while (*fmt && strchr("lhLqjzt", *fmt)) {
+            fmt++;
+        }
+        conv = *fmt;
+        if (conv == '\0') {
+            break;
+        }
+        fmt++;
+
+        if (conv == '%') {
+            out[n++] = '%';
+            continue;
+        }
+
+        val = arg < nargs ? rec->w[1 + arg] : 0;
+        arg++;
+        spec[s++] = conv;
+        spec[s] = '\0';
+
+        switch (conv) {
+            case 'd':
+            case 'i':
+                n += snprintf(out + n, size - n, spec, (int32_t)val);
+                break;
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+                n += snprintf(out + n, size - n, spec, val);
+                break;
+            case 'c':
+                n += snprintf(out + n, size - n, spec, (int)val);
+                break;
+            case 'p':
+                n += snprintf(out + n, size - n, "0x%08x", val);
+                break;
+            case 's':
+                str = sysmin_elf_string(elf, val);
+                if (str) {
+                    n += snprintf(out + n, size - n, spec, str);
+                }
+                else {
+                    n += snprintf(out + n, size - n, "<0x%08x>", val);
+                }
+                break;
+            default:
+                /* not supported, e.g. the XDC "%$" extensions */
+                n += snprintf(out + n, size - n, "%s", spec);
+                break;
+        }
+        if (n >= size) {
+            n = size - 1;
+        }
+    }
+
+    /* one line per record */
+    if (n == 0 || out[n - 1] != '\n') {
+        if (n + 2 > size) {
+            n = size - 2;
+        }
+        out[n++] = '\n';
+    }
+    out[n] = '\0';
+}
+
+static inline const char *sysmin_thread_name(unsigned type)
+{
+    static const char *names[] = { "Hwi", "Swi", "Task", "main" };
+
+    return type <= SYSMIN_THREAD_MAIN ? names[type] : "?";
+}
+
+/* the name of an EVENT record */
+static inline void sysmin_event_name(const struct sysmin_elf *elf,
+                                     const struct sysmin_rec *rec,
+                                     char *out, size_t size)
+{
+    const char *name = elf ? sysmin_elf_string(elf, rec->w[0]) : NULL;
+
+    if (name) {
+        snprintf(out, size, "%s", name);
+    }
+    else {
+        snprintf(out, size, "<0x%08x>", rec->w[0]);
+    }
+}
+
+/* "name begin|end (thread)" for an EVENT record */
+static inline void sysmin_format_event(const struct sysmin_elf *elf,
+                                       const struct sysmin_rec *rec,
+                                       char *out, size_t size)
+{
+    unsigned thread = (rec->w[1] >> 8) & 0xFF;
+    char name[128];
+
+    sysmin_event_name(elf, rec, name, sizeof(name));
+    if (rec->w[2]) {
+        snprintf(out, size, "%s %s (%s 0x%08x)\n", name,
+                 (rec->w[1] & 0xFF) == SYSMIN_EVENT_BEGIN ? "begin" : "end",
+                 sysmin_thread_name(thread), rec->w[2]);
+    }
+    else {
+        snprintf(out, size, "%s %s (%s)\n", name,
+                 (rec->w[1] & 0xFF) == SYSMIN_EVENT_BEGIN ? "begin" : "end",
+                 sysmin_thread_name(thread));
+    }
+}
+
+/* "[seconds.microseconds]" of a record timestamp, or the raw count */
+static inline void sysmin_ts_str(uint64_t ts, uint64_t freq, char *out,
+                                 size_t size)
+{
+    if (freq) {
+        snprintf(out, size, "[%7llu.%06llu]",
+                 (unsigned long long)(ts / freq),
+                 (unsigned long long)(ts % freq * 1000000 / freq));
+    }
+    else {
+        snprintf(out, size, "[#%llu]", (unsigned long long)ts);
+    }
+}
+
+static inline void sysmin_stream_init(struct sysmin_stream *st,
+                                      const struct sysmin_elf *elf,
+                                      sysmin_line_fxn fxn, void *arg)
+{
+    memset(st, 0, sizeof(*st));
+    st->elf = elf;
+    st->fxn = fxn;
+    st->arg = arg;
+}
+
+static inline void sysmin_stream_text(struct sysmin_stream *st)
+{
+    struct sysmin_line line;
+
+    if (st->len == 0) {
+        return;
+    }
+    if (st->text[st->len - 1] != '\n') {
+        st->text[st->len++] = '\n';
+    }
+    st->text[st->len] = '\0';
+
+    memset(&line, 0, sizeof(line));
+    line.text = st->text;
+    st->fxn(st->arg, &line);
+    st->len = 0;
+}
+
+/*
+ * Decode 'len' bytes of the buffer, which start at index 'idx' of it.
+ * Records are only recognized at word aligned indices; the writer never
+ * splits one across the wrap, nor publishes part of one.
+ */
+static inline void sysmin_stream_feed(struct sysmin_stream *st,
+                                      const uint8_t *buf, size_t len,
+                                      size_t idx)
+{
+    char text[SYSMIN_LINE_MAX];
+    struct sysmin_line line;
+    struct sysmin_rec rec;
+    size_t i = 0;
+    size_t n;
+    uint8_t ch;
+
+    while (i < len) {
+        if ((idx + i) % 4 == 0 &&
+            (n = sysmin_rec_parse(st->elf, buf + i, len - i, &rec)) != 0) {
+            i += n;
+            if (rec.type == SYSMIN_REC_SYNC) {
+                st->freq = rec.w[0] | (uint64_t)rec.w[1] << 32;
+                continue;
+            }
+            if (rec.type == SYSMIN_REC_EVENT) {
+                sysmin_format_event(st->elf, &rec, text, sizeof(text));
+            }
+            else {
+                sysmin_format(st->elf, &rec, text, sizeof(text));
+            }
+            line.record = 1;
+            line.core = rec.core;
+            line.ts = rec.ts;
+            line.text = text;
+            line.rec = rec;
+            st->fxn(st->arg, &line);
+            continue;
+        }
+
+        ch = buf[i++];
+        /* NUL padding, and the remains of records overwritten by the wrap */
+        if ((ch < ' ' || ch > '~') && ch != '\n' && ch != '\t') {
+            continue;
+        }
+        st->text[st->len++] = ch;
+        if (ch == '\n' || st->len == sizeof(st->text) - 2) {
+            sysmin_stream_text(st);
+        }
+    }
+}
+
+/* find the timestamp frequency in a SYNC record of a whole buffer */
+static inline uint64_t sysmin_find_freq(const uint8_t *buf, size_t len)
+{
+    struct sysmin_rec rec;
+    size_t i;
+
+    for (i = 0; i + SYSMIN_REC_HDRWORDS * 4 <= len; i += 4) {
+        if (sysmin_rec_parse(NULL, buf + i, len - i, &rec) &&
+            rec.type == SYSMIN_REC_SYNC) {
+            return rec.w[0] | (uint64_t)rec.w[1] << 32;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Time of a line in nanoseconds. Records use their timestamp, text lines
+ * the "[sec.frac]" prefix SysMin_putch writes, after the "[core]" tag on
+ * SMP. The text prefix comes from the Clock ticks while records use the
+ * Timestamp counter, so the two only agree to a Clock tick. Returns 0 if
+ * the line has no usable time.
+ */
+static inline int sysmin_line_ns(const struct sysmin_line *line,
+                                 uint64_t freq, uint64_t *ns)
+{
+    const char *p = line->text;
+    uint64_t sec = 0;
+    uint64_t frac = 0;
+    uint64_t scale = 1000000000;
+
+    if (line->record) {
+        if (freq == 0) {
+            return 0;
+        }
+        *ns = line->ts / freq * 1000000000 +
+              line->ts % freq * 1000000000 / freq;
+        return 1;
+    }
+
+    if (p[0] == '[' && p[1] >= '0' && p[1] <= '9' && p[2] == ']') {
+        p += 3;
+    }
+    if (*p++ != '[') {
+        return 0;
+    }
+    while (*p == ' ') {
+        p++;
+    }
+    if (*p < '0' || *p > '9') {
+        return 0;
+    }
+    while (*p >= '0' && *p <= '9') {
+        sec = sec * 10 + (*p++ - '0');
+    }
+    if (*p == '.') {
+        p++;
+        while (*p >= '0' && *p <= '9') {
+            if (scale > 1) {
+                scale /= 10;
+                frac += (*p - '0') * scale;
+            }
+            p++;
+        }
+    }
+    if (*p != ']') {
+        return 0;
+    }
+
+    *ns = sec * 1000000000 + frac;
+    return 1;
+}
+
+/* print a line the way the SysMin text output looks */
+static inline void sysmin_print_line(FILE *out, const struct sysmin_line *line,
+                                     uint64_t freq)
+{
+    char ts[32];
+
+    if (!line->record) {
+        fputs(line->text, out);
+        return;
+    }
+
+    sysmin_ts_str(line->ts, freq, ts, sizeof(ts));
+    if (line->core) {
+        fprintf(out, "[%u]", line->core - 1);
+    }
+    fprintf(out, "%s %s", ts, line->text);
+}
+
+/* sysmin_line_fxn queueing a copy of the line, 'arg' is the queue */
+static inline void sysmin_queue_add(void *arg, const struct sysmin_line *line)
+{
+    struct sysmin_queue *q = arg;
+    struct sysmin_qline *ql;
+    char *text;
+
+    if (q->num == q->max) {
+        ql = realloc(q->lines, (q->max ? q->max * 2 : 256) * sizeof(*ql));
+        if (ql == NULL) {
+            perror("sysmin_queue_add");
+            return;
+        }
+        q->lines = ql;
+        q->max = q->max ? q->max * 2 : 256;
+    }
+
+    text = strdup(line->text);
+    if (text == NULL) {
+        perror("sysmin_queue_add");
+        return;
+    }
+
+    /* a line without a time keeps the one of the line before it */
+    sysmin_line_ns(line, q->freq, &q->ns);
+
+    ql = &q->lines[q->num++];
+    ql->ns = q->ns;
+    ql->line = *line;
+    ql->line.text = text;
+}
+
+/*
+ * Queue the lines of a trace file holding a raw copy of a whole buffer,
+ * writeidx and readidx included, oldest first. The timestamp frequency is
+ * 'freq', or the one of the buffer's SYNC records if 0. Returns 0 on
+ * success.
+ */
+static inline int sysmin_read_buffer(const char *path,
+                                     const struct sysmin_elf *elf,
+                                     uint64_t freq, struct sysmin_queue *q)
+{
+    struct sysmin_stream st;
+    struct stat sb;
+    uint8_t *buf;
+    size_t len;
+    size_t widx;
+    FILE *fp;
+
+    fp = fopen(path, "rb");
+    if (fp == NULL || fstat(fileno(fp), &sb) < 0) {
+        perror(path);
+        return -1;
+    }
+    if (sb.st_size <= SYSMIN_IDX_BYTES) {
+        fprintf(stderr, "%s: too short for a trace buffer\n", path);
+        fclose(fp);
+        return -1;
+    }
+    buf = malloc(sb.st_size);
+    if (buf == NULL || fread(buf, 1, sb.st_size, fp) != (size_t)sb.st_size) {
+        perror(path);
+        fclose(fp);
+        free(buf);
+        return -1;
+    }
+    fclose(fp);
+
+    len = sb.st_size - SYSMIN_IDX_BYTES;
+    widx = sysmin_word(buf + len);
+    if (widx >= len) {
+        widx = 0;
+    }
+
+    q->freq = freq ? freq : sysmin_find_freq(buf, len);
+
+    sysmin_stream_init(&st, elf, sysmin_queue_add, q);
+    sysmin_stream_feed(&st, buf + widx, len - widx, widx);
+    sysmin_stream_feed(&st, buf, widx, 0);
+    sysmin_stream_text(&st);
+
+    free(buf);
+    return 0;
+}
+
+/*
+ * Print the queued lines of 'num' queues, always the earliest of their
+ * next lines, and empty the queues. Returns the number of lines printed.
+ */
+static inline size_t sysmin_queue_merge(struct sysmin_queue *queues, int num,
+                                        FILE *out)
+{
+    struct sysmin_queue *q;
+    struct sysmin_qline *ql;
+    size_t lines = 0;
+    int i;
+
+    for (;;) {
+        q = NULL;
+        for (i = 0; i < num; i++) {
+            if (queues[i].next < queues[i].num &&
+                (q == NULL ||
+                 queues[i].lines[queues[i].next].ns < q->lines[q->next].ns)) {
+                q = &queues[i];
+            }
+        }
+        if (q == NULL) {
+            break;
+        }
+
+        ql = &q->lines[q->next++];
+        sysmin_print_line(out, &ql->line, q->freq);
+        free((char *)ql->line.text);
+        lines++;
+    }
+
+    for (i = 0; i < num; i++) {
+        queues[i].num = 0;
+        queues[i].next = 0;
+    }
+
+    return lines;
+}
+
+#endif
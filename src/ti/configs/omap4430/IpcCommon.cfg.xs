@@ -45,6 +45,7 @@ Memory.defaultHeapSize = 0x20000;
 
 /* Modules used in the virtqueue/MessageQCopy/ServiceMgr libraries: */
 var Semaphore   = xdc.useModule('ti.sysbios.knl.Semaphore');
+var GateMutex   = xdc.useModule('ti.sysbios.gates.GateMutex');
 var BIOS        = xdc.useModule('ti.sysbios.BIOS');
 
 /* Reduces code size, by only pulling in modules explicitly referenced: */
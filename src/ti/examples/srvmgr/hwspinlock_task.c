@@ -47,6 +47,7 @@
 #include <stdlib.h>
 
 #include <ti/gates/hwspinlock/HwSpinlock.h>
+#include <ti/gates/hwspinlock/HwRwLock.h>
 #include <ti/sysbios/hal/Hwi.h>
 
 String HwSpinlockStatesName[] = {
@@ -102,6 +103,46 @@ Void testHwSpinlock(HwSpinlock_Handle handle, HwSpinlock_PreemptGate lp,
                Task_self(), Task_getPri(Task_self()));
 }
 
+/* Only shared by the tasks of this core in this test */
+static HwRwLock_SharedState rwState;
+
+Void testHwRwLock(HwRwLock_Handle handle, Bool write, Int timeout)
+{
+    Int status;
+    HwRwLock_Key key;
+    String mode = write ? "write" : "read";
+
+    System_printf("Acquiring HwRwLock for %s ...tsk(0x%x) pri(%d)\n",
+                   mode, Task_self(), Task_getPri(Task_self()));
+    if (write) {
+        status = HwRwLock_enterWrite(handle, HwSpinlock_PreemptGate_NONE,
+                                     timeout, &key);
+    }
+    else {
+        status = HwRwLock_enterRead(handle, HwSpinlock_PreemptGate_NONE,
+                                    timeout, &key);
+    }
+    if (status) {
+        System_printf("TIMEOUT: HwRwLock %s tsk(0x%x) pri(%d)\n",
+                       mode, Task_self(), Task_getPri(Task_self()));
+        return;
+    }
+
+    /* Hold it for a tick so that the other test tasks overlap */
+    System_printf("HwRwLock held for %s tsk(0x%x) pri(%d)\n",
+                   mode, Task_self(), Task_getPri(Task_self()));
+    Task_sleep(1);
+
+    System_printf("Releasing HwRwLock for %s ...tsk(0x%x) pri(%d)\n",
+                   mode, Task_self(), Task_getPri(Task_self()));
+    if (write) {
+        HwRwLock_leaveWrite(handle, &key);
+    }
+    else {
+        HwRwLock_leaveRead(handle, &key);
+    }
+}
+
 Void deleteHwSpinlock(HwSpinlock_Handle handle)
 {
     Int status, id;
@@ -123,6 +164,8 @@ Void hwSpinlockTestTaskFxn(UArg arg0, UArg arg1)
 {
     HwSpinlock_Params params;
     HwSpinlock_Handle handle1, handle2, handle3, handle4;
+    HwRwLock_Params rwParams;
+    HwRwLock_Handle rwHandle;
 
     HwSpinlock_Params_init(&params);
     System_printf("Create 4 HwSpinlock instances tsk(0x%x) pri(%d)\n",
@@ -161,6 +204,17 @@ Void hwSpinlockTestTaskFxn(UArg arg0, UArg arg1)
     deleteHwSpinlock(handle3);
     deleteHwSpinlock(handle4);
 
+    HwRwLock_Params_init(&rwParams);
+    rwParams.id = 4;
+    rwParams.sharedAddr = &rwState;
+    rwHandle = HwRwLock_create(&rwParams);
+    if (rwHandle) {
+        testHwRwLock(rwHandle, FALSE, HwSpinlock_WAIT_FOREVER);
+        testHwRwLock(rwHandle, TRUE, 500);
+        testHwRwLock(rwHandle, FALSE, 500);
+        HwRwLock_delete(rwHandle);
+    }
+
     System_printf("End of tsk(0x%x) pri(%d) ...\n",
                    Task_self(), Task_getPri(Task_self()));
     return;
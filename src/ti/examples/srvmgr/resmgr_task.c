@@ -67,6 +67,7 @@ void IpcResourceTaskFxn(UArg arg0, UArg arg1)
     IpcResource_Regulator regulator;
     IpcResource_Gpio gpio;
     IpcResource_Sdma sdma;
+    IpcResource_BatchEntry batch[2];
     IpcResource_ResHandle ivaId, ivasq0Id, ivasq1Id;
     IpcResource_ConstraintData ivaConstraints;
     IpcResource_ResHandle issId;
@@ -558,6 +559,39 @@ void IpcResourceTaskFxn(UArg arg0, UArg arg1)
 
         Task_sleep(SLEEP_TICKS);
 
+        auxclk.clkId = 1;
+        batch[0].type = IpcResource_TYPE_AUXCLK;
+        batch[0].resParams = &auxclk;
+        batch[1].type = IpcResource_TYPE_GPIO;
+        batch[1].resParams = &gpio;
+        System_printf("\nRequesting AuxClk #%d and GPIO #%d together...",
+                        auxclk.clkId, gpio.gpioId);
+        status = IpcResource_requestBatch(ipcResHandle, batch, 2);
+        if (!status) {
+            System_printf("Succeeded, status = 0x%x\n", status);
+        }
+        else {
+            System_printf("Failed, status = 0x%x\n", status);
+        }
+
+        Task_sleep(SLEEP_TICKS);
+
+        System_printf("Releasing AuxClk #%d and GPIO #%d...", auxclk.clkId,
+                        gpio.gpioId);
+        status = batch[0].status ? batch[0].status :
+                 IpcResource_release(ipcResHandle, batch[0].resHandle);
+        if (!batch[1].status) {
+            status |= IpcResource_release(ipcResHandle, batch[1].resHandle);
+        }
+        if (!status) {
+            System_printf("Succeeded, status = 0x%x\n", status);
+        }
+        else {
+            System_printf("Failed, status = 0x%x\n", status);
+        }
+
+        Task_sleep(SLEEP_TICKS);
+
         sdma.numCh = 5;
         System_printf("\nRequesting %d SDMA channels...", sdma.numCh);
         status = IpcResource_request(ipcResHandle, &sdmaId,
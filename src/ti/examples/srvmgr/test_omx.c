@@ -89,6 +89,15 @@ typedef struct {
 
 static Int32 fxnDouble(UInt32 size, UInt32 *data);
 
+/*
+ *  ======== fxnBusy used by omx_latency test app ========
+ */
+typedef struct {
+    UInt32 loops;
+} FxnBusyArgs;
+
+static Int32 fxnBusy(UInt32 size, UInt32 *data);
+
 /* ==========================================================================
  * OMX Fxns, adapted from rpc_omx_skel.c.
  *
@@ -108,14 +117,8 @@ static RPC_OMX_ERRORTYPE RPC_SKEL_GetParameter(UInt32 size, UInt32 *data);
 
 
 
-/* RcmServer static function table */
-static RcmServer_FxnDesc OMXServerFxnAry[] = {
-//    {"RPC_SKEL_GetHandle"   , RPC_SKEL_GetHandle},  // Set at runtime.
-    {"RPC_SKEL_GetHandle"   , NULL},
-    {"RPC_SKEL_SetParameter", RPC_SKEL_SetParameter},
-    {"RPC_SKEL_GetParameter", RPC_SKEL_GetParameter},
-    {"fxnDouble", fxnDouble },
-};
+/* RcmServer static function table, generated from test_omx.fxn */
+#include "test_omx_fxntab.h"
 
 #define OMXServerFxnAryLen (sizeof OMXServerFxnAry / sizeof OMXServerFxnAry[0])
 
@@ -124,6 +127,23 @@ static const RcmServer_FxnDescAry OMXServer_fxnTab = {
     OMXServerFxnAry
 };
 
+/* RcmServer worker pools, messages sent to pool id 0x8001 run here.
+ * The pool is shared by all OMX service instances, see main().
+ */
+static RcmServer_ThreadPoolDesc OMXServerPoolAry[] = {
+    {
+        "OMXWorkerPool",                /* name */
+        2,                              /* count */
+        Thread_Priority_NORMAL,         /* priority */
+        Thread_INVALID_OS_PRIORITY,     /* osPriority */
+        0,                              /* stackSize */
+        NULL                            /* stackSeg */
+    }
+};
+
+#define OMXServerPoolAryLen \
+    (sizeof OMXServerPoolAry / sizeof OMXServerPoolAry[0])
+
 
 static RPC_OMX_ERRORTYPE RPC_SKEL_SetParameter(UInt32 size, UInt32 *data)
 {
@@ -218,6 +238,24 @@ Int32 fxnDouble(UInt32 size, UInt32 *data)
     return a * 2;
 }
 
+/*
+ *  ======== fxnBusy ========
+ *
+ *  Spin for the requested number of loops, used to load the worker pool.
+ */
+Int32 fxnBusy(UInt32 size, UInt32 *data)
+{
+    FxnBusyArgs *args;
+    volatile UInt32 i;
+
+    args = (FxnBusyArgs *)((UInt32)data + sizeof(map_info_type));
+
+    for (i = 0; i < args->loops; i++) {
+    }
+
+    return (Int32)args->loops;
+}
+
 Int main(Int argc, char* argv[])
 {
     RcmServer_Params  rcmServerParams;
@@ -249,10 +287,25 @@ Int main(Int argc, char* argv[])
     rcmServerParams.priority    = Thread_Priority_ABOVE_NORMAL;
     rcmServerParams.fxns.length = OMXServer_fxnTab.length;
     rcmServerParams.fxns.elem   = OMXServer_fxnTab.elem;
+    rcmServerParams.workerPools.length = OMXServerPoolAryLen;
+    rcmServerParams.workerPools.elem   = OMXServerPoolAry;
+
+    /* keep the function profile read by the rcm_profile host tool */
+    rcmServerParams.profile = TRUE;
+
+    /* All OMX instances share one set of worker threads, rather than
+     * each connection creating its own:
+     */
+    RcmServer_createSharedPool(&OMXServerPoolAry[0]);
 
     /* Register an OMX service to create and call new OMX components: */
     ServiceMgr_register("OMX", &rcmServerParams);
 
+    /* Keep OMX instances ready so connects do not wait on instance create
+     * (measured by the omx_connect host tool):
+     */
+    ServiceMgr_setPrewarm("OMX", 2);
+
     /* Some background ping testing tasks, used by rpmsg samples: */
     start_ping_tasks();
 
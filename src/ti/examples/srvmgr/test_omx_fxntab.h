@@ -0,0 +1,19 @@
+/*
+ *  ======== test_omx_fxntab.h ========
+ *
+ *  Generated from test_omx.fxn by ti/grcm/FxnTab.xs, do not edit.
+ */
+
+#ifndef TEST_OMX_FXNTAB_H_
+#define TEST_OMX_FXNTAB_H_
+
+/* RcmServer static function table, in index order */
+static RcmServer_FxnDesc OMXServerFxnAry[] = {
+    {"RPC_SKEL_GetHandle",    NULL},                  /* 0 */
+    {"RPC_SKEL_SetParameter", RPC_SKEL_SetParameter}, /* 1 */
+    {"RPC_SKEL_GetParameter", RPC_SKEL_GetParameter}, /* 2 */
+    {"fxnDouble",             fxnDouble},             /* 3 */
+    {"fxnBusy",               fxnBusy},               /* 4 */
+};
+
+#endif
@@ -0,0 +1,445 @@
+/*
+ * Copyright (c) 2011-2012, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ *  ======== HwRwLock.c ========
+ */
+
+#include <xdc/std.h>
+#include <xdc/runtime/Assert.h>
+#include <xdc/runtime/Error.h>
+#include <xdc/runtime/Memory.h>
+#include <xdc/runtime/IGateProvider.h>
+#include <xdc/runtime/Log.h>
+#include <xdc/runtime/Diags.h>
+
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/knl/Clock.h>
+
+#include <ti/ipc/MultiProc.h>
+
+#include <string.h>
+
+#include <ti/gates/hwspinlock/HwSpinlock.h>
+#include <ti/gates/hwspinlock/HwRwLock.h>
+#include "_HwSpinlock.h"
+
+/*!
+ *  @brief  HwRwLock_Object type
+ */
+struct HwRwLock_Object {
+    HwSpinlock_Handle        hwlock;
+    HwRwLock_SharedState     *shared;
+    UInt16                   procId;
+    UInt                     spinBudget;
+    UInt                     maxBackoff;
+    HwSpinlock_WaitMode      waitMode;
+    IGateProvider_Handle     preemptGates[HwSpinlock_NUMPREEMPTGATES];
+    Int                      readHolds;     /* changed with hwlock entered */
+    Bool                     writeHeld;
+};
+
+/*
+ *  ======== _HwRwLock_begin ========
+ *  Enter the HwSpinlock guarding the shared state. Interrupts stay off
+ *  while it is held, so the hardware lock is never held across a
+ *  preemption.
+ */
+static inline Int _HwRwLock_begin(HwRwLock_Handle handle, UInt timeout,
+                                  HwSpinlock_Key *hkey)
+{
+    return (HwSpinlock_enter(handle->hwlock, HwSpinlock_PreemptGate_HWI,
+                             timeout, hkey));
+}
+
+static inline Void _HwRwLock_end(HwRwLock_Handle handle, HwSpinlock_Key *hkey)
+{
+    HwSpinlock_leave(handle->hwlock, hkey);
+}
+
+/*
+ *  ======== _HwRwLock_pause ========
+ *  Wait between two looks at the shared state, like HwSpinlock_enter does
+ *  between two reads of the lock register. Returns FALSE once the timeout
+ *  has elapsed.
+ */
+static Bool _HwRwLock_pause(HwRwLock_Handle handle, UInt *spins,
+                            UInt *backoff, UInt start, UInt timeout)
+{
+    volatile UInt delay;
+
+    if (timeout != HwSpinlock_WAIT_FOREVER &&
+        Clock_getTicks() - start > timeout) {
+        return (FALSE);
+    }
+
+    if (++(*spins) >= handle->spinBudget &&
+        handle->waitMode == HwSpinlock_WaitMode_YIELD) {
+        Task_yield();
+    }
+    else if (*spins >= handle->spinBudget &&
+             handle->waitMode == HwSpinlock_WaitMode_SLEEP) {
+        Task_sleep(1);
+    }
+    else {
+        for (delay = 0; delay < *backoff; delay++) {
+        }
+        if (*backoff < handle->maxBackoff) {
+            *backoff <<= 1;
+        }
+    }
+
+    return (TRUE);
+}
+
+/*
+ *  ======== _HwRwLock_held ========
+ *  Count a new hold of this core, with the HwSpinlock entered.
+ */
+static inline Void _HwRwLock_held(HwRwLock_Handle handle)
+{
+    if (handle->readHolds == 0 && !handle->writeHeld) {
+        _HwSpinlock_hold(handle->hwlock);
+    }
+}
+
+/*
+ *  ======== _HwRwLock_released ========
+ *  Same, after a hold of this core was dropped.
+ */
+static inline Void _HwRwLock_released(HwRwLock_Handle handle)
+{
+    if (handle->readHolds == 0 && !handle->writeHeld) {
+        _HwSpinlock_unhold(handle->hwlock);
+    }
+}
+
+/*
+ *************************************************************************
+ *                       Instance functions
+ *************************************************************************
+ */
+
+/*
+ *  ======== HwRwLock_Params_init ========
+ */
+Void HwRwLock_Params_init(HwRwLock_Params *params)
+{
+    params->id = HwSpinlock_NO_SPINLOCK;
+    params->sharedAddr = NULL;
+    params->initShared = FALSE;
+    params->spinBudget = HwSpinlock_DEFAULT_SPINBUDGET;
+    params->maxBackoff = HwSpinlock_DEFAULT_MAXBACKOFF;
+    params->waitMode = HwSpinlock_WaitMode_SPIN;
+}
+
+/*
+ *  ======== HwRwLock_create ========
+ */
+#define FXNN "HwRwLock_create"
+HwRwLock_Handle HwRwLock_create(HwRwLock_Params *params)
+{
+    HwRwLock_Handle handle;
+    HwSpinlock_Params hwParams;
+    Int i;
+
+    if (params->sharedAddr == NULL) {
+        Log_error0(FXNN": sharedAddr is required");
+        return NULL;
+    }
+
+    if (MultiProc_self() >= HwRwLock_MAXPROCS) {
+        Log_error0(FXNN": MultiProc id out of range");
+        return NULL;
+    }
+
+    /* Allocate handle */
+    handle = Memory_alloc(NULL, sizeof(*handle), 0, NULL);
+    if (!handle) {
+        Log_error0(FXNN": Unable to allocate handle");
+        return NULL;
+    }
+
+    HwSpinlock_Params_init(&hwParams);
+    hwParams.id = params->id;
+    hwParams.spinBudget = params->spinBudget;
+    hwParams.maxBackoff = params->maxBackoff;
+    hwParams.waitMode = params->waitMode;
+    handle->hwlock = HwSpinlock_create(&hwParams);
+    if (!handle->hwlock) {
+        Memory_free(NULL, handle, sizeof(*handle));
+        return NULL;
+    }
+
+    /* Create the preemption gates */
+    for (i = 0; i < HwSpinlock_NUMPREEMPTGATES; i++) {
+        handle->preemptGates[i] = (IGateProvider_Handle)
+                                    HwSpinlock_GateFxns[i].create(NULL, NULL);
+    }
+
+    handle->shared = params->sharedAddr;
+    handle->procId = MultiProc_self();
+    handle->spinBudget = params->spinBudget;
+    handle->maxBackoff = params->maxBackoff;
+    handle->waitMode = params->waitMode;
+    handle->readHolds = 0;
+    handle->writeHeld = FALSE;
+
+    if (params->initShared) {
+        memset((Ptr)handle->shared, 0, sizeof(HwRwLock_SharedState));
+    }
+
+    return handle;
+}
+#undef FXNN
+
+/*
+ *  ======== HwRwLock_delete ========
+ */
+#define FXNN "HwRwLock_delete"
+Int HwRwLock_delete(HwRwLock_Handle handle)
+{
+    Int i;
+
+    Assert_isTrue(handle, NULL);
+
+    /* Return error if trying to delete before unlock */
+    if (handle->readHolds || handle->writeHeld) {
+        Log_error0(FXNN": Error: HwRwLock still in use");
+        return HwSpinlock_STILL_IN_USE;
+    }
+
+    /* Delete the preemption gates */
+    for (i = 0; i < HwSpinlock_NUMPREEMPTGATES; i++) {
+        HwSpinlock_GateFxns[i].delete(&handle->preemptGates[i]);
+    }
+    HwSpinlock_delete(handle->hwlock);
+
+    /* Release the allocated memory for the handle */
+    Memory_free(NULL, handle, sizeof(*handle));
+
+    return HwSpinlock_S_SUCCESS;
+}
+#undef FXNN
+
+/*
+ *  ======== HwRwLock_enterRead ========
+ *  Readers get in while no writer holds or waits for the lock, on any
+ *  core.
+ */
+Int HwRwLock_enterRead(HwRwLock_Handle handle, HwSpinlock_PreemptGate pType,
+                       UInt timeout, HwRwLock_Key *key)
+{
+    HwRwLock_SharedState *shared;
+    HwSpinlock_Key hkey;
+    UInt start = Clock_getTicks();
+    UInt spins = 0;
+    UInt backoff = 1;
+    Bool admitted;
+    Int i;
+
+    Assert_isTrue(handle, NULL);
+    shared = handle->shared;
+    key->valid = FALSE;
+
+    while (TRUE) {
+        if (_HwRwLock_begin(handle, timeout, &hkey) != HwSpinlock_S_SUCCESS) {
+            return (HwSpinlock_E_TIMEOUT);
+        }
+
+        admitted = (shared->writer == 0);
+        for (i = 0; i < HwRwLock_MAXPROCS && admitted; i++) {
+            admitted = (shared->waiting[i] == 0);
+        }
+        if (admitted) {
+            _HwRwLock_held(handle);
+            shared->readers[handle->procId]++;
+            handle->readHolds++;
+        }
+
+        _HwRwLock_end(handle, &hkey);
+
+        if (admitted) {
+            break;
+        }
+
+        if (!_HwRwLock_pause(handle, &spins, &backoff, start, timeout)) {
+            return (HwSpinlock_E_TIMEOUT);
+        }
+    }
+
+    /* Disable preemption of pType and store the type in the key */
+    key->key = IGateProvider_enter(handle->preemptGates[pType]);
+    key->pType = pType;
+    key->valid = TRUE;
+    return (HwSpinlock_S_SUCCESS);
+}
+
+/*
+ *  ======== HwRwLock_leaveRead ========
+ */
+Void HwRwLock_leaveRead(HwRwLock_Handle handle, HwRwLock_Key *key)
+{
+    HwSpinlock_Key hkey;
+
+    Assert_isTrue(handle, NULL);
+
+    if (!key->valid) {
+        return;
+    }
+
+    /* Restore preemption first, HwSpinlock_enter may block */
+    IGateProvider_leave(handle->preemptGates[key->pType], key->key);
+    key->valid = FALSE;
+
+    _HwRwLock_begin(handle, HwSpinlock_WAIT_FOREVER, &hkey);
+    handle->shared->readers[handle->procId]--;
+    handle->readHolds--;
+    _HwRwLock_released(handle);
+    _HwRwLock_end(handle, &hkey);
+}
+
+/*
+ *  ======== HwRwLock_enterWrite ========
+ *  A writer first queues itself, which stops new readers, then waits for
+ *  the readers and any other writer to leave.
+ */
+Int HwRwLock_enterWrite(HwRwLock_Handle handle, HwSpinlock_PreemptGate pType,
+                        UInt timeout, HwRwLock_Key *key)
+{
+    HwRwLock_SharedState *shared;
+    HwSpinlock_Key hkey;
+    UInt start = Clock_getTicks();
+    UInt spins = 0;
+    UInt backoff = 1;
+    Bool admitted;
+    Int i;
+
+    Assert_isTrue(handle, NULL);
+    shared = handle->shared;
+    key->valid = FALSE;
+
+    if (_HwRwLock_begin(handle, timeout, &hkey) != HwSpinlock_S_SUCCESS) {
+        return (HwSpinlock_E_TIMEOUT);
+    }
+    shared->waiting[handle->procId]++;
+    _HwRwLock_end(handle, &hkey);
+
+    while (TRUE) {
+        _HwRwLock_begin(handle, HwSpinlock_WAIT_FOREVER, &hkey);
+
+        admitted = (shared->writer == 0);
+        for (i = 0; i < HwRwLock_MAXPROCS && admitted; i++) {
+            admitted = (shared->readers[i] == 0);
+        }
+        if (admitted) {
+            _HwRwLock_held(handle);
+            shared->writer = handle->procId + 1;
+            handle->writeHeld = TRUE;
+            shared->waiting[handle->procId]--;
+        }
+
+        _HwRwLock_end(handle, &hkey);
+
+        if (admitted) {
+            break;
+        }
+
+        if (!_HwRwLock_pause(handle, &spins, &backoff, start, timeout)) {
+            /* Give up our place, readers may go again */
+            _HwRwLock_begin(handle, HwSpinlock_WAIT_FOREVER, &hkey);
+            shared->waiting[handle->procId]--;
+            _HwRwLock_end(handle, &hkey);
+            return (HwSpinlock_E_TIMEOUT);
+        }
+    }
+
+    /* Disable preemption of pType and store the type in the key */
+    key->key = IGateProvider_enter(handle->preemptGates[pType]);
+    key->pType = pType;
+    key->valid = TRUE;
+    return (HwSpinlock_S_SUCCESS);
+}
+
+/*
+ *  ======== HwRwLock_leaveWrite ========
+ */
+Void HwRwLock_leaveWrite(HwRwLock_Handle handle, HwRwLock_Key *key)
+{
+    HwSpinlock_Key hkey;
+
+    Assert_isTrue(handle, NULL);
+
+    if (!key->valid || !handle->writeHeld) {
+        return;
+    }
+
+    /* Restore preemption first, HwSpinlock_enter may block */
+    IGateProvider_leave(handle->preemptGates[key->pType], key->key);
+    key->valid = FALSE;
+
+    _HwRwLock_begin(handle, HwSpinlock_WAIT_FOREVER, &hkey);
+    handle->shared->writer = 0;
+    handle->writeHeld = FALSE;
+    _HwRwLock_released(handle);
+    _HwRwLock_end(handle, &hkey);
+}
+
+/*
+ *  ======== HwRwLock_recover ========
+ */
+#define FXNN "HwRwLock_recover"
+Int HwRwLock_recover(HwRwLock_Handle handle, UInt16 procId)
+{
+    HwRwLock_SharedState *shared;
+    HwSpinlock_Key hkey;
+
+    Assert_isTrue(handle, NULL);
+    shared = handle->shared;
+
+    if (procId >= HwRwLock_MAXPROCS || procId == handle->procId) {
+        return (HwSpinlock_E_FAIL);
+    }
+
+    _HwRwLock_begin(handle, HwSpinlock_WAIT_FOREVER, &hkey);
+    Log_print3(Diags_USER1, FXNN": proc %d had %d readers, %d writers",
+               procId, shared->readers[procId],
+               shared->writer == procId + 1);
+    shared->readers[procId] = 0;
+    shared->waiting[procId] = 0;
+    if (shared->writer == procId + 1) {
+        shared->writer = 0;
+    }
+    _HwRwLock_end(handle, &hkey);
+
+    return (HwSpinlock_S_SUCCESS);
+}
+#undef FXNN
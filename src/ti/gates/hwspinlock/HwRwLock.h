@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2011-2012, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ *  ======== HwRwLock.h ========
+ *  Multi-core reader-writer lock on top of a HwSpinlock.
+ *
+ *  The reader counts and the writer live in an HwRwLock_SharedState placed
+ *  in non-cached memory mapped by every core using the lock. They are only
+ *  changed with the HwSpinlock entered, so the hardware lock is held for a
+ *  few instructions per enter/leave, not for the whole critical section.
+ *  A waiting writer stops new readers on all cores (writer preference).
+ *
+ *  While any task of this core holds the lock, its HwSpinlock stays marked
+ *  in ti_gates_HwSpinlock_sharedState, and the shared state records the
+ *  holds per processor, so a dead core's holds can be dropped with
+ *  HwRwLock_recover.
+ *
+ *  Like HwSpinlock_enter, the enter functions are Task only. The lock is
+ *  not recursive: a reader entering again while a writer waits deadlocks.
+ */
+
+#ifndef ti_gates_HwRwLock__include
+#define ti_gates_HwRwLock__include
+
+#include <ti/gates/hwspinlock/HwSpinlock.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/* =============================================================================
+ *  Constants
+ * =============================================================================
+ */
+
+/*!
+ *  @def    HwRwLock_MAXPROCS
+ *  @brief  Number of processors (MultiProc ids) the shared state tracks.
+ */
+#define HwRwLock_MAXPROCS               4
+
+
+/* =============================================================================
+ *  Structures & Enums
+ * =============================================================================
+ */
+
+/*!
+ *  @brief  HwRwLock_SharedState, the lock as seen by all the cores
+ */
+typedef struct HwRwLock_SharedState {
+    volatile UInt32 readers[HwRwLock_MAXPROCS]; /* read holds per proc */
+    volatile UInt32 waiting[HwRwLock_MAXPROCS]; /* queued writers per proc,
+                                                   new readers wait */
+    volatile UInt32 writer;         /* MultiProc id + 1 of the writer, or 0 */
+} HwRwLock_SharedState;
+
+/*!
+ *  @brief  HwRwLock_Params
+ */
+typedef struct HwRwLock_Params {
+    Int                   id;           /* HwSpinlock id */
+    HwRwLock_SharedState  *sharedAddr;  /* same state on every core */
+    Bool                  initShared;   /* TRUE on the one core that resets
+                                           the state, before the others
+                                           create the lock */
+    UInt                  spinBudget;   /* see HwSpinlock_DEFAULT_SPINBUDGET */
+    UInt                  maxBackoff;   /* see HwSpinlock_DEFAULT_MAXBACKOFF */
+    HwSpinlock_WaitMode   waitMode;
+} HwRwLock_Params;
+
+/*!
+ *  @brief  HwRwLock_Key
+ */
+typedef struct HwRwLock_Key {
+    IArg                    key;
+    HwSpinlock_PreemptGate  pType;
+    Bool                    valid;
+} HwRwLock_Key;
+
+/*!
+ *  @brief  HwRwLock_Handle type
+ */
+typedef struct HwRwLock_Object *HwRwLock_Handle;
+
+
+/* =============================================================================
+ *  HwRwLock Interface Functions
+ * =============================================================================
+ */
+
+/*!
+ *  @brief      HwRwLock_Params_init
+ *
+ *  @param[in]  HwRwLock_Params
+ *
+ *  @return     Void
+ */
+Void HwRwLock_Params_init(HwRwLock_Params *params);
+
+/*!
+ *  @brief      Create a reader-writer lock
+ *
+ *  @param[in]  HwRwLock_Params, id and sharedAddr are required
+ *
+ *  @return     HwRwLock_Handle
+ */
+HwRwLock_Handle HwRwLock_create(HwRwLock_Params *params);
+
+/*!
+ *  @brief      HwRwLock_delete
+ *
+ *  @param[in]  HwRwLock_Handle
+ *
+ *  @return     Status, HwSpinlock_STILL_IN_USE if held on this core
+ */
+Int HwRwLock_delete(HwRwLock_Handle handle);
+
+/*!
+ *  @brief      Enter the lock shared, for reading
+ *
+ *  @param[in]  timeout in Clock ticks, local protection option
+ *
+ *  @return     Status
+ */
+Int HwRwLock_enterRead(HwRwLock_Handle handle, HwSpinlock_PreemptGate pType,
+                       UInt timeout, HwRwLock_Key *key);
+
+/*!
+ *  @brief      Leave a shared hold
+ *
+ *  @param[in]  HwRwLock handle, key from HwRwLock_enterRead
+ *
+ *  @return     Void
+ */
+Void HwRwLock_leaveRead(HwRwLock_Handle handle, HwRwLock_Key *key);
+
+/*!
+ *  @brief      Enter the lock exclusive, for writing
+ *
+ *  @param[in]  timeout in Clock ticks, local protection option
+ *
+ *  @return     Status
+ */
+Int HwRwLock_enterWrite(HwRwLock_Handle handle, HwSpinlock_PreemptGate pType,
+                        UInt timeout, HwRwLock_Key *key);
+
+/*!
+ *  @brief      Leave the exclusive hold
+ *
+ *  @param[in]  HwRwLock handle, key from HwRwLock_enterWrite
+ *
+ *  @return     Void
+ */
+Void HwRwLock_leaveWrite(HwRwLock_Handle handle, HwRwLock_Key *key);
+
+/*!
+ *  @brief      Drop the holds of a processor that went down
+ *
+ *  @param[in]  HwRwLock handle, MultiProc id of the dead processor
+ *
+ *  @return     Status
+ */
+Int HwRwLock_recover(HwRwLock_Handle handle, UInt16 procId);
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
+
+#endif /* ti_gates_HwRwLock__include */
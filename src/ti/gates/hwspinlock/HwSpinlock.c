@@ -41,10 +41,13 @@
 #include <xdc/runtime/Log.h>
 #include <xdc/runtime/Diags.h>
 #include <xdc/runtime/Gate.h>
+#include <xdc/runtime/Timestamp.h>
 
 #include <ti/sysbios/knl/Task.h>
 #include <ti/sysbios/knl/Clock.h>
 
+#include <string.h>
+
 #include <ti/gates/hwspinlock/HwSpinlock.h>
 #include "_HwSpinlock.h"
 
@@ -84,6 +87,9 @@ Void HwSpinlock_Params_init(HwSpinlock_Params *params)
     params->relFxn= NULL;
     params->arg1 = NULL;
     params->arg2 = NULL;
+    params->spinBudget = HwSpinlock_DEFAULT_SPINBUDGET;
+    params->maxBackoff = HwSpinlock_DEFAULT_MAXBACKOFF;
+    params->waitMode = HwSpinlock_WaitMode_SPIN;
 }
 
 /*
@@ -139,6 +145,8 @@ HwSpinlock_Handle HwSpinlock_create(HwSpinlock_Params *params)
     handle->baseAddr = (volatile UInt32 *)HwSpinlock_BASEADDR;
     handle->refCnt = 1;
     handle->state = HwSpinlock_STATE_FREE;
+    memset(&handle->stats, 0, sizeof(handle->stats));
+    handle->holds = 0;
 
     /* Store the created handle */
     HwSpinlock_module.locks[params->id] = handle;
@@ -201,11 +209,24 @@ Int HwSpinlock_delete(HwSpinlock_Handle handle)
 
 /*
  *  ======== HwSpinlock_enter ========
+ *  Local tasks queue on the mutex, so only its owner reads the lock
+ *  register. While the lock is held by another core, the reads are spaced
+ *  by a delay doubling up to params.maxBackoff; after params.spinBudget
+ *  failed reads the task yields or sleeps between reads if so configured.
+ *  The mutex is let go between reads, in every wait mode, so other local
+ *  tasks get to check their own timeout meanwhile. A local task holding
+ *  the lock keeps the mutex until HwSpinlock_leave. The mutex makes this
+ *  a Task only function, so yield and sleep are allowed.
  */
 Int HwSpinlock_enter(HwSpinlock_Handle handle, HwSpinlock_PreemptGate pType,
                      UInt timeout, HwSpinlock_Key *hkey)
 {
     UInt start, elapsed;
+    UInt32 waitStart, waited;
+    UInt spins = 0;
+    UInt backoff = 1;
+    IArg mkey;
+    volatile UInt delay;
 
     Assert_isTrue(handle, NULL);
 
@@ -214,34 +235,66 @@ Int HwSpinlock_enter(HwSpinlock_Handle handle, HwSpinlock_PreemptGate pType,
         start = Clock_getTicks();
     }
 
-    while(1) {
-        /* Enter the localGate protection */
-        handle->mkey = GateMutexPri_enter(handle->mutex);
-
-        /* Try to get the hwspinlock */
-        if (handle->baseAddr[handle->params.id] == 0) {
-            handle->state = HwSpinlock_STATE_TAKEN;
-            /* Disable preemption of pType and store the type in handle */
-            hkey->key = IGateProvider_enter(handle->preemptGates[pType]);
-            hkey->valid = TRUE;
-            handle->pType = pType;
-            _HwSpinlock_set(handle->params.id);
-            return (HwSpinlock_S_SUCCESS);
-        }
+    /* Enter the localGate protection */
+    mkey = GateMutexPri_enter(handle->mutex);
 
-        /* If is already taken undo localGate protection */
-        GateMutexPri_leave(handle->mutex, handle->mkey);
+    /* Try to get the hwspinlock, a read of 0 takes it */
+    while (handle->baseAddr[handle->params.id] != 0) {
+        if (spins++ == 0) {
+            waitStart = Timestamp_get32();
+            handle->stats.contentions++;
+        }
 
         /* Check if timeout has elapsed */
         if (timeout != HwSpinlock_WAIT_FOREVER) {
             elapsed = Clock_getTicks() - start;
             if (elapsed > timeout) {
+                handle->stats.spins += spins;
+                GateMutexPri_leave(handle->mutex, mkey);
                 /* Mark key as invalid */
                 hkey->valid = FALSE;
                 return (HwSpinlock_E_TIMEOUT);
             }
         }
+
+        GateMutexPri_leave(handle->mutex, mkey);
+
+        if (spins >= handle->params.spinBudget &&
+            handle->params.waitMode == HwSpinlock_WaitMode_YIELD) {
+            Task_yield();
+        }
+        else if (spins >= handle->params.spinBudget &&
+                 handle->params.waitMode == HwSpinlock_WaitMode_SLEEP) {
+            Task_sleep(1);
+        }
+        else {
+            for (delay = 0; delay < backoff; delay++) {
+            }
+            if (backoff < handle->params.maxBackoff) {
+                backoff <<= 1;
+            }
+        }
+
+        mkey = GateMutexPri_enter(handle->mutex);
     }
+
+    handle->stats.acquisitions++;
+    if (spins) {
+        handle->stats.spins += spins;
+        waited = Timestamp_get32() - waitStart;
+        if (waited > handle->stats.maxWait) {
+            handle->stats.maxWait = waited;
+        }
+    }
+
+    handle->mkey = mkey;
+    handle->state = HwSpinlock_STATE_TAKEN;
+    /* Disable preemption of pType and store the type in handle */
+    hkey->key = IGateProvider_enter(handle->preemptGates[pType]);
+    hkey->valid = TRUE;
+    handle->pType = pType;
+    _HwSpinlock_set(handle->params.id);
+    return (HwSpinlock_S_SUCCESS);
 }
 
 /*
@@ -256,7 +309,9 @@ Void HwSpinlock_leave(HwSpinlock_Handle handle, HwSpinlock_Key *hkey)
        /* Leave the spinlock */
         handle->baseAddr[handle->params.id] = 0;
         handle->state = HwSpinlock_STATE_FREE;
-        _HwSpinlock_clr(handle->params.id);
+        if (!handle->holds) {
+            _HwSpinlock_clr(handle->params.id);
+        }
 
         /* Restore Preemption of pType */
         IGateProvider_leave(handle->preemptGates[handle->pType], hkey->key);
@@ -267,6 +322,24 @@ Void HwSpinlock_leave(HwSpinlock_Handle handle, HwSpinlock_Key *hkey)
     }
 }
 
+/*
+ *  ======== _HwSpinlock_hold ========
+ */
+Void _HwSpinlock_hold(HwSpinlock_Handle handle)
+{
+    handle->holds++;
+}
+
+/*
+ *  ======== _HwSpinlock_unhold ========
+ *  The bit is cleared by the HwSpinlock_leave that follows.
+ */
+Void _HwSpinlock_unhold(HwSpinlock_Handle handle)
+{
+    Assert_isTrue(handle->holds > 0, NULL);
+    handle->holds--;
+}
+
 /*
  *  ======== HwSpinlock_getId ========
  */
@@ -284,3 +357,25 @@ HwSpinlock_State HwSpinlock_getState(HwSpinlock_Handle handle)
     Assert_isTrue(handle, NULL);
     return (handle->state);
 }
+
+/*
+ *  ======== HwSpinlock_getStats ========
+ */
+Void HwSpinlock_getStats(HwSpinlock_Handle handle, HwSpinlock_Stats *stats)
+{
+    Assert_isTrue(handle, NULL);
+    *stats = handle->stats;
+}
+
+/*
+ *  ======== HwSpinlock_resetStats ========
+ */
+Void HwSpinlock_resetStats(HwSpinlock_Handle handle)
+{
+    IArg key;
+
+    Assert_isTrue(handle, NULL);
+    key = GateMutexPri_enter(handle->mutex);
+    memset(&handle->stats, 0, sizeof(handle->stats));
+    GateMutexPri_leave(handle->mutex, key);
+}
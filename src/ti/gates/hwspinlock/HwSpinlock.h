@@ -81,6 +81,20 @@ extern const UInt32 ti_gates_HwSpinlock_numLocks;
  */
 #define HwSpinlock_WAIT_FOREVER        0xFFFFFFFF
 
+/*!
+ *  @def    HwSpinlock_DEFAULT_SPINBUDGET
+ *  @brief  Default number of failed reads of the lock register spent
+ *          spinning with backoff before the wait mode applies.
+ */
+#define HwSpinlock_DEFAULT_SPINBUDGET  64
+
+/*!
+ *  @def    HwSpinlock_DEFAULT_MAXBACKOFF
+ *  @brief  Default upper bound of the delay loop between two reads of the
+ *          lock register, it doubles from 1 after each failed read.
+ */
+#define HwSpinlock_DEFAULT_MAXBACKOFF  512
+
 
 /* =============================================================================
  *  Structures & Enums
@@ -108,6 +122,18 @@ typedef enum HwSpinlock_PreemptGate {
     HwSpinlock_PreemptGate_TASK   = 3   /* Use the TASK local protection level */
 } HwSpinlock_PreemptGate;
 
+/*!
+ *  @brief  How to wait once the spin budget is used up
+ *          - HwSpinlock_WaitMode_SPIN  -> keep spinning, at the max backoff
+ *          - HwSpinlock_WaitMode_YIELD -> Task_yield between reads
+ *          - HwSpinlock_WaitMode_SLEEP -> Task_sleep one tick between reads
+ */
+typedef enum HwSpinlock_WaitMode {
+    HwSpinlock_WaitMode_SPIN    = 0,
+    HwSpinlock_WaitMode_YIELD   = 1,
+    HwSpinlock_WaitMode_SLEEP   = 2
+} HwSpinlock_WaitMode;
+
 typedef Void * (*HwSpinlock_hookFxn)(Void *);
 
 /*!
@@ -119,8 +145,22 @@ typedef struct HwSpinlock_Params {
     HwSpinlock_hookFxn    relFxn;
     Void                  *arg1;
     Void                  *arg2;
+    UInt                  spinBudget;   /* see HwSpinlock_DEFAULT_SPINBUDGET */
+    UInt                  maxBackoff;   /* see HwSpinlock_DEFAULT_MAXBACKOFF */
+    HwSpinlock_WaitMode   waitMode;
 } HwSpinlock_Params;
 
+/*!
+ *  @brief  HwSpinlock_Stats, contention of a lock since its creation or
+ *          the last HwSpinlock_resetStats
+ */
+typedef struct HwSpinlock_Stats {
+    UInt32 acquisitions;    /* successful HwSpinlock_enter calls */
+    UInt32 contentions;     /* of which found the lock taken */
+    UInt32 spins;           /* failed reads of the lock register */
+    UInt32 maxWait;         /* longest wait, in Timestamp counts */
+} HwSpinlock_Stats;
+
 /*!
  *  @brief  HwSpinlock_Key
  */
@@ -204,6 +244,25 @@ Int HwSpinlock_getId(HwSpinlock_Handle handle);
  */
 HwSpinlock_State HwSpinlock_getState(HwSpinlock_Handle handle);
 
+/*!
+ *  @brief      HwSpinlock_getStats
+ *
+ *  @param[in]  HwSpinlock handle
+ *  @param[out] Contention statistics of the lock on this core
+ *
+ *  @return     Void
+ */
+Void HwSpinlock_getStats(HwSpinlock_Handle handle, HwSpinlock_Stats *stats);
+
+/*!
+ *  @brief      HwSpinlock_resetStats
+ *
+ *  @param[in]  HwSpinlock handle
+ *
+ *  @return     Void
+ */
+Void HwSpinlock_resetStats(HwSpinlock_Handle handle);
+
 #if defined (__cplusplus)
 }
 #endif /* defined (__cplusplus) */
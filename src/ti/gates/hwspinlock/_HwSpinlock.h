@@ -67,7 +67,7 @@ typedef struct {
 /*!
  *  @brief HwSpinlock GateFxns
  */
-HwSpinlock_PreemptGateFxn HwSpinlock_GateFxns[] = {
+static HwSpinlock_PreemptGateFxn HwSpinlock_GateFxns[] = {
     {(HwSpinlock_createFxn)GateNull_create,
                                         (HwSpinlock_deleteFxn)GateNull_delete},
     {(HwSpinlock_createFxn)GateHwi_create,
@@ -108,8 +108,17 @@ struct HwSpinlock_Object {
     GateMutexPri_Handle      mutex;
     Int                      refCnt;
     HwSpinlock_State         state;
+    HwSpinlock_Stats         stats;     /* updated with mutex entered */
+    Int                      holds;     /* HwRwLock holds on this core */
 };
 
+/*
+ *  Keep/stop keeping the lock marked in ti_gates_HwSpinlock_sharedState
+ *  past HwSpinlock_leave, for HwRwLock. Call with the lock entered.
+ */
+Void _HwSpinlock_hold(HwSpinlock_Handle handle);
+Void _HwSpinlock_unhold(HwSpinlock_Handle handle);
+
 #if defined (__cplusplus)
 }
 #endif /* defined (__cplusplus) */
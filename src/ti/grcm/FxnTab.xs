@@ -0,0 +1,384 @@
+/*
+ * Copyright (c) 2011-2012, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ *  ======== FxnTab.xs ========
+ *
+ *  Generate an RcmServer static function table and its host side header
+ *  from one function table spec, so the two cannot drift.
+ *
+ *  The spec is a text file with one function per line, in index order:
+ *
+ *      # comment
+ *      <name>      <server symbol, or NULL if set at runtime>
+ *
+ *  The server header defines the RcmServer_FxnDesc array. The host header
+ *  defines an index macro for each function, with the static table bit
+ *  set, and a perfect hash from name to index so that clients never need
+ *  a SYM_IDX round trip to look a name up.
+ *
+ *  Usage, from a package.bld script:
+ *
+ *      var FxnTab = xdc.loadCapsule("ti/grcm/FxnTab.xs");
+ *      FxnTab.generate({
+ *          spec:       "test_omx.fxn",
+ *          array:      "OMXServerFxnAry",
+ *          serverHdr:  "test_omx_fxntab.h",
+ *          prefix:     "omx_fxn",
+ *          hostHdr:    "../../../host/omx_fxntab.h"
+ *      });
+ */
+
+/* static function table indices have bit 31 set */
+var STATIC_BIT = "0x80000000";
+
+/* fnv-1a constants */
+var FNV_BASIS = 2166136261;
+var FNV_PRIME = 16777619;
+
+/* give up on a table size after this many seeds */
+var MAX_SEEDS = 10000;
+
+
+/*
+ *  ======== parse ========
+ *  Return the list of {name, symbol} entries in the spec text.
+ */
+function parse(text, specName)
+{
+    var lines = text.split("\n");
+    var entries = [];
+    var seen = {};
+
+    for (var i = 0; i < lines.length; i++) {
+        var line = lines[i].replace(/#.*/, "").replace(/^\s+|\s+$/g, "");
+
+        if (line == "") {
+            continue;
+        }
+
+        var fields = line.split(/\s+/);
+
+        if (fields.length != 2) {
+            throw new Error(specName + ":" + (i + 1) +
+                ": expected '<name> <symbol>'");
+        }
+        if (!fields[0].match(/^[A-Za-z_][A-Za-z0-9_]*$/)) {
+            throw new Error(specName + ":" + (i + 1) +
+                ": invalid function name '" + fields[0] + "'");
+        }
+        if (fields[0] in seen) {
+            throw new Error(specName + ":" + (i + 1) +
+                ": duplicate function name '" + fields[0] + "'");
+        }
+
+        seen[fields[0]] = true;
+        entries.push({name: fields[0], symbol: fields[1]});
+    }
+
+    if (entries.length == 0) {
+        throw new Error(specName + ": no functions");
+    }
+    if (entries.length > 255) {
+        throw new Error(specName + ": more than 255 functions");
+    }
+
+    return (entries);
+}
+
+
+/*
+ *  ======== mul32 ========
+ *  32-bit unsigned multiply, without losing precision in a double.
+ */
+function mul32(a, b)
+{
+    var hi = (((a >>> 16) * b) & 0xffff) << 16;
+
+    return ((hi + (a & 0xffff) * b) >>> 0);
+}
+
+
+/*
+ *  ======== hash ========
+ *  Seeded fnv-1a, must match the C function written to the host header.
+ */
+function hash(name, seed)
+{
+    var h = (FNV_BASIS ^ seed) >>> 0;
+
+    for (var i = 0; i < name.length; i++) {
+        h = (h ^ name.charCodeAt(i)) >>> 0;
+        h = mul32(h, FNV_PRIME);
+    }
+
+    return (h);
+}
+
+
+/*
+ *  ======== perfectHash ========
+ *  Find the smallest power of two table, and a seed, for which no two
+ *  names hash to the same slot. Returns {seed, slots} where slots[i] is
+ *  the index of the name in slot i, or 255 if the slot is empty.
+ */
+function perfectHash(names)
+{
+    for (var size = 1; size < names.length; size <<= 1) {
+    }
+
+    for (;; size <<= 1) {
+        for (var seed = 0; seed < MAX_SEEDS; seed++) {
+            var slots = [];
+            var ok = true;
+
+            for (var i = 0; i < size; i++) {
+                slots.push(255);
+            }
+
+            for (var i = 0; (i < names.length) && ok; i++) {
+                var s = hash(names[i], seed) & (size - 1);
+
+                if (slots[s] != 255) {
+                    ok = false;
+                }
+                slots[s] = i;
+            }
+
+            if (ok) {
+                return ({seed: seed, slots: slots});
+            }
+        }
+    }
+}
+
+
+/*
+ *  ======== banner ========
+ */
+function banner(file, spec)
+{
+    return ("/*\n" +
+        " *  ======== " + file + " ========\n" +
+        " *\n" +
+        " *  Generated from " + spec + " by ti/grcm/FxnTab.xs, do not edit.\n" +
+        " */\n\n");
+}
+
+
+/*
+ *  ======== guard ========
+ */
+function guard(file)
+{
+    return (file.replace(/^.*\//, "").replace(/[^A-Za-z0-9]/g, "_")
+        .toUpperCase() + "_");
+}
+
+
+/*
+ *  ======== genServer ========
+ *  Return the text of the server header.
+ */
+function genServer(entries, args)
+{
+    var file = args.serverHdr.replace(/^.*\//, "");
+    var spec = args.spec.replace(/^.*\//, "");
+    var width = 0;
+    var symWidth = 0;
+    var out;
+
+    for (var i = 0; i < entries.length; i++) {
+        width = Math.max(width, entries[i].name.length + 2);
+        symWidth = Math.max(symWidth, entries[i].symbol.length);
+    }
+
+    out = banner(file, spec);
+    out += "#ifndef " + guard(file) + "\n#define " + guard(file) + "\n\n";
+    out += "/* RcmServer static function table, in index order */\n";
+    out += "static RcmServer_FxnDesc " + args.array + "[] = {\n";
+
+    for (var i = 0; i < entries.length; i++) {
+        var str = "\"" + entries[i].name + "\",";
+
+        while (str.length < width + 1) {
+            str += " ";
+        }
+        str += " " + entries[i].symbol + "},";
+
+        while (str.length < width + symWidth + 4) {
+            str += " ";
+        }
+        out += "    {" + str + " /* " + i + " */\n";
+    }
+
+    out += "};\n\n#endif\n";
+
+    return (out);
+}
+
+
+/*
+ *  ======== genHost ========
+ *  Return the text of the host header.
+ */
+function genHost(entries, args)
+{
+    var file = args.hostHdr.replace(/^.*\//, "");
+    var spec = args.spec.replace(/^.*\//, "");
+    var prefix = args.prefix;
+    var PREFIX = prefix.toUpperCase();
+    var names = [];
+    var width = 0;
+    var out;
+
+    for (var i = 0; i < entries.length; i++) {
+        names.push(entries[i].name);
+        width = Math.max(width,
+            PREFIX.length + "_IDX_".length + entries[i].name.length);
+    }
+
+    var ph = perfectHash(names);
+
+    out = banner(file, spec);
+    out += "#ifndef " + guard(file) + "\n#define " + guard(file) + "\n\n";
+    out += "#include <stdint.h>\n#include <string.h>\n\n";
+
+    out += "/* static function indices, bit 31 marks the static table */\n";
+    for (var i = 0; i < entries.length; i++) {
+        var str = PREFIX + "_IDX_" + entries[i].name.toUpperCase();
+
+        while (str.length < width + 4) {
+            str += " ";
+        }
+        out += "#define " + str + "(" + i + " | " + STATIC_BIT + ")\n";
+    }
+    out += "\n#define " + PREFIX + "_COUNT " + entries.length + "\n\n";
+
+    out += "static const char * const " + prefix + "_names[] = {\n";
+    for (var i = 0; i < entries.length; i++) {
+        out += "    \"" + entries[i].name + "\",\n";
+    }
+    out += "};\n\n";
+
+    out += "/* perfect hash of the names, 0xff marks an empty slot */\n";
+    out += "#define " + PREFIX + "_SEED " + ph.seed + "u\n";
+    out += "#define " + PREFIX + "_SLOTS " + ph.slots.length + "\n\n";
+    out += "static const uint8_t " + prefix + "_slot[" + PREFIX +
+        "_SLOTS] = {\n   ";
+    for (var i = 0; i < ph.slots.length; i++) {
+        out += " 0x" + (ph.slots[i] < 16 ? "0" : "") +
+            ph.slots[i].toString(16) + ",";
+        if ((i % 8 == 7) && (i + 1 < ph.slots.length)) {
+            out += "\n   ";
+        }
+    }
+    out += "\n};\n\n";
+
+    out += "/*\n" +
+        " *  ======== " + prefix + "_idx ========\n" +
+        " *\n" +
+        " *  Return the function index for the given name, or 0 if the name\n" +
+        " *  is not in the table.\n" +
+        " */\n";
+    out += "static inline uint32_t " + prefix + "_idx(const char *name)\n{\n";
+    out += "    const unsigned char *cp = (const unsigned char *)name;\n";
+    out += "    uint32_t h = " + FNV_BASIS + "u ^ " + PREFIX + "_SEED;\n";
+    out += "    uint8_t i;\n\n";
+    out += "    while (*cp) {\n";
+    out += "        h = (h ^ *cp++) * " + FNV_PRIME + "u;\n";
+    out += "    }\n\n";
+    out += "    i = " + prefix + "_slot[h & (" + PREFIX + "_SLOTS - 1)];\n\n";
+    out += "    if ((i == 0xff) || strcmp(" + prefix + "_names[i], name)) {\n";
+    out += "        return (0);\n";
+    out += "    }\n\n";
+    out += "    return (i | " + STATIC_BIT + ");\n}\n\n#endif\n";
+
+    return (out);
+}
+
+
+/*
+ *  ======== readFile ========
+ */
+function readFile(path)
+{
+    var reader = new java.io.BufferedReader(new java.io.FileReader(path));
+    var text = "";
+    var line;
+
+    while ((line = reader.readLine()) != null) {
+        text += String(line) + "\n";
+    }
+    reader.close();
+
+    return (text);
+}
+
+
+/*
+ *  ======== writeFile ========
+ *  Only write the file if its contents change, so that the build does
+ *  not rebuild everything that includes it.
+ */
+function writeFile(path, text)
+{
+    var file = new java.io.File(path);
+
+    if (file.exists() && (readFile(path) == text)) {
+        return;
+    }
+
+    var writer = new java.io.FileWriter(file);
+    writer.write(text);
+    writer.close();
+}
+
+
+/*
+ *  ======== generate ========
+ *  Read args.spec and write args.serverHdr and args.hostHdr.
+ */
+function generate(args)
+{
+    var entries = parse(readFile(args.spec), args.spec);
+
+    if (args.prefix == undefined) {
+        args.prefix = "fxn";
+    }
+
+    writeFile(args.serverHdr, genServer(entries, args));
+
+    if (args.hostHdr != undefined) {
+        writeFile(args.hostHdr, genHost(entries, args));
+    }
+}
@@ -55,6 +55,7 @@
 #include <xdc/runtime/knl/SemThread.h>
 #include <xdc/runtime/knl/SyncSemThread.h>
 #include <xdc/runtime/knl/ISemaphore.h>
+#include <xdc/runtime/knl/Thread.h>
 
 /* package header files */
 #include <ti/ipc/MessageQ.h>
@@ -64,6 +65,8 @@
 
 #elif defined(RCM_ti_syslink)
 #include <ti/syslink/utils/List.h>
+#define List_Struct List_Object
+#define List_handle(exp) (exp)
 
 #else
     #error "undefined ipc binding"
@@ -74,6 +77,10 @@
 #include "RcmTypes.h"
 #include "RcmClient.h"
 
+/* number of mailbox slots, must be a power of two */
+#define RcmClient_MBX_SLOTS 32
+#define RcmClient_MBX_MASK  (RcmClient_MBX_SLOTS - 1)
+
 /* recipient list element structure */
 typedef struct {
     List_Elem elem;
@@ -82,6 +89,20 @@ typedef struct {
     SemThread_Struct event;
 } Recipient;
 
+/* mailbox slot, indexed by the low bits of the message id */
+typedef struct {
+    List_Struct mail;           // undelivered messages for this slot
+    List_Struct recipients;     // threads waiting on this slot
+} Mailbox;
+
+/* pending asynchronous call list element structure */
+typedef struct {
+    List_Elem elem;
+    UInt16 msgId;
+    RcmClient_CallbackFxn callback;
+    Ptr appData;
+} Callback;
+
 typedef struct RcmClient_Object_tag {
     GateThread_Struct   gate;           // instance gate
     MessageQ_Handle     msgQue;         // message queue
@@ -91,10 +112,13 @@ typedef struct RcmClient_Object_tag {
     UInt32              serverMsgQ;     // server message queue
     Bool                cbNotify;       // callback notification
     UInt16              msgId;          // last used message id
-    ISemaphore_Handle   mbxLock;        // mailbox lock
-    ISemaphore_Handle   queueLock;      // message queue lock
-    List_Handle         recipients;     // list of waiting recipients
-    List_Handle         newMail;        // list of undelivered messages
+    Mailbox *           mbx;            // return message mailbox slots
+    Bool                mailman;        // true when a thread owns msgQue
+    UInt32              waitMask;       // slots with waiting recipients
+    MessageQ_Handle     cbMsgQue;       // callback return message queue
+    Thread_Handle       cbThread;       // callback server thread
+    Bool                cbShutdown;     // callback server shutdown flag
+    List_Handle         cbPending;      // list of pending async calls
 } RcmClient_Object;
 
 typedef struct RcmClient_Module_tag {
@@ -125,12 +149,28 @@ RcmClient_Packet *getPacketAddrElem(
         List_Elem *             elem
     );
 
+static
+Void RcmClient_deliver_P(
+        RcmClient_Object *      obj,
+        RcmClient_Packet *      packet
+    );
+
+static
+Void RcmClient_handOff_P(
+        RcmClient_Object *      obj
+    );
+
 static Int RcmClient_getReturnMsg_P(
         RcmClient_Object *      obj,
         const UInt16            msgId,
         RcmClient_Message **    returnMsg
     );
 
+static
+Void RcmClient_cbServerThrFxn_P(
+        IArg                    arg
+    );
+
 static
 Int RcmClient_Instance_init(
         RcmClient_Object *              obj,
@@ -313,9 +353,9 @@ Int RcmClient_Instance_init(RcmClient_Object *obj, String server,
     Error_Block eb;
     MessageQ_Params mqParams;
     SyncSemThread_Params syncParams;
-    SemThread_Params semParams;
-    SemThread_Handle semHndl;
     List_Params listP;
+    Thread_Params threadP;
+    UInt i;
     Int rval;
     Int status = RcmClient_S_SUCCESS;
 
@@ -331,10 +371,13 @@ Int RcmClient_Instance_init(RcmClient_Object *obj, String server,
     obj->serverMsgQ = MessageQ_INVALIDMESSAGEQ;
     obj->msgQue = NULL;
     obj->errorMsgQue = NULL;
-    obj->mbxLock = NULL;
-    obj->queueLock = NULL;
-    obj->recipients = NULL;
-    obj->newMail = NULL;
+    obj->mbx = NULL;
+    obj->mailman = FALSE;
+    obj->waitMask = 0;
+    obj->cbMsgQue = NULL;
+    obj->cbThread = NULL;
+    obj->cbShutdown = FALSE;
+    obj->cbPending = NULL;
 
     /* create the instance gate */
     GateThread_construct(&obj->gate, NULL, &eb);
@@ -391,78 +434,76 @@ Int RcmClient_Instance_init(RcmClient_Object *obj, String server,
 
     /* create callback server */
     if ((obj->cbNotify = params->callbackNotification)) {
-        /* TODO create callback server thread */
-        /* make sure to free resources acquired by thread */
-        Error_raise(&eb, Error_E_generic, "Not Implemented", 0);
-        goto leave;
-    }
 
-    /* register the heapId used for message allocation */
-    if ((obj->heapId = params->heapId) == RcmClient_INVALIDHEAPID) {
-        Log_error0(FXNN": must specify a heap id in create params");
-        status = RcmClient_E_INVALIDHEAPID;
-        goto leave;
-    }
+        /* create the message queue for async return messages */
+        MessageQ_Params_init(&mqParams);
+        obj->cbMsgQue = MessageQ_create(NULL, &mqParams);
 
-    /* create the mailbox lock */
-    SemThread_Params_init(&semParams);
-    semHndl = SemThread_create(1, &semParams, &eb);
-    if (Error_check(&eb)) {
-        status = RcmClient_E_FAIL;
-        goto leave;
-    }
-    obj->mbxLock = SemThread_Handle_upCast(semHndl);
-
-    /* create the message queue lock */
-    SemThread_Params_init(&semParams);
-    semHndl = SemThread_create(1, &semParams, &eb);
-    if (Error_check(&eb)) {
-        status = RcmClient_E_FAIL;
-        goto leave;
-    }
-    obj->queueLock = SemThread_Handle_upCast(semHndl);
+        if (NULL == obj->cbMsgQue) {
+            Log_error0(FXNN": could not create callback message queue");
+            status = RcmClient_E_MSGQCREATEFAILED;
+            goto leave;
+        }
 
-    /* create the return message recipient list */
+        /* create the list of pending async calls */
 #if defined(RCM_ti_ipc)
-    List_Params_init(&listP);
-    obj->recipients = List_create(&listP, &eb);
+        List_Params_init(&listP);
+        obj->cbPending = List_create(&listP, &eb);
 
-    if (Error_check(&eb)) {
-        Log_error0(FXNN": could not create list object");
-        status = RcmClient_E_LISTCREATEFAILED;
-        goto leave;
-    }
+        if (Error_check(&eb)) {
+            Log_error0(FXNN": could not create list object");
+            status = RcmClient_E_LISTCREATEFAILED;
+            goto leave;
+        }
 #elif defined(RCM_ti_syslink)
-    List_Params_init(&listP);
-    obj->recipients = List_create(&listP, NULL);
+        List_Params_init(&listP);
+        obj->cbPending = List_create(&listP, NULL);
+
+        if (NULL == obj->cbPending) {
+            Log_error0(FXNN": could not create list object");
+            status = RcmClient_E_LISTCREATEFAILED;
+            goto leave;
+        }
+#endif
+
+        /* create the callback server thread */
+        Thread_Params_init(&threadP);
+        threadP.arg = (IArg)obj;
+        threadP.instance->name = "RcmClient_cbServerThr";
+
+        obj->cbThread = Thread_create(
+            (Thread_RunFxn)(RcmClient_cbServerThrFxn_P), &threadP, &eb);
 
-    if (NULL == obj->recipients) {
-        Log_error0(FXNN": could not create list object");
-        status = RcmClient_E_LISTCREATEFAILED;
+        if (Error_check(&eb)) {
+            Log_error0(FXNN": could not create callback server thread");
+            status = RcmClient_E_FAIL;
+            goto leave;
+        }
+    }
+
+    /* register the heapId used for message allocation */
+    if ((obj->heapId = params->heapId) == RcmClient_INVALIDHEAPID) {
+        Log_error0(FXNN": must specify a heap id in create params");
+        status = RcmClient_E_INVALIDHEAPID;
         goto leave;
     }
-#endif
 
-    /* create list of undelivered messages (new mail) */
-#if defined(RCM_ti_ipc)
-    List_Params_init(&listP);
-    obj->newMail = List_create(&listP, &eb);
+    /* create the return message mailbox */
+    obj->mbx = (Mailbox *)xdc_runtime_Memory_alloc(RcmClient_Module_heap(),
+        RcmClient_MBX_SLOTS * sizeof(Mailbox), sizeof(Ptr), &eb);
 
     if (Error_check(&eb)) {
-        Log_error0(FXNN": could not create list object");
-        status = RcmClient_E_LISTCREATEFAILED;
+        Log_error2(FXNN": out of memory: heap=0x%x, size=%u",
+            (IArg)RcmClient_Module_heap(),
+            RcmClient_MBX_SLOTS * sizeof(Mailbox));
+        status = RcmClient_E_NOMEMORY;
         goto leave;
     }
-#elif defined(RCM_ti_syslink)
-    List_Params_init(&listP);
-    obj->newMail = List_create(&listP, NULL);
 
-    if (NULL == obj->newMail) {
-        Log_error0(FXNN": could not create list object");
-        status = RcmClient_E_LISTCREATEFAILED;
-        goto leave;
+    for (i = 0; i < RcmClient_MBX_SLOTS; i++) {
+        List_construct(&obj->mbx[i].mail, NULL);
+        List_construct(&obj->mbx[i].recipients, NULL);
     }
-#endif
 
 leave:
     Log_print2(Diags_EXIT, "<-- %s: %d", (IArg)FXNN, (IArg)status);
@@ -527,30 +568,58 @@ Int RcmClient_destruct(RcmClient_Struct *structPtr)
 #define FXNN "RcmClient_Instance_finalize"
 Int RcmClient_Instance_finalize(RcmClient_Object *obj)
 {
-    SemThread_Handle semH;
+    List_Elem *elem;
+    List_Handle listH;
+    UInt i;
+    Error_Block eb;
     Int status = RcmClient_S_SUCCESS;
 
 
     Log_print1(Diags_ENTRY, "--> "FXNN": (obj=0x%x)", (IArg)obj);
 
-    if (NULL != obj->newMail) {
-        List_delete(&obj->newMail);
+    Error_init(&eb);
+
+    /* block until callback server thread exits */
+    if (NULL != obj->cbThread) {
+        obj->cbShutdown = TRUE;
+        MessageQ_unblock(obj->cbMsgQue);
+        Thread_join(obj->cbThread, &eb);
+
+        if (Error_check(&eb)) {
+            Log_error0(FXNN": callback server thread did not exit properly");
+            status = RcmClient_E_FAIL;
+        }
+        Thread_delete(&obj->cbThread);
     }
 
-    if (NULL != obj->recipients) {
-        List_delete(&obj->recipients);
+    /* discard any calls which never completed */
+    if (NULL != obj->cbPending) {
+        while ((elem = List_get(obj->cbPending)) != NULL) {
+            Log_warning1(FXNN": discarding pending async call, msgId=%d",
+                (IArg)((Callback *)elem)->msgId);
+            xdc_runtime_Memory_free(RcmClient_Module_heap(),
+                (Ptr)elem, sizeof(Callback));
+        }
+        List_delete(&obj->cbPending);
     }
 
-    if (NULL != obj->queueLock) {
-        semH = SemThread_Handle_downCast(obj->queueLock);
-        SemThread_delete(&semH);
-        obj->queueLock = NULL;
+    if (NULL != obj->cbMsgQue) {
+        MessageQ_delete(&obj->cbMsgQue);
     }
 
-    if (NULL != obj->mbxLock) {
-        semH = SemThread_Handle_downCast(obj->mbxLock);
-        SemThread_delete(&semH);
-        obj->mbxLock = NULL;
+    /* return any undelivered messages to the heap */
+    if (NULL != obj->mbx) {
+        for (i = 0; i < RcmClient_MBX_SLOTS; i++) {
+            listH = List_handle(&obj->mbx[i].mail);
+            while ((elem = List_get(listH)) != NULL) {
+                MessageQ_free((MessageQ_Msg)getPacketAddrElem(elem));
+            }
+            List_destruct(&obj->mbx[i].mail);
+            List_destruct(&obj->mbx[i].recipients);
+        }
+        xdc_runtime_Memory_free(RcmClient_Module_heap(), (Ptr)obj->mbx,
+            RcmClient_MBX_SLOTS * sizeof(Mailbox));
+        obj->mbx = NULL;
     }
 
     if (MessageQ_INVALIDMESSAGEQ != obj->serverMsgQ) {
@@ -906,6 +975,10 @@ Int RcmClient_execAsync(RcmClient_Object *obj, RcmClient_Message *cmdMsg,
 {
     RcmClient_Packet *packet;
     MessageQ_Msg msgqMsg;
+    Callback *cb;
+    GateThread_Handle gateH;
+    IArg key;
+    Error_Block eb;
     Int rval;
     Int status = RcmClient_S_SUCCESS;
 
@@ -924,21 +997,45 @@ Int RcmClient_execAsync(RcmClient_Object *obj, RcmClient_Message *cmdMsg,
     packet = RcmClient_getPacketAddr_P(cmdMsg);
     packet->desc |= RcmClient_Desc_RCM_MSG << RcmClient_Desc_TYPE_SHIFT;
 
-    /* set the return address to this instance's message queue */
+    /* record the callback before the return message can arrive */
+    Error_init(&eb);
+    cb = (Callback *)xdc_runtime_Memory_alloc(RcmClient_Module_heap(),
+        sizeof(Callback), sizeof(Ptr), &eb);
+
+    if (Error_check(&eb)) {
+        Log_error2(FXNN": out of memory: heap=0x%x, size=%u",
+            (IArg)RcmClient_Module_heap(), sizeof(Callback));
+        status = RcmClient_E_NOMEMORY;
+        goto leave;
+    }
+
+    cb->msgId = packet->msgId;
+    cb->callback = callback;
+    cb->appData = appData;
+
+    gateH = GateThread_handle(&obj->gate);
+    key = GateThread_enter(gateH);
+    List_put(obj->cbPending, &cb->elem);
+    GateThread_leave(gateH, key);
+
+    /* set the return address to the callback server's message queue */
     msgqMsg = (MessageQ_Msg)packet;
-    MessageQ_setReplyQueue(obj->msgQue, msgqMsg);
+    MessageQ_setReplyQueue(obj->cbMsgQue, msgqMsg);
 
     /* send the message to the server */
     rval = MessageQ_put((MessageQ_QueueId)obj->serverMsgQ, msgqMsg);
 
     if (rval < 0) {
         Log_error0(FXNN": unable to the send message to the server");
+        key = GateThread_enter(gateH);
+        List_remove(obj->cbPending, &cb->elem);
+        GateThread_leave(gateH, key);
+        xdc_runtime_Memory_free(RcmClient_Module_heap(),
+            (Ptr)cb, sizeof(Callback));
         status = RcmClient_E_EXECFAILED;
         goto leave;
     }
 
-    /* TODO finish this function */
-
 leave:
     Log_print2(Diags_EXIT, "<-- %s: %d", (IArg)FXNN, (IArg)status);
     return(status);
@@ -946,6 +1043,79 @@ leave:
 #undef FXNN
 
 
+/*
+ *  ======== RcmClient_cbServerThrFxn_P ========
+ *  Callback server thread
+ *
+ *  Receives the return messages of RcmClient_execAsync() calls and invokes
+ *  the callback registered for each one. Ownership of the return message
+ *  passes to the callback.
+ */
+#define FXNN "RcmClient_cbServerThrFxn_P"
+Void RcmClient_cbServerThrFxn_P(IArg arg)
+{
+    RcmClient_Object *obj = (RcmClient_Object *)arg;
+    GateThread_Handle gateH;
+    IArg key;
+    List_Elem *elem;
+    Callback *cb;
+    RcmClient_Packet *packet;
+    MessageQ_Msg msgqMsg;
+    Int rval;
+
+
+    Log_print1(Diags_ENTRY, "--> "FXNN": (arg=0x%x)", arg);
+
+    gateH = GateThread_handle(&obj->gate);
+
+    while (!obj->cbShutdown) {
+
+        /* block until a return message arrives */
+        msgqMsg = NULL;
+        rval = MessageQ_get(obj->cbMsgQue, &msgqMsg, MessageQ_FOREVER);
+
+        if ((rval < 0) && (rval != MessageQ_E_UNBLOCKED)) {
+            Log_error1(FXNN": ipc error 0x%x", (IArg)rval);
+            continue;
+        }
+
+        if (msgqMsg == NULL) {
+            continue;
+        }
+
+        /* find and remove the pending call for this message */
+        packet = getPacketAddrMsgqMsg(msgqMsg);
+        key = GateThread_enter(gateH);
+
+        elem = NULL;
+        while ((elem = List_next(obj->cbPending, elem)) != NULL) {
+            if (((Callback *)elem)->msgId == packet->msgId) {
+                List_remove(obj->cbPending, elem);
+                break;
+            }
+        }
+
+        GateThread_leave(gateH, key);
+
+        if (elem == NULL) {
+            Log_error1(FXNN": no callback for msgId=%d", (IArg)packet->msgId);
+            MessageQ_free(msgqMsg);
+            continue;
+        }
+
+        /* notify the application */
+        cb = (Callback *)elem;
+        (*cb->callback)(&packet->message, cb->appData);
+
+        xdc_runtime_Memory_free(RcmClient_Module_heap(),
+            (Ptr)cb, sizeof(Callback));
+    }
+
+    Log_print0(Diags_EXIT, "<-- "FXNN":");
+}
+#undef FXNN
+
+
 /*
  *  ======== RcmClient_execCmd ========
  */
@@ -1311,6 +1481,25 @@ Int RcmClient_removeSymbol(RcmClient_Object *obj, String name)
 #undef FXNN
 
 
+/*
+ *  ======== RcmClient_setPriority ========
+ */
+Void RcmClient_setPriority(RcmClient_Message *msg, UInt16 priority)
+{
+    RcmClient_Packet *packet;
+
+
+    if (priority > RcmClient_PRIORITY_HIGHEST) {
+        priority = RcmClient_PRIORITY_HIGHEST;
+    }
+
+    packet = RcmClient_getPacketAddr_P(msg);
+    packet->desc &= ~(RcmClient_Desc_PRI_MASK);
+    packet->desc |= ((priority << RcmClient_Desc_PRI_SHIFT)
+        & RcmClient_Desc_PRI_MASK);
+}
+
+
 /*
  *  ======== RcmClient_waitUntilDone ========
  */
@@ -1364,33 +1553,100 @@ UInt16 RcmClient_genMsgId_P(RcmClient_Object *obj)
 }
 
 
+/*
+ *  ======== RcmClient_deliver_P ========
+ *  Deliver a return message to its recipient
+ *
+ *  The message is handed directly to a waiting recipient if there is one,
+ *  otherwise it is left in the mailbox slot until the recipient arrives
+ *  to collect it. Must be called with the instance gate held.
+ */
+Void RcmClient_deliver_P(RcmClient_Object *obj, RcmClient_Packet *packet)
+{
+    Mailbox *slot;
+    List_Elem *elem;
+    Recipient *recipient;
+
+
+    slot = &obj->mbx[packet->msgId & RcmClient_MBX_MASK];
+
+    /* search the (usually empty) slot wait list for the message owner */
+    elem = NULL;
+    while ((elem = List_next(List_handle(&slot->recipients), elem)) != NULL) {
+        recipient = (Recipient *)elem;
+        if (recipient->msgId == packet->msgId) {
+            recipient->msg = &packet->message;
+            SemThread_post(SemThread_handle(&recipient->event), NULL);
+            return;
+        }
+    }
+
+    /* no recipient waiting, use the elem in the MessageQ header */
+    List_put(List_handle(&slot->mail), (List_Elem *)&packet->msgqHeader);
+}
+
+
+/*
+ *  ======== RcmClient_handOff_P ========
+ *  Hand the mailman role to a waiting recipient
+ *
+ *  Must be called with the instance gate held and the mailman role free.
+ */
+Void RcmClient_handOff_P(RcmClient_Object *obj)
+{
+    UInt i;
+    List_Elem *elem;
+    Recipient *recipient;
+
+
+    for (i = 0; (i < RcmClient_MBX_SLOTS) && (obj->waitMask >> i); i++) {
+        if ((obj->waitMask & (1 << i)) == 0) {
+            continue;
+        }
+
+        elem = NULL;
+        while ((elem = List_next(List_handle(&obj->mbx[i].recipients), elem))
+            != NULL) {
+            recipient = (Recipient *)elem;
+            if (NULL == recipient->msg) {
+                SemThread_post(SemThread_handle(&recipient->event), NULL);
+                return;
+            }
+        }
+    }
+}
+
+
 /*
  *  ======== RcmClient_getReturnMsg_P ========
  *  A thread safe algorithm for message delivery
  *
  *  This function is called to pickup a specified return message from
- *  the server. Messages are taken from the queue and either delivered
- *  to the mailbox if not the specified message or returned to the caller.
- *  The calling thread might take the role of mailman or simply wait
- *  on a list of recipients.
+ *  the server. Return messages are kept in a mailbox indexed by the low
+ *  bits of the message id, so both delivery and pickup only look at one
+ *  slot. Slot collisions are resolved by matching the full message id.
+ *
+ *  One calling thread at a time takes the role of mailman and reads the
+ *  message queue, delivering messages which are not its own either to
+ *  the waiting recipient or to the mailbox slot. All other callers wait
+ *  on their own event in the slot. When the mailman finds its message,
+ *  it hands the role over to one of the waiting recipients.
  *
- *  This algorithm guarantees that a waiting recipient is released as soon
- *  as his message arrives. All new unclaimed mail is placed in the mailbox
- *  until the recipient arrives to collect it. The messages can arrive in
- *  any order and will be processed as they arrive. Message delivery is never
- *  stalled waiting on an absent recipient.
+ *  A waiting recipient is released as soon as its message arrives and
+ *  message delivery is never stalled waiting on an absent recipient.
  */
 #define FXNN "RcmClient_getReturnMsg_P"
 Int RcmClient_getReturnMsg_P(RcmClient_Object *obj, const UInt16 msgId,
     RcmClient_Message **returnMsg)
 {
+    GateThread_Handle gateH;
+    IArg key;
+    Mailbox *slot;
+    UInt32 slotBit;
     List_Elem *elem;
-    Recipient *recipient;
-    RcmClient_Packet *packet;
-    Bool messageDelivered;
-    MessageQ_Msg msgqMsg = NULL;
-    Bool messageFound = FALSE;
-    Int queueLockAcquired = 0;
+    Recipient self;
+    RcmClient_Packet *packet = NULL;
+    MessageQ_Msg msgqMsg;
     Error_Block eb;
     Int rval;
     Int status = RcmClient_S_SUCCESS;
@@ -1403,226 +1659,101 @@ Int RcmClient_getReturnMsg_P(RcmClient_Object *obj, const UInt16 msgId,
     Error_init(&eb);
     *returnMsg = NULL;
 
-    /* keep trying until message found */
-    while (!messageFound) {
+    gateH = GateThread_handle(&obj->gate);
+    slot = &obj->mbx[msgId & RcmClient_MBX_MASK];
+    slotBit = 1 << (msgId & RcmClient_MBX_MASK);
 
-        /* acquire the mailbox lock */
-        Semaphore_pend(obj->mbxLock, Semaphore_FOREVER, &eb);
-        if (Error_check(&eb)) {
-            /* TODO */
-            goto leave;
-        }
+    /* construct recipient on local stack */
+    self.msgId = msgId;
+    self.msg = NULL;
+    SemThread_construct(&self.event, 0, NULL, &eb);
 
-        /* search new mail list for message */
-        elem = NULL;
-        while ((elem = List_next(obj->newMail, elem)) != NULL) {
+    if (Error_check(&eb)) {
+        status = RcmClient_E_FAIL;
+        goto leave;
+    }
+
+    key = GateThread_enter(gateH);
+
+    /* check the mailbox slot for the message */
+    elem = NULL;
+    while ((elem = List_next(List_handle(&slot->mail), elem)) != NULL) {
+        if (getPacketAddrElem(elem)->msgId == msgId) {
+            List_remove(List_handle(&slot->mail), elem);
             packet = getPacketAddrElem(elem);
-            if (msgId == packet->msgId) {
-                List_remove(obj->newMail, elem);
-                *returnMsg = &packet->message;
-                messageFound = TRUE;
+            break;
+        }
+    }
+
+    /* keep trying until message found */
+    while ((NULL == packet) && (status >= 0)) {
+
+        if (!obj->mailman) {
+            /*
+             * mailman role
+             */
+            obj->mailman = TRUE;
+            GateThread_leave(gateH, key);
+
+            /* get next message, this blocks the thread */
+            msgqMsg = NULL;
+            rval = MessageQ_get(obj->msgQue, &msgqMsg, MessageQ_FOREVER);
+
+            key = GateThread_enter(gateH);
+            obj->mailman = FALSE;
+
+            if ((rval < 0) || (NULL == msgqMsg)) {
+                Log_error0(FXNN": lost return message");
+                status = RcmClient_E_LOSTMSG;
                 break;
             }
-        }
+            Log_print0(Diags_INFO, FXNN": return message received");
 
-        if (messageFound) {
-            /* release the mailbox lock */
-            Semaphore_post(obj->mbxLock, &eb);
-            if (Error_check(&eb)) {
-                /* TODO */
+            packet = getPacketAddrMsgqMsg(msgqMsg);
+
+            if (packet->msgId != msgId) {
+                RcmClient_deliver_P(obj, packet);
+                packet = NULL;
             }
         }
         else {
-            /* attempt the message queue lock */
-            queueLockAcquired = Semaphore_pend(obj->queueLock, 0, &eb);
-            if (Error_check(&eb)) {
-                /* TODO */
-                goto leave;
+            /* wait for the message or for the mailman role */
+            List_put(List_handle(&slot->recipients), &self.elem);
+            obj->waitMask |= slotBit;
+            GateThread_leave(gateH, key);
+
+            SemThread_pend(SemThread_handle(&self.event),
+                Semaphore_FOREVER, &eb);
+
+            key = GateThread_enter(gateH);
+            List_remove(List_handle(&slot->recipients), &self.elem);
+            if (List_empty(List_handle(&slot->recipients))) {
+                obj->waitMask &= ~slotBit;
             }
 
-            if (1 == queueLockAcquired) {
-                /*
-                 * mailman role
-                 */
-
-                /* deliver new mail until message found */
-                while (!messageFound) {
-
-                    /* get message from queue if available (non-blocking) */
-                    if (NULL == msgqMsg) {
-                        rval = MessageQ_get(obj->msgQue, &msgqMsg, 0);
-
-                        if ((MessageQ_E_TIMEOUT != rval) && (rval < 0)) {
-                            Log_error0(FXNN": lost return message");
-                            status = RcmClient_E_LOSTMSG;
-                            goto leave;
-                        }
-                        Log_print0(Diags_INFO, FXNN": return message received");
-                    }
-
-                    while (NULL != msgqMsg) {
-
-                        /* check if message found */
-                        packet = getPacketAddrMsgqMsg(msgqMsg);
-                        messageFound = (msgId == packet->msgId);
-
-                        if (messageFound) {
-                            *returnMsg = &packet->message;
-
-                            /* search wait list for new mailman */
-                            elem = NULL;
-                            while ((elem =
-                                List_next(obj->recipients, elem)) != NULL) {
-                                recipient = (Recipient *)elem;
-                                if (NULL == recipient->msg) {
-                                    /* signal recipient's event */
-                                    SemThread_post(SemThread_handle(
-                                        &recipient->event), &eb);
-                                    break;
-                                }
-                            }
-
-                            /* release the message queue lock */
-                            Semaphore_post(obj->queueLock, &eb);
-                            if (Error_check(&eb)) {
-                                /* TODO */
-                            }
-
-                            /* release the mailbox lock */
-                            Semaphore_post(obj->mbxLock, &eb);
-                            if (Error_check(&eb)) {
-                                /* TODO */
-                            }
-
-                            break;
-                        }
-                        else {
-                            /*
-                             * deliver message to mailbox
-                             */
-
-                            /* search recipient list for message owner */
-                            elem = NULL;
-                            messageDelivered = FALSE;
-                            while ((elem =
-                                List_next(obj->recipients, elem)) != NULL) {
-                                recipient = (Recipient *)elem;
-                                if (recipient->msgId == packet->msgId) {
-                                    recipient->msg = &packet->message;
-                                    /* signal the recipient's event */
-                                    SemThread_post(SemThread_handle(
-                                        &recipient->event), &eb);
-                                    messageDelivered = TRUE;
-                                    break;
-                                }
-                            }
-
-                            /* add undelivered message to new mail list */
-                            if (!messageDelivered) {
-                                /* use the elem in the MessageQ header */
-                                elem = (List_Elem *)&packet->msgqHeader;
-                                List_put(obj->newMail, elem);
-                            }
-                        }
-
-                        /* get next message from queue if available */
-                        rval = MessageQ_get(obj->msgQue, &msgqMsg, 0);
-
-                        if ((MessageQ_E_TIMEOUT != rval) && (rval < 0)) {
-                            Log_error0(FXNN": lost return message");
-                            status = RcmClient_E_LOSTMSG;
-                            goto leave;
-                        }
-                        Log_print0(Diags_INFO, FXNN": return message received");
-                    }
-
-                    if (!messageFound) {
-                        /*
-                         * message queue empty
-                         */
-
-                        /* release the mailbox lock */
-                        Semaphore_post(obj->mbxLock, &eb);
-                        if (Error_check(&eb)) {
-                            /* TODO */
-                        }
-
-                        /* get next message, this blocks the thread */
-                        rval = MessageQ_get(obj->msgQue, &msgqMsg,
-                            MessageQ_FOREVER);
-
-                        if (rval < 0) {
-                            Log_error0(FXNN": lost return message");
-                            status = RcmClient_E_LOSTMSG;
-                            goto leave;
-                        }
-                        Log_print0(Diags_INFO, FXNN": return message received");
-
-                        if (msgqMsg == NULL) {
-                            Log_error0(FXNN": reply message has been lost");
-                            status = RcmClient_E_LOSTMSG;
-                            goto leave;
-                        }
-
-                        /* acquire the mailbox lock */
-                        Semaphore_pend(obj->mbxLock, Semaphore_FOREVER, &eb);
-                        if (Error_check(&eb)) {
-                            goto leave;  /* TODO */
-                        }
-                    }
-                }
+            if (Error_check(&eb)) {
+                status = RcmClient_E_FAIL;
+                break;
             }
-            else {
-                /* construct recipient on local stack */
-                Recipient self;
-                self.msgId = msgId;
-                self.msg = NULL;
-                SemThread_construct(&self.event, 0, NULL, &eb);
-                if (Error_check(&eb)) {
-                    /* TODO */
-                }
-
-                /* add recipient to wait list */
-                elem = &self.elem;
-                List_put(obj->recipients, elem);
-
-                /* release the mailbox lock */
-                Semaphore_post(obj->mbxLock, &eb);
-                if (Error_check(&eb)) {
-                    /* TODO */
-                }
-
-                /* wait on event */
-                SemThread_pend(SemThread_handle(&self.event),
-                    Semaphore_FOREVER, &eb);
-                if (Error_check(&eb)) {
-                    /* TODO */
-                }
-
-                /* acquire the mailbox lock */
-                Semaphore_pend(obj->mbxLock, Semaphore_FOREVER, &eb);
-                if (Error_check(&eb)) {
-                    goto leave;  /* TODO */
-                }
-
-                if (NULL != self.msg) {
-                    /* pickup message */
-                    *returnMsg = self.msg;
-                    messageFound = TRUE;
-                }
-
-                /* remove recipient from wait list */
-                List_remove(obj->recipients, elem);
-                SemThread_destruct(&self.event);
-
-                /* release the mailbox lock */
-                Semaphore_post(obj->mbxLock, &eb);
-                if (Error_check(&eb)) {
-                    /* TODO */
-                }
+
+            if (NULL != self.msg) {
+                /* pickup message */
+                packet = RcmClient_getPacketAddr_P(self.msg);
             }
         }
-    } /* while (!messageFound) */
+    }
+
+    /* if the mailman role is free, pass it on to a waiting recipient */
+    if (!obj->mailman && (obj->waitMask != 0)) {
+        RcmClient_handOff_P(obj);
+    }
+
+    GateThread_leave(gateH, key);
+    SemThread_destruct(&self.event);
+
+    if (NULL != packet) {
+        *returnMsg = &packet->message;
+    }
 
 leave:
     Log_print2(Diags_EXIT, "<-- %s: %d", (IArg)FXNN, (IArg)status);
@@ -427,6 +427,23 @@ extern "C" {
  */
 #define RcmClient_DISCRETEJOBID (0)
 
+/*!
+ *  @brief Normal message priority
+ *
+ *  When a new message is allocated, its priority is initialized to
+ *  this value.
+ *
+ *  @sa RcmClient_setPriority
+ */
+#define RcmClient_PRIORITY_NORMAL (0)
+
+/*!
+ *  @brief Highest message priority
+ *
+ *  @sa RcmClient_setPriority
+ */
+#define RcmClient_PRIORITY_HIGHEST (3)
+
 /*!
  *  @brief RcmClient instance object handle
  */
@@ -542,9 +559,12 @@ typedef struct {
     Bool                _f7;
     UInt16              _f8;
     Ptr                 _f9;
-    Ptr                 _f10;
-    Ptr                 _f11;
+    Bool                _f10;
+    UInt32              _f11;
     Ptr                 _f12;
+    Ptr                 _f13;
+    Bool                _f14;
+    Ptr                 _f15;
 } RcmClient_Struct;
 
 
@@ -826,7 +846,8 @@ Int RcmClient_exec(
  *  When the remote function completes, the given callback function is
  *  invoked by this RcmClient instance's callback server thread. The
  *  callback function is used to asynchronously notify the client that
- *  the remote function has completed.
+ *  the remote function has completed. The callback receives ownership
+ *  of the return message and must release it with RcmClient_free().
  *
  *  The RcmClient instance must be create with callbackNotification
  *  set to true in order to use this function.
@@ -1038,6 +1059,27 @@ Int RcmClient_removeSymbol(
         String                  name
     );
 
+/*
+ *  ======== RcmClient_setPriority ========
+ */
+/*!
+ *  @brief Set the dispatch priority of a message
+ *
+ *  Messages processed by a worker pool are taken from the pool's ready
+ *  queue in priority order, highest priority first. Messages of equal
+ *  priority are processed in the order received. Messages in a job
+ *  stream are always processed in order, regardless of priority.
+ *
+ *  @param[in] msg Pointer to an RcmClient_Message structure.
+ *
+ *  @param[in] priority The message priority, from RcmClient_PRIORITY_NORMAL
+ *  to RcmClient_PRIORITY_HIGHEST.
+ */
+Void RcmClient_setPriority(
+        RcmClient_Message *     msg,
+        UInt16                  priority
+    );
+
 /*
  *  ======== RcmClient_waitUntilDone ========
  */
@@ -41,11 +41,14 @@
 
 #define xdc_runtime_Memory__nolocalnames  /* short name clashes with SysLink */
 
+#include <string.h>
+
 /* rtsc header files */
 #include <xdc/std.h>
 #include <xdc/runtime/Assert.h>
 #include <xdc/runtime/Diags.h>
 #include <xdc/runtime/Error.h>
+#include <xdc/runtime/Gate.h>
 #include <xdc/runtime/IHeap.h>
 #include <xdc/runtime/Log.h>
 #include <xdc/runtime/Memory.h>
@@ -57,6 +60,9 @@
 #include <xdc/runtime/knl/SemThread.h>
 #include <xdc/runtime/knl/Thread.h>
 #include <xdc/runtime/System.h>
+#include <xdc/runtime/Timestamp.h>
+
+#include <ti/trace/SysMin.h>
 
 #define MSGBUFFERSIZE    512   // Make global and move to MessageQCopy.h
 
@@ -80,6 +86,8 @@
 
 #if USE_MESSAGEQCOPY
 #include <ti/srvmgr/rpmsg_omx.h>
+#include <ti/resources/IpcMemory.h>
+#include <ti/sysbios/hal/Cache.h>
 #endif
 
 #define _RCM_KeyResetValue 0x07FF       // key reset value
@@ -88,10 +96,24 @@
 
 #define RcmServer_MAX_TABLES 9          // max number of function tables
 #define RcmServer_POOL_MAP_LEN 4        // pool map length
+#define RcmServer_NUM_PRIORITIES 4      // ready queue priority levels
 
 #define RcmServer_E_InvalidFxnIdx       (-101)
 #define RcmServer_E_JobIdNotFound       (-102)
 #define RcmServer_E_PoolIdNotFound      (-103)
+#define RcmServer_E_InvalidMultiMsg     (-104)
+#define RcmServer_E_InvalidBulk         (-105)
+#define RcmServer_E_InvalidCall         (-106)
+
+#define RcmServer_S_JobInBand           (1)     // caller runs job message
+
+typedef struct {                        // per-function profile
+    UInt32                      calls;      // number of calls
+    UInt32                      minTicks;   // shortest execution time
+    UInt32                      maxTicks;   // longest execution time
+    UInt64                      execTicks;  // total execution time
+    UInt64                      waitTicks;  // total receive to exec time
+} RcmServer_FxnStats;
 
 typedef struct {                        // function table element
     String                      name;
@@ -104,6 +126,7 @@ typedef struct {                        // function table element
     RcmServer_MsgFxn            addr;
 #endif
     UInt16                      key;
+    RcmServer_FxnStats          stats;
 } RcmServer_FxnTabElem;
 
 typedef struct {
@@ -112,6 +135,11 @@ typedef struct {
 } RcmServer_FxnTabElemAry;
 
 typedef struct {
+    List_Elem                   elem;
+    struct RcmServer_ThreadPool_tag *pool;  // pool owning this link
+} RcmServer_PoolLink;
+
+typedef struct RcmServer_ThreadPool_tag {
     String                      name;       // pool name
     Int                         count;      // thread count (at create time)
     Thread_Priority             priority;   // thread priority
@@ -120,9 +148,25 @@ typedef struct {
     String                      stackSeg;   // thread stack placement
     ISemaphore_Handle           sem;        // message semaphore (counting)
     List_Struct                 threadList; // list of worker threads
-    List_Struct                 readyQueue; // queue of messages
+    List_Struct                 readyQueue[RcmServer_NUM_PRIORITIES];
+                                            // message queues, by priority
+    struct RcmServer_SharedPool_tag *shared;// shared pool, if attached
+    RcmServer_PoolLink          link;       // shared pool member link
+    struct RcmServer_Object_tag *server;    // owning server instance
+    UInt                        busy;       // messages held by shared workers
+    ISemaphore_Handle           idle;       // posted when busy drops to zero
+    UInt                        queued;     // messages on the ready queues
+                                            // (updated in the system gate)
 } RcmServer_ThreadPool;
 
+typedef struct RcmServer_SharedPool_tag {
+    List_Elem                   elem;
+    RcmServer_ThreadPool        pool;       // threads and semaphore
+    GateThread_Struct           gate;       // protects members and busy
+    List_Struct                 members;    // attached pools, service order
+    UInt                        refCount;   // number of attached pools
+} RcmServer_SharedPool;
+
 typedef struct RcmServer_Object_tag {
     GateThread_Struct           gate;       // instance gate
     Ptr                         run;        // run semaphore for the server
@@ -134,7 +178,7 @@ typedef struct RcmServer_Object_tag {
 #else
     MessageQ_Handle             serverQue;  // inbound message queue
 #endif
-    Thread_Handle               serverThread; // server thread object
+    Thread_Handle               serverThread[RcmServer_MAX_READERS];
     RcmServer_FxnTabElemAry     fxnTabStatic; // static function table
     RcmServer_FxnTabElem *      fxnTab[RcmServer_MAX_TABLES]; // base pointers
     UInt16                      key;        // function index key
@@ -143,6 +187,11 @@ typedef struct RcmServer_Object_tag {
     Int                         poolMap0Len;// length of static table
     RcmServer_ThreadPool *      poolMap[RcmServer_POOL_MAP_LEN];
     List_Handle                 jobList;    // list of job stream queues
+    RcmServer_CacheFxn          cacheInvFxn; // bulk buffer invalidate
+    RcmServer_CacheFxn          cacheWbFxn; // bulk buffer write-back
+    GateThread_Struct           recvGate;   // one server thread receives
+    UInt                        readers;    // number of server threads
+    Bool                        profile;    // keep the function profile
 } RcmServer_Object;
 
 typedef struct {
@@ -152,6 +201,7 @@ typedef struct {
     Bool                        terminate;  // thread terminate flag
     RcmServer_ThreadPool*       pool;       // worker pool
     RcmServer_Object *          server;     // server instance
+    RcmServer_SharedPool *      shared;     // shared pool, or NULL
 } RcmServer_WorkerThread;
 
 typedef struct {
@@ -166,6 +216,9 @@ typedef struct RcmServer_Module_tag {
     IHeap_Handle        heap;
 } RcmServer_Module;
 
+/* message handler, returns TRUE if the packet is to be sent as the reply */
+typedef Bool (*RcmServer_MsgHandler)(RcmServer_Object *, RcmClient_Packet *);
+
 
 /* private functions */
 static
@@ -195,15 +248,74 @@ Int RcmServer_dispatch_P(
 static
 Int RcmServer_execMsg_I(
         RcmServer_Object *              obj,
-        RcmClient_Message *             msg
+        RcmClient_Message *             msg,
+        UInt32                          stamp
+    );
+
+static
+Int RcmServer_execMulti_P(
+        RcmServer_Object *              obj,
+        RcmClient_Message *             msg,
+        UInt32                          stamp
+    );
+
+static
+Int RcmServer_execBulk_P(
+        RcmServer_Object *              obj,
+        RcmClient_Message *             msg,
+        UInt32                          stamp
+    );
+
+#if USE_MESSAGEQCOPY
+static
+Void RcmServer_msgCall_P(
+        RcmServer_Object *              obj,
+        RcmClient_Packet *              packet,
+        UInt16                          len
+    );
+#endif
+
+static
+Int RcmServer_mapBulk_P(
+        RcmClient_BulkDesc *            bulk,
+        Ptr *                           bufPtr
+    );
+
+#if USE_MESSAGEQCOPY
+static
+Bool RcmServer_isShared_I(
+        UInt32                          da,
+        UInt32                          size
     );
+#endif
+
+#if USE_MESSAGEQCOPY
+static
+Void RcmServer_cacheInv_P(
+        Ptr                             addr,
+        SizeT                           size
+    );
+
+static
+Void RcmServer_cacheWb_P(
+        Ptr                             addr,
+        SizeT                           size
+    );
+#endif
 
 static
 Int RcmServer_getFxnAddr_P(
         RcmServer_Object *              obj,
         UInt32                          fxnIdx,
         RcmServer_MsgFxn *              addrPtr,
-        RcmServer_MsgCreateFxn *        createPtr
+        RcmServer_MsgCreateFxn *        createPtr,
+        RcmServer_FxnTabElem **         slotPtr
+    );
+
+static
+Int RcmServer_getStats_P(
+        RcmServer_Object *              obj,
+        RcmClient_Message *             msg
     );
 
 static
@@ -225,12 +337,154 @@ Int RcmServer_getPool_P(
         RcmServer_ThreadPool **         poolP
     );
 
+static
+Bool RcmServer_attachPool_P(
+        RcmServer_Object *              obj,
+        RcmServer_ThreadPool *          pool
+    );
+
+static
+Void RcmServer_detachPool_P(
+        RcmServer_ThreadPool *          pool
+    );
+
+static
+RcmServer_SharedPool *RcmServer_findSharedPool_P(
+        String                          name
+    );
+
+static
+RcmClient_Packet *RcmServer_getShared_P(
+        RcmServer_SharedPool *          shared,
+        RcmServer_ThreadPool **         poolPtr
+    );
+
+static inline
+Void RcmServer_releaseShared_I(
+        RcmServer_ThreadPool *          pool
+    );
+
+static
+RcmClient_Packet *RcmServer_getReady_P(
+        RcmServer_ThreadPool *          pool
+    );
+
+static inline
+Void RcmServer_countReady_I(
+        RcmServer_ThreadPool *          pool,
+        Int                             delta
+    );
+
+static inline
+Void RcmServer_putReady_I(
+        RcmServer_ThreadPool *          pool,
+        RcmClient_Packet *              packet
+    );
+
+#if USE_MESSAGEQCOPY
+static
+RcmClient_Packet *RcmServer_copyPacket_P(
+        RcmClient_Packet *              packet,
+        UInt16                          len
+    );
+
+static inline
+Void RcmServer_freePacket_I(
+        RcmClient_Packet *              packet
+    );
+#endif
+
 static
 Void RcmServer_process_P(
         RcmServer_Object *              obj,
         RcmClient_Packet *              packet
     );
 
+static
+Int RcmServer_reply_P(
+        RcmServer_Object *              obj,
+        RcmClient_Packet *              packet
+    );
+
+static
+Int RcmServer_returnMsg_P(
+        RcmServer_Object *              obj,
+        RcmClient_Packet *              packet,
+        UInt16                          code,
+        Int32                           result
+    );
+
+static inline
+UInt16 RcmServer_errToStatus_I(
+        Int                             rval
+    );
+
+static
+Bool RcmServer_msgExec_P(
+        RcmServer_Object *              obj,
+        RcmClient_Packet *              packet
+    );
+
+static
+Bool RcmServer_msgMulti_P(
+        RcmServer_Object *              obj,
+        RcmClient_Packet *              packet
+    );
+
+static
+Bool RcmServer_msgBulk_P(
+        RcmServer_Object *              obj,
+        RcmClient_Packet *              packet
+    );
+
+static
+Bool RcmServer_msgCmd_P(
+        RcmServer_Object *              obj,
+        RcmClient_Packet *              packet
+    );
+
+static
+Bool RcmServer_msgDpc_P(
+        RcmServer_Object *              obj,
+        RcmClient_Packet *              packet
+    );
+
+static
+Bool RcmServer_msgSymIdx_P(
+        RcmServer_Object *              obj,
+        RcmClient_Packet *              packet
+    );
+
+static
+Bool RcmServer_msgJobAcq_P(
+        RcmServer_Object *              obj,
+        RcmClient_Packet *              packet
+    );
+
+static
+Bool RcmServer_msgJobRel_P(
+        RcmServer_Object *              obj,
+        RcmClient_Packet *              packet
+    );
+
+static inline
+Bool RcmServer_inBand_I(
+        RcmServer_Object *              obj,
+        RcmClient_Packet *              packet
+    );
+
+static
+RcmClient_Packet *RcmServer_nextJobMsg_P(
+        RcmServer_Object *              obj,
+        UInt16                          jobId
+    );
+
+static
+Void RcmServer_runJob_P(
+        RcmServer_Object *              obj,
+        RcmClient_Packet *              packet
+    );
+
 static
 Int RcmServer_relJobId_P(
         RcmServer_Object *              obj,
@@ -242,6 +496,15 @@ Void RcmServer_serverThrFxn_P(
         IArg                            arg
     );
 
+static inline
+Void RcmServer_profile_I(
+        RcmServer_Object *              obj,
+        RcmServer_FxnTabElem *          slot,
+        UInt32                          stamp,
+        UInt32                          start,
+        UInt32                          end
+    );
+
 static inline
 Void RcmServer_setStatusCode_I(
         RcmClient_Packet *              packet,
@@ -269,6 +532,51 @@ static RcmServer_Module RcmServer_Mod = {
     (IHeap_Handle)NULL  /* heap */
 };
 
+/* message handlers, indexed by message type */
+static RcmServer_MsgHandler RcmServer_msgHandlers[] = {
+    NULL,                       /* 0x0 */
+    RcmServer_msgExec_P,        /* RcmClient_Desc_RCM_MSG */
+    RcmServer_msgDpc_P,         /* RcmClient_Desc_DPC */
+    NULL,                       /* RcmClient_Desc_SYM_ADD */
+    RcmServer_msgSymIdx_P,      /* RcmClient_Desc_SYM_IDX */
+    RcmServer_msgCmd_P,         /* RcmClient_Desc_CMD */
+    RcmServer_msgJobAcq_P,      /* RcmClient_Desc_JOB_ACQ */
+    RcmServer_msgJobRel_P,      /* RcmClient_Desc_JOB_REL */
+    RcmServer_msgMulti_P,       /* RcmClient_Desc_MULTI */
+    RcmServer_msgBulk_P,        /* RcmClient_Desc_BULK */
+    NULL, NULL, NULL, NULL, NULL, NULL
+};
+
+#if USE_MESSAGEQCOPY
+typedef struct {                        // shared buffer region
+    UInt32                      base;       // device address
+    UInt32                      len;        // length, 0 when not in table
+} RcmServer_Region;
+
+/* resource table entries which may hold buffers passed by the host; the
+ * code and data carveouts and the peripheral windows are left out */
+static String RcmServer_sharedNames[] = {
+    "IPU_MEM_IOBUFS",
+    "IPU_TILER_MODE_0_1",
+    "IPU_TILER_MODE_2",
+    "IPU_TILER_MODE_3",
+    "DSP_MEM_IOBUFS",
+    "DSP_TILER_MODE_0_1",
+    "DSP_TILER_MODE_2",
+    "DSP_TILER_MODE_3"
+};
+
+#define RcmServer_NUM_REGIONS \
+    (sizeof(RcmServer_sharedNames) / sizeof(RcmServer_sharedNames[0]))
+
+/* base and length of the above, looked up once by RcmServer_init */
+static RcmServer_Region RcmServer_sharedRegions[RcmServer_NUM_REGIONS];
+#endif
+
+/* shared worker pools, protected by the shared pool gate */
+static List_Struct RcmServer_sharedPools;
+static GateThread_Struct RcmServer_sharedGate;
+
 /* module diags mask */
 Registry_Desc Registry_CURDESC;
 
@@ -281,6 +589,10 @@ Registry_Desc Registry_CURDESC;
 Void RcmServer_init(Void)
 {
     Registry_Result result;
+    Error_Block eb;
+#if USE_MESSAGEQCOPY
+    UInt i;
+#endif
 
 
     if (curInit++ != 0) {
@@ -294,6 +606,21 @@ Void RcmServer_init(Void)
 
     /* the size of object and struct must be the same */
     Assert_isTrue(sizeof(RcmServer_Object) == sizeof(RcmServer_Struct), NULL);
+
+    /* shared worker pool registry */
+    Error_init(&eb);
+    List_construct(&RcmServer_sharedPools, NULL);
+    GateThread_construct(&RcmServer_sharedGate, NULL, &eb);
+    Assert_isTrue(!Error_check(&eb), NULL);
+
+#if USE_MESSAGEQCOPY
+    /* regions missing from this core's table keep a zero length */
+    for (i = 0; i < RcmServer_NUM_REGIONS; i++) {
+        IpcMemory_getRegion(RcmServer_sharedNames[i],
+            &RcmServer_sharedRegions[i].base,
+            &RcmServer_sharedRegions[i].len);
+    }
+#endif
 }
 
 
@@ -311,6 +638,10 @@ Void RcmServer_exit(Void)
         return; /* module still in use */
     }
 
+    /* shared worker pools must have been deleted by now */
+    GateThread_destruct(&RcmServer_sharedGate);
+    List_destruct(&RcmServer_sharedPools);
+
     /* unregister from xdc.runtime */
 //  result = Registry_removeModule(MODULE_NAME);
 //  Assert_isTrue(result == Registry_SUCCESS, (Assert_Id)NULL);
@@ -327,6 +658,7 @@ Void RcmServer_Params_init(RcmServer_Params *params)
     params->osPriority = Thread_INVALID_OS_PRIORITY;
     params->stackSize = 0;  // use system default
     params->stackSeg = "";
+    params->readers = 1;
 
     /* default pool */
     params->defaultPool.name = NULL;
@@ -343,6 +675,18 @@ Void RcmServer_Params_init(RcmServer_Params *params)
     /* function table */
     params->fxns.length = 0;
     params->fxns.elem = NULL;
+
+    /* bulk buffer cache maintenance */
+#if USE_MESSAGEQCOPY
+    params->cacheInvFxn = RcmServer_cacheInv_P;
+    params->cacheWbFxn = RcmServer_cacheWb_P;
+#else
+    params->cacheInvFxn = NULL;
+    params->cacheWbFxn = NULL;
+#endif
+
+    /* function profile */
+    params->profile = FALSE;
 }
 
 
@@ -464,7 +808,7 @@ Int RcmServer_Instance_init_P(RcmServer_Object *obj, String name,
     Thread_Params threadP;
     SemThread_Params semThreadP;
     SemThread_Handle semThreadH;
-    Int i, j;
+    Int i, j, p;
     SizeT size;
     Char *cp;
     RcmServer_ThreadPool *poolAry;
@@ -483,12 +827,18 @@ Int RcmServer_Instance_init_P(RcmServer_Object *obj, String name,
     obj->jobId = 0xFFFF;
     obj->run = NULL;
     obj->serverQue = NULL;
-    obj->serverThread = NULL;
     obj->fxnTabStatic.length = 0;
     obj->fxnTabStatic.elem = NULL;
     obj->poolMap0Len = 0;
     obj->jobList = NULL;
+    obj->cacheInvFxn = params->cacheInvFxn;
+    obj->cacheWbFxn = params->cacheWbFxn;
+    obj->readers = params->readers;
+    obj->profile = params->profile;
 
+    for (i = 0; i < RcmServer_MAX_READERS; i++) {
+        obj->serverThread[i] = NULL;
+    }
 
     /* initialize the function table */
     for (i = 0; i < RcmServer_MAX_TABLES; i++) {
@@ -509,6 +859,22 @@ Int RcmServer_Instance_init_P(RcmServer_Object *obj, String name,
         goto leave;
     }
 
+    /* create the gate which the server threads take turns receiving on */
+    GateThread_construct(&obj->recvGate, NULL, &eb);
+
+    if (Error_check(&eb)) {
+        Log_error0(FXNN": could not create gate object");
+        status = RcmServer_E_FAIL;
+        goto leave;
+    }
+
+    if ((obj->readers < 1) || (obj->readers > RcmServer_MAX_READERS)) {
+        Log_error1(FXNN": invalid number of server threads, %d",
+            (IArg)obj->readers);
+        status = RcmServer_E_FAIL;
+        goto leave;
+    }
+
     /* create list for job objects */
 #if defined(RCM_ti_ipc)
     List_Params_init(&listP);
@@ -568,6 +934,8 @@ Int RcmServer_Instance_init_P(RcmServer_Object *obj, String name,
             cp += (_strlen(params->fxns.elem[i].name) + 1);
             obj->fxnTabStatic.elem[i].addr.fxn = params->fxns.elem[i].addr.fxn;
             obj->fxnTabStatic.elem[i].key = 0;
+            _memset(&obj->fxnTabStatic.elem[i].stats, 0,
+                sizeof(RcmServer_FxnStats));
         }
 
         /* hook up the static function table */
@@ -641,22 +1009,32 @@ Int RcmServer_Instance_init_P(RcmServer_Object *obj, String name,
     poolAry[0].stackSize = params->defaultPool.stackSize;
     poolAry[0].stackSeg = NULL;
     poolAry[0].sem = NULL;
+    poolAry[0].shared = NULL;
+    poolAry[0].server = obj;
+    poolAry[0].busy = 0;
+    poolAry[0].idle = NULL;
+    poolAry[0].queued = 0;
 
     List_construct(&(poolAry[0].threadList), NULL);
-    List_construct(&(poolAry[0].readyQueue), NULL);
+    for (p = 0; p < RcmServer_NUM_PRIORITIES; p++) {
+        List_construct(&(poolAry[0].readyQueue[p]), NULL);
+    }
 
-    SemThread_Params_init(&semThreadP);
-    semThreadP.mode = SemThread_Mode_COUNTING;
+    /* a shared pool provides the threads and semaphore */
+    if (!RcmServer_attachPool_P(obj, &poolAry[0])) {
+        SemThread_Params_init(&semThreadP);
+        semThreadP.mode = SemThread_Mode_COUNTING;
 
-    semThreadH = SemThread_create(0, &semThreadP, &eb);
+        semThreadH = SemThread_create(0, &semThreadP, &eb);
 
-    if (Error_check(&eb)) {
-        Log_error0(FXNN": could not create semaphore");
-        status = RcmServer_E_FAIL;
-        goto leave;
-    }
+        if (Error_check(&eb)) {
+            Log_error0(FXNN": could not create semaphore");
+            status = RcmServer_E_FAIL;
+            goto leave;
+        }
 
-    poolAry[0].sem = SemThread_Handle_upCast(semThreadH);
+        poolAry[0].sem = SemThread_Handle_upCast(semThreadH);
+    }
 
     /* initialize the static worker pools, poolAry[1..(n-1)] */
     for (i = 0; i < params->workerPools.length; i++) {
@@ -674,9 +1052,22 @@ Int RcmServer_Instance_init_P(RcmServer_Object *obj, String name,
         poolAry[i+1].osPriority =params->workerPools.elem[i].osPriority;
         poolAry[i+1].stackSize = params->workerPools.elem[i].stackSize;
         poolAry[i+1].stackSeg = NULL;
+        poolAry[i+1].sem = NULL;
+        poolAry[i+1].shared = NULL;
+        poolAry[i+1].server = obj;
+        poolAry[i+1].busy = 0;
+        poolAry[i+1].idle = NULL;
+        poolAry[i+1].queued = 0;
 
         List_construct(&(poolAry[i+1].threadList), NULL);
-        List_construct(&(poolAry[i+1].readyQueue), NULL);
+        for (p = 0; p < RcmServer_NUM_PRIORITIES; p++) {
+            List_construct(&(poolAry[i+1].readyQueue[p]), NULL);
+        }
+
+        /* a shared pool provides the threads and semaphore */
+        if (RcmServer_attachPool_P(obj, &poolAry[i+1])) {
+            continue;
+        }
 
         SemThread_Params_init(&semThreadP);
         semThreadP.mode = SemThread_Mode_COUNTING;
@@ -714,6 +1105,7 @@ Int RcmServer_Instance_init_P(RcmServer_Object *obj, String name,
             worker->terminate = FALSE;
             worker->pool = &(poolAry[i]);
             worker->server = obj;
+            worker->shared = NULL;
 
             /* add worker thread to worker pool */
             listH = List_handle(&(poolAry[i].threadList));
@@ -772,7 +1164,7 @@ Int RcmServer_Instance_init_P(RcmServer_Object *obj, String name,
         goto leave;
     }
 
-    /* create the server thread */
+    /* create the server threads */
     Thread_Params_init(&threadP);
     threadP.arg = (IArg)obj;
     threadP.priority = params->priority;
@@ -780,13 +1172,15 @@ Int RcmServer_Instance_init_P(RcmServer_Object *obj, String name,
     threadP.stackSize = params->stackSize;
     threadP.instance->name = "RcmServer_serverThr";
 
-    obj->serverThread = Thread_create(
-        (Thread_RunFxn)(RcmServer_serverThrFxn_P), &threadP, &eb);
+    for (i = 0; i < obj->readers; i++) {
+        obj->serverThread[i] = Thread_create(
+            (Thread_RunFxn)(RcmServer_serverThrFxn_P), &threadP, &eb);
 
-    if (Error_check(&eb)) {
-        Log_error0(FXNN": could not create server thread");
-        status = RcmServer_E_FAIL;
-        goto leave;
+        if (Error_check(&eb)) {
+            Log_error1(FXNN": could not create server thread %d", (IArg)i);
+            status = RcmServer_E_FAIL;
+            goto leave;
+        }
     }
 
 
@@ -853,7 +1247,7 @@ Int RcmServer_destruct(RcmServer_Struct *structPtr)
 #define FXNN "RcmServer_Instance_finalize_P"
 Int RcmServer_Instance_finalize_P(RcmServer_Object *obj)
 {
-    Int i, j;
+    Int i, j, p;
     Int size;
     Char *cp;
     UInt tabCount;
@@ -865,12 +1259,8 @@ Int RcmServer_Instance_finalize_P(RcmServer_Object *obj)
     List_Handle listH;
     List_Handle msgQueH;
     RcmClient_Packet *packet;
-#if USE_MESSAGEQCOPY == 0
-    MessageQ_Msg msgqMsg;
-#endif
     SemThread_Handle semThreadH;
     RcmServer_JobStream *job;
-    Int rval;
     Int status = RcmClient_S_SUCCESS;
 
     Log_print1(Diags_ENTRY, "--> "FXNN": (obj=0x%x)", (IArg)obj);
@@ -878,16 +1268,24 @@ Int RcmServer_Instance_finalize_P(RcmServer_Object *obj)
     /* must initialize the error block before using it */
     Error_init(&eb);
 
-    /* block until server thread exits */
+    /* block until the server threads exit; the one in receive is
+     * unblocked, the others see the shutdown flag before receiving */
     obj->shutdown = TRUE;
 
-    if (obj->serverThread != NULL) {
+    if (obj->serverThread[0] != NULL) {
 #if USE_MESSAGEQCOPY
         MessageQCopy_unblock(obj->serverQue);
 #else
         MessageQ_unblock(obj->serverQue);
 #endif
-        Thread_join(obj->serverThread, &eb);
+    }
+
+    for (i = 0; i < RcmServer_MAX_READERS; i++) {
+        if (obj->serverThread[i] == NULL) {
+            continue;
+        }
+
+        Thread_join(obj->serverThread[i], &eb);
 
         if (Error_check(&eb)) {
             Log_error0(FXNN": server thread did not exit properly");
@@ -896,42 +1294,47 @@ Int RcmServer_Instance_finalize_P(RcmServer_Object *obj)
         }
     }
 
-    /* delete any remaining job objects (there should not be any) */
-    while ((elem = List_get(obj->jobList)) != NULL) {
-        job = (RcmServer_JobStream *)elem;
+    /* stop shared workers from taking more messages for this instance,
+     * and wait for those already taken, before tearing anything down */
+    poolAry = obj->poolMap[0];
+
+    for (i = 0; i < obj->poolMap0Len; i++) {
+        if (poolAry[i].shared != NULL) {
+            RcmServer_detachPool_P(&poolAry[i]);
+        }
+    }
 
-        /* return any remaining messages (there should not be any) */
-        msgQueH = List_handle(&job->msgQue);
+    /* delete any remaining job objects (there should not be any), the
+     * list is not there if create failed before making it */
+    if (obj->jobList != NULL) {
+        while ((elem = List_get(obj->jobList)) != NULL) {
+            job = (RcmServer_JobStream *)elem;
 
-        while ((elem = List_get(msgQueH)) != NULL) {
-            packet = (RcmClient_Packet *)elem;
-            Log_warning2(
-                FXNN": returning unprocessed message, jobId=0x%x, packet=0x%x",
-                (IArg)job->jobId, (IArg)packet);
+            /* return any remaining messages (there should not be any) */
+            msgQueH = List_handle(&job->msgQue);
 
-            RcmServer_setStatusCode_I(packet, RcmServer_Status_Unprocessed);
+            while ((elem = List_get(msgQueH)) != NULL) {
+                packet = (RcmClient_Packet *)elem;
+                Log_warning2(FXNN": returning unprocessed message, "
+                    "jobId=0x%x, packet=0x%x", (IArg)job->jobId,
+                    (IArg)packet);
+
+                RcmServer_setStatusCode_I(packet,
+                    RcmServer_Status_Unprocessed);
+                RcmServer_reply_P(obj, packet);
 #if USE_MESSAGEQCOPY
-            packet->hdr.type = OMX_RAW_MSG;
-            packet->hdr.len = PACKET_DATA_SIZE + packet->message.dataSize;
-            rval = MessageQCopy_send(obj->dstProc, obj->replyAddr,
-                                 obj->localAddr, (Ptr)&packet->hdr,
-                                 PACKET_HDR_SIZE + packet->message.dataSize);
-#else
-            msgqMsg = &packet->msgqHeader;
-            rval = MessageQ_put(MessageQ_getReplyQueue(msgqMsg), msgqMsg);
+                RcmServer_freePacket_I(packet);
 #endif
-            if (rval < 0) {
-                Log_error1(FXNN": unknown ipc error, 0x%x", (IArg)rval);
             }
-        }
 
-        /* finalize the job stream object */
-        List_destruct(&job->msgQue);
+            /* finalize the job stream object */
+            List_destruct(&job->msgQue);
 
-        xdc_runtime_Memory_free(RcmServer_Module_heap(),
-            (Ptr)job, sizeof(RcmServer_JobStream));
+            xdc_runtime_Memory_free(RcmServer_Module_heap(),
+                (Ptr)job, sizeof(RcmServer_JobStream));
+        }
+        List_delete(&(obj->jobList));
     }
-    List_delete(&(obj->jobList));
 
     /* convenience alias */
     poolAry = obj->poolMap[0];
@@ -983,37 +1386,29 @@ Int RcmServer_Instance_finalize_P(RcmServer_Object *obj)
                 sizeof(RcmServer_WorkerThread));
         }
 
-        /* free up pool resources */
-        semThreadH = SemThread_Handle_downCast(poolAry[i].sem);
-        SemThread_delete(&semThreadH);
+        /* free up pool resources, the shared pool owns its semaphore */
+        if (poolAry[i].shared == NULL) {
+            semThreadH = SemThread_Handle_downCast(poolAry[i].sem);
+            SemThread_delete(&semThreadH);
+        }
         List_destruct(&(poolAry[i].threadList));
 
         /* return any remaining messages on the readyQueue */
-        msgQueH = List_handle(&poolAry[i].readyQueue);
-
-        while ((elem = List_get(msgQueH)) != NULL) {
-            packet = (RcmClient_Packet *)elem;
+        while ((packet = RcmServer_getReady_P(&poolAry[i])) != NULL) {
             Log_warning2(
                 FXNN": returning unprocessed message, msgId=0x%x, packet=0x%x",
                 (IArg)packet->msgId, (IArg)packet);
 
             RcmServer_setStatusCode_I(packet, RcmServer_Status_Unprocessed);
+            RcmServer_reply_P(obj, packet);
 #if USE_MESSAGEQCOPY
-            packet->hdr.type = OMX_RAW_MSG;
-            packet->hdr.len = PACKET_DATA_SIZE + packet->message.dataSize;
-            rval = MessageQCopy_send(obj->dstProc, obj->replyAddr,
-                                 obj->localAddr, (Ptr)&packet->hdr,
-                                 PACKET_HDR_SIZE + packet->message.dataSize);
-#else
-            msgqMsg = &packet->msgqHeader;
-            rval = MessageQ_put(MessageQ_getReplyQueue(msgqMsg), msgqMsg);
+            RcmServer_freePacket_I(packet);
 #endif
-            if (rval < 0) {
-                Log_error1(FXNN": unknown ipc error, 0x%x", (IArg)rval);
-            }
         }
 
-        List_destruct(&(poolAry[i].readyQueue));
+        for (p = 0; p < RcmServer_NUM_PRIORITIES; p++) {
+            List_destruct(&(poolAry[i].readyQueue[p]));
+        }
     }
 
     /* free the name block for the static pools */
@@ -1057,8 +1452,10 @@ Int RcmServer_Instance_finalize_P(RcmServer_Object *obj)
         }
     }
 
-    if (NULL != obj->serverThread) {
-        Thread_delete(&obj->serverThread);
+    for (i = 0; i < RcmServer_MAX_READERS; i++) {
+        if (NULL != obj->serverThread[i]) {
+            Thread_delete(&obj->serverThread[i]);
+        }
     }
 
     if (NULL != obj->serverQue) {
@@ -1091,7 +1488,8 @@ Int RcmServer_Instance_finalize_P(RcmServer_Object *obj)
             obj->fxnTabStatic.length * sizeof(RcmServer_FxnTabElem));
     }
 
-    /* destruct the instance gate */
+    /* destruct the instance gates */
+    GateThread_destruct(&obj->recvGate);
     GateThread_destruct(&obj->gate);
 
 
@@ -1103,14 +1501,259 @@ leave:
 
 
 /*
- *  ======== RcmServer_addSymbol ========
+ *  ======== RcmServer_createSharedPool ========
  */
-#define FXNN "RcmServer_addSymbol"
-Int RcmServer_addSymbol(RcmServer_Object *obj, String funcName,
-        RcmServer_MsgFxn addr, UInt32 *index)
+#define FXNN "RcmServer_createSharedPool"
+Int RcmServer_createSharedPool(const RcmServer_ThreadPoolDesc *desc)
 {
-    GateThread_Handle gateH;
-    IArg key;
+    Error_Block eb;
+    Thread_Params threadP;
+    SemThread_Params semThreadP;
+    SemThread_Handle semThreadH;
+    RcmServer_SharedPool *shared = NULL;
+    RcmServer_WorkerThread *worker;
+    IArg key;
+    Int j;
+    SizeT size;
+    Int status = RcmServer_S_SUCCESS;
+
+
+    Log_print1(Diags_ENTRY, "--> "FXNN": (desc=0x%x)", (IArg)desc);
+
+    Error_init(&eb);
+
+    if ((desc->name == NULL) || (desc->name[0] == '\0')) {
+        Log_error0(FXNN": shared pool must have a name");
+        status = RcmServer_E_FAIL;
+        goto leave;
+    }
+
+    key = GateThread_enter(GateThread_handle(&RcmServer_sharedGate));
+
+    if (RcmServer_findSharedPool_P(desc->name) != NULL) {
+        GateThread_leave(GateThread_handle(&RcmServer_sharedGate), key);
+        Log_error0(FXNN": shared pool already exists");
+        status = RcmServer_E_FAIL;
+        goto leave;
+    }
+
+    /* allocate the pool object and its name in one block */
+    size = sizeof(RcmServer_SharedPool) + _strlen(desc->name) + 1;
+    shared = (RcmServer_SharedPool *)xdc_runtime_Memory_calloc(
+        RcmServer_Module_heap(), size, sizeof(Ptr), &eb);
+
+    if (Error_check(&eb)) {
+        GateThread_leave(GateThread_handle(&RcmServer_sharedGate), key);
+        Log_error2(FXNN": out of memory: heap=0x%x, size=%u",
+            (IArg)RcmServer_Module_heap(), size);
+        status = RcmServer_E_NOMEMORY;
+        goto leave;
+    }
+
+    shared->pool.name = (String)(shared + 1);
+    _strcpy(shared->pool.name, desc->name);
+    shared->pool.count = desc->count;
+    shared->pool.priority = desc->priority;
+    shared->pool.osPriority = desc->osPriority;
+    shared->pool.stackSize = desc->stackSize;
+    shared->pool.stackSeg = NULL;
+    shared->pool.shared = shared;
+    shared->pool.server = NULL;
+    shared->refCount = 0;
+
+    List_construct(&(shared->pool.threadList), NULL);
+    List_construct(&(shared->members), NULL);
+    GateThread_construct(&shared->gate, NULL, &eb);
+
+    if (Error_check(&eb)) {
+        GateThread_leave(GateThread_handle(&RcmServer_sharedGate), key);
+        Log_error0(FXNN": could not create gate object");
+        status = RcmServer_E_FAIL;
+        goto leave;
+    }
+
+    SemThread_Params_init(&semThreadP);
+    semThreadP.mode = SemThread_Mode_COUNTING;
+
+    semThreadH = SemThread_create(0, &semThreadP, &eb);
+
+    if (Error_check(&eb)) {
+        GateThread_leave(GateThread_handle(&RcmServer_sharedGate), key);
+        Log_error0(FXNN": could not create semaphore");
+        status = RcmServer_E_FAIL;
+        goto leave;
+    }
+
+    shared->pool.sem = SemThread_Handle_upCast(semThreadH);
+
+    /* publish the pool before its threads start */
+    List_put(List_handle(&RcmServer_sharedPools), &(shared->elem));
+
+    GateThread_leave(GateThread_handle(&RcmServer_sharedGate), key);
+
+    /* create the worker threads */
+    for (j = 0; j < shared->pool.count; j++) {
+
+        /* allocate worker thread object */
+        size = sizeof(RcmServer_WorkerThread);
+        worker = (RcmServer_WorkerThread *)xdc_runtime_Memory_alloc(
+            RcmServer_Module_heap(), size, sizeof(Ptr), &eb);
+
+        if (Error_check(&eb)) {
+            Log_error2(FXNN": out of memory: heap=0x%x, size=%u",
+                (IArg)RcmServer_Module_heap(), size);
+            status = RcmServer_E_NOMEMORY;
+            goto leave;
+        }
+
+        /* initialize worker thread object */
+        worker->jobId = RcmClient_DISCRETEJOBID;
+        worker->thread = NULL;
+        worker->terminate = FALSE;
+        worker->pool = &(shared->pool);
+        worker->server = NULL;
+        worker->shared = shared;
+
+        /* add worker thread to worker pool */
+        List_putHead(List_handle(&(shared->pool.threadList)),
+            &(worker->elem));
+
+        /* create worker thread */
+        Thread_Params_init(&threadP);
+        threadP.arg = (IArg)worker;
+        threadP.priority = shared->pool.priority;
+        threadP.osPriority = shared->pool.osPriority;
+        threadP.stackSize = shared->pool.stackSize;
+        threadP.instance->name = "RcmServer_sharedThr";
+
+        worker->thread = Thread_create(
+            (Thread_RunFxn)(RcmServer_workerThrFxn_P), &threadP, &eb);
+
+        if (Error_check(&eb)) {
+            Log_error1(FXNN": could not create worker thread, thread=%d",
+                (IArg)j);
+            status = RcmServer_E_FAIL;
+            goto leave;
+        }
+    }
+
+leave:
+    Log_print1(Diags_EXIT, "<-- "FXNN": %d", (IArg)status);
+    return(status);
+}
+#undef FXNN
+
+
+/*
+ *  ======== RcmServer_deleteSharedPool ========
+ */
+#define FXNN "RcmServer_deleteSharedPool"
+Int RcmServer_deleteSharedPool(String name)
+{
+    Error_Block eb;
+    SemThread_Handle semThreadH;
+    RcmServer_SharedPool *shared;
+    RcmServer_WorkerThread *worker;
+    List_Handle listH;
+    List_Elem *elem;
+    IArg key;
+    Int status = RcmServer_S_SUCCESS;
+
+
+    Log_print1(Diags_ENTRY, "--> "FXNN": (name=0x%x)", (IArg)name);
+
+    Error_init(&eb);
+
+    /* remove the pool from the registry, unless still in use */
+    key = GateThread_enter(GateThread_handle(&RcmServer_sharedGate));
+
+    shared = RcmServer_findSharedPool_P(name);
+
+    if (shared == NULL) {
+        status = RcmServer_E_FAIL;
+    }
+    else if (shared->refCount > 0) {
+        status = RcmServer_E_POOLBUSY;
+    }
+    else {
+        List_remove(List_handle(&RcmServer_sharedPools), &(shared->elem));
+    }
+
+    GateThread_leave(GateThread_handle(&RcmServer_sharedGate), key);
+
+    if (status < 0) {
+        Log_error1(FXNN": cannot delete shared pool, status=%d",
+            (IArg)status);
+        goto leave;
+    }
+
+    listH = List_handle(&(shared->pool.threadList));
+
+    /* mark each worker thread for termination */
+    elem = NULL;
+    while ((elem = List_next(listH, elem)) != NULL) {
+        worker = (RcmServer_WorkerThread *)elem;
+        worker->terminate = TRUE;
+    }
+
+    /* unblock each worker thread so it can terminate */
+    elem = NULL;
+    while ((elem = List_next(listH, elem)) != NULL) {
+        Semaphore_post(shared->pool.sem, &eb);
+
+        if (Error_check(&eb)) {
+            Log_error0(FXNN": post failed on thread");
+            status = RcmServer_E_FAIL;
+            goto leave;
+        }
+    }
+
+    /* wait for each worker thread to terminate */
+    while ((elem = List_get(listH)) != NULL) {
+        worker = (RcmServer_WorkerThread *)elem;
+
+        Thread_join(worker->thread, &eb);
+
+        if (Error_check(&eb)) {
+            Log_error1(
+                FXNN": worker thread did not exit properly, thread=0x%x",
+                (IArg)worker->thread);
+            status = RcmServer_E_FAIL;
+            goto leave;
+        }
+
+        Thread_delete(&worker->thread);
+
+        xdc_runtime_Memory_free(RcmServer_Module_heap(), (Ptr)worker,
+            sizeof(RcmServer_WorkerThread));
+    }
+
+    /* free up pool resources */
+    semThreadH = SemThread_Handle_downCast(shared->pool.sem);
+    SemThread_delete(&semThreadH);
+    List_destruct(&(shared->pool.threadList));
+    List_destruct(&(shared->members));
+    GateThread_destruct(&shared->gate);
+
+    xdc_runtime_Memory_free(RcmServer_Module_heap(), (Ptr)shared,
+        sizeof(RcmServer_SharedPool) + _strlen(shared->pool.name) + 1);
+
+leave:
+    Log_print1(Diags_EXIT, "<-- "FXNN": %d", (IArg)status);
+    return(status);
+}
+#undef FXNN
+
+
+/*
+ *  ======== RcmServer_addSymbol ========
+ */
+#define FXNN "RcmServer_addSymbol"
+Int RcmServer_addSymbol(RcmServer_Object *obj, String funcName,
+        RcmServer_MsgFxn addr, UInt32 *index)
+{
+    GateThread_Handle gateH;
+    IArg key;
     Int len;
     UInt i, j;
     UInt tabCount;
@@ -1189,6 +1832,7 @@ Int RcmServer_addSymbol(RcmServer_Object *obj, String funcName,
 
         _strcpy(slot->name, funcName);
         slot->key = RcmServer_getNextKey_P(obj);
+        _memset(&slot->stats, 0, sizeof(RcmServer_FxnStats));
         fxnIdx = (slot->key << _RCM_KeyShift) | (i << 12) | j;
     }
 
@@ -1278,6 +1922,7 @@ leave:
 Int RcmServer_start(RcmServer_Object *obj)
 {
     Error_Block eb;
+    UInt i;
     Int status = RcmServer_S_SUCCESS;
 
 
@@ -1285,12 +1930,15 @@ Int RcmServer_start(RcmServer_Object *obj)
 
     Error_init(&eb);
 
-    /* unblock the server thread */
-    Semaphore_post(obj->run, &eb);
+    /* unblock the server threads */
+    for (i = 0; i < obj->readers; i++) {
+        Semaphore_post(obj->run, &eb);
 
-    if (Error_check(&eb)) {
-        Log_error0(FXNN": semaphore post failed");
-        status = RcmServer_E_FAIL;
+        if (Error_check(&eb)) {
+            Log_error0(FXNN": semaphore post failed");
+            status = RcmServer_E_FAIL;
+            break;
+        }
     }
 
     Log_print1(Diags_EXIT, "<-- "FXNN": %d", (IArg)status);
@@ -1393,8 +2041,9 @@ leave:
  *
  *  Return Value
  *      < 0: error
- *        0: success, job stream queue
- *      > 0: success, ready queue
+ *        0: success, job stream queue or ready queue
+ *      RcmServer_S_JobInBand: in-band job stream message, now owned by
+ *          the caller, run it with RcmServer_runJob_P
  *
  *  Pool id description
  *
@@ -1427,6 +2076,7 @@ Int RcmServer_dispatch_P(RcmServer_Object *obj, RcmClient_Packet *packet)
 
     Log_print2(Diags_ENTRY,
         "--> "FXNN": (obj=0x%x, packet=0x%x)", (IArg)obj, (IArg)packet);
+    SysMin_eventBegin(FXNN);
 
     Error_init(&eb);
 
@@ -1445,8 +2095,7 @@ Int RcmServer_dispatch_P(RcmServer_Object *obj, RcmClient_Packet *packet)
     jobId = packet->message.jobId;
 
     if (jobId == RcmClient_DISCRETEJOBID) {
-        listH = List_handle(&pool->readyQueue);
-        List_put(listH, (List_Elem *)packet);
+        RcmServer_putReady_I(pool, packet);
 
         /* dispatch a new worker thread */
         Semaphore_post(pool->sem, &eb);
@@ -1476,11 +2125,16 @@ Int RcmServer_dispatch_P(RcmServer_Object *obj, RcmClient_Packet *packet)
             status = RcmServer_E_JobIdNotFound;
         }
 
+        /* if job object is empty, in-band messages are run by the caller */
+        else if (job->empty && RcmServer_inBand_I(obj, packet)) {
+            job->empty = FALSE;
+            status = RcmServer_S_JobInBand;
+        }
+
         /* if job object is empty, place message directly on ready queue */
         else if (job->empty) {
             job->empty = FALSE;
-            listH = List_handle(&pool->readyQueue);
-            List_put(listH, (List_Elem *)packet);
+            RcmServer_putReady_I(pool, packet);
 
             /* dispatch a new worker thread */
             Semaphore_post(pool->sem, &eb);
@@ -1501,6 +2155,7 @@ Int RcmServer_dispatch_P(RcmServer_Object *obj, RcmClient_Packet *packet)
 
 
 leave:
+    SysMin_eventEnd(FXNN);
     Log_print1(Diags_EXIT, "<-- "FXNN": %d", (IArg)status);
     return(status);
 }
@@ -1510,17 +2165,30 @@ leave:
 /*
  *  ======== RcmServer_execMsg_I ========
  */
-Int RcmServer_execMsg_I(RcmServer_Object *obj, RcmClient_Message *msg)
+Int RcmServer_execMsg_I(RcmServer_Object *obj, RcmClient_Message *msg,
+        UInt32 stamp)
 {
     RcmServer_MsgFxn fxn;
 #if USE_MESSAGEQCOPY
     RcmServer_MsgCreateFxn createFxn = NULL;
 #endif
+    RcmServer_FxnTabElem *slot;
+    UInt32 start = 0;
     Int status;
 
-    status = RcmServer_getFxnAddr_P(obj, msg->fxnIdx, &fxn, &createFxn);
+    /* the reserved stats index is served by the server itself */
+    if (msg->fxnIdx == RcmServer_FXNIDX_STATS) {
+        msg->result = RcmServer_getStats_P(obj, msg);
+        return(RcmServer_S_SUCCESS);
+    }
+
+    status = RcmServer_getFxnAddr_P(obj, msg->fxnIdx, &fxn, &createFxn,
+        &slot);
 
     if (status >= 0) {
+        if (obj->profile) {
+            start = Timestamp_get32();
+        }
 #if 0
         System_printf("RcmServer_execMsg_I: Calling fxnIdx: %d\n",
                       (msg->fxnIdx & 0x0000FFFF));
@@ -1535,6 +2203,9 @@ Int RcmServer_execMsg_I(RcmServer_Object *obj, RcmClient_Message *msg)
 #else
         msg->result = (*fxn)(msg->dataSize, msg->data);
 #endif
+        if (obj->profile) {
+            RcmServer_profile_I(obj, slot, stamp, start, Timestamp_get32());
+        }
     }
 
     return(status);
@@ -1542,497 +2213,1464 @@ Int RcmServer_execMsg_I(RcmServer_Object *obj, RcmClient_Message *msg)
 
 
 /*
- *  ======== RcmServer_getFxnAddr_P ========
- *
- *  The function index (fxnIdx) uses the following format. Note that the
- *  format differs for static vs. dynamic functions. All static functions
- *  are in fxnTab[0], all dynamic functions are in fxnTab[1 - 8].
- *
- *  Bits    Description
+ *  ======== RcmServer_execMulti_P ========
  *
- *  Static Function Index
- *  --------------------------------------------------------------------
- *  31      static/dynamic function flag
- *              0 = dynamic function
- *              1 = static function
- *  30:20   reserved
- *  19:16   reserved
- *  15:0    offset: 0 - 65,535
+ *  Execute the records of a multi-call message in order. Each record's
+ *  result is written back in place and msg->result is set to the number
+ *  of records executed. Execution stops at the first record which has an
+ *  invalid function index or which overruns the message payload.
  *
- *  Dynamic Function Index
- *  --------------------------------------------------------------------
- *  31      static/dynamic function flag
- *              0 = dynamic function
- *              1 = static function
- *  30:20   key
- *  19:16   reserved
- *  15:12   index: 1 - 8
- *  11:0    offset: 0 - [31, 63, 127, 255, 511, 1023, 2047, 4095]
+ *  Return Value
+ *      < 0: error, msg->result records were executed
+ *        0: success, all records executed
+ *      > 0: number of records whose function returned an error
  */
-#define FXNN "RcmServer_getFxnAddr_P"
-Int RcmServer_getFxnAddr_P(RcmServer_Object *obj, UInt32 fxnIdx,
-        RcmServer_MsgFxn *addrPtr, RcmServer_MsgCreateFxn *createPtr)
+#define FXNN "RcmServer_execMulti_P"
+Int RcmServer_execMulti_P(RcmServer_Object *obj, RcmClient_Message *msg,
+        UInt32 stamp)
 {
-    UInt i, j;
-    UInt16 key;
+    RcmServer_MsgFxn fxn;
+    RcmServer_MsgCreateFxn createFxn;
     RcmServer_FxnTabElem *slot;
-    RcmServer_MsgFxn addr = NULL;
-    RcmServer_MsgCreateFxn createAddr = NULL;
+    RcmClient_MultiRec *rec;
+    UInt32 start = 0;
+    UInt32 count;
+    UInt32 offset;
+    UInt32 recSize;
+    UInt32 i;
+    Int fxnErrors = 0;
     Int status = RcmServer_S_SUCCESS;
 
-    /* static functions have bit-31 set */
-    if (fxnIdx & 0x80000000) {
-        j = (fxnIdx & 0x0000FFFF);
-        if (j < (obj->fxnTabStatic.length)) {
 
-            /* fetch the function address from the table */
-            slot = (obj->fxnTab[0])+j;
-            if (j == 0)  {
-                 createAddr = slot->addr.createFxn;
-            }
-            else {
-                 addr = slot->addr.fxn;
-            }
+    Log_print2(Diags_ENTRY,
+        "--> "FXNN": (obj=0x%x, msg=0x%x)", (IArg)obj, (IArg)msg);
+
+    msg->result = 0;
+
+    if (msg->dataSize < RcmClient_MULTI_HDR_SIZE) {
+        Log_error1(FXNN": invalid payload size %d", (IArg)msg->dataSize);
+        status = RcmServer_E_InvalidMultiMsg;
+        goto leave;
+    }
+
+    /* data[0] is the map info word of the rpmsg_omx driver */
+    count = msg->data[1];
+    offset = RcmClient_MULTI_HDR_SIZE;
+
+    for (i = 0; i < count; i++) {
+
+        /* validate the record against the message payload */
+        if ((offset + RcmClient_MULTIREC_HDR_SIZE) > msg->dataSize) {
+            status = RcmServer_E_InvalidMultiMsg;
+            break;
         }
-        else {
-            Log_error1(FXNN": invalid function index 0x%x", (IArg)fxnIdx);
-            status = RcmServer_E_InvalidFxnIdx;
-            goto leave;
+        rec = (RcmClient_MultiRec *)((Char *)msg->data + offset);
+
+        /* check before rounding up, a huge dataSize would wrap around */
+        if (rec->dataSize >
+            (msg->dataSize - offset - RcmClient_MULTIREC_HDR_SIZE)) {
+            status = RcmServer_E_InvalidMultiMsg;
+            break;
         }
-    }
-    /* must be a dynamic function */
-    else {
-        /* extract the key from the function index */
-        key = (fxnIdx & _RCM_KeyMask) >> _RCM_KeyShift;
+        recSize = RcmClient_MULTIREC_HDR_SIZE + ((rec->dataSize + 3) & ~3);
 
-        i = (fxnIdx & 0xF000) >> 12;
-        if ((i > 0) && (i < RcmServer_MAX_TABLES) && (obj->fxnTab[i] != NULL)) {
+        if ((offset + recSize) > msg->dataSize) {
+            status = RcmServer_E_InvalidMultiMsg;
+            break;
+        }
 
-            /* fetch the function address from the table */
-            j = (fxnIdx & 0x0FFF);
-            slot = (obj->fxnTab[i])+j;
-            addr = slot->addr.fxn;
+        createFxn = NULL;
+        status = RcmServer_getFxnAddr_P(obj, rec->fxnIdx, &fxn, &createFxn,
+            &slot);
 
-            /* validate the key */
-            if (key != slot->key) {
-                Log_error1(FXNN": invalid function index 0x%x", (IArg)fxnIdx);
-                status = RcmServer_E_InvalidFxnIdx;
-                goto leave;
-            }
+        if (status < 0) {
+            rec->result = status;
+            break;
+        }
+
+        if (obj->profile) {
+
+            start = Timestamp_get32();
+
+        }
+#if USE_MESSAGEQCOPY
+        if (createFxn)  {
+            rec->result = (*createFxn)(obj, rec->dataSize, rec->data);
         }
         else {
-            Log_error1(FXNN": invalid function index 0x%x", (IArg)fxnIdx);
-            status = RcmServer_E_InvalidFxnIdx;
-            goto leave;
+            rec->result = (*fxn)(rec->dataSize, rec->data);
+        }
+#else
+        rec->result = (*fxn)(rec->dataSize, rec->data);
+#endif
+        if (obj->profile) {
+            RcmServer_profile_I(obj, slot, stamp, start, Timestamp_get32());
         }
+
+        if (rec->result < 0) {
+            fxnErrors++;
+        }
+
+        msg->result++;
+        offset += recSize;
     }
 
-leave:
+    if (status == RcmServer_E_InvalidMultiMsg) {
+        Log_error1(FXNN": record %d overruns the message payload", (IArg)i);
+    }
+
+leave:
     if (status >= 0) {
-       if (j == 0)  {
-           *createPtr = createAddr;
-       }
-       else {
-           *addrPtr = addr;
-       }
+        status = fxnErrors;
     }
+
+    Log_print1(Diags_EXIT, "<-- "FXNN": %d", (IArg)status);
     return(status);
 }
 #undef FXNN
 
 
-/* *  ======== RcmServer_getSymIdx_P ========
+/*
+ *  ======== RcmServer_execBulk_P ========
  *
- *  Must have table gate before calling this function.
+ *  Execute a message whose arguments are passed by reference. The message
+ *  payload holds an RcmClient_BulkDesc; the function is called with the
+ *  translated buffer address and the buffer size.
+ *
+ *  Return Value
+ *      < 0: error, function not called
+ *        0: success, msg->result holds the function return value
  */
-#define FXNN "RcmServer_getSymIdx_P"
-Int RcmServer_getSymIdx_P(RcmServer_Object *obj, String name, UInt32 *index)
+#define FXNN "RcmServer_execBulk_P"
+Int RcmServer_execBulk_P(RcmServer_Object *obj, RcmClient_Message *msg,
+        UInt32 stamp)
 {
-    UInt i, j, len;
+    RcmServer_MsgFxn fxn;
+#if USE_MESSAGEQCOPY
+    RcmServer_MsgCreateFxn createFxn = NULL;
+#endif
     RcmServer_FxnTabElem *slot;
-    UInt32 fxnIdx = 0xFFFFFFFF;
+    RcmClient_BulkDesc *bulk;
+    UInt32 *buf;
+    UInt32 start = 0;
     Int status = RcmServer_S_SUCCESS;
 
 
-    Log_print3(Diags_ENTRY,
-        "--> "FXNN": (obj=0x%x, name=0x%x, index=0x%x)",
-        (IArg)obj, (IArg)name, (IArg)index);
+    Log_print2(Diags_ENTRY,
+        "--> "FXNN": (obj=0x%x, msg=0x%x)", (IArg)obj, (IArg)msg);
 
-    /* search tables for given function name */
-    for (i = 0; i < RcmServer_MAX_TABLES; i++) {
-        if (obj->fxnTab[i] != NULL) {
-            len = (i == 0) ? obj->fxnTabStatic.length : (1 << (i + 4));
-            for (j = 0; j < len; j++) {
-                slot = (obj->fxnTab[i]) + j;
-                if ((((obj->fxnTab[i])+j)->name != NULL) &&
-                    (_strcmp(((obj->fxnTab[i])+j)->name, name) == 0)) {
-                    /* found function name */
-                    if (i == 0) {
-                        fxnIdx = 0x80000000 | j;
-                    } else {
-                        fxnIdx = (slot->key << _RCM_KeyShift) | (i << 12) | j;
-                    }
-                    break;
-                }
-            }
-        }
+    if (msg->dataSize < sizeof(RcmClient_BulkDesc)) {
+        Log_error1(FXNN": invalid payload size %d", (IArg)msg->dataSize);
+        status = RcmServer_E_InvalidBulk;
+        goto leave;
+    }
 
-        if (0xFFFFFFFF != fxnIdx) {
-            break;
-        }
+    bulk = (RcmClient_BulkDesc *)(msg->data);
+
+    status = RcmServer_mapBulk_P(bulk, (Ptr *)&buf);
+
+    if (status < 0) {
+        goto leave;
     }
 
-    /* log an error if the symbol was not found */
-    if (fxnIdx == 0xFFFFFFFF) {
-        Log_error0(FXNN": given symbol not found");
-        status = RcmServer_E_SYMBOLNOTFOUND;
+    status = RcmServer_getFxnAddr_P(obj, msg->fxnIdx, &fxn, &createFxn,
+        &slot);
+
+    if (status < 0) {
+        goto leave;
     }
 
-    /* if success, return symbol index */
-    if (status >= 0) {
-        *index = fxnIdx;
+    if ((bulk->flags & RcmClient_BULK_IN) && (obj->cacheInvFxn != NULL)) {
+        (*obj->cacheInvFxn)((Ptr)buf, bulk->size);
+    }
+
+    if (obj->profile) {
+
+        start = Timestamp_get32();
+
+    }
+#if USE_MESSAGEQCOPY
+    if (createFxn)  {
+        msg->result = (*createFxn)(obj, bulk->size, buf);
+    }
+    else {
+        msg->result = (*fxn)(bulk->size, buf);
+    }
+#else
+    msg->result = (*fxn)(bulk->size, buf);
+#endif
+    if (obj->profile) {
+        RcmServer_profile_I(obj, slot, stamp, start, Timestamp_get32());
     }
 
+    if ((bulk->flags & RcmClient_BULK_OUT) && (obj->cacheWbFxn != NULL)) {
+        (*obj->cacheWbFxn)((Ptr)buf, bulk->size);
+    }
+
+leave:
     Log_print1(Diags_EXIT, "<-- "FXNN": %d", (IArg)status);
     return(status);
 }
 #undef FXNN
 
 
+#if USE_MESSAGEQCOPY
 /*
- *  ======== RcmServer_getNextKey_P ========
+ *  ======== RcmServer_msgCall_P ========
+ *
+ *  Execute a direct call message (RcmServer_HDR_CALL) and send back its
+ *  header. See RcmServer_CallMsg for the message layout.
  */
-UInt16 RcmServer_getNextKey_P(RcmServer_Object *obj)
+#define FXNN "RcmServer_msgCall_P"
+Void RcmServer_msgCall_P(RcmServer_Object *obj, RcmClient_Packet *packet,
+        UInt16 len)
 {
-    GateThread_Handle gateH;
-    IArg gateKey;
-    UInt16 key;
-
+    RcmServer_CallMsg *call = (RcmServer_CallMsg *)(&packet->hdr + 1);
+    RcmServer_CallParam *param = (RcmServer_CallParam *)(call + 1);
+    RcmServer_CallXlt *xlt;
+    RcmServer_MsgFxn fxn;
+    RcmServer_MsgCreateFxn createFxn = NULL;
+    RcmServer_FxnTabElem *slot;
+    RcmClient_BulkDesc bulk;
+    UInt32 args[2 * RcmServer_CALL_MAX_PARAMS];
+    UInt32 saved[RcmServer_CALL_MAX_XLTS];
+    UInt32 *ptr;
+    UInt32 type;
+    UInt32 da;
+    UInt32 start = 0;
+    UInt i, n = 0;
+    Int status = RcmServer_S_SUCCESS;
 
-    gateH = GateThread_handle(&obj->gate);
-    gateKey = GateThread_enter(gateH);
 
-    if (obj->key <= 1) {
-        obj->key = _RCM_KeyResetValue;  /* don't use 0 as a key value */
+    Log_print2(Diags_ENTRY,
+        "--> "FXNN": (obj=0x%x, packet=0x%x)", (IArg)obj, (IArg)packet);
+    SysMin_eventBegin(FXNN);
+
+    /* the descriptors must all be in the message */
+    if ((len < sizeof(struct rpmsg_omx_hdr) + sizeof(RcmServer_CallMsg))
+        || (call->numParams > RcmServer_CALL_MAX_PARAMS)
+        || (call->numXlts > RcmServer_CALL_MAX_XLTS)
+        || (len < sizeof(struct rpmsg_omx_hdr) + sizeof(RcmServer_CallMsg)
+            + call->numParams * sizeof(RcmServer_CallParam)
+            + call->numXlts * sizeof(RcmServer_CallXlt))) {
+        Log_error1(FXNN": invalid call message, len=%d", (IArg)len);
+        status = RcmServer_E_InvalidCall;
+        goto leave;
     }
-    else {
-        (obj->key)--;
+
+    xlt = (RcmServer_CallXlt *)(param + call->numParams);
+
+    /* map the buffers, the function gets (size, data) pairs */
+    for (i = 0; i < call->numParams; i++) {
+        type = RcmServer_PARAM_TYPE(param[i].desc);
+        args[2 * i] = RcmServer_PARAM_SIZE(param[i].desc);
+        args[2 * i + 1] = param[i].data;
+
+        if (type == RcmServer_PARAM_VALUE) {
+            continue;
+        }
+
+        bulk.addr = param[i].data;
+        bulk.size = args[2 * i];
+        bulk.flags = RcmClient_BULK_PHYS;
+
+        status = RcmServer_mapBulk_P(&bulk, (Ptr *)&args[2 * i + 1]);
+
+        if (status < 0) {
+            goto leave;
+        }
+
+        if ((type & RcmServer_PARAM_IN) && (obj->cacheInvFxn != NULL)) {
+            (*obj->cacheInvFxn)((Ptr)args[2 * i + 1], args[2 * i]);
+        }
     }
-    key = obj->key;
 
-    GateThread_leave(gateH, gateKey);
+    /* translate the pointers stored in the buffers */
+    for (n = 0; n < call->numXlts; n++) {
+        i = xlt[n].index;
 
-    return(key);
-}
+        if ((i >= call->numParams)
+            || (RcmServer_PARAM_TYPE(param[i].desc) == RcmServer_PARAM_VALUE)
+            || (xlt[n].offset & 3)
+            || (xlt[n].offset + sizeof(UInt32) > args[2 * i])) {
+            status = RcmServer_E_InvalidCall;
+            break;
+        }
 
+        ptr = (UInt32 *)(args[2 * i + 1] + xlt[n].offset);
 
-/*
- *  ======== RcmServer_getPool_P ========
- */
-#define FXNN "RcmServer_getPool_P"
-Int RcmServer_getPool_P(RcmServer_Object *obj,
-        RcmClient_Packet *packet, RcmServer_ThreadPool **poolP)
-{
-    UInt16 poolId;
-    UInt16 offset;
-    Int status = RcmServer_S_SUCCESS;
+        /* the size of the target is unknown, it must at least start
+         * in a shared region like the buffers themselves */
+        if ((IpcMemory_physToVirt(*ptr, &da) != IpcMemory_S_SUCCESS)
+            || !RcmServer_isShared_I(da, 1)) {
+            Log_error1(FXNN": physical address 0x%x not shared", (IArg)*ptr);
+            status = RcmServer_E_InvalidCall;
+            break;
+        }
 
+        saved[n] = *ptr;
+        *ptr = da;
+    }
 
-    poolId = packet->message.poolId;
+    if (status >= 0) {
+        status = RcmServer_getFxnAddr_P(obj, call->fxnIdx, &fxn, &createFxn,
+            &slot);
+    }
 
-    /* static pools have bit-15 set */
-    if (poolId & 0x8000) {
-        offset = (poolId & 0x00FF);
-        if (offset < obj->poolMap0Len) {
-            *poolP = &(obj->poolMap[0])[offset];
+    if (status >= 0) {
+        if (obj->profile) {
+            start = Timestamp_get32();
+        }
+        if (createFxn)  {
+            call->result = (*createFxn)(obj, call->numParams * 2 *
+                sizeof(UInt32), args);
         }
         else {
-            Log_error1(FXNN": pool id=0x%x not found", (IArg)poolId);
-            *poolP = NULL;
-            status = RcmServer_E_PoolIdNotFound;
-            goto leave;
+            call->result = (*fxn)(call->numParams * 2 * sizeof(UInt32), args);
+        }
+        if (obj->profile) {
+            RcmServer_profile_I(obj, slot, packet->stamp, start,
+                Timestamp_get32());
+        }
+    }
+
+    /* the client gets its buffers back as it sent them; a restored word
+     * of an input buffer must not linger dirty in the cache either */
+    while (n-- > 0) {
+        i = xlt[n].index;
+        ptr = (UInt32 *)(args[2 * i + 1] + xlt[n].offset);
+        *ptr = saved[n];
+
+        type = RcmServer_PARAM_TYPE(param[i].desc);
+
+        if (!(type & RcmServer_PARAM_OUT) && (obj->cacheWbFxn != NULL)) {
+            (*obj->cacheWbFxn)((Ptr)ptr, sizeof(UInt32));
+        }
+    }
+
+    if (status >= 0) {
+        for (i = 0; i < call->numParams; i++) {
+            type = RcmServer_PARAM_TYPE(param[i].desc);
+
+            if ((type & RcmServer_PARAM_OUT) && (obj->cacheWbFxn != NULL)) {
+                (*obj->cacheWbFxn)((Ptr)args[2 * i + 1], args[2 * i]);
+            }
         }
     }
 
 leave:
-    return(status);
+    if (status < 0) {
+        packet->hdr.flags = RcmServer_errToStatus_I(status);
+        call->result = status;
+    }
+    else {
+        packet->hdr.flags = RcmServer_Status_SUCCESS;
+    }
+
+    RcmServer_reply_P(obj, packet);
+
+    SysMin_eventEnd(FXNN);
+    Log_print1(Diags_EXIT, "<-- "FXNN": %d", (IArg)status);
 }
 #undef FXNN
+#endif
 
 
 /*
- *  ======== RcmServer_process_P ========
+ *  ======== RcmServer_mapBulk_P ========
+ *
+ *  Validate a bulk buffer descriptor and return the local address of the
+ *  buffer. The whole range must lie in one of the shared buffer regions
+ *  of the resource table, see RcmServer_sharedNames.
  */
-#define FXNN "RcmServer_process_P"
-Void RcmServer_process_P(RcmServer_Object *obj, RcmClient_Packet *packet)
+#define FXNN "RcmServer_mapBulk_P"
+Int RcmServer_mapBulk_P(RcmClient_BulkDesc *bulk, Ptr *bufPtr)
 {
-    String name;
-    UInt32 fxnIdx;
-    RcmServer_MsgFxn fxn;
-    RcmClient_Message *rcmMsg;
 #if USE_MESSAGEQCOPY
-    RcmServer_MsgCreateFxn createFxn = NULL;
-#endif
-#if USE_MESSAGEQCOPY == 0
-    MessageQ_Msg msgqMsg;
+    UInt32 da;
 #endif
-    UInt16 messageType;
-    Error_Block eb;
-    UInt16 jobId;
-    Int rval;
     Int status = RcmServer_S_SUCCESS;
 
 
-    Log_print2(Diags_ENTRY,
-        "--> "FXNN": (obj=0x%x, packet=0x%x)", (IArg)obj, (IArg)packet);
+    *bufPtr = NULL;
 
-    Error_init(&eb);
+    if ((bulk->size == 0) || ((bulk->addr + bulk->size - 1) < bulk->addr)) {
+        Log_error2(FXNN": invalid buffer, addr=0x%x, size=%d",
+            (IArg)bulk->addr, (IArg)bulk->size);
+        status = RcmServer_E_InvalidBulk;
+        goto leave;
+    }
 
-    /* decode the message */
-    rcmMsg = &packet->message;
-#if USE_MESSAGEQCOPY == 0
-    msgqMsg = &packet->msgqHeader;
-#endif
-    Log_print1(Diags_INFO, FXNN": message desc=0x%x", (IArg)packet->desc);
+#if USE_MESSAGEQCOPY
+    /* translate a physical address to the local device address */
+    if (bulk->flags & RcmClient_BULK_PHYS) {
+        if (IpcMemory_physToVirt(bulk->addr, &da) != IpcMemory_S_SUCCESS) {
+            Log_error1(FXNN": physical address 0x%x not mapped",
+                (IArg)bulk->addr);
+            status = RcmServer_E_InvalidBulk;
+            goto leave;
+        }
+    }
+    else {
+        da = bulk->addr;
+    }
 
-    /* extract the message type from the packet descriptor field */
-    messageType = (RcmClient_Desc_TYPE_MASK & packet->desc) >>
-        RcmClient_Desc_TYPE_SHIFT;
+    /* a region maps linearly, so this also makes it contiguous */
+    if (!RcmServer_isShared_I(da, bulk->size)) {
+        Log_error2(FXNN": buffer not in a shared region, da=0x%x, size=%d",
+            (IArg)da, (IArg)bulk->size);
+        status = RcmServer_E_InvalidBulk;
+        goto leave;
+    }
 
-    /* process the given message */
-    switch (messageType) {
+    *bufPtr = (Ptr)da;
+#else
+    /* no resource table, only local addresses are accepted */
+    if (bulk->flags & RcmClient_BULK_PHYS) {
+        status = RcmServer_E_InvalidBulk;
+        goto leave;
+    }
 
-        case RcmClient_Desc_RCM_MSG:
-            rval = RcmServer_execMsg_I(obj, rcmMsg);
+    *bufPtr = (Ptr)(bulk->addr);
+#endif
 
-            if (rval < 0) {
-                switch (rval) {
-                    case RcmServer_E_InvalidFxnIdx:
-                        RcmServer_setStatusCode_I(
-                            packet, RcmServer_Status_INVALID_FXN);
-                        break;
-                    default:
-                        RcmServer_setStatusCode_I(
-                            packet, RcmServer_Status_Error);
-                        break;
-                }
-            }
-            else if (rcmMsg->result < 0) {
-                RcmServer_setStatusCode_I(packet, RcmServer_Status_MSG_FXN_ERR);
-            }
-            else {
-                RcmServer_setStatusCode_I(packet, RcmServer_Status_SUCCESS);
-            }
+leave:
+    return(status);
+}
+#undef FXNN
 
-#if USE_MESSAGEQCOPY
-#if 0
-            System_printf("RcmServer_process_P: Sending reply from: %d to: %d\n",
-                      obj->localAddr, obj->replyAddr);
-#endif
 
-            packet->hdr.type = OMX_RAW_MSG;
-            packet->hdr.len = PACKET_DATA_SIZE + packet->message.dataSize;
-            status = MessageQCopy_send(obj->dstProc, obj->replyAddr,
-                                 obj->localAddr, (Ptr)&packet->hdr,
-                                 PACKET_HDR_SIZE + packet->message.dataSize);
-#else
-            status = MessageQ_put(MessageQ_getReplyQueue(msgqMsg), msgqMsg);
-#endif
-            if (status < 0) {
-                Log_error1(FXNN": unknown ipc error, 0x%x", (IArg)status);
-            }
-            break;
+#if USE_MESSAGEQCOPY
+/*
+ *  ======== RcmServer_isShared_I ========
+ *
+ *  Return TRUE if [da, da + size) lies inside a single shared region.
+ */
+Bool RcmServer_isShared_I(UInt32 da, UInt32 size)
+{
+    RcmServer_Region *region;
+    UInt i;
 
-        case RcmClient_Desc_CMD:
-            status = RcmServer_execMsg_I(obj, rcmMsg);
 
-            /* if all went well, free the message */
-            if ((status >= 0) && (rcmMsg->result >= 0)) {
+    for (i = 0; i < RcmServer_NUM_REGIONS; i++) {
+        region = &RcmServer_sharedRegions[i];
 
-#if USE_MESSAGEQCOPY == 0
-                status = MessageQ_free(msgqMsg);
-#endif
-                if (status < 0) {
-                    Log_error1(
-                        FXNN": MessageQ_free returned error %d", (IArg)status);
-                }
-            }
+        if ((da >= region->base) && (size <= region->len)
+            && ((da - region->base) <= (region->len - size))) {
+            return(TRUE);
+        }
+    }
 
-            /* an error occurred, must return message to client */
-            else {
-                if (status < 0) {
-                    /* error trying to process the message */
-                    switch (status) {
-                        case RcmServer_E_InvalidFxnIdx:
-                            RcmServer_setStatusCode_I(
-                                packet, RcmServer_Status_INVALID_FXN);
-                            break;
-                        default:
-                            RcmServer_setStatusCode_I(
-                                packet, RcmServer_Status_Error);
-                            break;
-                    }
-                }
-                else  {
-                    /* error in message function */
-                    RcmServer_setStatusCode_I(
-                        packet, RcmServer_Status_MSG_FXN_ERR);
-                }
+    return(FALSE);
+}
 
-                /* send error message back to client */
-#if USE_MESSAGEQCOPY
-                packet->hdr.type = OMX_RAW_MSG;
-                packet->hdr.len = PACKET_DATA_SIZE + packet->message.dataSize;
-                status = MessageQCopy_send(obj->dstProc, obj->replyAddr,
-                                 obj->localAddr, (Ptr)&packet->hdr,
-                                 PACKET_HDR_SIZE + packet->message.dataSize);
-#else
-                status = MessageQ_put(MessageQ_getReplyQueue(msgqMsg), msgqMsg);
-#endif
-                if (status < 0) {
-                    Log_error1(FXNN": unknown ipc error, 0x%x", (IArg)status);
-                }
-            }
-            break;
 
-        case RcmClient_Desc_DPC:
-            rval = RcmServer_getFxnAddr_P(obj, rcmMsg->fxnIdx, &fxn,
-                                          &createFxn);
+/*
+ *  ======== RcmServer_cacheInv_P ========
+ */
+Void RcmServer_cacheInv_P(Ptr addr, SizeT size)
+{
+    Cache_inv(addr, size, Cache_Type_ALL, TRUE);
+}
 
-            if (rval < 0) {
-                RcmServer_setStatusCode_I(
-                    packet, RcmServer_Status_SYMBOL_NOT_FOUND);
-                Error_init(&eb);
-            }
 
-#if USE_MESSAGEQCOPY
-            packet->hdr.type = OMX_RAW_MSG;
-            packet->hdr.len = PACKET_DATA_SIZE + packet->message.dataSize;
-            status = MessageQCopy_send(obj->dstProc, obj->replyAddr,
-                                 obj->localAddr, (Ptr)&packet->hdr,
-                                 PACKET_HDR_SIZE + packet->message.dataSize);
-#else
-            status = MessageQ_put(MessageQ_getReplyQueue(msgqMsg), msgqMsg);
+/*
+ *  ======== RcmServer_cacheWb_P ========
+ */
+Void RcmServer_cacheWb_P(Ptr addr, SizeT size)
+{
+    Cache_wb(addr, size, Cache_Type_ALL, TRUE);
+}
 #endif
-            if (status < 0) {
-                Log_error1(FXNN": unknown ipc error, 0x%x", (IArg)status);
-            }
 
-            /* invoke the function with a null context */
-#if USE_MESSAGEQCOPY
-            if (createFxn)  {
-                 (*createFxn)(obj, 0, NULL);
+
+/*
+ *  ======== RcmServer_getFxnAddr_P ========
+ *
+ *  The function index (fxnIdx) uses the following format. Note that the
+ *  format differs for static vs. dynamic functions. All static functions
+ *  are in fxnTab[0], all dynamic functions are in fxnTab[1 - 8].
+ *
+ *  Bits    Description
+ *
+ *  Static Function Index
+ *  --------------------------------------------------------------------
+ *  31      static/dynamic function flag
+ *              0 = dynamic function
+ *              1 = static function
+ *  30:20   reserved
+ *  19:16   reserved
+ *  15:0    offset: 0 - 65,535
+ *
+ *  Dynamic Function Index
+ *  --------------------------------------------------------------------
+ *  31      static/dynamic function flag
+ *              0 = dynamic function
+ *              1 = static function
+ *  30:20   key
+ *  19:16   reserved
+ *  15:12   index: 1 - 8
+ *  11:0    offset: 0 - [31, 63, 127, 255, 511, 1023, 2047, 4095]
+ */
+#define FXNN "RcmServer_getFxnAddr_P"
+Int RcmServer_getFxnAddr_P(RcmServer_Object *obj, UInt32 fxnIdx,
+        RcmServer_MsgFxn *addrPtr, RcmServer_MsgCreateFxn *createPtr,
+        RcmServer_FxnTabElem **slotPtr)
+{
+    UInt i, j;
+    UInt16 key;
+    RcmServer_FxnTabElem *slot;
+    RcmServer_MsgFxn addr = NULL;
+    RcmServer_MsgCreateFxn createAddr = NULL;
+    Int status = RcmServer_S_SUCCESS;
+
+    /* static functions have bit-31 set */
+    if (fxnIdx & 0x80000000) {
+        j = (fxnIdx & 0x0000FFFF);
+        if (j < (obj->fxnTabStatic.length)) {
+
+            /* fetch the function address from the table */
+            slot = (obj->fxnTab[0])+j;
+            if (j == 0)  {
+                 createAddr = slot->addr.createFxn;
             }
             else {
-                 (*fxn)(0, NULL);
+                 addr = slot->addr.fxn;
             }
-#else
-            (*fxn)(0, NULL);
-#endif
+        }
+        else {
+            Log_error1(FXNN": invalid function index 0x%x", (IArg)fxnIdx);
+            status = RcmServer_E_InvalidFxnIdx;
+            goto leave;
+        }
+    }
+    /* must be a dynamic function */
+    else {
+        /* extract the key from the function index */
+        key = (fxnIdx & _RCM_KeyMask) >> _RCM_KeyShift;
+
+        i = (fxnIdx & 0xF000) >> 12;
+        if ((i > 0) && (i < RcmServer_MAX_TABLES) && (obj->fxnTab[i] != NULL)) {
+
+            /* fetch the function address from the table */
+            j = (fxnIdx & 0x0FFF);
+            slot = (obj->fxnTab[i])+j;
+            addr = slot->addr.fxn;
+
+            /* validate the key */
+            if (key != slot->key) {
+                Log_error1(FXNN": invalid function index 0x%x", (IArg)fxnIdx);
+                status = RcmServer_E_InvalidFxnIdx;
+                goto leave;
+            }
+        }
+        else {
+            Log_error1(FXNN": invalid function index 0x%x", (IArg)fxnIdx);
+            status = RcmServer_E_InvalidFxnIdx;
+            goto leave;
+        }
+    }
+
+leave:
+    if (status >= 0) {
+       if (j == 0)  {
+           *createPtr = createAddr;
+       }
+       else {
+           *addrPtr = addr;
+       }
+       if (slotPtr != NULL) {
+           *slotPtr = slot;
+       }
+    }
+    return(status);
+}
+#undef FXNN
+
+
+/*
+ *  ======== RcmServer_getStats_P ========
+ *
+ *  Fill the message payload with a page of the function profile table,
+ *  see RcmServer_FXNIDX_STATS. Entries are numbered in table order, the
+ *  static functions first. Returns the number of entries copied.
+ */
+#define FXNN "RcmServer_getStats_P"
+Int RcmServer_getStats_P(RcmServer_Object *obj, RcmClient_Message *msg)
+{
+    GateThread_Handle gateH;
+    IArg key;
+    RcmServer_StatsHdr *hdr;
+    RcmServer_StatsRec *rec;
+    RcmServer_FxnTabElem *slot;
+    Types_FreqHz freq;
+    UInt32 first;
+    UInt32 max;
+    UInt32 n = 0;
+    UInt i, j, k, len;
+
+
+    Log_print2(Diags_ENTRY,
+        "--> "FXNN": (obj=0x%x, msg=0x%x)", (IArg)obj, (IArg)msg);
+
+    if (msg->dataSize < sizeof(RcmServer_StatsHdr)) {
+        Log_error1(FXNN": payload too small, size=%d", (IArg)msg->dataSize);
+        return(RcmServer_E_FAIL);
+    }
+
+    hdr = (RcmServer_StatsHdr *)msg->data;
+    rec = (RcmServer_StatsRec *)(hdr + 1);
+    first = hdr->first;
+    max = (msg->dataSize - sizeof(RcmServer_StatsHdr)) /
+        sizeof(RcmServer_StatsRec);
+
+    Timestamp_getFreq(&freq);
+    hdr->freq = freq.lo;
+    hdr->count = 0;
+
+    gateH = GateThread_handle(&obj->gate);
+    key = GateThread_enter(gateH);
+
+    for (i = 0; i < RcmServer_MAX_TABLES; i++) {
+        if (obj->fxnTab[i] == NULL) {
+            continue;
+        }
+        len = (i == 0) ? obj->fxnTabStatic.length : (1 << (i + 4));
+
+        for (j = 0; j < len; j++) {
+            slot = (obj->fxnTab[i]) + j;
+
+            /* skip empty dynamic slots */
+            if ((i > 0) && (slot->name == NULL)) {
+                continue;
+            }
+
+            if ((n >= first) && (hdr->count < max)) {
+                rec->fxnIdx = (i == 0) ? (0x80000000 | j) :
+                    ((slot->key << _RCM_KeyShift) | (i << 12) | j);
+                rec->calls = slot->stats.calls;
+                rec->minTicks = slot->stats.minTicks;
+                rec->maxTicks = slot->stats.maxTicks;
+                rec->execLo = (UInt32)(slot->stats.execTicks);
+                rec->execHi = (UInt32)(slot->stats.execTicks >> 32);
+                rec->waitLo = (UInt32)(slot->stats.waitTicks);
+                rec->waitHi = (UInt32)(slot->stats.waitTicks >> 32);
+                _memset(rec->name, 0, RcmServer_STATS_NAMELEN);
+                for (k = 0; (slot->name != NULL) && (slot->name[k] != '\0')
+                    && (k < RcmServer_STATS_NAMELEN - 1); k++) {
+                    rec->name[k] = slot->name[k];
+                }
+                hdr->count++;
+                rec++;
+            }
+            n++;
+        }
+    }
+
+    GateThread_leave(gateH, key);
+
+    hdr->total = n;
+
+    Log_print1(Diags_EXIT, "<-- "FXNN": %d", (IArg)hdr->count);
+    return(hdr->count);
+}
+#undef FXNN
+
+
+/* *  ======== RcmServer_getSymIdx_P ========
+ *
+ *  Must have table gate before calling this function.
+ */
+#define FXNN "RcmServer_getSymIdx_P"
+Int RcmServer_getSymIdx_P(RcmServer_Object *obj, String name, UInt32 *index)
+{
+    UInt i, j, len;
+    RcmServer_FxnTabElem *slot;
+    UInt32 fxnIdx = 0xFFFFFFFF;
+    Int status = RcmServer_S_SUCCESS;
+
+
+    Log_print3(Diags_ENTRY,
+        "--> "FXNN": (obj=0x%x, name=0x%x, index=0x%x)",
+        (IArg)obj, (IArg)name, (IArg)index);
+
+    /* search tables for given function name */
+    for (i = 0; i < RcmServer_MAX_TABLES; i++) {
+        if (obj->fxnTab[i] != NULL) {
+            len = (i == 0) ? obj->fxnTabStatic.length : (1 << (i + 4));
+            for (j = 0; j < len; j++) {
+                slot = (obj->fxnTab[i]) + j;
+                if ((((obj->fxnTab[i])+j)->name != NULL) &&
+                    (_strcmp(((obj->fxnTab[i])+j)->name, name) == 0)) {
+                    /* found function name */
+                    if (i == 0) {
+                        fxnIdx = 0x80000000 | j;
+                    } else {
+                        fxnIdx = (slot->key << _RCM_KeyShift) | (i << 12) | j;
+                    }
+                    break;
+                }
+            }
+        }
+
+        if (0xFFFFFFFF != fxnIdx) {
             break;
+        }
+    }
+
+    /* log an error if the symbol was not found */
+    if (fxnIdx == 0xFFFFFFFF) {
+        Log_error0(FXNN": given symbol not found");
+        status = RcmServer_E_SYMBOLNOTFOUND;
+    }
+
+    /* if success, return symbol index */
+    if (status >= 0) {
+        *index = fxnIdx;
+    }
+
+    Log_print1(Diags_EXIT, "<-- "FXNN": %d", (IArg)status);
+    return(status);
+}
+#undef FXNN
+
+
+/*
+ *  ======== RcmServer_getNextKey_P ========
+ */
+UInt16 RcmServer_getNextKey_P(RcmServer_Object *obj)
+{
+    GateThread_Handle gateH;
+    IArg gateKey;
+    UInt16 key;
+
+
+    gateH = GateThread_handle(&obj->gate);
+    gateKey = GateThread_enter(gateH);
+
+    if (obj->key <= 1) {
+        obj->key = _RCM_KeyResetValue;  /* don't use 0 as a key value */
+    }
+    else {
+        (obj->key)--;
+    }
+    key = obj->key;
+
+    GateThread_leave(gateH, gateKey);
+
+    return(key);
+}
+
+
+/*
+ *  ======== RcmServer_getPool_P ========
+ */
+#define FXNN "RcmServer_getPool_P"
+Int RcmServer_getPool_P(RcmServer_Object *obj,
+        RcmClient_Packet *packet, RcmServer_ThreadPool **poolP)
+{
+    UInt16 poolId;
+    UInt16 offset;
+    Int status = RcmServer_S_SUCCESS;
+
+
+    poolId = packet->message.poolId;
+
+    /* static pools have bit-15 set */
+    if (poolId & 0x8000) {
+        offset = (poolId & 0x00FF);
+        if (offset < obj->poolMap0Len) {
+            *poolP = &(obj->poolMap[0])[offset];
+        }
+        else {
+            Log_error1(FXNN": pool id=0x%x not found", (IArg)poolId);
+            *poolP = NULL;
+            status = RcmServer_E_PoolIdNotFound;
+            goto leave;
+        }
+    }
+
+leave:
+    return(status);
+}
+#undef FXNN
+
+
+/*
+ *  ======== RcmServer_attachPool_P ========
+ *
+ *  If a shared pool has the same name as the given pool, attach the pool
+ *  to it. The pool then keeps its own ready queues but has no threads;
+ *  its messages are run by the shared pool's threads. Returns TRUE if
+ *  the pool was attached.
+ */
+Bool RcmServer_attachPool_P(RcmServer_Object *obj, RcmServer_ThreadPool *pool)
+{
+    RcmServer_SharedPool *shared;
+    GateThread_Handle gateH;
+    IArg key, key2;
+
+
+    if ((pool->name == NULL) || (pool->name[0] == '\0')) {
+        return(FALSE);
+    }
+
+    gateH = GateThread_handle(&RcmServer_sharedGate);
+    key = GateThread_enter(gateH);
+
+    shared = RcmServer_findSharedPool_P(pool->name);
+
+    if (shared != NULL) {
+        pool->shared = shared;
+        pool->count = 0;
+        pool->sem = shared->pool.sem;
+        pool->link.pool = pool;
+
+        key2 = GateThread_enter(GateThread_handle(&shared->gate));
+        List_put(List_handle(&shared->members), &(pool->link.elem));
+        shared->refCount++;
+        GateThread_leave(GateThread_handle(&shared->gate), key2);
+    }
+
+    GateThread_leave(gateH, key);
+
+    return(shared != NULL);
+}
+
+
+/*
+ *  ======== RcmServer_detachPool_P ========
+ *
+ *  Remove the pool from its shared pool and wait until the shared workers
+ *  have finished all messages they took from it. Messages still on the
+ *  pool's ready queues are left there for the caller. The last worker to
+ *  finish posts the idle semaphore, see RcmServer_releaseShared_I.
+ */
+#define FXNN "RcmServer_detachPool_P"
+Void RcmServer_detachPool_P(RcmServer_ThreadPool *pool)
+{
+    RcmServer_SharedPool *shared = pool->shared;
+    GateThread_Handle gateH;
+    SemThread_Params semThreadP;
+    SemThread_Struct idle;
+    Error_Block eb;
+    IArg key;
+    UInt busy;
+
+
+    Error_init(&eb);
+    gateH = GateThread_handle(&shared->gate);
+
+    SemThread_Params_init(&semThreadP);
+    semThreadP.mode = SemThread_Mode_BINARY;
+    SemThread_construct(&idle, 0, &semThreadP, &eb);
+    Assert_isTrue(!Error_check(&eb), NULL);
+
+    key = GateThread_enter(gateH);
+    List_remove(List_handle(&shared->members), &(pool->link.elem));
+    shared->refCount--;
+    busy = pool->busy;
+    if (busy > 0) {
+        pool->idle = SemThread_Handle_upCast(SemThread_handle(&idle));
+    }
+    GateThread_leave(gateH, key);
+
+    if (busy > 0) {
+        Semaphore_pend(pool->idle, Semaphore_FOREVER, &eb);
+
+        if (Error_check(&eb)) {
+            Log_error0(FXNN": Semaphore_pend failed");
+        }
+        pool->idle = NULL;
+    }
+
+    SemThread_destruct(&idle);
+}
+#undef FXNN
+
+
+/*
+ *  ======== RcmServer_findSharedPool_P ========
+ *
+ *  Caller must hold the shared pool registry gate.
+ */
+RcmServer_SharedPool *RcmServer_findSharedPool_P(String name)
+{
+    List_Elem *elem = NULL;
+    RcmServer_SharedPool *shared;
+
+
+    while ((elem = List_next(List_handle(&RcmServer_sharedPools), elem))
+        != NULL) {
+        shared = (RcmServer_SharedPool *)elem;
+
+        if (_strcmp(shared->pool.name, name) == 0) {
+            return(shared);
+        }
+    }
+
+    return(NULL);
+}
+
+
+/*
+ *  ======== RcmServer_getShared_P ========
+ *
+ *  Take the next message for a shared pool worker. The highest priority
+ *  level with any message wins; within that level the attached pools are
+ *  served in turn, the pool just served moving to the end of the line.
+ *  The pool the message came from is returned in poolPtr and stays busy
+ *  until RcmServer_releaseShared_I is called.
+ */
+RcmClient_Packet *RcmServer_getShared_P(RcmServer_SharedPool *shared,
+        RcmServer_ThreadPool **poolPtr)
+{
+    GateThread_Handle gateH;
+    List_Handle membersH;
+    List_Elem *elem;
+    List_Elem *packet = NULL;
+    RcmServer_ThreadPool *pool = NULL;
+    IArg key;
+    Int p;
+
+
+    gateH = GateThread_handle(&shared->gate);
+    membersH = List_handle(&shared->members);
+
+    key = GateThread_enter(gateH);
+
+    for (p = RcmServer_NUM_PRIORITIES - 1; (p >= 0) && (packet == NULL); p--) {
+        elem = NULL;
+        while ((elem = List_next(membersH, elem)) != NULL) {
+            pool = ((RcmServer_PoolLink *)elem)->pool;
+            packet = List_get(List_handle(&pool->readyQueue[p]));
+
+            if (packet != NULL) {
+                pool->busy++;
+                RcmServer_countReady_I(pool, -1);
+
+                /* round robin, this pool goes to the end of the line */
+                List_remove(membersH, elem);
+                List_put(membersH, elem);
+                break;
+            }
+        }
+    }
+
+    GateThread_leave(gateH, key);
+
+    *poolPtr = (packet != NULL ? pool : NULL);
+    return((RcmClient_Packet *)packet);
+}
+
+
+/*
+ *  ======== RcmServer_releaseShared_I ========
+ */
+Void RcmServer_releaseShared_I(RcmServer_ThreadPool *pool)
+{
+    GateThread_Handle gateH = GateThread_handle(&pool->shared->gate);
+    Error_Block eb;
+    IArg key;
+
+
+    Error_init(&eb);
+    key = GateThread_enter(gateH);
+
+    /* wake up RcmServer_detachPool_P, posted in the gate as the
+     * semaphore goes away as soon as it returns */
+    if ((--pool->busy == 0) && (pool->idle != NULL)) {
+        Semaphore_post(pool->idle, &eb);
+    }
+
+    GateThread_leave(gateH, key);
+}
+
+
+/*
+ *  ======== RcmServer_getReady_P ========
+ *
+ *  Take the highest priority message off the pool's ready queue.
+ *  Returns NULL if the ready queue is empty.
+ */
+RcmClient_Packet *RcmServer_getReady_P(RcmServer_ThreadPool *pool)
+{
+    List_Elem *elem = NULL;
+    Int p;
+
+
+    for (p = RcmServer_NUM_PRIORITIES - 1; p >= 0; p--) {
+        elem = List_get(List_handle(&pool->readyQueue[p]));
+        if (elem != NULL) {
+            RcmServer_countReady_I(pool, -1);
+            break;
+        }
+    }
+
+    return((RcmClient_Packet *)elem);
+}
+
+
+/*
+ *  ======== RcmServer_putReady_I ========
+ *
+ *  Place a message at the end of the pool's ready queue for its priority.
+ *  Priorities beyond the number of levels are treated as the highest.
+ */
+Void RcmServer_putReady_I(RcmServer_ThreadPool *pool, RcmClient_Packet *packet)
+{
+    UInt16 pri;
+
+
+    pri = (packet->desc & RcmClient_Desc_PRI_MASK) >> RcmClient_Desc_PRI_SHIFT;
+
+    if (pri >= RcmServer_NUM_PRIORITIES) {
+        pri = RcmServer_NUM_PRIORITIES - 1;
+    }
+
+    List_put(List_handle(&pool->readyQueue[pri]), (List_Elem *)packet);
+    RcmServer_countReady_I(pool, 1);
+}
+
+
+/*
+ *  ======== RcmServer_countReady_I ========
+ *
+ *  Ready queues are filled without a gate (List_put is atomic) and
+ *  drained under different gates, so the counter is kept in the system
+ *  gate.
+ */
+Void RcmServer_countReady_I(RcmServer_ThreadPool *pool, Int delta)
+{
+    IArg key;
+
+
+    key = Gate_enterSystem();
+    pool->queued += delta;
+    Gate_leaveSystem(key);
+}
+
+
+#if USE_MESSAGEQCOPY
+/*
+ *  ======== RcmServer_copyPacket_P ========
+ *
+ *  The server thread receives into a buffer on its stack, which is reused
+ *  for the next message. Messages handed to a worker pool must be copied
+ *  to a buffer of their own, released with RcmServer_freePacket_I once
+ *  the reply has been sent.
+ */
+#define FXNN "RcmServer_copyPacket_P"
+RcmClient_Packet *RcmServer_copyPacket_P(RcmClient_Packet *packet, UInt16 len)
+{
+    RcmClient_Packet *copy;
+    Error_Block eb;
+
+
+    Error_init(&eb);
+
+    copy = (RcmClient_Packet *)xdc_runtime_Memory_alloc(
+        RcmServer_Module_heap(), MSGBUFFERSIZE, sizeof(Ptr), &eb);
+
+    if (Error_check(&eb)) {
+        Log_error2(FXNN": out of memory: heap=0x%x, size=%u",
+            (IArg)RcmServer_Module_heap(), MSGBUFFERSIZE);
+        return(NULL);
+    }
+
+    memcpy(copy, packet, ((Char *)&packet->hdr - (Char *)packet) + len);
+
+    return(copy);
+}
+#undef FXNN
+
+
+/*
+ *  ======== RcmServer_freePacket_I ========
+ */
+Void RcmServer_freePacket_I(RcmClient_Packet *packet)
+{
+    xdc_runtime_Memory_free(RcmServer_Module_heap(), (Ptr)packet,
+        MSGBUFFERSIZE);
+}
+#endif
+
+
+/*
+ *  ======== RcmServer_process_P ========
+ *
+ *  Run the handler for the message type. If the handler asks for it,
+ *  the message is then returned to the client as the reply.
+ */
+#define FXNN "RcmServer_process_P"
+Void RcmServer_process_P(RcmServer_Object *obj, RcmClient_Packet *packet)
+{
+    RcmServer_MsgHandler handler;
+    UInt16 messageType;
+
+
+    Log_print2(Diags_ENTRY,
+        "--> "FXNN": (obj=0x%x, packet=0x%x)", (IArg)obj, (IArg)packet);
+    SysMin_eventBegin(FXNN);
+
+    Log_print1(Diags_INFO, FXNN": message desc=0x%x", (IArg)packet->desc);
+
+    /* extract the message type from the packet descriptor field */
+    messageType = (RcmClient_Desc_TYPE_MASK & packet->desc) >>
+        RcmClient_Desc_TYPE_SHIFT;
+
+    handler = RcmServer_msgHandlers[messageType];
+
+    if (handler == NULL) {
+        Log_error1(FXNN": unknown message type recieved, 0x%x",
+            (IArg)messageType);
+    }
+    else if ((*handler)(obj, packet)) {
+        RcmServer_reply_P(obj, packet);
+    }
+
+    SysMin_eventEnd(FXNN);
+    Log_print0(Diags_EXIT, "<-- "FXNN":");
+}
+#undef FXNN
+
+
+/*
+ *  ======== RcmServer_reply_P ========
+ *
+ *  Return a message to the client. Every reply and every returned message
+ *  leaves the server through here.
+ *
+ *  MessageQCopy_send copies the packet into a free vring buffer; the
+ *  transport has no call to build the reply in place, so this is the one
+ *  copy made on the reply path.
+ */
+#define FXNN "RcmServer_reply_P"
+Int RcmServer_reply_P(RcmServer_Object *obj, RcmClient_Packet *packet)
+{
+#if USE_MESSAGEQCOPY == 0
+    MessageQ_Msg msgqMsg;
+#endif
+    Int status;
+
+
+#if USE_MESSAGEQCOPY
+    /* a direct call returns its header only, see RcmServer_msgCall_P */
+    if (packet->hdr.type == RcmServer_HDR_CALL) {
+        packet->hdr.type = RcmServer_HDR_CALL_RETURN;
+        packet->hdr.len = sizeof(RcmServer_CallMsg);
+        status = MessageQCopy_send(obj->dstProc, obj->replyAddr,
+                                   obj->localAddr, (Ptr)&packet->hdr,
+                                   sizeof(struct rpmsg_omx_hdr)
+                                   + sizeof(RcmServer_CallMsg));
+    }
+    else {
+        packet->hdr.type = OMX_RAW_MSG;
+        packet->hdr.len = PACKET_DATA_SIZE + packet->message.dataSize;
+        status = MessageQCopy_send(obj->dstProc, obj->replyAddr,
+                                   obj->localAddr, (Ptr)&packet->hdr,
+                                   PACKET_HDR_SIZE + packet->message.dataSize);
+    }
+#else
+    msgqMsg = &packet->msgqHeader;
+    status = MessageQ_put(MessageQ_getReplyQueue(msgqMsg), msgqMsg);
+#endif
+
+    if (status < 0) {
+        Log_error1(FXNN": unknown ipc error, 0x%x", (IArg)status);
+    }
+
+    return(status);
+}
+#undef FXNN
+
+
+/*
+ *  ======== RcmServer_returnMsg_P ========
+ *
+ *  Return a message to the client unprocessed, with the given status
+ *  code and result.
+ */
+Int RcmServer_returnMsg_P(RcmServer_Object *obj, RcmClient_Packet *packet,
+        UInt16 code, Int32 result)
+{
+    RcmServer_setStatusCode_I(packet, code);
+    packet->message.result = result;
+
+    return(RcmServer_reply_P(obj, packet));
+}
+
+
+/*
+ *  ======== RcmServer_errToStatus_I ========
+ *
+ *  Map an internal error code to the status code returned to the client.
+ */
+UInt16 RcmServer_errToStatus_I(Int rval)
+{
+    switch (rval) {
+        case RcmServer_E_InvalidFxnIdx:
+            return(RcmServer_Status_INVALID_FXN);
+
+        case RcmServer_E_InvalidBulk:
+            return(RcmServer_Status_INVALID_BULK);
+
+        case RcmServer_E_InvalidCall:
+            return(RcmServer_Status_INVALID_CALL);
+
+        case RcmServer_E_JobIdNotFound:
+            return(RcmServer_Status_JobNotFound);
+
+        case RcmServer_E_PoolIdNotFound:
+            return(RcmServer_Status_PoolNotFound);
+
+        default:
+            return(RcmServer_Status_Error);
+    }
+}
+
+
+/*
+ *  ======== RcmServer_msgExec_P ========
+ *
+ *  RcmClient_Desc_RCM_MSG: execute the function, reply with the result.
+ */
+Bool RcmServer_msgExec_P(RcmServer_Object *obj, RcmClient_Packet *packet)
+{
+    RcmClient_Message *rcmMsg = &packet->message;
+    Int rval;
+
+
+    rval = RcmServer_execMsg_I(obj, rcmMsg, packet->stamp);
+
+    if (rval < 0) {
+        RcmServer_setStatusCode_I(packet, RcmServer_errToStatus_I(rval));
+    }
+    else if (rcmMsg->result < 0) {
+        RcmServer_setStatusCode_I(packet, RcmServer_Status_MSG_FXN_ERR);
+    }
+    else {
+        RcmServer_setStatusCode_I(packet, RcmServer_Status_SUCCESS);
+    }
+
+    return(TRUE);
+}
+
+
+/*
+ *  ======== RcmServer_msgMulti_P ========
+ *
+ *  RcmClient_Desc_MULTI: execute all records, one reply carries the
+ *  results of all of them.
+ */
+Bool RcmServer_msgMulti_P(RcmServer_Object *obj, RcmClient_Packet *packet)
+{
+    Int rval;
+
+
+    rval = RcmServer_execMulti_P(obj, &packet->message, packet->stamp);
+
+    if (rval < 0) {
+        RcmServer_setStatusCode_I(packet, RcmServer_errToStatus_I(rval));
+    }
+    else if (rval > 0) {
+        RcmServer_setStatusCode_I(packet, RcmServer_Status_MSG_FXN_ERR);
+    }
+    else {
+        RcmServer_setStatusCode_I(packet, RcmServer_Status_SUCCESS);
+    }
+
+    return(TRUE);
+}
+
+
+/*
+ *  ======== RcmServer_msgBulk_P ========
+ *
+ *  RcmClient_Desc_BULK: execute the function on the referenced buffer,
+ *  the reply carries only the descriptor back.
+ */
+Bool RcmServer_msgBulk_P(RcmServer_Object *obj, RcmClient_Packet *packet)
+{
+    RcmClient_Message *rcmMsg = &packet->message;
+    Int rval;
+
+
+    rval = RcmServer_execBulk_P(obj, rcmMsg, packet->stamp);
+
+    if (rval < 0) {
+        RcmServer_setStatusCode_I(packet, RcmServer_errToStatus_I(rval));
+    }
+    else if (rcmMsg->result < 0) {
+        RcmServer_setStatusCode_I(packet, RcmServer_Status_MSG_FXN_ERR);
+    }
+    else {
+        RcmServer_setStatusCode_I(packet, RcmServer_Status_SUCCESS);
+    }
+
+    return(TRUE);
+}
+
+
+/*
+ *  ======== RcmServer_msgCmd_P ========
+ *
+ *  RcmClient_Desc_CMD: execute the function, the message is only
+ *  returned to the client if an error occurred.
+ */
+#define FXNN "RcmServer_msgCmd_P"
+Bool RcmServer_msgCmd_P(RcmServer_Object *obj, RcmClient_Packet *packet)
+{
+    RcmClient_Message *rcmMsg = &packet->message;
+    Int rval;
+
+
+    rval = RcmServer_execMsg_I(obj, rcmMsg, packet->stamp);
+
+    /* if all went well, free the message */
+    if ((rval >= 0) && (rcmMsg->result >= 0)) {
+#if USE_MESSAGEQCOPY == 0
+        rval = MessageQ_free(&packet->msgqHeader);
+
+        if (rval < 0) {
+            Log_error1(FXNN": MessageQ_free returned error %d", (IArg)rval);
+        }
+#endif
+        return(FALSE);
+    }
+
+    /* an error occurred, must return message to client */
+    if (rval < 0) {
+        RcmServer_setStatusCode_I(packet, RcmServer_errToStatus_I(rval));
+    }
+    else {
+        RcmServer_setStatusCode_I(packet, RcmServer_Status_MSG_FXN_ERR);
+    }
+
+    return(TRUE);
+}
+#undef FXNN
+
+
+/*
+ *  ======== RcmServer_msgDpc_P ========
+ *
+ *  RcmClient_Desc_DPC: reply first, then invoke the function with a
+ *  null context.
+ */
+Bool RcmServer_msgDpc_P(RcmServer_Object *obj, RcmClient_Packet *packet)
+{
+    RcmServer_MsgFxn fxn;
+    RcmServer_MsgCreateFxn createFxn = NULL;
+    Int rval;
+
+
+    rval = RcmServer_getFxnAddr_P(obj, packet->message.fxnIdx, &fxn,
+        &createFxn, NULL);
+
+    if (rval < 0) {
+        RcmServer_setStatusCode_I(packet, RcmServer_Status_SYMBOL_NOT_FOUND);
+    }
+
+    RcmServer_reply_P(obj, packet);
+
+    if (rval < 0) {
+        return(FALSE);
+    }
+
+#if USE_MESSAGEQCOPY
+    if (createFxn)  {
+         (*createFxn)(obj, 0, NULL);
+    }
+    else {
+         (*fxn)(0, NULL);
+    }
+#else
+    (*fxn)(0, NULL);
+#endif
+
+    return(FALSE);
+}
+
+
+/*
+ *  ======== RcmServer_msgSymIdx_P ========
+ *
+ *  RcmClient_Desc_SYM_IDX: look up a function index by name.
+ */
+Bool RcmServer_msgSymIdx_P(RcmServer_Object *obj, RcmClient_Packet *packet)
+{
+    RcmClient_Message *rcmMsg = &packet->message;
+    UInt32 fxnIdx;
+    Int rval;
+
 
-        case RcmClient_Desc_SYM_ADD:
-            break;
+    rval = RcmServer_getSymIdx_P(obj, (String)rcmMsg->data, &fxnIdx);
 
-        case RcmClient_Desc_SYM_IDX:
-            name = (String)rcmMsg->data;
-            rval = RcmServer_getSymIdx_P(obj, name, &fxnIdx);
+    if (rval < 0) {
+        RcmServer_setStatusCode_I(packet, RcmServer_Status_SYMBOL_NOT_FOUND);
+    }
+    else {
+        RcmServer_setStatusCode_I(packet, RcmServer_Status_SUCCESS);
+        rcmMsg->data[0] = fxnIdx;
+        rcmMsg->result = 0;
+    }
 
-            if (rval < 0) {
-                RcmServer_setStatusCode_I(
-                    packet, RcmServer_Status_SYMBOL_NOT_FOUND);
-            }
-            else {
-                RcmServer_setStatusCode_I(packet, RcmServer_Status_SUCCESS);
-                rcmMsg->data[0] = fxnIdx;
-                rcmMsg->result = 0;
-            }
+    return(TRUE);
+}
 
-#if USE_MESSAGEQCOPY
-            packet->hdr.type = OMX_RAW_MSG;
-            packet->hdr.len = PACKET_DATA_SIZE + packet->message.dataSize;
-            status = MessageQCopy_send(obj->dstProc, obj->replyAddr,
-                                 obj->localAddr, (Ptr)&packet->hdr,
-                                 PACKET_HDR_SIZE + packet->message.dataSize);
-#else
-            status = MessageQ_put(MessageQ_getReplyQueue(msgqMsg), msgqMsg);
-#endif
-            if (status < 0) {
-                Log_error1(FXNN": unknown ipc error, 0x%x", (IArg)status);
-            }
-            break;
 
-        case RcmClient_Desc_JOB_ACQ:
-            rval = RcmServer_acqJobId_P(obj, &jobId);
+/*
+ *  ======== RcmServer_msgJobAcq_P ========
+ *
+ *  RcmClient_Desc_JOB_ACQ: allocate a new job stream.
+ */
+Bool RcmServer_msgJobAcq_P(RcmServer_Object *obj, RcmClient_Packet *packet)
+{
+    RcmClient_Message *rcmMsg = &packet->message;
+    UInt16 jobId;
+    Int rval;
+
 
-            if (rval < 0) {
-                RcmServer_setStatusCode_I(packet, RcmServer_Status_Error);
-            }
-            else {
-                RcmServer_setStatusCode_I(packet, RcmServer_Status_SUCCESS);
-                *(UInt16 *)(&rcmMsg->data[0]) = jobId;
-                rcmMsg->result = 0;
-            }
+    rval = RcmServer_acqJobId_P(obj, &jobId);
 
-#if USE_MESSAGEQCOPY
-            packet->hdr.type = OMX_RAW_MSG;
-            packet->hdr.len = PACKET_DATA_SIZE + packet->message.dataSize;
-            status = MessageQCopy_send(obj->dstProc, obj->replyAddr,
-                                 obj->localAddr, (Ptr)&packet->hdr,
-                                 PACKET_HDR_SIZE + packet->message.dataSize);
-#else
-            status = MessageQ_put(MessageQ_getReplyQueue(msgqMsg), msgqMsg);
-#endif
-            if (status < 0) {
-                Log_error1(FXNN": unknown ipc error, 0x%x", (IArg)status);
-            }
-            break;
+    if (rval < 0) {
+        RcmServer_setStatusCode_I(packet, RcmServer_Status_Error);
+    }
+    else {
+        RcmServer_setStatusCode_I(packet, RcmServer_Status_SUCCESS);
+        *(UInt16 *)(&rcmMsg->data[0]) = jobId;
+        rcmMsg->result = 0;
+    }
 
-        case RcmClient_Desc_JOB_REL:
-            jobId = (UInt16)(rcmMsg->data[0]);
-            rval = RcmServer_relJobId_P(obj, jobId);
+    return(TRUE);
+}
 
-            if (rval < 0) {
-                switch (rval) {
-                    case RcmServer_E_JobIdNotFound:
-                        RcmServer_setStatusCode_I(
-                            packet, RcmServer_Status_JobNotFound);
-                        break;
-                    default:
-                        RcmServer_setStatusCode_I(
-                            packet, RcmServer_Status_Error);
-                        break;
-                }
-                rcmMsg->result = rval;
-            }
-            else {
-                RcmServer_setStatusCode_I(packet, RcmServer_Status_SUCCESS);
-                rcmMsg->result = 0;
-            }
 
-#if USE_MESSAGEQCOPY
-            packet->hdr.type = OMX_RAW_MSG;
-            packet->hdr.len = PACKET_DATA_SIZE + packet->message.dataSize;
-            status = MessageQCopy_send(obj->dstProc, obj->replyAddr,
-                                 obj->localAddr, (Ptr)&packet->hdr,
-                                 PACKET_HDR_SIZE + packet->message.dataSize);
-#else
-            status = MessageQ_put(MessageQ_getReplyQueue(msgqMsg), msgqMsg);
-#endif
-            if (status < 0) {
-                Log_error1(FXNN": unknown ipc error, 0x%x", (IArg)status);
-            }
-            break;
+/*
+ *  ======== RcmServer_msgJobRel_P ========
+ *
+ *  RcmClient_Desc_JOB_REL: release a job stream.
+ */
+Bool RcmServer_msgJobRel_P(RcmServer_Object *obj, RcmClient_Packet *packet)
+{
+    RcmClient_Message *rcmMsg = &packet->message;
+    Int rval;
 
-        default:
-            Log_error1(FXNN": unknown message type recieved, 0x%x",
-                (IArg)messageType);
-            break;
+
+    rval = RcmServer_relJobId_P(obj, (UInt16)(rcmMsg->data[0]));
+
+    if (rval < 0) {
+        RcmServer_setStatusCode_I(packet, RcmServer_errToStatus_I(rval));
+        rcmMsg->result = rval;
+    }
+    else {
+        RcmServer_setStatusCode_I(packet, RcmServer_Status_SUCCESS);
+        rcmMsg->result = 0;
     }
 
-    Log_print0(Diags_EXIT, "<-- "FXNN":");
+    return(TRUE);
 }
-#undef FXNN
 
 
 /*
@@ -2047,10 +3685,6 @@ Int RcmServer_relJobId_P(RcmServer_Object *obj, UInt16 jobId)
     List_Handle msgQueH;
     RcmClient_Packet *packet;
     RcmServer_JobStream *job;
-#if USE_MESSAGEQCOPY == 0
-    MessageQ_Msg msgqMsg;
-#endif
-    Int rval;
     Int status = RcmServer_S_SUCCESS;
 
 
@@ -2092,20 +3726,10 @@ Int RcmServer_relJobId_P(RcmServer_Object *obj, UInt16 jobId)
             (IArg)jobId, (IArg)packet);
 
         RcmServer_setStatusCode_I(packet, RcmServer_Status_Unprocessed);
-
+        RcmServer_reply_P(obj, packet);
 #if USE_MESSAGEQCOPY
-        packet->hdr.type = OMX_RAW_MSG;
-        packet->hdr.len = PACKET_DATA_SIZE + packet->message.dataSize;
-        rval = MessageQCopy_send(obj->dstProc, obj->replyAddr,
-                                 obj->localAddr, (Ptr)&packet->hdr,
-                                 PACKET_HDR_SIZE + packet->message.dataSize);
-#else
-        msgqMsg = &packet->msgqHeader;
-        rval = MessageQ_put(MessageQ_getReplyQueue(msgqMsg), msgqMsg);
+        RcmServer_freePacket_I(packet);
 #endif
-        if (rval < 0) {
-            Log_error1(FXNN": unknown ipc error, 0x%x", (IArg)rval);
-        }
     }
 
     /* finalize the job stream object */
@@ -2124,6 +3748,12 @@ leave:
 
 /*
  *  ======== RcmServer_serverThrFxn_P ========
+ *
+ *  The server threads take turns receiving on the endpoint. A thread
+ *  holds the receive gate until the message is either dispatched or known
+ *  to be independent of all others, so job stream messages are queued in
+ *  the order they were received. Decoding and in-band execution of
+ *  independent messages then proceed in parallel.
  */
 #define FXNN "RcmServer_serverThrFxn_P"
 Void RcmServer_serverThrFxn_P(IArg arg)
@@ -2133,13 +3763,15 @@ Void RcmServer_serverThrFxn_P(IArg arg)
 #if USE_MESSAGEQCOPY
     Char         recvBuf[MSGBUFFERSIZE];
     UInt16       len;
+    RcmClient_Packet *copy;
 #else
     MessageQ_Msg msgqMsg = NULL;
 #endif
+    GateThread_Handle recvGateH;
+    IArg key;
     Int rval;
     Bool running = TRUE;
     RcmServer_Object *obj = (RcmServer_Object *)arg;
-    Int dataSize;
 
 #if USE_MESSAGEQCOPY
     packet = (RcmClient_Packet *)&recvBuf[0];
@@ -2148,6 +3780,7 @@ Void RcmServer_serverThrFxn_P(IArg arg)
     Log_print1(Diags_ENTRY, "--> "FXNN": (arg=0x%x)", arg);
 
     Error_init(&eb);
+    recvGateH = GateThread_handle(&obj->recvGate);
 
     /* wait until ready to run */
     Semaphore_pend(obj->run, Semaphore_FOREVER, &eb);
@@ -2160,7 +3793,17 @@ Void RcmServer_serverThrFxn_P(IArg arg)
     while (running) {
         Log_print1(Diags_INFO,
             FXNN": waiting for message, thread=0x%x",
-            (IArg)(obj->serverThread));
+            (IArg)Thread_self(NULL));
+
+        /* wait for this thread's turn to receive */
+        key = GateThread_enter(recvGateH);
+
+        /* another server thread saw the shutdown or disconnect */
+        if (obj->shutdown) {
+            GateThread_leave(recvGateH, key);
+            running = FALSE;
+            continue;
+        }
 
         /* block until message arrives */
         do {
@@ -2182,7 +3825,8 @@ Void RcmServer_serverThrFxn_P(IArg arg)
             }
             Assert_isTrue((len <= MSGBUFFERSIZE), NULL);
             Assert_isTrue((packet->hdr.type == OMX_RAW_MSG) ||
-                          (packet->hdr.type == OMX_DISC_REQ) , NULL);
+                          (packet->hdr.type == OMX_DISC_REQ) ||
+                          (packet->hdr.type == RcmServer_HDR_CALL), NULL);
 
             if ((rval < 0) && (rval != MessageQCopy_E_UNBLOCKED)) {
 #else
@@ -2198,20 +3842,24 @@ Void RcmServer_serverThrFxn_P(IArg arg)
         } while ((msgqMsg == NULL) && !obj->shutdown);
 #endif
 
-        /* if shutdown, exit this thread */
+        /* if shutdown, exit this thread, the other server threads exit
+         * when they see the shutdown flag */
 #if USE_MESSAGEQCOPY
         if (obj->shutdown || packet->hdr.type == OMX_DISC_REQ) {
+            obj->shutdown = TRUE;
+            GateThread_leave(recvGateH, key);
             running = FALSE;
             Log_print1(Diags_INFO,
-                FXNN": terminating, thread=0x%x", (IArg)(obj->serverThread));
+                FXNN": terminating, thread=0x%x", (IArg)Thread_self(NULL));
             continue;
         }
 #else
         if (obj->shutdown) {
             running = FALSE;
             Log_print1(Diags_INFO,
-                FXNN": terminating, thread=0x%x", (IArg)(obj->serverThread));
+                FXNN": terminating, thread=0x%x", (IArg)Thread_self(NULL));
             if (msgqMsg == NULL ) {
+                GateThread_leave(recvGateH, key);
                 continue;
             }
         }
@@ -2219,71 +3867,73 @@ Void RcmServer_serverThrFxn_P(IArg arg)
 
 #if USE_MESSAGEQCOPY == 0
         packet = (RcmClient_Packet *)msgqMsg;
+        msgqMsg = NULL;
+#endif
+
+        /* timestamp used for the function profile queue wait time */
+        if (obj->profile) {
+            packet->stamp = Timestamp_get32();
+        }
+
+#if USE_MESSAGEQCOPY
+        /* direct calls are independent of all other messages */
+        if (packet->hdr.type == RcmServer_HDR_CALL) {
+            GateThread_leave(recvGateH, key);
+            RcmServer_msgCall_P(obj, packet, len);
+            continue;
+        }
 #endif
 
         Log_print2(Diags_INFO,
             FXNN": message received, thread=0x%x packet=0x%x",
-            (IArg)(obj->serverThread), (IArg)packet);
+            (IArg)Thread_self(NULL), (IArg)packet);
 
-        if ((packet->message.poolId == RcmClient_DEFAULTPOOLID)
-            && ((obj->poolMap[0])[0].count == 0)) {
+        /* with one server thread, job stream order is the receive order */
+        if (RcmServer_inBand_I(obj, packet) && ((obj->readers == 1) ||
+            (packet->message.jobId == RcmClient_DISCRETEJOBID))) {
+
+            GateThread_leave(recvGateH, key);
 
             /* in-band (server thread) message processing */
             RcmServer_process_P(obj, packet);
         }
         else {
-            /* out-of-band (worker thread) message processing */
-            rval = RcmServer_dispatch_P(obj, packet);
+            /* out-of-band (worker thread) message processing, or an
+             * in-band job stream message which must wait its turn */
+#if USE_MESSAGEQCOPY
+            /* receive buffer is reused, worker needs its own copy */
+            copy = RcmServer_copyPacket_P(packet, len);
 
-            /* if error, message was not dispatched; must return to client */
-            if (rval < 0) {
-                switch (rval) {
-                    case RcmServer_E_JobIdNotFound:
-                        RcmServer_setStatusCode_I(
-                            packet, RcmServer_Status_JobNotFound);
-                        break;
-
-                    case RcmServer_E_PoolIdNotFound:
-                        RcmServer_setStatusCode_I(
-                            packet, RcmServer_Status_PoolNotFound);
-                        break;
-
-                    default:
-                        RcmServer_setStatusCode_I(
-                            packet, RcmServer_Status_Error);
-                        break;
-                }
-                packet->message.result = rval;
+            if (copy == NULL) {
+                rval = RcmServer_E_NOMEMORY;
+            }
+            else {
+                rval = RcmServer_dispatch_P(obj, copy);
 
-                /* return the message to the client */
-#if USE_MESSAGEQCOPY
-#if 0
-                System_printf("RcmServer_serverThrFxn_P: "
-                              "Sending response from: %d to: %d\n",
-                              obj->localAddr, obj->replyAddr);
-                System_printf("sending: %d + %d\n", PACKET_HDR_SIZE,
-                              packet->message.dataSize);
-#endif
-                packet->hdr.type = OMX_RAW_MSG;
                 if (rval < 0) {
-                    packet->hdr.len = sizeof(UInt32);
-                    packet->desc = 0x4142;
-                    packet->msgId = 0x0044;
-                    dataSize = sizeof(struct rpmsg_omx_hdr) + sizeof(UInt32);
-                }
-                else {
-                    packet->hdr.len = PACKET_DATA_SIZE +
-                        packet->message.dataSize;
-                    dataSize = PACKET_HDR_SIZE + packet->message.dataSize;
+                    RcmServer_freePacket_I(copy);
                 }
-                rval = MessageQCopy_send(obj->dstProc, obj->replyAddr,
-                                 obj->localAddr, (Ptr)&packet->hdr, dataSize);
+            }
+            GateThread_leave(recvGateH, key);
+
+            /* this thread owns the job stream, run it */
+            if (rval == RcmServer_S_JobInBand) {
+                RcmServer_runJob_P(obj, copy);
+            }
 #else
-                rval = MessageQ_put(MessageQ_getReplyQueue(msgqMsg), msgqMsg);
+            rval = RcmServer_dispatch_P(obj, packet);
+            GateThread_leave(recvGateH, key);
+
+            /* this thread owns the job stream, run it */
+            if (rval == RcmServer_S_JobInBand) {
+                RcmServer_runJob_P(obj, packet);
+            }
 #endif
-                if (rval < 0) {
-                    Log_error1(FXNN": unknown ipc error, 0x%x", (IArg)rval);
-                }
+
+            /* if error, message was not dispatched; must return to client */
+            if (rval < 0) {
+                RcmServer_returnMsg_P(obj, packet,
+                    RcmServer_errToStatus_I(rval), rval);
             }
         }
     }
@@ -2295,6 +3945,166 @@ Void RcmServer_serverThrFxn_P(IArg arg)
 #undef FXNN
 
 
+/*
+ *  ======== RcmServer_inBand_I ========
+ *
+ *  Return TRUE if the message runs on the server threads.
+ */
+Bool RcmServer_inBand_I(RcmServer_Object *obj, RcmClient_Packet *packet)
+{
+    return((packet->message.poolId == RcmClient_DEFAULTPOOLID)
+        && ((obj->poolMap[0])[0].count == 0)
+        && ((obj->poolMap[0])[0].shared == NULL));
+}
+
+
+/*
+ *  ======== RcmServer_nextJobMsg_P ========
+ *
+ *  Called when a job stream message has finished running. Queue up the
+ *  next message of the job stream on its worker pool. If the next message
+ *  is in-band, it is returned instead and the caller must run it.
+ */
+#define FXNN "RcmServer_nextJobMsg_P"
+RcmClient_Packet *RcmServer_nextJobMsg_P(RcmServer_Object *obj, UInt16 jobId)
+{
+    Error_Block eb;
+    GateThread_Handle gateH;
+    IArg key;
+    List_Elem *elem;
+    List_Handle listH;
+    RcmServer_JobStream *job;
+    RcmServer_ThreadPool *pool;
+    RcmClient_Packet *packet = NULL;
+    Int rval;
+
+
+    Error_init(&eb);
+
+    /* must protect job list while searching it */
+    gateH = GateThread_handle(&obj->gate);
+    key = GateThread_enter(gateH);
+
+    /* find the job object in the list */
+    elem = NULL;
+    while ((elem = List_next(obj->jobList, elem)) != NULL) {
+        job = (RcmServer_JobStream *)elem;
+        if (job->jobId == jobId) {
+            break;
+        }
+    }
+
+    /* if job object not found, it is not an error */
+    if (elem == NULL) {
+        GateThread_leave(gateH, key);
+        return(NULL);
+    }
+
+    /* found the job object */
+    listH = List_handle(&job->msgQue);
+
+    /* get next job message and either return it or queue it */
+    do {
+        elem = List_get(listH);
+
+        if (elem == NULL) {
+            job->empty = TRUE;  /* no more messages */
+            break;
+        }
+
+        /* get target pool id */
+        packet = (RcmClient_Packet *)elem;
+        rval = RcmServer_getPool_P(obj, packet, &pool);
+
+        /* if error, return the message to the client */
+        if (rval < 0) {
+            RcmServer_returnMsg_P(obj, packet,
+                RcmServer_errToStatus_I(rval), rval);
+#if USE_MESSAGEQCOPY
+            RcmServer_freePacket_I(packet);
+#endif
+            packet = NULL;
+        }
+
+        /* in-band message, the caller runs it */
+        else if (RcmServer_inBand_I(obj, packet)) {
+            break;
+        }
+
+        /* packet is valid, queue it in the corresponding pool's
+         * ready queue */
+        else {
+            RcmServer_putReady_I(pool, packet);
+            packet = NULL;
+            Semaphore_post(pool->sem, &eb);
+
+            if (Error_check(&eb)) {
+                Log_error0(FXNN": semaphore post failed");
+            }
+        }
+
+    } while (rval < 0);
+
+    GateThread_leave(gateH, key);
+
+    return(packet);
+}
+#undef FXNN
+
+
+/*
+ *  ======== RcmServer_runJob_P ========
+ *
+ *  Run a job stream message, and the in-band messages which were queued
+ *  on the job stream behind it.
+ */
+Void RcmServer_runJob_P(RcmServer_Object *obj, RcmClient_Packet *packet)
+{
+    UInt16 jobId = packet->message.jobId;
+
+
+    do {
+        RcmServer_process_P(obj, packet);
+#if USE_MESSAGEQCOPY
+        RcmServer_freePacket_I(packet);
+#endif
+    } while ((packet = RcmServer_nextJobMsg_P(obj, jobId)) != NULL);
+}
+
+
+/*
+ *  ======== RcmServer_profile_I ========
+ *
+ *  Account one call of the function in the given slot. The stamp is the
+ *  time at which the server thread received the message. Only called
+ *  when the server was created with RcmServer_Params.profile set.
+ */
+Void RcmServer_profile_I(RcmServer_Object *obj, RcmServer_FxnTabElem *slot,
+        UInt32 stamp, UInt32 start, UInt32 end)
+{
+    GateThread_Handle gateH;
+    IArg key;
+    RcmServer_FxnStats *stats = &slot->stats;
+    UInt32 ticks = end - start;
+
+
+    gateH = GateThread_handle(&obj->gate);
+    key = GateThread_enter(gateH);
+
+    if ((stats->calls == 0) || (ticks < stats->minTicks)) {
+        stats->minTicks = ticks;
+    }
+    if (ticks > stats->maxTicks) {
+        stats->maxTicks = ticks;
+    }
+    stats->calls++;
+    stats->execTicks += ticks;
+    stats->waitTicks += (start - stamp);
+
+    GateThread_leave(gateH, key);
+}
+
+
 /*
  *  ======== RcmServer_setStatusCode_I ========
  */
@@ -2318,29 +4128,30 @@ Void RcmServer_workerThrFxn_P(IArg arg)
 {
     Error_Block eb;
     RcmClient_Packet *packet;
-    List_Elem *elem;
-    List_Handle listH;
-    List_Handle readyQueueH;
     UInt16 jobId;
-    GateThread_Handle gateH;
-    IArg key;
-    RcmServer_ThreadPool *pool;
-    RcmServer_JobStream *job;
+    RcmServer_ThreadPool *member;
+    RcmServer_Object *server;
     RcmServer_WorkerThread *obj;
     Bool running;
-    Int rval;
 
 
     Log_print1(Diags_ENTRY, "--> "FXNN": (arg=0x%x)", arg);
 
     Error_init(&eb);
     obj = (RcmServer_WorkerThread *)arg;
-    readyQueueH = List_handle(&obj->pool->readyQueue);
     packet = NULL;
+    member = NULL;
     running = TRUE;
 
     /* main processing loop */
     while (running) {
+
+        /* done with the previous message of a shared pool member */
+        if (member != NULL) {
+            RcmServer_releaseShared_I(member);
+            member = NULL;
+        }
+
         Log_print1(Diags_INFO,
             FXNN": waiting for job, thread=0x%x", (IArg)(obj->thread));
 
@@ -2361,9 +4172,19 @@ Void RcmServer_workerThrFxn_P(IArg arg)
             continue;
         }
 
-        /* get next message from ready queue */
+        /* get highest priority message from ready queue */
         if (packet == NULL) {
-            packet = (RcmClient_Packet *)List_get(readyQueueH);
+            if (obj->shared != NULL) {
+                packet = RcmServer_getShared_P(obj->shared, &member);
+
+                /* a detached instance may have left its posts behind */
+                if (packet == NULL) {
+                    continue;
+                }
+            }
+            else {
+                packet = RcmServer_getReady_P(obj->pool);
+            }
         }
 
         if (packet == NULL) {
@@ -2372,6 +4193,9 @@ Void RcmServer_workerThrFxn_P(IArg arg)
             continue;
         }
 
+        /* shared workers run messages for many server instances */
+        server = (member != NULL ? member->server : obj->server);
+
         Log_print2(Diags_INFO, FXNN": job received, thread=0x%x packet=0x%x",
             (IArg)obj->thread, (IArg)packet);
 
@@ -2379,111 +4203,48 @@ Void RcmServer_workerThrFxn_P(IArg arg)
         jobId = packet->message.jobId;
 
         /* process the message */
-        RcmServer_process_P(obj->server, packet);
+        RcmServer_process_P(server, packet);
+#if USE_MESSAGEQCOPY
+        RcmServer_freePacket_I(packet);
+#endif
         packet = NULL;
 
         /* If this worker thread just finished processing a job message,
-         * queue up the next message for this job id. As an optimization,
-         * if the message is addressed to this worker's pool, then don't
-         * signal the semaphore, just get the next message from the queue
-         * and processes it. This keeps the current thread running instead
-         * of switching to another thread.
+         * queue up the next message for this job id. In-band messages of
+         * the job stream are run right here, the server threads are not
+         * waiting for them.
          */
-        if (jobId != RcmClient_DISCRETEJOBID) {
-
-            /* must protect job list while searching it */
-            gateH = GateThread_handle(&obj->server->gate);
-            key = GateThread_enter(gateH);
-
-            /* find the job object in the list */
-            elem = NULL;
-            while ((elem = List_next(obj->server->jobList, elem)) != NULL) {
-                job = (RcmServer_JobStream *)elem;
-                if (job->jobId == jobId) {
-                    break;
-                }
-            }
-
-            /* if job object not found, it is not an error */
-            if (elem == NULL) {
-                GateThread_leave(gateH, key);
-                continue;
-            }
-
-            /* found the job object */
-            listH = List_handle(&job->msgQue);
-
-            /* get next job message and either process it or queue it */
-            do {
-                elem = List_get(listH);
+        if ((jobId != RcmClient_DISCRETEJOBID) &&
+            ((packet = RcmServer_nextJobMsg_P(server, jobId)) != NULL)) {
+            RcmServer_runJob_P(server, packet);
+            packet = NULL;
+        }
+    }  /* while (running) */
 
-                if (elem == NULL) {
-                    job->empty = TRUE;  /* no more messages */
-                    break;
-                }
-                else {
-                    /* get target pool id */
-                    packet = (RcmClient_Packet *)elem;
-                    rval = RcmServer_getPool_P(obj->server, packet, &pool);
-
-                    /* if error, return the message to the client */
-                    if (rval < 0) {
-                        switch (rval) {
-                            case RcmServer_E_PoolIdNotFound:
-                                RcmServer_setStatusCode_I(
-                                    packet, RcmServer_Status_PoolNotFound);
-                                break;
-
-                            default:
-                                RcmServer_setStatusCode_I(
-                                    packet, RcmServer_Status_Error);
-                                break;
-                        }
-                        packet->message.result = rval;
+    Log_print0(Diags_EXIT, "<-- "FXNN":");
+}
+#undef FXNN
 
-#if USE_MESSAGEQCOPY
-                        packet->hdr.type = OMX_RAW_MSG;
-                        packet->hdr.len = PACKET_DATA_SIZE + packet->message.dataSize;
-                        rval = MessageQCopy_send(
-                                 (obj->server)->dstProc,
-                                 (obj->server)->replyAddr,
-                                 (obj->server)->localAddr, (Ptr)&packet->hdr,
-                                 PACKET_HDR_SIZE + packet->message.dataSize);
-#else
-                        rval = MessageQ_put(
-                            MessageQ_getReplyQueue(&packet->msgqHeader),
-                            &packet->msgqHeader);
-#endif
-                        if (rval < 0) {
-                            Log_error1(
-                                FXNN": unknown ipc error, 0x%x", (IArg)rval);
-                        }
-                    }
-                    /* packet is valid, queue it in the corresponding pool's
-                     * ready queue */
-                    else {
-                        listH = List_handle(&pool->readyQueue);
-                        List_put(listH, elem);
-                        packet = NULL;
-                        Semaphore_post(pool->sem, &eb);
-
-                        if (Error_check(&eb)) {
-                            Log_error0(FXNN": semaphore post failed");
-                        }
-                    }
 
-                    /* loop around and wait to be run again */
-                }
+/*
+ *  ======== RcmServer_getQueueDepth ========
+ *
+ *  The counters are read without taking the gates that protect them,
+ *  the sum is only a snapshot.
+ */
+UInt RcmServer_getQueueDepth(RcmServer_Object *obj)
+{
+    RcmServer_ThreadPool *poolAry = obj->poolMap[0];
+    UInt depth = 0;
+    Int i;
 
-            } while (rval < 0);
 
-            GateThread_leave(gateH, key);
-        }
-    }  /* while (running) */
+    for (i = 0; i < obj->poolMap0Len; i++) {
+        depth += poolAry[i].queued;
+    }
 
-    Log_print0(Diags_EXIT, "<-- "FXNN":");
+    return(depth);
 }
-#undef FXNN
 
 
 /*
@@ -127,9 +127,24 @@ extern "C" {
  */
 #define RcmServer_E_SYMBOLTABLEFULL (-5)
 
+/*!
+ *  @brief The shared worker pool is still in use
+ *
+ *  A shared worker pool cannot be deleted while server instances are
+ *  attached to it. Delete those instances first.
+ */
+#define RcmServer_E_POOLBUSY (-6)
+
 
 // -------- constants and types --------
 
+/*!
+ *  @brief Maximum number of server threads per instance
+ *
+ *  @sa RcmServer_Params.readers
+ */
+#define RcmServer_MAX_READERS (4)
+
 /*!
  *  @brief Remote function type
  *
@@ -157,6 +172,15 @@ typedef Int32 (*RcmServer_MsgFxn)(UInt32, UInt32 *);
 typedef Int32 (*RcmServer_MsgCreateFxn)(Void *, UInt32, UInt32 *);
 #endif
 
+/*!
+ *  @brief Cache maintenance function
+ *
+ *  Called with the local address and size of a buffer passed by reference
+ *  in an RcmClient_Desc_BULK message. See RcmServer_Params.cacheInvFxn
+ *  and RcmServer_Params.cacheWbFxn.
+ */
+typedef Void (*RcmServer_CacheFxn)(Ptr, SizeT);
+
 
 
 /*!
@@ -315,6 +339,18 @@ typedef struct {
      */
     String stackSeg;
 
+    /*!
+     *  @brief Number of server threads, 1 to RcmServer_MAX_READERS.
+     *
+     *  With more than one server thread, the threads take turns receiving
+     *  from the server endpoint and then decode, dispatch and run in-band
+     *  messages in parallel. Messages of a job stream still run one at a
+     *  time, in the order they were received; only independent messages
+     *  and independent job streams run concurrently. All server threads
+     *  use the priority and stack attributes above.
+     */
+    UInt readers;
+
     /*!
      *  @brief The default thread pool used for anonymous messages.
      */
@@ -328,6 +364,10 @@ typedef struct {
      *  cannot be removed with a call to RcmServer_deletePool(). However,
      *  worker threads may be created or deleted at runtime.
      *
+     *  If a shared worker pool with the same name has been created with
+     *  RcmServer_createSharedPool(), the server attaches to it instead of
+     *  creating its own threads, and the remaining descriptor fields are
+     *  ignored. The same applies to the default pool.
      */
     RcmServer_ThreadPoolDescAry workerPools;
 
@@ -365,6 +405,34 @@ typedef struct {
      */
     RcmServer_FxnDescAry fxns;
 
+    /*!
+     *  @brief Cache invalidate function for by-reference buffers
+     *
+     *  Called on a bulk buffer marked RcmClient_BULK_IN before the
+     *  function reads it. The default invalidates the data caches of
+     *  the local processor. Set to NULL if the buffer is not cached.
+     */
+    RcmServer_CacheFxn cacheInvFxn;
+
+    /*!
+     *  @brief Cache write-back function for by-reference buffers
+     *
+     *  Called on a bulk buffer marked RcmClient_BULK_OUT after the
+     *  function has written it. The default writes back the data caches
+     *  of the local processor. Set to NULL if the buffer is not cached.
+     */
+    RcmServer_CacheFxn cacheWbFxn;
+
+    /*!
+     *  @brief Keep the per-function profile
+     *
+     *  When set, the server timestamps every message and accounts each
+     *  function call under the instance gate; the profile is read through
+     *  RcmServer_FXNIDX_STATS. Off by default, as it adds to the cost of
+     *  every call. When off, the profile reads back as all zeros.
+     */
+    Bool profile;
+
 } RcmServer_Params;
 
 /*!
@@ -385,7 +453,7 @@ typedef struct {
 #else
     Ptr                 _f3;
 #endif
-    Ptr                 _f4;
+    Ptr                 _f4[RcmServer_MAX_READERS];
     struct {
         Int     _f1;
         Ptr     _f2;
@@ -397,6 +465,11 @@ typedef struct {
     Int                 _f10;
     Ptr                 _f11[4];
     Ptr                 _f12;
+    Ptr                 _f13;
+    Ptr                 _f14;
+    GateThread_Struct   _f15;
+    UInt                _f16;
+    Bool                _f17;
 } RcmServer_Struct;
 
 
@@ -491,6 +564,30 @@ Int RcmServer_create(
         RcmServer_Handle *      handle
     );
 
+/*
+ *  ======== RcmServer_createSharedPool ========
+ */
+/*!
+ *  @brief Create a worker pool shared by all server instances
+ *
+ *  Server instances which name this pool in their worker pool (or default
+ *  pool) create params attach to it instead of creating threads of their
+ *  own. The pool's threads serve the attached instances in turn, so a busy
+ *  instance cannot starve the others. Within that rotation, higher priority
+ *  messages are always served first.
+ *
+ *  Create the pool before the server instances which use it.
+ *
+ *  @param[in] desc The pool descriptor. The name is required.
+ *
+ *  @retval RcmServer_S_SUCCESS
+ *  @retval RcmServer_E_FAIL
+ *  @retval RcmServer_E_NOMEMORY
+ */
+Int RcmServer_createSharedPool(
+        const RcmServer_ThreadPoolDesc *desc
+    );
+
 /*
  *  ======== RcmServer_delete ========
  */
@@ -503,6 +600,22 @@ Int RcmServer_delete(
         RcmServer_Handle *      handlePtr
     );
 
+/*
+ *  ======== RcmServer_deleteSharedPool ========
+ */
+/*!
+ *  @brief Delete a shared worker pool
+ *
+ *  @param[in] name The name of the pool.
+ *
+ *  @retval RcmServer_S_SUCCESS
+ *  @retval RcmServer_E_FAIL
+ *  @retval RcmServer_E_POOLBUSY
+ */
+Int RcmServer_deleteSharedPool(
+        String                  name
+    );
+
 /*
  *  ======== RcmServer_destruct ========
  */
@@ -592,6 +705,25 @@ Int RcmServer_start(
         RcmServer_Handle        handle
     );
 
+/*
+ *  ======== RcmServer_getQueueDepth ========
+ */
+/*!
+ *  @brief Get the number of messages waiting for a worker thread
+ *
+ *  Counts the messages on the ready queues of all the worker pools of
+ *  the instance, which have not been taken by a worker yet. The value
+ *  is a snapshot meant for load reporting; it may be stale by the time
+ *  it is returned.
+ *
+ *  @param[in] handle Handle to an instance object.
+ *
+ *  @retval Number of queued messages.
+ */
+UInt RcmServer_getQueueDepth(
+        RcmServer_Handle        handle
+    );
+
 
 #if USE_MESSAGEQCOPY
 /*
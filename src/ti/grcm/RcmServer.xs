@@ -62,6 +62,7 @@ function module$use()
     xdc.useModule('xdc.runtime.knl.Sync');
     xdc.useModule('xdc.runtime.knl.SyncSemThread');
     xdc.useModule('xdc.runtime.knl.Thread');
+    xdc.useModule('ti.trace.SysMin');
 
     if (Settings.IpcSupport_ti_sdo_ipc == Settings.ipc) {
         xdc.useModule('ti.sdo.utils.List');
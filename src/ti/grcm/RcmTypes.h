@@ -65,7 +65,7 @@
  *
  *  Bits    Description
  *  --------------------------------------------------------------------
- *  [15:12] reserved
+ *  [15:12] message priority, 0 = normal (lowest)
  *  [11:8]  message type
  *  [7:0]   client protocol version
  *
@@ -87,8 +87,12 @@
 #define RcmClient_Desc_CMD        0x5       // cmd message (one-way)
 #define RcmClient_Desc_JOB_ACQ    0x6       // acquire a job id
 #define RcmClient_Desc_JOB_REL    0x7       // release a job id
+#define RcmClient_Desc_MULTI      0x8       // batched exec message
+#define RcmClient_Desc_BULK       0x9       // exec with by-reference payload
 #define RcmClient_Desc_TYPE_MASK  0x0F00    // field mask
 #define RcmClient_Desc_TYPE_SHIFT 8         // field shift width
+#define RcmClient_Desc_PRI_MASK   0xF000    // priority field mask
+#define RcmClient_Desc_PRI_SHIFT  12        // priority field shift width
 
 /* server status codes must be 0 - 15, it has to fit in a 4-bit field */
 #define RcmServer_Status_SUCCESS          ((UInt16)0) // success
@@ -100,6 +104,8 @@
 #define RcmServer_Status_Unprocessed      ((UInt16)6) // unprocessed message
 #define RcmServer_Status_JobNotFound      ((UInt16)7) // job id not found
 #define RcmServer_Status_PoolNotFound     ((UInt16)8) // pool id not found
+#define RcmServer_Status_INVALID_BULK     ((UInt16)9) // bad bulk buffer
+#define RcmServer_Status_INVALID_CALL     ((UInt16)10) // bad call message
 
 /* the packet structure (actual message send to server) */
 
@@ -116,6 +122,7 @@ struct rpmsg_omx_hdr {
 typedef struct {
     Bits32             reserved0; // reserved for List.elem->next
     Bits32             reserved1; // reserved for List.elem->prev
+    UInt32             stamp;     // local only, receive timestamp
     struct rpmsg_omx_hdr hdr;
     UInt16             desc;      // protocol, descriptor, status
     UInt16             msgId;     // message id
@@ -124,9 +131,10 @@ typedef struct {
 
 /*
  * Defined to equal packed structure size received on the host.
- * Strips off the first two ListElem fields and the .data[1] field in .message
+ * Strips off the first two ListElem fields, the stamp field and the .data[1]
+ * field in .message
  */
-#define PACKET_HDR_SIZE  (sizeof(RcmClient_Packet) - 3 * sizeof(UInt32))
+#define PACKET_HDR_SIZE  (sizeof(RcmClient_Packet) - 4 * sizeof(UInt32))
 #define PACKET_DATA_SIZE (PACKET_HDR_SIZE - sizeof(struct rpmsg_omx_hdr))
 
 /* To test on BIOS side only, uncomment and rebuild anything that
@@ -137,6 +145,7 @@ typedef struct {
 #else
 typedef struct {
     MessageQ_MsgHeader msgqHeader;  // MessageQ header (8 words)
+    UInt32 stamp;                   // receive timestamp
     UInt16 desc;                    // protocol, descriptor, status
     UInt16 msgId;                   // message id
     RcmClient_Message message;      // client message body (5 words + payload)
@@ -144,6 +153,179 @@ typedef struct {
 
 #endif
 
+/*
+ *  ======== RcmClient_MultiRec ========
+ *
+ *  Payload layout of an RcmClient_Desc_MULTI message. The message fxnIdx
+ *  field is ignored. message.data[0] is the map info word which the
+ *  rpmsg_omx driver reads from every message, it must be 0 (no buffers to
+ *  map). message.data[1] holds the record count, followed by that many
+ *  records packed back-to-back. Each record's data is padded to a word
+ *  boundary. On return, each record's result field holds the return value
+ *  of its function and message.result holds the number of records which
+ *  were executed.
+ *
+ *  Word    Description
+ *  --------------------------------------------------------------------
+ *  0       map info (0)
+ *  1       record count (N)
+ *  2       record[0].fxnIdx
+ *  3       record[0].result
+ *  4       record[0].dataSize (in bytes)
+ *  5..     record[0].data
+ *  ...     record[1] .. record[N-1]
+ */
+typedef struct {
+    UInt32              fxnIdx;     // function index
+    Int32               result;     // function return value
+    UInt32              dataSize;   // size of data in bytes
+    UInt32              data[1];    // function payload
+} RcmClient_MultiRec;
+
+/* record size without the .data[1] field */
+#define RcmClient_MULTIREC_HDR_SIZE (3 * sizeof(UInt32))
+
+/* map info and record count words ahead of the first record */
+#define RcmClient_MULTI_HDR_SIZE (2 * sizeof(UInt32))
+
+/*
+ *  ======== RcmClient_BulkDesc ========
+ *
+ *  Payload of an RcmClient_Desc_BULK message. Instead of carrying the
+ *  function arguments in the message, the descriptor references a buffer
+ *  in one of the shared carveouts (e.g. IPU_MEM_IOBUFS or IPU_MEM_IPC_DATA).
+ *  The address is a device address, or a physical address if the
+ *  RcmClient_BULK_PHYS flag is set. The server validates the whole range
+ *  against the resource table through IpcMemory and calls the function
+ *  with (size, buffer) as if the buffer had been sent in the message.
+ *
+ *  RcmClient_BULK_IN: the server reads the buffer, its cache lines are
+ *  invalidated before the function is called.
+ *
+ *  RcmClient_BULK_OUT: the server writes the buffer, its cache lines are
+ *  written back after the function returns.
+ *
+ *  Only the descriptor travels back in the reply; message.result holds the
+ *  function's return value.
+ */
+typedef struct {
+    UInt32              addr;       // buffer device (or physical) address
+    UInt32              size;       // buffer size in bytes
+    UInt32              flags;      // RcmClient_BULK_* flags
+} RcmClient_BulkDesc;
+
+#define RcmClient_BULK_IN       0x1 // buffer is read by the server
+#define RcmClient_BULK_OUT      0x2 // buffer is written by the server
+#define RcmClient_BULK_PHYS     0x4 // addr is a physical address
+
+/*
+ *  ======== RcmServer_CallMsg ========
+ *
+ *  Direct call message. It is sent with the rpmsg header type
+ *  RcmServer_HDR_CALL in place of OMX_RAW_MSG, and replaces the RCM
+ *  packet (descriptor, message id and the five word RcmClient_Message)
+ *  with a three word header. The header is followed by numParams
+ *  parameter descriptors, then by numXlts pointer translations.
+ *
+ *  Each parameter descriptor holds the parameter type and size, and the
+ *  parameter data:
+ *
+ *  RcmServer_PARAM_VALUE: data is passed to the function as is.
+ *
+ *  RcmServer_PARAM_IN, _OUT: data is the physical address of a buffer of
+ *  size bytes in a shared carveout. It is translated to the local address
+ *  through IpcMemory and validated as for RcmClient_Desc_BULK; IN buffers
+ *  are invalidated before the call, OUT buffers written back after it.
+ *
+ *  A translation names a buffer parameter and the byte offset of a
+ *  physical address stored in that buffer, e.g. a pointer member of a
+ *  structure. The address is replaced by its local address for the call
+ *  and restored afterwards.
+ *
+ *  The function runs on the server thread, and is called with
+ *  (numParams * 8, params) where params holds a (size, data) pair per
+ *  parameter, data being the local address for buffers (the OmapRpc
+ *  parameter layout). Only the header travels back, with the rpmsg header
+ *  type RcmServer_HDR_CALL_RETURN and an RcmServer_Status_* code in the
+ *  rpmsg header flags; result holds the return value of the function.
+ *
+ *  Word    Description
+ *  --------------------------------------------------------------------
+ *  0       [31:24] numXlts, [23:16] numParams, [15:0] msgId
+ *  1       fxnIdx
+ *  2       result (out)
+ *  3..     params[numParams] (2 words each), xlts[numXlts] (1 word each)
+ */
+#define RcmServer_HDR_CALL          11  // rpmsg header type of a call
+#define RcmServer_HDR_CALL_RETURN   12  // rpmsg header type of its reply
+
+#define RcmServer_PARAM_VALUE   0x0 // scalar value
+#define RcmServer_PARAM_IN      0x1 // buffer read by the function
+#define RcmServer_PARAM_OUT     0x2 // buffer written by the function
+
+#define RcmServer_PARAM_DESC(type, size) (((type) << 28) | ((size) & 0x0FFFFFFF))
+#define RcmServer_PARAM_TYPE(desc)  ((desc) >> 28)
+#define RcmServer_PARAM_SIZE(desc)  ((desc) & 0x0FFFFFFF)
+
+#define RcmServer_CALL_MAX_PARAMS   10  // max parameters of a call
+#define RcmServer_CALL_MAX_XLTS     16  // max pointer translations
+
+typedef struct {
+    UInt32              desc;       // [31:28] type, [27:0] size in bytes
+    UInt32              data;       // value, or buffer physical address
+} RcmServer_CallParam;
+
+typedef struct {
+    UInt16              index;      // parameter holding the pointer
+    UInt16              offset;     // byte offset of the pointer in it
+} RcmServer_CallXlt;
+
+typedef struct {
+    UInt16              msgId;      // message id, returned as is
+    UInt8               numParams;  // number of parameters
+    UInt8               numXlts;    // number of translations
+    UInt32              fxnIdx;     // function index
+    Int32               result;     // function return value
+} RcmServer_CallMsg;
+
+/*
+ *  ======== RcmServer_FXNIDX_STATS ========
+ *
+ *  Reserved static function index which returns the server's per-function
+ *  profile instead of calling a function. The request carries an
+ *  RcmServer_StatsHdr with the index of the first entry to return. The
+ *  reply fills the message payload with the header followed by as many
+ *  RcmServer_StatsRec entries as fit in message.dataSize. A client pages
+ *  through the table by advancing 'first' until it reaches 'total'.
+ *
+ *  All tick counts are in Timestamp units; 'freq' is the Timestamp
+ *  frequency in Hz. The wait time is measured from the moment the server
+ *  thread received the message until the function started executing.
+ *  The counts stay zero unless the server was created with
+ *  RcmServer_Params.profile set.
+ */
+#define RcmServer_FXNIDX_STATS  (0x8000FFFF)
+#define RcmServer_STATS_NAMELEN 16
+
+typedef struct {
+    UInt32              first;      // in: index of first entry to return
+    UInt32              total;      // out: number of entries on the server
+    UInt32              count;      // out: number of entries in this reply
+    UInt32              freq;       // out: timestamp frequency (Hz)
+} RcmServer_StatsHdr;
+
+typedef struct {
+    UInt32              fxnIdx;     // function index
+    UInt32              calls;      // number of calls
+    UInt32              minTicks;   // shortest execution time
+    UInt32              maxTicks;   // longest execution time
+    UInt32              execLo;     // total execution time (low word)
+    UInt32              execHi;     // total execution time (high word)
+    UInt32              waitLo;     // total queue wait time (low word)
+    UInt32              waitHi;     // total queue wait time (high word)
+    Char                name[RcmServer_STATS_NAMELEN]; // truncated name
+} RcmServer_StatsRec;
+
 /* string functions */
 Void *_memset(Void *s, Int c, Int n);
 Int _strcmp(Char *s, Char *t);
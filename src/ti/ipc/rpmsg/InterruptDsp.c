@@ -41,6 +41,7 @@
 #include <ti/sysbios/family/c64p/tesla/Wugen.h>
 
 #include <ti/ipc/MultiProc.h>
+#include <ti/trace/SysMin.h>
 
 #include <ti/ipc/rpmsg/InterruptDsp.h>
 
@@ -201,8 +202,12 @@ Void InterruptDsp_isr(UArg arg)
 {
     UArg payload;
 
+    SysMin_eventBegin("InterruptDsp_isr");
+
     payload = InterruptDsp_intClear();
     if (payload != (UInt)INVALIDPAYLOAD) {
         userFxn(payload);
     }
+
+    SysMin_eventEnd("InterruptDsp_isr");
 }
@@ -45,6 +45,7 @@
 #endif
 
 #include <ti/ipc/MultiProc.h>
+#include <ti/trace/SysMin.h>
 
 #include <ti/ipc/rpmsg/InterruptIpu.h>
 
@@ -297,6 +298,8 @@ Void InterruptIpu_isr(UArg arg)
 {
     UArg payload;
 
+    SysMin_eventBegin("InterruptIpu_isr");
+
     payload = InterruptIpu_intClear();
     if (payload != INVALIDPAYLOAD) {
         Log_print1(Diags_USER1,
@@ -304,4 +307,6 @@ Void InterruptIpu_isr(UArg arg)
             (IArg)payload);
         userFxn(payload);
     }
+
+    SysMin_eventEnd("InterruptIpu_isr");
 }
@@ -59,6 +59,7 @@
 
 #include <ti/sdo/utils/List.h>
 #include <ti/ipc/MultiProc.h>
+#include <ti/trace/SysMin.h>
 
 #include "MessageQCopy.h"
 #include "VirtQueue.h"
@@ -149,6 +150,7 @@ static Void MessageQCopy_swiFxn(UArg arg0, UArg arg1)
     Int               len;
 
     Log_print0(Diags_ENTRY, "--> "FXNN);
+    SysMin_eventBegin(FXNN);
 
     /* Process all available buffers: */
     while ((token = VirtQueue_getAvailBuf(transport.virtQueue_fromHost,
@@ -171,6 +173,7 @@ static Void MessageQCopy_swiFxn(UArg arg0, UArg arg1)
        /* Tell host we've processed the buffers: */
        VirtQueue_kick(transport.virtQueue_fromHost);
     }
+    SysMin_eventEnd(FXNN);
     Log_print0(Diags_EXIT, "<-- "FXNN);
 }
 #undef FXNN
@@ -0,0 +1,393 @@
+/*
+ * Copyright (c) 2012, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/** ============================================================================
+ *  @file       ShmRing.c
+ *
+ *  @brief      Single producer, single consumer rings in shared memory.
+ *
+ *  ============================================================================
+ */
+
+#include <xdc/std.h>
+#include <xdc/runtime/System.h>
+#include <xdc/runtime/Memory.h>
+#include <xdc/runtime/Log.h>
+#include <xdc/runtime/Diags.h>
+
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/hal/Hwi.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/knl/Semaphore.h>
+
+#include <string.h>
+
+#include "ShmRing.h"
+#include "InterruptProxy.h"
+
+/* =============================================================================
+ * Structures & Enums
+ * =============================================================================
+ */
+
+#define SHMRING_MAGIC           0x52494E47      /* "RING" */
+
+/*
+ * Order all previous loads and stores against all later ones, as seen by
+ * the other core.  The M3 needs a dmb; the C64x+ is in-order and has no
+ * write buffer ahead of L2, so a compiler barrier is enough there.
+ */
+#if defined(xdc_target__isaCompatible_v7M)
+#define ShmRing_barrier()       asm(" dmb")
+#elif defined(__GNUC__)
+#define ShmRing_barrier()       __sync_synchronize()
+#else
+#define ShmRing_barrier()
+#endif
+
+/*
+ * Shared header.  Each side's fields live in their own 64 byte block so
+ * that the producer and consumer never write the same cache line.
+ */
+typedef struct ShmRing_Header {
+    /* Written once by the consumer at create time */
+    volatile UInt32 magic;
+    volatile UInt32 numSlots;
+    volatile UInt32 slotSize;
+    UInt32          pad0[13];
+
+    /* Owned by the producer: free-running count of published slots */
+    volatile UInt32 writeIdx;
+    UInt32          pad1[15];
+
+    /* Owned by the consumer */
+    volatile UInt32 readIdx;    /* free-running count of consumed slots */
+    volatile UInt32 waiting;    /* set while pending on the doorbell */
+    UInt32          pad2[14];
+} ShmRing_Header;
+
+/* The ShmRing instance object */
+typedef struct ShmRing_Object {
+    ShmRing_Header   *hdr;
+    UInt8            *slots;
+    UInt32           mask;
+    UInt32           slotSize;
+    UInt             id;
+    UInt16           remoteProcId;
+    ShmRing_Role     role;
+    Bool             doorbell;
+    Semaphore_Handle sem;
+} ShmRing_Object;
+
+/* =============================================================================
+ *  Globals
+ * =============================================================================
+ */
+#pragma DATA_SECTION(ti_ipc_ShmRing_region, ".ipc_rings")
+#pragma DATA_ALIGN(ti_ipc_ShmRing_region, 64)
+UInt32 ti_ipc_ShmRing_region[ShmRing_REGION_SIZE / sizeof(UInt32)];
+
+/* Consumers by ring id, for routing doorbells */
+static ShmRing_Object *consumers[ShmRing_NUM_RINGS] = {NULL};
+
+/* =============================================================================
+ *  ShmRing Functions:
+ * =============================================================================
+ */
+
+/*
+ *  ======== ShmRing_Params_init ========
+ */
+Void ShmRing_Params_init(ShmRing_Params *params)
+{
+    params->base     = NULL;
+    params->numSlots = ShmRing_DEFAULT_NUMSLOTS;
+    params->slotSize = ShmRing_DEFAULT_SLOTSIZE;
+    params->doorbell = TRUE;
+}
+
+/*
+ *  ======== ShmRing_create ========
+ */
+ShmRing_Handle ShmRing_create(UInt id, UInt16 remoteProcId,
+                              ShmRing_Role role, ShmRing_Params *params)
+{
+    ShmRing_Object *obj;
+    ShmRing_Params  defaults;
+    ShmRing_Header *hdr;
+    UInt            key;
+
+    if (params == NULL) {
+        ShmRing_Params_init(&defaults);
+        params = &defaults;
+    }
+
+    if (id >= ShmRing_NUM_RINGS || params->numSlots == 0 ||
+        (params->numSlots & (params->numSlots - 1)) != 0 ||
+        params->slotSize <= sizeof(UInt32) || (params->slotSize & 3) != 0) {
+        System_printf("ShmRing_create: invalid ring %d geometry\n", id);
+        return (NULL);
+    }
+
+    if (params->base != NULL) {
+        hdr = (ShmRing_Header *)params->base;
+    }
+    else {
+        if (ShmRing_HEADER_SIZE + params->numSlots * params->slotSize >
+            ShmRing_REGION_SIZE / ShmRing_NUM_RINGS) {
+            System_printf("ShmRing_create: ring %d does not fit the region\n",
+                          id);
+            return (NULL);
+        }
+        hdr = (ShmRing_Header *)((UInt8 *)ti_ipc_ShmRing_region +
+                  id * (ShmRing_REGION_SIZE / ShmRing_NUM_RINGS));
+    }
+
+    obj = Memory_alloc(NULL, sizeof(ShmRing_Object), 0, NULL);
+    if (obj == NULL) {
+        return (NULL);
+    }
+
+    obj->hdr          = hdr;
+    obj->slots        = (UInt8 *)hdr + ShmRing_HEADER_SIZE;
+    obj->mask         = params->numSlots - 1;
+    obj->slotSize     = params->slotSize;
+    obj->id           = id;
+    obj->remoteProcId = remoteProcId;
+    obj->role         = role;
+    obj->doorbell     = params->doorbell;
+    obj->sem          = NULL;
+
+    if (role == ShmRing_Role_PRODUCER) {
+        return (obj);
+    }
+
+    if (obj->doorbell) {
+        Semaphore_Params semParams;
+
+        Semaphore_Params_init(&semParams);
+        semParams.mode = Semaphore_Mode_BINARY;
+        obj->sem = Semaphore_create(0, &semParams, NULL);
+        if (obj->sem == NULL) {
+            Memory_free(NULL, obj, sizeof(ShmRing_Object));
+            return (NULL);
+        }
+    }
+
+    key = Hwi_disable();
+    if (consumers[id] != NULL) {
+        Hwi_restore(key);
+        System_printf("ShmRing_create: ring %d already has a consumer\n", id);
+        if (obj->sem) {
+            Semaphore_delete(&obj->sem);
+        }
+        Memory_free(NULL, obj, sizeof(ShmRing_Object));
+        return (NULL);
+    }
+    consumers[id] = obj;
+    Hwi_restore(key);
+
+    /* Reset the ring, then publish it to the producer */
+    hdr->magic    = 0;
+    ShmRing_barrier();
+    hdr->writeIdx = 0;
+    hdr->readIdx  = 0;
+    hdr->waiting  = 0;
+    hdr->numSlots = params->numSlots;
+    hdr->slotSize = params->slotSize;
+    ShmRing_barrier();
+    hdr->magic    = SHMRING_MAGIC;
+
+    Log_print3(Diags_USER1, "ShmRing_create: ring %d, %d x %d bytes",
+               (IArg)id, (IArg)params->numSlots, (IArg)params->slotSize);
+
+    return (obj);
+}
+
+/*
+ *  ======== ShmRing_put ========
+ */
+Int ShmRing_put(ShmRing_Handle handle, Ptr data, UInt32 len)
+{
+    ShmRing_Object *obj = (ShmRing_Object *)handle;
+    ShmRing_Header *hdr = obj->hdr;
+    UInt8          *slot;
+    UInt32          w;
+
+    if (hdr->magic != SHMRING_MAGIC) {
+        return (ShmRing_E_NOTREADY);
+    }
+
+    if (len > obj->slotSize - sizeof(UInt32)) {
+        return (ShmRing_E_INVALIDARG);
+    }
+
+    w = hdr->writeIdx;
+    if (w - hdr->readIdx > obj->mask) {
+        return (ShmRing_E_FULL);
+    }
+
+    /* Don't overwrite the slot until the consumer's readIdx is seen */
+    ShmRing_barrier();
+
+    slot = obj->slots + (w & obj->mask) * obj->slotSize;
+    *(UInt32 *)slot = len;
+    memcpy(slot + sizeof(UInt32), data, len);
+
+    /* Slot contents must be visible before the index that publishes them */
+    ShmRing_barrier();
+    hdr->writeIdx = w + 1;
+
+    if (obj->doorbell) {
+        /* Pairs with the barrier after 'waiting' is set in ShmRing_get */
+        ShmRing_barrier();
+        if (hdr->waiting) {
+            InterruptProxy_intSend(obj->remoteProcId,
+                                   (UArg)(ShmRing_DOORBELL_BASE + obj->id));
+        }
+    }
+
+    return (ShmRing_S_SUCCESS);
+}
+
+/*
+ *  ======== ShmRing_get ========
+ */
+Int ShmRing_get(ShmRing_Handle handle, Ptr data, UInt32 *len, UInt timeout)
+{
+    ShmRing_Object *obj = (ShmRing_Object *)handle;
+    ShmRing_Header *hdr = obj->hdr;
+    UInt8          *slot;
+    UInt32          r = hdr->readIdx;
+    UInt32          msgLen;
+
+    while (hdr->writeIdx == r) {
+        if (timeout == 0) {
+            *len = 0;
+            return (ShmRing_E_TIMEOUT);
+        }
+
+        if (!obj->doorbell) {
+            Task_sleep(1);
+            if (timeout != ShmRing_FOREVER) {
+                timeout--;
+            }
+            continue;
+        }
+
+        /*
+         * Announce that we are about to block, then look again: a put that
+         * completed before the producer could see 'waiting' is caught here.
+         */
+        hdr->waiting = 1;
+        ShmRing_barrier();
+        if (hdr->writeIdx != r) {
+            hdr->waiting = 0;
+            break;
+        }
+
+        if (!Semaphore_pend(obj->sem, timeout == ShmRing_FOREVER ?
+                            BIOS_WAIT_FOREVER : timeout)) {
+            hdr->waiting = 0;
+            if (hdr->writeIdx != r) {
+                break;
+            }
+            *len = 0;
+            return (ShmRing_E_TIMEOUT);
+        }
+        hdr->waiting = 0;
+    }
+
+    /* Don't read the slot before the writeIdx that published it */
+    ShmRing_barrier();
+
+    slot = obj->slots + (r & obj->mask) * obj->slotSize;
+    msgLen = *(UInt32 *)slot;
+    if (msgLen > *len) {
+        *len = msgLen;
+        return (ShmRing_E_INVALIDARG);
+    }
+    memcpy(data, slot + sizeof(UInt32), msgLen);
+    *len = msgLen;
+
+    /* Done reading the slot before handing it back to the producer */
+    ShmRing_barrier();
+    hdr->readIdx = r + 1;
+
+    return (ShmRing_S_SUCCESS);
+}
+
+/*
+ *  ======== ShmRing_delete ========
+ */
+Void ShmRing_delete(ShmRing_Handle *handlePtr)
+{
+    ShmRing_Object *obj = (ShmRing_Object *)*handlePtr;
+    UInt            key;
+
+    if (obj->role == ShmRing_Role_CONSUMER) {
+        /* Stop the producer from publishing into a ring nobody reads */
+        obj->hdr->magic = 0;
+        ShmRing_barrier();
+
+        key = Hwi_disable();
+        consumers[obj->id] = NULL;
+        Hwi_restore(key);
+
+        if (obj->sem) {
+            Semaphore_delete(&obj->sem);
+        }
+    }
+
+    Memory_free(NULL, obj, sizeof(ShmRing_Object));
+    *handlePtr = NULL;
+}
+
+/*
+ *  ======== ShmRing_processDoorbell ========
+ *  Called from VirtQueue_isr with every mailbox payload it does not own.
+ */
+Int ShmRing_processDoorbell(UArg msg)
+{
+    UInt            index = (UInt)msg - ShmRing_DOORBELL_BASE;
+    ShmRing_Object *obj;
+
+    if (index >= ShmRing_NUM_RINGS) {
+        return 0;
+    }
+
+    /* A doorbell for a deleted consumer is still ours; just drop it */
+    obj = consumers[index];
+    if (obj && obj->sem) {
+        Semaphore_post(obj->sem);
+    }
+    return 1;
+}
@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2012, Texas Instruments Incorporated
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * *  Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * *  Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/** ============================================================================
+ *  @file       ShmRing.h
+ *
+ *  @brief      Single producer, single consumer rings in shared memory.
+ *
+ *  A ShmRing moves small fixed-size messages between two cores without
+ *  going through the host vrings, the mailbox FIFO or a HwSpinlock:
+ *  - Exactly one writer (the producer core) and one reader (the consumer
+ *    core) per ring.
+ *  - The producer only writes writeIdx and the slots, the consumer only
+ *    writes readIdx and the waiting flag, so memory barriers are the only
+ *    synchronization needed.
+ *  - The shared header holds indices only, never pointers, so both cores
+ *    may map the ring at different addresses.
+ *  - Optionally, the producer rings a mailbox doorbell when the consumer
+ *    is blocked; otherwise the consumer polls.
+ *
+ *  By default, rings are carved out of ti_ipc_ShmRing_region, which the
+ *  platform places at the same address on both M3 cores (section
+ *  ".ipc_rings") and advertises to the host through a custom resource
+ *  table entry.  Rings shared with the DSP must be placed in non-cached
+ *  memory both processors map, and passed in through ShmRing_Params::base.
+ *
+ *  The consumer creates the ring, which resets the shared header; the
+ *  producer may only put once ShmRing_put stops returning
+ *  #ShmRing_E_NOTREADY.
+ *
+ *  The ShmRing header should be included in an application as follows:
+ *  @code
+ *  #include <ti/ipc/rpmsg/ShmRing.h>
+ *  @endcode
+ *
+ *  ============================================================================
+ */
+
+#ifndef ti_ipc_ShmRing__include
+#define ti_ipc_ShmRing__include
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+
+/* =============================================================================
+ *  Structures & Definitions
+ * =============================================================================
+ */
+
+/*!
+ *  @brief      Used as the timeout value to specify wait forever
+ */
+#define ShmRing_FOREVER                     ~(0)
+
+/*!
+ *  @def    ShmRing_S_SUCCESS
+ *  @brief  Operation is successful.
+ */
+#define ShmRing_S_SUCCESS                   0
+
+/*!
+ *  @def    ShmRing_E_FAIL
+ *  @brief  Operation is not successful.
+ */
+#define ShmRing_E_FAIL                      -1
+
+/*!
+ *  @def    ShmRing_E_INVALIDARG
+ *  @brief  Bad ring id, geometry, or message length.
+ */
+#define ShmRing_E_INVALIDARG                -2
+
+/*!
+ *  @def    ShmRing_E_MEMORY
+ *  @brief  Operation resulted in memory failure.
+ */
+#define ShmRing_E_MEMORY                    -3
+
+/*!
+ *  @def    ShmRing_E_TIMEOUT
+ *  @brief  No message arrived before the timeout expired.
+ */
+#define ShmRing_E_TIMEOUT                   -6
+
+/*!
+ *  @def    ShmRing_E_FULL
+ *  @brief  All slots are in use; the consumer is behind.
+ */
+#define ShmRing_E_FULL                      -8
+
+/*!
+ *  @def    ShmRing_E_NOTREADY
+ *  @brief  The consumer has not initialized the ring yet.
+ */
+#define ShmRing_E_NOTREADY                  -9
+
+/*!
+ *  @def    ShmRing_NUM_RINGS
+ *  @brief  Number of rings carved out of the default shared region.
+ */
+#define ShmRing_NUM_RINGS                   4
+
+/*!
+ *  @def    ShmRing_REGION_SIZE
+ *  @brief  Size in bytes of ti_ipc_ShmRing_region.
+ */
+#define ShmRing_REGION_SIZE                 0x1000
+
+/*!
+ *  @def    ShmRing_HEADER_SIZE
+ *  @brief  Bytes taken by the shared header in front of the slots.
+ */
+#define ShmRing_HEADER_SIZE                 192
+
+/*!
+ *  @def    ShmRing_DEFAULT_NUMSLOTS
+ *  @brief  Default number of slots; must be a power of 2.
+ */
+#define ShmRing_DEFAULT_NUMSLOTS            8
+
+/*!
+ *  @def    ShmRing_DEFAULT_SLOTSIZE
+ *  @brief  Default slot size in bytes, including the 4 byte length word.
+ *
+ *  With the defaults, a ring fits in 1/ShmRing_NUM_RINGS of the region.
+ */
+#define ShmRing_DEFAULT_SLOTSIZE            96
+
+/*!
+ *  @def    ShmRing_DOORBELL_BASE
+ *  @brief  Mailbox payload for the doorbell of ring 0; ring n uses base + n.
+ */
+#define ShmRing_DOORBELL_BASE               0xF0F0F100
+
+/*!
+ *  @brief  Which side of the ring the caller is.
+ */
+typedef enum ShmRing_Role {
+    ShmRing_Role_PRODUCER = 0,
+    ShmRing_Role_CONSUMER = 1
+} ShmRing_Role;
+
+/*!
+ *  @brief  ShmRing_Params: geometry and placement of a ring.
+ *
+ *  Both sides must agree on every field.
+ */
+typedef struct ShmRing_Params {
+    Ptr     base;       /*!< NULL: ring 'id' of ti_ipc_ShmRing_region     */
+    UInt32  numSlots;   /*!< Number of slots, a power of 2                */
+    UInt32  slotSize;   /*!< Slot size, a multiple of 4, incl. length word */
+    Bool    doorbell;   /*!< Interrupt a blocked consumer on put          */
+} ShmRing_Params;
+
+/*!
+ *  @brief  ShmRing_Handle type
+ */
+typedef struct ShmRing_Object *ShmRing_Handle;
+
+/*!
+ *  @brief  Default shared region, placed in section ".ipc_rings".
+ */
+extern UInt32 ti_ipc_ShmRing_region[];
+
+/* =============================================================================
+ *  ShmRing Functions:
+ * =============================================================================
+ */
+
+/*!
+ *  @brief      Initialize a ShmRing_Params structure to the defaults.
+ *
+ *  @param[out] params      Parameters to initialize.
+ */
+Void ShmRing_Params_init(ShmRing_Params *params);
+
+/*!
+ *  @brief      Attach to one side of a ring.
+ *
+ *  The consumer resets the shared header and publishes the geometry; the
+ *  producer only validates its arguments.  The consumer must be created
+ *  before the producer can put.
+ *
+ *  @param[in]  id            Ring id, below #ShmRing_NUM_RINGS; also selects
+ *                            the doorbell payload.
+ *  @param[in]  remoteProcId  MultiProc ID of the other side.
+ *  @param[in]  role          Producer or consumer.
+ *  @param[in]  params        Ring parameters, or NULL for the defaults.
+ *
+ *  @return     ShmRing Handle, or NULL if:
+ *                            - the id or geometry is invalid;
+ *                            - the consumer side of this id is taken;
+ *                            - could not allocate object
+ */
+ShmRing_Handle ShmRing_create(UInt id, UInt16 remoteProcId,
+                              ShmRing_Role role, ShmRing_Params *params);
+
+/*!
+ *  @brief      Copy a message into the next free slot.
+ *
+ *  Never blocks.  If the doorbell is enabled and the consumer is waiting,
+ *  the remote core is interrupted.
+ *
+ *  @param[in]  handle      Producer handle.
+ *  @param[in]  data        Message to copy.
+ *  @param[in]  len         Message length, at most slotSize - 4.
+ *
+ *  @return     - #ShmRing_S_SUCCESS: message published
+ *              - #ShmRing_E_FULL: no free slot, retry later
+ *              - #ShmRing_E_NOTREADY: consumer not created yet
+ *              - #ShmRing_E_INVALIDARG: message too long
+ */
+Int ShmRing_put(ShmRing_Handle handle, Ptr data, UInt32 len);
+
+/*!
+ *  @brief      Copy out the oldest message.
+ *
+ *  With the doorbell enabled, the caller pends until the producer rings
+ *  or the timeout expires; without it, the caller polls once per tick.
+ *  A timeout of zero never blocks.
+ *
+ *  @param[in]     handle   Consumer handle.
+ *  @param[out]    data     Buffer receiving the message.
+ *  @param[in,out] len      In: size of data.  Out: message length.
+ *  @param[in]     timeout  Maximum number of ticks to wait.
+ *
+ *  @return     - #ShmRing_S_SUCCESS: message returned
+ *              - #ShmRing_E_TIMEOUT: ring stayed empty
+ *              - #ShmRing_E_INVALIDARG: data too small, message left in ring
+ */
+Int ShmRing_get(ShmRing_Handle handle, Ptr data, UInt32 *len, UInt timeout);
+
+/*!
+ *  @brief      Detach from a ring.
+ *
+ *  @param[in,out]  handlePtr   Pointer to handle to delete; set to NULL.
+ */
+Void ShmRing_delete(ShmRing_Handle *handlePtr);
+
+/*!
+ *  @brief      Wake the consumer of a ring from the mailbox ISR.
+ *
+ *  @param[in]  msg         Mailbox payload.
+ *
+ *  @return     1 if msg was a ShmRing doorbell, 0 otherwise.
+ */
+Int ShmRing_processDoorbell(UArg msg);
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
+#endif /* ti_ipc_ShmRing__include */
@@ -68,9 +68,11 @@
 
 #include <ti/ipc/rpmsg/InterruptProxy.h>
 #include <ti/ipc/rpmsg/VirtQueue.h>
+#include <ti/ipc/rpmsg/ShmRing.h>
 #include <ti/pm/IpcPower.h>
 
 #include <ti/ipc/MultiProc.h>
+#include <ti/trace/SysMin.h>
 
 #include <string.h>
 
@@ -348,10 +350,10 @@ Bool VirtQueue_enableCallback(VirtQueue_Object *vq)
 }
 
 /*!
- * ======== VirtQueue_isr ========
- * Note 'arg' is ignored: it is the Hwi argument, not the mailbox argument.
+ * ======== VirtQueue_processMsg ========
+ * Handle a mailbox message, for VirtQueue_isr.
  */
-Void VirtQueue_isr(UArg msg)
+static Void VirtQueue_processMsg(UArg msg)
 {
     VirtQueue_Object *vq;
 
@@ -408,6 +410,9 @@ Void VirtQueue_isr(UArg msg)
                 if (OffloadM3_processSysM3Tasks(msg))
                     return;
 #endif
+                /* Check and process any inter-core ShmRing doorbells */
+                if (ShmRing_processDoorbell(msg))
+                    return;
 
                 /*
                  *  If the message isn't one of the above, it's either part of the
@@ -418,6 +423,9 @@ Void VirtQueue_isr(UArg msg)
 #ifndef SMP
     }
     else if (msg & 0xFFFF0000) {
+        if (ShmRing_processDoorbell(msg)) {
+            return;
+        }
         if (msg == (UInt)RP_MSG_HIBERNATION) {
             IpcPower_suspend();
         }
@@ -446,6 +454,17 @@ Void VirtQueue_isr(UArg msg)
 #endif
 }
 
+/*!
+ * ======== VirtQueue_isr ========
+ * Note 'arg' is ignored: it is the Hwi argument, not the mailbox argument.
+ */
+Void VirtQueue_isr(UArg msg)
+{
+    SysMin_eventBegin("VirtQueue_isr");
+    VirtQueue_processMsg(msg);
+    SysMin_eventEnd("VirtQueue_isr");
+}
+
 
 /*!
  * ======== VirtQueue_create ========
@@ -41,6 +41,7 @@
 function init()
 {
     xdc.loadPackage('ti.pm');
+    xdc.useModule('ti.trace.SysMin');
     var Semaphore = xdc.useModule('ti.sysbios.knl.Semaphore');
     var semParams = new Semaphore.Params();
     Program.global.MessageQCopy_semHandle = Semaphore.create(1, semParams);
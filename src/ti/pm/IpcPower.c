@@ -347,6 +347,14 @@ Void IpcPower_idle()
     asm(" wfi");
 }
 
+/*
+ *  ======== IpcPower_getIdleCount ========
+ */
+UInt32 IpcPower_getIdleCount()
+{
+    return (IpcPower_idleCount);
+}
+
 /*
  *  ======== IpcPower_wakeLock ========
  */
@@ -137,6 +137,15 @@ UInt IpcPower_hibernateUnlock();
  */
 Bool IpcPower_canHibernate();
 
+/*!
+ *  @brief      Return the number of times the core went idle
+ *
+ *  The count goes up each time the idle loop puts the core to sleep; a
+ *  core with nothing to do sleeps about once per timer tick. On SMP both
+ *  cores add to the same count.
+ */
+UInt32 IpcPower_getIdleCount();
+
 /*!
  *  @brief      Register callback function for a Power event
  *
@@ -261,6 +261,14 @@ Void IpcPower_idle()
     asm(" idle");
 }
 
+/*
+ *  ======== IpcPower_getIdleCount ========
+ */
+UInt32 IpcPower_getIdleCount()
+{
+    return (IpcPower_idleCount);
+}
+
 /*
  *  ======== IpcPower_hibernateLock ========
  */
@@ -52,6 +52,7 @@
 
 #define DEFAULT_TIMEOUT 500
 #define MAXMSGSIZE      128
+#define MAXBATCHSIZE    256
 
 static UInt16 IpcResource_resLen(IpcResource_Type type)
 {
@@ -98,13 +99,347 @@ static Int _IpcResource_translateError(Int kstatus)
     return IpcResource_E_FAIL;
 }
 
+/*
+ * Fill in the name and parameters of an allocation, the processors are
+ * allocated as "rproc" with their name as parameter. Returns the length
+ * of the parameters, or -1 if the type or parameters are invalid.
+ */
+static Int _IpcResource_packAlloc(IpcResource_Type type, Void *resParams,
+                                  Char *resName, Char *params)
+{
+    IpcResource_Processor *rproc = (Void *)params;
+    UInt16 rlen = IpcResource_resLen(type);
+    Char *name;
+
+    name = IpcResource_toName(type);
+    if (!name || (rlen && !resParams)) {
+        return -1;
+    }
+
+    switch(type) {
+    case IpcResource_TYPE_IPU:
+    case IpcResource_TYPE_DSP:
+        strncpy(rproc->name, name, 16);
+        strncpy(resName, "rproc", 16);
+        return sizeof(*rproc);
+
+    default:
+        strncpy(resName, name, 16);
+        memcpy(params, resParams, rlen);
+        return rlen;
+    }
+}
+
+static Void _IpcResource_unlink(IpcResource_Handle handle,
+                                IpcResource_Pending *p)
+{
+    IpcResource_Pending *prev = NULL;
+    IpcResource_Pending *cur;
+
+    for (cur = handle->head; cur != NULL; prev = cur, cur = cur->next) {
+        if (cur == p) {
+            if (prev) {
+                prev->next = p->next;
+            }
+            else {
+                handle->head = p->next;
+            }
+            if (handle->tail == p) {
+                handle->tail = prev;
+            }
+            break;
+        }
+    }
+}
+
+/*
+ * Hand each ack to the request it answers: by id if the host returns
+ * them, else the oldest one outstanding.
+ */
+static Void _IpcResource_recvTask(UArg arg0, UArg arg1)
+{
+    IpcResource_Handle handle = (IpcResource_Handle)arg0;
+    Char msg[MAXBATCHSIZE];
+    IpcResource_Ack *ack = (Void *)msg;
+    IpcResource_Pending *p;
+    UInt16 len;
+    UInt32 remote;
+    Int status;
+
+    while (!handle->shutdown) {
+        status = MessageQCopy_recv(handle->msgq, msg, &len, &remote,
+                                   MessageQCopy_FOREVER);
+        if (status) {
+            continue;
+        }
+        if (remote != handle->remote || len < sizeof(*ack)) {
+            System_printf("IpcResource: dropped message from %d len %d\n",
+                          remote, len);
+            continue;
+        }
+
+        Semaphore_pend(handle->sem, BIOS_WAIT_FOREVER);
+        p = handle->head;
+        if (handle->caps & IpcResource_CAP_REQID) {
+            while (p && p->id != IpcResource_REQ_ID(ack->reqType)) {
+                p = p->next;
+            }
+        }
+        if (p == NULL) {
+            Semaphore_post(handle->sem);
+            System_printf("IpcResource: unexpected ack type 0x%x\n",
+                          ack->reqType);
+            continue;
+        }
+
+        _IpcResource_unlink(handle, p);
+        if (p->abandoned) {
+            p->busy = FALSE;
+            Semaphore_post(handle->sem);
+            Semaphore_post(handle->slotSem);
+            continue;
+        }
+        memcpy(p->ack, msg, (len < p->maxLen) ? len : p->maxLen);
+        p->len = len;
+        p->done = TRUE;
+        /*
+         * Post before releasing the lock: a waiter that timed out and sees
+         * 'done' takes this count back right away, none is left behind on
+         * the slot.
+         */
+        Semaphore_post(p->sem);
+        Semaphore_post(handle->sem);
+    }
+
+    Semaphore_post(handle->exitSem);
+}
+
+/*
+ * Send a request. If it has an ack, the ack is copied to ack (maxLen
+ * bytes at most) and the request has to be completed by
+ * _IpcResource_wait(); ack may be the request buffer itself.
+ */
+static Int _IpcResource_send(IpcResource_Handle handle, IpcResource_Req *req,
+                             UInt16 len, Void *ack, UInt16 maxLen,
+                             IpcResource_Pending **pending)
+{
+    IpcResource_Pending *p = NULL;
+    Int status;
+    UInt i;
+
+    *pending = NULL;
+
+    if (ack) {
+        Semaphore_pend(handle->slotSem, BIOS_WAIT_FOREVER);
+    }
+
+    /* kept across the send, so the pending list is in send order */
+    Semaphore_pend(handle->sem, BIOS_WAIT_FOREVER);
+    if (ack) {
+        for (i = 0; i < IpcResource_MAX_PENDING; i++) {
+            if (!handle->pending[i].busy) {
+                p = &handle->pending[i];
+                break;
+            }
+        }
+        p->busy = TRUE;
+        p->done = FALSE;
+        p->abandoned = FALSE;
+        p->ack = ack;
+        p->maxLen = maxLen;
+        p->len = 0;
+        p->next = NULL;
+        if (++handle->nextId == 0) {
+            handle->nextId = 1;
+        }
+        p->id = handle->nextId;
+        if (handle->caps & IpcResource_CAP_REQID) {
+            req->reqType = IpcResource_REQ_TAG(req->reqType, p->id);
+        }
+        if (handle->tail) {
+            handle->tail->next = p;
+        }
+        else {
+            handle->head = p;
+        }
+        handle->tail = p;
+    }
+
+    status = MessageQCopy_send(MultiProc_getId("HOST"), handle->remote,
+                               handle->endPoint, req, len);
+    if (status && p) {
+        _IpcResource_unlink(handle, p);
+        p->busy = FALSE;
+    }
+    Semaphore_post(handle->sem);
+
+    if (status) {
+        if (p) {
+            Semaphore_post(handle->slotSem);
+        }
+        return status;
+    }
+
+    *pending = p;
+    return IpcResource_S_SUCCESS;
+}
+
+/* Wait for the ack of a request, returns its length in len */
+static Int _IpcResource_wait(IpcResource_Handle handle,
+                             IpcResource_Pending *p, UInt16 *len)
+{
+    Bool acked;
+    Bool release = TRUE;
+
+    acked = Semaphore_pend(p->sem, handle->timeout);
+
+    Semaphore_pend(handle->sem, BIOS_WAIT_FOREVER);
+    if (!acked && p->done) {
+        /* came in just after the timeout, p->sem was posted with 'done' */
+        Semaphore_pend(p->sem, BIOS_NO_WAIT);
+        acked = TRUE;
+    }
+    if (acked) {
+        *len = p->len;
+    }
+    else if (handle->caps & IpcResource_CAP_REQID) {
+        _IpcResource_unlink(handle, p);
+    }
+    else {
+        /* its ack may still come, and the next ack is matched after it */
+        p->abandoned = TRUE;
+        release = FALSE;
+    }
+    if (release) {
+        p->busy = FALSE;
+    }
+    Semaphore_post(handle->sem);
+
+    if (release) {
+        Semaphore_post(handle->slotSem);
+    }
+
+    return acked ? IpcResource_S_SUCCESS : IpcResource_E_TIMEOUT;
+}
+
+static Void _IpcResource_merge(IpcResource_ConstraintData *dst,
+                               IpcResource_ConstraintData *src)
+{
+    if (src->mask & IpcResource_C_FREQ) {
+        dst->frequency = src->frequency;
+    }
+    if (src->mask & IpcResource_C_LAT) {
+        dst->latency = src->latency;
+    }
+    if (src->mask & IpcResource_C_BW) {
+        dst->bandwidth = src->bandwidth;
+    }
+    dst->mask |= src->mask;
+}
+
+static UInt16 _IpcResource_packConstraints(IpcResource_Req *req,
+                                           UInt32 reqType,
+                                           IpcResource_ResHandle resHandle,
+                                           IpcResource_ConstraintData *cdata)
+{
+    IpcResource_Constraint *c = (Void *)req->data;
+
+    req->reqType = reqType;
+    c->resHandle = resHandle;
+    memcpy(&c->cdata, cdata, sizeof(c->cdata));
+
+    return sizeof(*req) + sizeof(*c);
+}
+
+/*
+ * Send the asynchronous constraint updates queued in the last
+ * IpcResource_ASYNC_DELAY ticks: per resource a release and a request
+ * message, as needed, all sent before waiting for any ack.
+ */
+static Void _IpcResource_flushTask(UArg arg0, UArg arg1)
+{
+    IpcResource_Handle handle = (IpcResource_Handle)arg0;
+    IpcResource_AsyncUpdate updates[IpcResource_MAX_ASYNC];
+    IpcResource_Pending *p[IpcResource_MAX_ASYNC];
+    Int status[IpcResource_MAX_ASYNC];
+    Char msg[IpcResource_MAX_ASYNC][sizeof(IpcResource_Ack) +
+                                    sizeof(IpcResource_Constraint)];
+    IpcResource_Ack *ack;
+    UInt16 len;
+    UInt n;
+    UInt i;
+    UInt j;
+
+    while (!handle->flushStop) {
+        Semaphore_pend(handle->flushSem, BIOS_WAIT_FOREVER);
+        Task_sleep(IpcResource_ASYNC_DELAY);
+
+        n = 0;
+        Semaphore_pend(handle->sem, BIOS_WAIT_FOREVER);
+        for (i = 0; i < IpcResource_MAX_ASYNC; i++) {
+            if (handle->async[i].used) {
+                updates[n++] = handle->async[i];
+                handle->async[i].used = FALSE;
+            }
+        }
+        handle->numAsync = 0;
+        Semaphore_post(handle->sem);
+
+        for (i = 0; i < n; i++) {
+            status[i] = IpcResource_S_SUCCESS;
+            p[i] = NULL;
+
+            if (updates[i].rel.mask) {
+                len = _IpcResource_packConstraints((Void *)msg[i],
+                        IpcResource_ReqType_REL_CONSTRAINTS,
+                        updates[i].resHandle, &updates[i].rel);
+                status[i] = _IpcResource_send(handle, (Void *)msg[i], len,
+                                              NULL, 0, &p[i]);
+            }
+            if (updates[i].req.mask && status[i] == IpcResource_S_SUCCESS) {
+                len = _IpcResource_packConstraints((Void *)msg[i],
+                        IpcResource_ReqType_REQ_CONSTRAINTS,
+                        updates[i].resHandle, &updates[i].req);
+                status[i] = _IpcResource_send(handle, (Void *)msg[i], len,
+                                              msg[i], sizeof(msg[i]), &p[i]);
+            }
+            if (status[i]) {
+                status[i] = IpcResource_E_FAIL;
+            }
+        }
+
+        for (i = 0; i < n; i++) {
+            if (p[i]) {
+                ack = (Void *)msg[i];
+                status[i] = _IpcResource_wait(handle, p[i], &len);
+                if (status[i] == IpcResource_S_SUCCESS) {
+                    status[i] = _IpcResource_translateError(ack->status);
+                }
+            }
+            if (status[i]) {
+                System_printf("IpcResource: constraints for resource %d "
+                              "failed status %d\n", updates[i].resHandle,
+                              status[i]);
+            }
+            for (j = 0; j < updates[i].numCbs; j++) {
+                updates[i].cbFxn[j](updates[i].resHandle, status[i],
+                                    updates[i].cbArg[j]);
+            }
+        }
+    }
+
+    Semaphore_post(handle->exitSem);
+}
+
 IpcResource_Handle IpcResource_connect(UInt timeout)
 {
     UInt16 dstProc;
     UInt16 len;
     IpcResource_Handle handle;
     IpcResource_Ack ack;
+    Task_Params params;
     Int status;
+    UInt i;
 
     handle = Memory_alloc(NULL, sizeof(*handle), 0, NULL);
     if (!handle) {
@@ -112,12 +447,28 @@ IpcResource_Handle IpcResource_connect(UInt timeout)
         return NULL;
     }
 
+    memset(handle, 0, sizeof(*handle));
     handle->timeout = (!timeout) ? DEFAULT_TIMEOUT :
                       (timeout == IpcResource_FOREVER) ? MessageQCopy_FOREVER :
                       timeout;
 
     dstProc = MultiProc_getId("HOST");
     handle->sem = Semaphore_create(1, NULL, NULL);
+    handle->exitSem = Semaphore_create(0, NULL, NULL);
+    handle->slotSem = Semaphore_create(IpcResource_MAX_PENDING, NULL, NULL);
+    handle->flushSem = Semaphore_create(0, NULL, NULL);
+    for (i = 0; i < IpcResource_MAX_PENDING; i++) {
+        handle->pending[i].sem = Semaphore_create(0, NULL, NULL);
+        if (!handle->pending[i].sem) {
+            System_printf("IpcResource_connect: No memory");
+            goto err;
+        }
+    }
+    if (!handle->sem || !handle->exitSem || !handle->slotSem ||
+        !handle->flushSem) {
+        System_printf("IpcResource_connect: No memory");
+        goto err;
+    }
 
     MessageQCopy_init(dstProc);
     handle->msgq= MessageQCopy_create(MessageQCopy_ASSIGN_ANY,
@@ -150,19 +501,65 @@ IpcResource_Handle IpcResource_connect(UInt timeout)
         goto err_disc;
     }
 
+    handle->caps = ack.reqType & (IpcResource_CAP_REQID |
+                                  IpcResource_CAP_BATCH);
+
+    /* Acks are received at the priority of the connecting task */
+    Task_Params_init(&params);
+    params.instance->name = "IpcResource_recv";
+    params.priority = Task_getPri(Task_self());
+    params.arg0 = (UArg)handle;
+    handle->recvTask = Task_create(_IpcResource_recvTask, &params, NULL);
+    if (!handle->recvTask) {
+        System_printf("IpcResource_connect: Task_create failed\n");
+        goto err_disc;
+    }
+
+    params.instance->name = "IpcResource_flush";
+    handle->flushTask = Task_create(_IpcResource_flushTask, &params, NULL);
+    if (!handle->flushTask) {
+        System_printf("IpcResource_connect: Task_create failed\n");
+        goto err_recv;
+    }
+
     return handle;
 
+err_recv:
+    handle->shutdown = TRUE;
+    MessageQCopy_unblock(handle->msgq);
+    Semaphore_pend(handle->exitSem, BIOS_WAIT_FOREVER);
+    Task_delete(&handle->recvTask);
+
 err_disc:
     NameMap_unregister("rpmsg-resmgr", handle->endPoint);
     MessageQCopy_delete(&handle->msgq);
 err:
+    for (i = 0; i < IpcResource_MAX_PENDING; i++) {
+        if (handle->pending[i].sem) {
+            Semaphore_delete(&handle->pending[i].sem);
+        }
+    }
+    if (handle->flushSem) {
+        Semaphore_delete(&handle->flushSem);
+    }
+    if (handle->slotSem) {
+        Semaphore_delete(&handle->slotSem);
+    }
+    if (handle->exitSem) {
+        Semaphore_delete(&handle->exitSem);
+    }
+    if (handle->sem) {
+        Semaphore_delete(&handle->sem);
+    }
     Memory_free(NULL, handle, sizeof(*handle));
     return NULL;
 }
 
+/* No request may be outstanding on the handle */
 Int IpcResource_disconnect(IpcResource_Handle handle)
 {
     Int status;
+    UInt i;
 
     if (!handle) {
         System_printf("IpcResource_disconnect: handle is NULL\n");
@@ -171,6 +568,17 @@ Int IpcResource_disconnect(IpcResource_Handle handle)
 
     NameMap_unregister("rpmsg-resmgr", handle->endPoint);
 
+    /* the queued constraint updates are sent first */
+    handle->flushStop = TRUE;
+    Semaphore_post(handle->flushSem);
+    Semaphore_pend(handle->exitSem, BIOS_WAIT_FOREVER);
+    Task_delete(&handle->flushTask);
+
+    handle->shutdown = TRUE;
+    MessageQCopy_unblock(handle->msgq);
+    Semaphore_pend(handle->exitSem, BIOS_WAIT_FOREVER);
+    Task_delete(&handle->recvTask);
+
     status = MessageQCopy_delete(&handle->msgq);
     if (status) {
         System_printf("IpcResource_disconnect: MessageQCopy_delete "
@@ -178,6 +586,12 @@ Int IpcResource_disconnect(IpcResource_Handle handle)
         return status;
     }
 
+    for (i = 0; i < IpcResource_MAX_PENDING; i++) {
+        Semaphore_delete(&handle->pending[i].sem);
+    }
+    Semaphore_delete(&handle->flushSem);
+    Semaphore_delete(&handle->slotSem);
+    Semaphore_delete(&handle->exitSem);
     Semaphore_delete(&handle->sem);
 
     Memory_free(NULL, handle, sizeof(*handle));
@@ -194,76 +608,40 @@ Int IpcResource_request(IpcResource_Handle handle,
     IpcResource_AllocData *rdata = (Void *)req->data;
     IpcResource_Ack *ack = (Void *)msg;
     IpcResource_AckData *adata = (Void *)ack->data;
+    IpcResource_Pending *p;
     UInt16 hlen = sizeof(*rdata) + sizeof(*req);
     UInt16 alen = sizeof(*ack);
-    UInt16 rlen = IpcResource_resLen(type);
+    Int rlen;
     UInt16 len;
-    UInt32 remote;
     Int status;
-    Char *name;
-    IpcResource_Processor rproc;
 
     if (!handle || !resHandle) {
         System_printf("IpcResource_request: Invalid paramaters\n");
         return IpcResource_E_INVALARGS;
     }
 
-    name = IpcResource_toName(type);
-    if (!name) {
+    rlen = _IpcResource_packAlloc(type, resParams, rdata->resName,
+                                  rdata->resParams);
+    if (rlen < 0) {
         System_printf("IpcResource_request: resource type %d "
-                      "is invalid\n", type);
+                      "is invalid or needs parameters\n", type);
         return IpcResource_E_INVALARGS;
     }
 
-    if (rlen && !resParams) {
-        System_printf("IpcResource_request: resource type %d "
-                      "needs parameters\n", type);
-        return IpcResource_E_INVALARGS;
-    }
-
-    strncpy(rdata->resName, name, 16);
     req->reqType = IpcResource_ReqType_ALLOC;
 
-    switch(type) {
-    case IpcResource_TYPE_IPU:
-    case IpcResource_TYPE_DSP:
-        strcpy(rproc.name, rdata->resName);
-        strncpy(rdata->resName, "rproc", 16);
-        resParams = &rproc;
-        rlen = sizeof(rproc);
-        break;
-
-    default:
-        break;
-    }
-
-    memcpy(rdata->resParams, resParams, rlen);
-    Semaphore_pend(handle->sem, BIOS_WAIT_FOREVER);
-    status = MessageQCopy_send(MultiProc_getId("HOST"), handle->remote,
-                        handle->endPoint, req, hlen + rlen);
+    status = _IpcResource_send(handle, req, hlen + rlen, msg, sizeof(msg),
+                               &p);
     if (status) {
-        Semaphore_post(handle->sem);
         System_printf("IpcResource_request: MessageQCopy_send "
                       "failed status %d\n", status);
         status = IpcResource_E_FAIL;
         goto end;
     }
 
-    status = MessageQCopy_recv(handle->msgq, ack, &len, &remote,
-                               handle->timeout);
-    Semaphore_post(handle->sem);
+    status = _IpcResource_wait(handle, p, &len);
     if (status) {
-        System_printf("IpcResource_request: MessageQCopy_recv "
-                      "failed status %d\n", status);
-        status = (status == MessageQCopy_E_TIMEOUT) ? IpcResource_E_TIMEOUT :
-                 IpcResource_E_FAIL;
-        goto end;
-    }
-    if (remote != handle->remote) {
-        System_printf("IpcResource_request: MessageQCopy_recv "
-                      "invalid message source %d, channel source %d\n",
-                      remote, handle->remote);
-        status = IpcResource_E_FAIL;
+        System_printf("IpcResource_request: no ack, status %d\n", status);
         goto end;
     }
 
@@ -277,12 +655,194 @@ Int IpcResource_request(IpcResource_Handle handle,
     Assert_isTrue(len == rlen + alen + sizeof(*adata), NULL);
 
     *resHandle = adata->resHandle;
-    memcpy(resParams, adata->resParams, rlen);
+    if (IpcResource_resLen(type)) {
+        memcpy(resParams, adata->resParams, rlen);
+    }
 
 end:
     return status;
 }
 
+/*
+ *  Several allocations in flight at once: packed into ALLOC_BATCH messages
+ *  if the host takes them, else sent as separate requests; in both cases
+ *  up to IpcResource_BATCH_WINDOW messages are outstanding. The status of
+ *  each resource is in its entry, the first failure is returned. Resources
+ *  allocated before a failure stay allocated.
+ */
+Int IpcResource_requestBatch(IpcResource_Handle handle,
+                             IpcResource_BatchEntry *entries, UInt num)
+{
+    struct {
+        IpcResource_Pending *p;
+        UInt first;
+        UInt count;
+    } sent[IpcResource_BATCH_WINDOW];
+    Char *bufs;
+    Char *msg;
+    IpcResource_Req *req;
+    IpcResource_Ack *ack;
+    IpcResource_BatchReq *breq;
+    IpcResource_BatchAlloc *balloc;
+    IpcResource_AllocData *rdata;
+    Char *data;
+    UInt16 len;
+    UInt16 size;
+    UInt next = 0;
+    UInt oldest = 0;
+    UInt inflight = 0;
+    UInt i, n;
+    Int rlen;
+    Int status;
+    Int result = IpcResource_S_SUCCESS;
+
+    if (!handle || (num && !entries)) {
+        System_printf("IpcResource_requestBatch: Invalid paramaters\n");
+        return IpcResource_E_INVALARGS;
+    }
+
+    bufs = Memory_alloc(NULL, IpcResource_BATCH_WINDOW * MAXBATCHSIZE, 0,
+                        NULL);
+    if (!bufs) {
+        System_printf("IpcResource_requestBatch: No memory\n");
+        return IpcResource_E_FAIL;
+    }
+
+    while (next < num || inflight > 0) {
+        /* send while there is room in the window */
+        if (next < num && inflight < IpcResource_BATCH_WINDOW) {
+            n = (oldest + inflight) % IpcResource_BATCH_WINDOW;
+            msg = bufs + n * MAXBATCHSIZE;
+            req = (Void *)msg;
+            sent[n].first = next;
+            sent[n].count = 0;
+
+            if (handle->caps & IpcResource_CAP_BATCH) {
+                req->reqType = IpcResource_ReqType_ALLOC_BATCH;
+                breq = (Void *)req->data;
+                size = sizeof(*req) + sizeof(*breq);
+                while (next < num) {
+                    balloc = (Void *)(msg + size);
+                    if (size + sizeof(*balloc) + IpcResource_resLen(
+                            entries[next].type) + sizeof(IpcResource_Processor)
+                            > MAXBATCHSIZE) {
+                        break;
+                    }
+                    rlen = _IpcResource_packAlloc(entries[next].type,
+                            entries[next].resParams, balloc->resName,
+                            balloc->resParams);
+                    if (rlen < 0) {
+                        break;
+                    }
+                    balloc->len = rlen;
+                    size += sizeof(*balloc) + rlen;
+                    next++;
+                    sent[n].count++;
+                }
+                breq->num = sent[n].count;
+            }
+            else {
+                req->reqType = IpcResource_ReqType_ALLOC;
+                rdata = (Void *)req->data;
+                rlen = _IpcResource_packAlloc(entries[next].type,
+                        entries[next].resParams, rdata->resName,
+                        rdata->resParams);
+                if (rlen >= 0) {
+                    size = sizeof(*req) + sizeof(*rdata) + rlen;
+                    next++;
+                    sent[n].count = 1;
+                }
+            }
+
+            /* an invalid entry is failed on its own */
+            if (sent[n].count == 0) {
+                entries[next].status = IpcResource_E_INVALARGS;
+                if (result == IpcResource_S_SUCCESS) {
+                    result = IpcResource_E_INVALARGS;
+                }
+                next++;
+                continue;
+            }
+
+            status = _IpcResource_send(handle, req, size, msg, MAXBATCHSIZE,
+                                       &sent[n].p);
+            if (status) {
+                System_printf("IpcResource_requestBatch: MessageQCopy_send "
+                              "failed status %d\n", status);
+                for (i = 0; i < sent[n].count; i++) {
+                    entries[sent[n].first + i].status = IpcResource_E_FAIL;
+                }
+                if (result == IpcResource_S_SUCCESS) {
+                    result = IpcResource_E_FAIL;
+                }
+                continue;
+            }
+            inflight++;
+            continue;
+        }
+
+        /* complete the oldest */
+        n = oldest;
+        oldest = (oldest + 1) % IpcResource_BATCH_WINDOW;
+        inflight--;
+        msg = bufs + n * MAXBATCHSIZE;
+        ack = (Void *)msg;
+
+        status = _IpcResource_wait(handle, sent[n].p, &len);
+        if (status == IpcResource_S_SUCCESS) {
+            status = _IpcResource_translateError(ack->status);
+        }
+        if (status == IpcResource_S_SUCCESS && len > MAXBATCHSIZE) {
+            status = IpcResource_E_FAIL;
+        }
+
+        data = ack->data;
+        for (i = sent[n].first; i < sent[n].first + sent[n].count; i++) {
+            rlen = IpcResource_resLen(entries[i].type);
+            if (status) {
+                entries[i].status = status;
+            }
+            else if (handle->caps & IpcResource_CAP_BATCH) {
+                IpcResource_BatchAck *back = (Void *)data;
+                UInt16 plen = rlen;
+
+                if (entries[i].type == IpcResource_TYPE_IPU ||
+                    entries[i].type == IpcResource_TYPE_DSP) {
+                    plen = sizeof(IpcResource_Processor);
+                }
+                data += sizeof(*back) + plen;
+                if (data > msg + len) {
+                    entries[i].status = IpcResource_E_FAIL;
+                }
+                else {
+                    entries[i].status =
+                        _IpcResource_translateError(back->status);
+                    entries[i].resHandle = back->resHandle;
+                    if (rlen && !entries[i].status) {
+                        memcpy(entries[i].resParams, back->resParams, rlen);
+                    }
+                }
+            }
+            else {
+                IpcResource_AckData *adata = (Void *)data;
+
+                entries[i].status = IpcResource_S_SUCCESS;
+                entries[i].resHandle = adata->resHandle;
+                if (rlen) {
+                    memcpy(entries[i].resParams, adata->resParams, rlen);
+                }
+            }
+            if (entries[i].status && result == IpcResource_S_SUCCESS) {
+                result = entries[i].status;
+            }
+        }
+    }
+
+    Memory_free(NULL, bufs, IpcResource_BATCH_WINDOW * MAXBATCHSIZE);
+
+    return result;
+}
+
 Int IpcResource_requestData(IpcResource_Handle handle,
                             IpcResource_ResHandle resHandle,
                             IpcResource_ReqDataType dataType,
@@ -292,11 +852,11 @@ Int IpcResource_requestData(IpcResource_Handle handle,
     IpcResource_Ack *ack = (Void *)msg;
     IpcResource_Req *req = (Void *)msg;
     IpcResource_ReqData *reqData = (Void *)req->data;
+    IpcResource_Pending *p;
     UInt16 hlen = sizeof(*reqData);
     UInt16 alen = sizeof(*ack);
     UInt16 rlen = IpcResource_reqDataLen(dataType);
     UInt16 len;
-    UInt32 remote;
     Int status;
 
     if (!handle) {
@@ -313,25 +873,19 @@ Int IpcResource_requestData(IpcResource_Handle handle,
     reqData->resHandle = resHandle;
     reqData->type = dataType;
 
-    Semaphore_pend(handle->sem, BIOS_WAIT_FOREVER);
-    status = MessageQCopy_send(MultiProc_getId("HOST"), handle->remote,
-                        handle->endPoint, req, sizeof(*req) + hlen + rlen);
+    status = _IpcResource_send(handle, req, sizeof(*req) + hlen + rlen, msg,
+                               sizeof(msg), &p);
     if (status) {
-        Semaphore_post(handle->sem);
         System_printf("IpcResource_requestData: MessageQCopy_send "
                       "failed status %d\n", status);
         status = IpcResource_E_FAIL;
         goto end;
     }
 
-    status = MessageQCopy_recv(handle->msgq, ack, &len, &remote,
-                               handle->timeout);
-    Semaphore_post(handle->sem);
+    status = _IpcResource_wait(handle, p, &len);
     if (status) {
-        System_printf("IpcResource_requestData: MessageQCopy_recv "
-                      "failed status %d\n", status);
-        status = (status == MessageQCopy_E_TIMEOUT) ? IpcResource_E_TIMEOUT :
-                 IpcResource_E_FAIL;
+        System_printf("IpcResource_requestData: no ack, status %d\n",
+                      status);
         goto end;
     }
 
@@ -359,10 +913,10 @@ Int IpcResource_setConstraints(IpcResource_Handle handle,
     IpcResource_Ack *ack = (Void *)msg;
     IpcResource_Req *req = (Void *)msg;
     IpcResource_Constraint *c = (Void *)req->data;
+    IpcResource_Pending *p;
     UInt16 rlen = sizeof(*c);
     UInt16 alen = sizeof(*ack);
     UInt16 len;
-    UInt32 remote;
     Int status;
 
     if (!handle) {
@@ -375,15 +929,13 @@ Int IpcResource_setConstraints(IpcResource_Handle handle,
         return IpcResource_E_INVALARGS;
     }
 
-    req->reqType = reqType;
-    c->resHandle = resHandle;
+    _IpcResource_packConstraints(req, reqType, resHandle, constraints);
 
-    memcpy(&c->cdata, constraints, rlen);
-    Semaphore_pend(handle->sem, BIOS_WAIT_FOREVER);
-    status = MessageQCopy_send(MultiProc_getId("HOST"), handle->remote,
-                        handle->endPoint, req, sizeof(*req) + rlen);
+    /* releases are not acked */
+    status = _IpcResource_send(handle, req, sizeof(*req) + rlen,
+               (reqType == IpcResource_ReqType_REL_CONSTRAINTS) ? NULL : msg,
+               sizeof(msg), &p);
     if (status) {
-        Semaphore_post(handle->sem);
         System_printf("IpcResource_setConstraints: MessageQCopy_send "
                       "failed status %d\n", status);
         status = IpcResource_E_FAIL;
@@ -391,25 +943,13 @@ Int IpcResource_setConstraints(IpcResource_Handle handle,
     }
 
     if (reqType == IpcResource_ReqType_REL_CONSTRAINTS) {
-        Semaphore_post(handle->sem);
         goto end;
     }
 
-    status = MessageQCopy_recv(handle->msgq, ack, &len, &remote,
-                               handle->timeout);
-    Semaphore_post(handle->sem);
+    status = _IpcResource_wait(handle, p, &len);
     if (status) {
-        System_printf("IpcResource_setConstraints: MessageQCopy_recv "
-                      "failed status %d\n", status);
-        status = (status == MessageQCopy_E_TIMEOUT) ? IpcResource_E_TIMEOUT :
-                 IpcResource_E_FAIL;
-        goto end;
-    }
-    if (remote != handle->remote) {
-        System_printf("IpcResource_setConstraints: MessageQCopy_recv "
-                      "invalid message source %d, channel source %d\n",
-                      remote, handle->remote);
-        status = IpcResource_E_FAIL;
+        System_printf("IpcResource_setConstraints: no ack, status %d\n",
+                      status);
         goto end;
     }
 
@@ -446,6 +986,118 @@ Int IpcResource_releaseConstraints(IpcResource_Handle handle,
                                       constraints);
 }
 
+/*
+ *  Queue a constraint update, merged with the ones for the same resource
+ *  not sent yet: the latest value of each field is sent after
+ *  IpcResource_ASYNC_DELAY ticks. The callbacks of all the updates merged
+ *  are called, in order, with the status of the merged update. With too
+ *  many resources pending the update is made synchronously; with too many
+ *  callbacks pending for the resource it fails with IpcResource_E_BUSY.
+ */
+static Int _IpcResource_setConstraintsAsync(IpcResource_Handle handle,
+                                        IpcResource_ResHandle resHandle,
+                                        UInt32 reqType,
+                                        IpcResource_ConstraintData *constraints,
+                                        IpcResource_ConstraintsCallback cbFxn,
+                                        UArg cbArg)
+{
+    IpcResource_AsyncUpdate *u = NULL;
+    Bool first;
+    Int status;
+    UInt i;
+
+    if (!handle) {
+        System_printf("IpcResource_setConstraintsAsync: Invalid "
+                      "paramaters\n");
+        return IpcResource_E_INVALARGS;
+    }
+
+    if (!constraints) {
+        System_printf("IpcResource_setConstraintsAsync: needs parameters\n");
+        return IpcResource_E_INVALARGS;
+    }
+
+    Semaphore_pend(handle->sem, BIOS_WAIT_FOREVER);
+    for (i = 0; i < IpcResource_MAX_ASYNC; i++) {
+        if (handle->async[i].used) {
+            if (handle->async[i].resHandle == resHandle) {
+                u = &handle->async[i];
+                break;
+            }
+        }
+        else if (u == NULL) {
+            u = &handle->async[i];
+        }
+    }
+
+    if (u == NULL) {
+        Semaphore_post(handle->sem);
+        status = IpcResource_setConstraints(handle, resHandle, reqType,
+                                            constraints);
+        if (cbFxn) {
+            cbFxn(resHandle, status, cbArg);
+        }
+        return status;
+    }
+
+    /* nothing is merged if the callback could not be kept */
+    if (u->used && cbFxn && u->numCbs == IpcResource_MAX_ASYNC_CBS) {
+        Semaphore_post(handle->sem);
+        System_printf("IpcResource_setConstraintsAsync: too many callbacks "
+                      "pending for resource %d\n", resHandle);
+        return IpcResource_E_BUSY;
+    }
+
+    first = FALSE;
+    if (!u->used) {
+        memset(u, 0, sizeof(*u));
+        u->used = TRUE;
+        u->resHandle = resHandle;
+        first = (++handle->numAsync == 1);
+    }
+
+    if (reqType == IpcResource_ReqType_REQ_CONSTRAINTS) {
+        _IpcResource_merge(&u->req, constraints);
+        u->rel.mask &= ~constraints->mask;
+    }
+    else {
+        _IpcResource_merge(&u->rel, constraints);
+        u->req.mask &= ~constraints->mask;
+    }
+    if (cbFxn) {
+        u->cbFxn[u->numCbs] = cbFxn;
+        u->cbArg[u->numCbs] = cbArg;
+        u->numCbs++;
+    }
+    Semaphore_post(handle->sem);
+
+    if (first) {
+        Semaphore_post(handle->flushSem);
+    }
+
+    return IpcResource_S_SUCCESS;
+}
+
+Int IpcResource_requestConstraintsAsync(IpcResource_Handle handle,
+                                        IpcResource_ResHandle resHandle,
+                                        Void *constraints,
+                                        IpcResource_ConstraintsCallback cbFxn,
+                                        UArg cbArg)
+{
+    return _IpcResource_setConstraintsAsync(handle, resHandle,
+            IpcResource_ReqType_REQ_CONSTRAINTS, constraints, cbFxn, cbArg);
+}
+
+Int IpcResource_releaseConstraintsAsync(IpcResource_Handle handle,
+                                        IpcResource_ResHandle resHandle,
+                                        Void *constraints,
+                                        IpcResource_ConstraintsCallback cbFxn,
+                                        UArg cbArg)
+{
+    return _IpcResource_setConstraintsAsync(handle, resHandle,
+            IpcResource_ReqType_REL_CONSTRAINTS, constraints, cbFxn, cbArg);
+}
+
 Int IpcResource_release(IpcResource_Handle handle,
                         IpcResource_ResHandle resHandle)
 {
@@ -190,6 +190,23 @@ typedef struct IpcResource_Object *IpcResource_Handle;
 
 typedef Int32 IpcResource_ResHandle;
 
+/*!
+ *  @brief  One resource of an IpcResource_requestBatch() call
+ */
+typedef struct {
+    IpcResource_Type      type;         /**< Resource type */
+    Void                 *resParams;    /**< As for IpcResource_request */
+    IpcResource_ResHandle resHandle;    /**< [out] Handle when allocated */
+    Int                   status;       /**< [out] Status of this resource */
+} IpcResource_BatchEntry;
+
+/*!
+ *  @brief  Completion of an asynchronous constraint update, with the
+ *          status of the message that carried it
+ */
+typedef Void (*IpcResource_ConstraintsCallback)(
+                IpcResource_ResHandle resHandle, Int status, UArg arg);
+
 /* =============================================================================
  *  IpcResource Functions:
  * =============================================================================
@@ -199,6 +216,8 @@ IpcResource_Handle IpcResource_connect(UInt timeout);
 Int IpcResource_request(IpcResource_Handle handle,
                         IpcResource_ResHandle *resHandle,
                         IpcResource_Type type, Void *resParams);
+Int IpcResource_requestBatch(IpcResource_Handle handle,
+                             IpcResource_BatchEntry *entries, UInt num);
 Int IpcResource_release(IpcResource_Handle handle,
                         IpcResource_ResHandle resHandle);
 Int IpcResource_requestConstraints(IpcResource_Handle handle,
@@ -207,6 +226,16 @@ Int IpcResource_requestConstraints(IpcResource_Handle handle,
 Int IpcResource_releaseConstraints(IpcResource_Handle handle,
                                    IpcResource_ResHandle resHandle,
                                    Void *constraints);
+Int IpcResource_requestConstraintsAsync(IpcResource_Handle handle,
+                                        IpcResource_ResHandle resHandle,
+                                        Void *constraints,
+                                        IpcResource_ConstraintsCallback cbFxn,
+                                        UArg cbArg);
+Int IpcResource_releaseConstraintsAsync(IpcResource_Handle handle,
+                                        IpcResource_ResHandle resHandle,
+                                        Void *constraints,
+                                        IpcResource_ConstraintsCallback cbFxn,
+                                        UArg cbArg);
 Int IpcResource_disconnect(IpcResource_Handle handle);
 Int IpcResource_requestData(IpcResource_Handle handle,
                             IpcResource_ResHandle resHandle,
@@ -65,9 +65,36 @@ typedef enum {
     IpcResource_ReqType_FREE,
     IpcResource_ReqType_REQ_CONSTRAINTS,
     IpcResource_ReqType_REL_CONSTRAINTS,
-    IpcResource_ReqType_REQ_DATA
+    IpcResource_ReqType_REQ_DATA,
+    IpcResource_ReqType_ALLOC_BATCH
 } IpcResource_ReqType;
 
+/*
+ * The request type is in the low 16 bits of reqType. A host advertising
+ * IpcResource_CAP_REQID in the reqType of its connect ack accepts a
+ * request id in the high 16 bits and returns it in the ack, so acks can
+ * come back in any order. Without it acks are matched in send order.
+ * IpcResource_CAP_BATCH means it understands IpcResource_ReqType_ALLOC_BATCH.
+ */
+#define IpcResource_CAP_REQID               0x00010000
+#define IpcResource_CAP_BATCH               0x00020000
+
+#define IpcResource_REQ_TYPE(reqType)       ((reqType) & 0xFFFF)
+#define IpcResource_REQ_ID(reqType)         ((reqType) >> 16)
+#define IpcResource_REQ_TAG(reqType, id)    ((reqType) | ((UInt32)(id) << 16))
+
+/* Requests outstanding on one handle, and those one batch may use */
+#define IpcResource_MAX_PENDING             8
+#define IpcResource_BATCH_WINDOW            4
+
+/* Resources with asynchronous constraint updates waiting to be sent, and
+ * the ticks the updates are held to be merged before sending */
+#define IpcResource_MAX_ASYNC               4
+#define IpcResource_ASYNC_DELAY             2
+
+/* Callbacks of the updates merged into one pending update */
+#define IpcResource_MAX_ASYNC_CBS           4
+
 typedef struct {
     Char   resName[16];
     Char   resParams[];
@@ -103,12 +130,57 @@ typedef struct {
     Char name[16];
 } IpcResource_Processor;
 
+/* ALLOC_BATCH request data: num entries of IpcResource_BatchAlloc */
+typedef struct {
+    UInt32 num;
+    Char   entries[];
+} IpcResource_BatchReq;
+
+typedef struct {
+    UInt32 len;                 /* of resParams */
+    Char   resName[16];
+    Char   resParams[];
+} IpcResource_BatchAlloc;
+
+/* ALLOC_BATCH ack data: an IpcResource_BatchAck for each entry, in order */
+typedef struct {
+    Int32  status;
+    UInt32 resHandle;
+    UInt32 base;
+    Char   resParams[];
+} IpcResource_BatchAck;
+
 typedef struct {
     UInt32 resHandle;
     UInt32 type;
     Char   data[];
 } IpcResource_ReqData;
 
+/* A request waiting for its ack */
+typedef struct IpcResource_Pending {
+    struct IpcResource_Pending *next;
+    Semaphore_Handle    sem;        /* posted when the ack is in */
+    UInt16              id;
+    Bool                busy;
+    Bool                done;       /* the ack has been copied in */
+    Bool                abandoned;  /* timed out, drop the ack */
+    Void               *ack;
+    UInt16              maxLen;
+    UInt16              len;
+} IpcResource_Pending;
+
+/* The merged constraint updates of one resource, latest value per field,
+ * and the callbacks of all the updates merged */
+typedef struct {
+    Bool                            used;
+    IpcResource_ResHandle           resHandle;
+    IpcResource_ConstraintData      req;
+    IpcResource_ConstraintData      rel;
+    UInt                            numCbs;
+    IpcResource_ConstraintsCallback cbFxn[IpcResource_MAX_ASYNC_CBS];
+    UArg                            cbArg[IpcResource_MAX_ASYNC_CBS];
+} IpcResource_AsyncUpdate;
+
 /*!
  *  @brief  IpcResource_Object type
  */
@@ -116,8 +188,22 @@ struct IpcResource_Object {
     UInt32              endPoint;
     UInt32              remote;
     UInt                timeout;
-    Semaphore_Handle    sem;
+    Semaphore_Handle    sem;        /* protects the pending list */
     MessageQCopy_Handle msgq;
+    UInt32              caps;
+    UInt16              nextId;
+    Bool                shutdown;
+    Task_Handle         recvTask;
+    Semaphore_Handle    exitSem;
+    Semaphore_Handle    slotSem;    /* counts the free pending entries */
+    IpcResource_Pending *head;      /* in send order */
+    IpcResource_Pending *tail;
+    IpcResource_Pending pending[IpcResource_MAX_PENDING];
+    Task_Handle         flushTask;
+    Semaphore_Handle    flushSem;   /* posted when an update is queued */
+    Bool                flushStop;
+    UInt                numAsync;   /* protected by sem, as is async */
+    IpcResource_AsyncUpdate async[IpcResource_MAX_ASYNC];
 };
 
 /* Names should match the IpcResource_Type definitions */
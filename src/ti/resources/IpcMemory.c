@@ -38,6 +38,8 @@
 #include <xdc/runtime/System.h>
 #include <xdc/runtime/Startup.h>
 
+#include <string.h>
+
 #include <ti/resources/rsc_types.h>
 #include "package/internal/IpcMemory.xdc.h"
 
@@ -126,3 +128,26 @@ Int IpcMemory_physToVirt(UInt32 pa, UInt32 *va)
 
     return (IpcMemory_E_NOTFOUND);
 }
+
+/*
+ *  ======== IpcMemory_getRegion ========
+ */
+Int IpcMemory_getRegion(String name, UInt32 *da, UInt32 *len)
+{
+    UInt32 i;
+    IpcMemory_MemEntry *entry;
+
+    *da = 0;
+    *len = 0;
+
+    for (i = 0; i < module->pTable->num; i++) {
+        entry = IpcMemory_getEntry(i);
+        if (entry && strncmp(entry->name, name, sizeof(entry->name)) == 0) {
+                *da = entry->da;
+                *len = entry->len;
+                return (IpcMemory_S_SUCCESS);
+        }
+    }
+
+    return (IpcMemory_E_NOTFOUND);
+}
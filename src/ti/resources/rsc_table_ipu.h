@@ -44,6 +44,7 @@
 
 #include <ti/resources/rsc_types.h>
 #include <ti/gates/hwspinlock/HwSpinlock.h>
+#include <ti/ipc/rpmsg/ShmRing.h>
 
 /* IPU Memory Map */
 #define L4_44XX_BASE            0x4a000000
@@ -151,11 +152,18 @@
 /* flip up bits whose indices represent features we support */
 #define RPMSG_IPU_C0_FEATURES   1
 
+/* SMP builds have a trace entry for each core's SysMin ring */
+#ifdef SMP
+#define NUM_ENTRIES             18
+#else
+#define NUM_ENTRIES             17
+#endif
+
 struct resource_table {
     UInt32 version;
     UInt32 num;
     UInt32 reserved[2];
-    UInt32 offset[16];  /* Should match 'num' in actual definition */
+    UInt32 offset[NUM_ENTRIES];  /* Should match 'num' in actual definition */
 
     /* rpmsg vdev entry */
     struct fw_rsc_vdev rpmsg_vdev;
@@ -174,6 +182,11 @@ struct resource_table {
     /* trace entry */
     struct fw_rsc_trace trace;
 
+#ifdef SMP
+    /* trace entry for core 1 */
+    struct fw_rsc_trace trace1;
+#endif
+
     /* devmem entry */
     struct fw_rsc_devmem devmem0;
 
@@ -206,18 +219,23 @@ struct resource_table {
 
     /* hwspinlock custom entry */
     struct fw_rsc_custom hwspin;
+
+    /* inter-core shmring custom entry */
+    struct fw_rsc_custom_shmring_entry shmring;
 };
 
 #define TRACEBUFADDR (UInt32)&ti_trace_SysMin_Module_State_0_outbuf__A
+#define TRACEBUFSIZE 0x8000     /* SysMin.bufSize, per core */
 #define HWSPINKLOCKSTATEADDR (UInt32)&ti_gates_HwSpinlock_sharedState
 #define HWSPINKLOCKNUMADDR (UInt32)&ti_gates_HwSpinlock_numLocks
+#define SHMRINGADDR (UInt32)&ti_ipc_ShmRing_region
 
 #pragma DATA_SECTION(ti_resources_ResourceTable, ".resource_table")
 #pragma DATA_ALIGN(ti_resources_ResourceTable, 4096)
 
 struct resource_table ti_resources_ResourceTable = {
     1,      /* we're the first version that implements this */
-    16,     /* number of entries in the table */
+    NUM_ENTRIES,    /* number of entries in the table */
     0, 0,   /* reserved, must be zero */
     /* offsets to entries */
     {
@@ -226,6 +244,9 @@ struct resource_table ti_resources_ResourceTable = {
         offsetof(struct resource_table, data_cout),
         offsetof(struct resource_table, ipcdata_cout),
         offsetof(struct resource_table, trace),
+#ifdef SMP
+        offsetof(struct resource_table, trace1),
+#endif
         offsetof(struct resource_table, devmem0),
         offsetof(struct resource_table, devmem1),
         offsetof(struct resource_table, devmem2),
@@ -237,6 +258,7 @@ struct resource_table ti_resources_ResourceTable = {
         offsetof(struct resource_table, devmem8),
         offsetof(struct resource_table, devmem9),
         offsetof(struct resource_table, hwspin),
+        offsetof(struct resource_table, shmring),
     },
 
     /* rpmsg vdev entry */
@@ -268,9 +290,16 @@ struct resource_table ti_resources_ResourceTable = {
     },
 
     {
-        TYPE_TRACE, TRACEBUFADDR, 0x8000, 0, "trace:sysm3",
+        TYPE_TRACE, TRACEBUFADDR, TRACEBUFSIZE, 0, "trace:sysm3",
     },
 
+#ifdef SMP
+    {
+        TYPE_TRACE, TRACEBUFADDR + TRACEBUFSIZE, TRACEBUFSIZE, 0,
+        "trace:appm3",
+    },
+#endif
+
     {
         TYPE_DEVMEM,
         IPU_MEM_IPC_VRING, PHYS_MEM_IPC_VRING,
@@ -336,6 +365,12 @@ struct resource_table ti_resources_ResourceTable = {
         sizeof(struct fw_rsc_custom_hwspin),
         { HWSPINKLOCKNUMADDR, HWSPINKLOCKSTATEADDR, "hwspin"},
     },
+
+    {
+        TYPE_CUSTOM, TYPE_SHMRING,
+        sizeof(struct fw_rsc_custom_shmring),
+        { SHMRINGADDR, ShmRing_REGION_SIZE, ShmRing_NUM_RINGS, "ipc_rings"},
+    },
 };
 
 #endif /* _RSC_TABLE_IPU_H_ */
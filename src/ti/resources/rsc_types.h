@@ -77,6 +77,7 @@
 
 /* Custom Resource info: Must match drivers/remoteproc/omap_remoteproc.h */
 #define TYPE_HWSPIN      1
+#define TYPE_SHMRING     2
 
 /* Resource info specific to hwspinlock */
 struct fw_rsc_custom_hwspin {
@@ -85,9 +86,18 @@ struct fw_rsc_custom_hwspin {
     Char    name[32];
 };
 
+/* Resource info specific to inter-core shared-memory rings */
+struct fw_rsc_custom_shmring {
+    UInt32  da;
+    UInt32  len;
+    UInt32  num_rings;
+    Char    name[32];
+};
+
 union fw_custom {
     /* add custom resources here */
     struct fw_rsc_custom_hwspin hwspin;
+    struct fw_rsc_custom_shmring shmring;
     /* maintain reserved as the last element */
     UInt32 reserved;
 };
@@ -148,4 +158,12 @@ struct fw_rsc_custom {
     union fw_custom rsc;
 };
 
+/* Same layout as fw_rsc_custom, for statically initializing a shmring */
+struct fw_rsc_custom_shmring_entry {
+    UInt32          type;
+    UInt32          sub_type;
+    UInt32          rsc_size;
+    struct fw_rsc_custom_shmring rsc;
+};
+
 #endif /* _RSC_TYPES_H_ */
@@ -39,8 +39,13 @@
 #include <xdc/std.h>
 #include <xdc/cfg/global.h>
 #include <xdc/runtime/System.h>
+#include <xdc/runtime/Memory.h>
 
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Clock.h>
 #include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/knl/Semaphore.h>
+#include <ti/sysbios/gates/GateMutex.h>
 
 #include <ti/grcm/RcmTypes.h>
 #include <ti/grcm/RcmServer.h>
@@ -50,6 +55,7 @@
 #include <stdlib.h>
 
 #include <ti/ipc/rpmsg/MessageQCopy.h>
+#include <ti/pm/IpcPower.h>
 #include "rpmsg_omx.h"
 #include "NameMap.h"
 #include "ServiceMgr.h"
@@ -57,28 +63,91 @@
 
 #define  MAX_NAMELEN       64
 
-/* This artificially limits the number of service instances on this core: */
-#define  MAX_TUPLES        256
-#define  FREE_TUPLE_KEY    0xFFFFFFFF
+/* Initial number of buckets of the service instance table; it doubles
+ * whenever it holds more than two instances per bucket:
+ */
+#define  INIT_BUCKETS      32
+
+/* Slots of the service name index (a power of two, >= 2x service types) */
+#define  NAME_SLOTS        (2 * ServiceMgr_NUMSERVICETYPES)
 
 #define  MAX_SERVICES      4
 
-/* ServiceMgr disconnect hook function */
-static ServiceMgr_disconnectFuncPtr ServiceMgr_disconnectUserFxn = NULL;
+/* Priority of the task building prewarmed service instances (lowest) */
+#define  PREWARM_PRIORITY  1
+
+/* Priority of the task tearing down disconnected instances (lowest) */
+#define  REAPER_PRIORITY   1
+
+/* Cores adding to the IpcPower idle count */
+#ifdef SMP
+#define  IDLE_CORES        2
+#else
+#define  IDLE_CORES        1
+#endif
+
+/* ServiceMgr disconnect hook functions, in registration order */
+struct DisconnectHook {
+    struct DisconnectHook        *next;
+    Service_Handle               srvc;      /* NULL: any instance */
+    Ptr                          data;
+    ServiceMgr_disconnectFuncPtr fxn;
+};
+
+static struct DisconnectHook *disconnectHooks = NULL;
 
 struct ServiceDef {
     Char                   name[MAX_NAMELEN];
+    UInt32                 hash;        /* nameHash() of name */
     RcmServer_Params       rcmServerParams;
     Bool                   taken;
+    UInt                   prewarm;     /* instances to keep ready */
+    UInt                   numReady;    /* instances in ready[] */
+    UInt                   numActive;   /* instances handed out */
+    RcmServer_Handle       ready[ServiceMgr_MAX_PREWARM];
 };
 
 struct ServiceDef serviceDefs[ServiceMgr_NUMSERVICETYPES];
 
+/* Name index: open addressing on the name hash, each slot holds the
+ * serviceDefs index + 1, or 0 when free.
+ */
+static UInt8 nameSlots[NAME_SLOTS];
+
+/* Service instances, hashed by endpoint address. Entries of removed
+ * instances are kept on a free list for reuse, so connect/disconnect
+ * storms do not go to the heap for each instance.
+ */
 struct Tuple {
-    UInt32   key;
-    UInt32   value;
+    struct Tuple      *next;
+    UInt32            key;
+    UInt32            value;
+    struct ServiceDef *sd;
+};
+
+static struct Tuple     **tupleBuckets = NULL;
+static UInt             numBuckets = 0;
+static UInt             numTuples = 0;
+static struct Tuple     *freeTuples = NULL;
+static GateMutex_Handle tupleGate = NULL;
+
+/* Disconnected instances waiting for the reaper task, oldest first. The
+ * queue and the disconnect hooks are protected by tupleGate as well.
+ */
+static struct Tuple     *reapHead = NULL;
+static struct Tuple     *reapTail = NULL;
+static Semaphore_Handle reapSem = NULL;
+
+/* Idle estimate of the last load window, protected by tupleGate */
+static UInt32           idleCount = 0;
+static UInt32           idleTicks = 0;
+static UInt32           idlePercent = 100;
+
+static Int32 ServiceMgr_loadFxn(UInt32 size, UInt32 *data);
+
+static RcmServer_FxnDesc loadFxnAry[] = {
+    {"ServiceMgr_loadFxn", ServiceMgr_loadFxn}
 };
-struct Tuple Tuples[MAX_TUPLES];
 
 typedef struct {
     Task_FuncPtr    fxn;
@@ -90,11 +159,53 @@ typedef struct {
 
 static ServiceMgr_ServiceTask serviceTasks[MAX_SERVICES];
 
+/* Prewarmed instances: the gate protects ready[] and numReady of every
+ * service type, the semaphore wakes the task which refills them.
+ */
+static GateMutex_Handle prewarmGate = NULL;
+static Semaphore_Handle prewarmSem = NULL;
+static Task_Handle      prewarmTask = NULL;
+static Bool             servicesStarted = FALSE;
+
+static Void startPrewarm();
+static Void reaperTaskFxn(UArg arg0, UArg arg1);
+
+/* FNV-1a hash of a service name */
+static UInt32 nameHash(String name)
+{
+    UInt32 hash = 2166136261u;
+
+    while (*name != '\0') {
+        hash = (hash ^ (UInt8)*name++) * 16777619u;
+    }
+
+    return (hash);
+}
+
+/* Look up a registered service type by name, NULL if there is none */
+static struct ServiceDef *findService(String name)
+{
+    UInt32            hash = nameHash(name);
+    UInt              slot = hash & (NAME_SLOTS - 1);
+    struct ServiceDef *sd;
+
+    while (nameSlots[slot] != 0) {
+        sd = &serviceDefs[nameSlots[slot] - 1];
+        if ((sd->hash == hash) && !strcmp(name, sd->name)) {
+            return (sd);
+        }
+        slot = (slot + 1) & (NAME_SLOTS - 1);
+    }
+
+    return (NULL);
+}
+
 
 Void ServiceMgr_init()
 {
     static Int  curInit = 0;
     UInt        i;
+    RcmServer_Params params;
 
     if (curInit++ != 0) {
         return; /* module already initialized */
@@ -104,10 +215,30 @@ Void ServiceMgr_init()
 
     for (i = 0; i < ServiceMgr_NUMSERVICETYPES; i++) {
        serviceDefs[i].taken = FALSE;
+       serviceDefs[i].prewarm = 0;
+       serviceDefs[i].numReady = 0;
+       serviceDefs[i].numActive = 0;
     }
 
-    for (i = 0; i < MAX_TUPLES; i++) {
-       Tuples[i].key = FREE_TUPLE_KEY;
+    for (i = 0; i < NAME_SLOTS; i++) {
+       nameSlots[i] = 0;
+    }
+
+    prewarmGate = GateMutex_create(NULL, NULL);
+    prewarmSem = Semaphore_create(0, NULL, NULL);
+
+    tupleGate = GateMutex_create(NULL, NULL);
+    reapSem = Semaphore_create(0, NULL, NULL);
+    tupleBuckets = Memory_alloc(NULL, INIT_BUCKETS * sizeof(struct Tuple *),
+                                0, NULL);
+    if (tupleBuckets == NULL) {
+        System_printf("ServiceMgr_init: could not allocate instance table\n");
+    }
+    else {
+        numBuckets = INIT_BUCKETS;
+        for (i = 0; i < numBuckets; i++) {
+           tupleBuckets[i] = NULL;
+        }
     }
 
     for (i = 0; i < MAX_SERVICES; i++) {
@@ -115,12 +246,19 @@ Void ServiceMgr_init()
         serviceTasks[i].fxn = NULL;
         serviceTasks[i].reserved = (UInt16) -1;
     }
+
+    /* Publish the load of this core, for the host to place instances: */
+    RcmServer_Params_init(&params);
+    params.fxns.length = sizeof(loadFxnAry) / sizeof(loadFxnAry[0]);
+    params.fxns.elem = loadFxnAry;
+    ServiceMgr_register(ServiceMgr_LOAD_SERVICE, &params);
 }
 
 UInt ServiceMgr_start(UInt16 reserved)
 {
     UInt        i;
     UInt        count = 0;
+    Task_Params params;
     static Bool started = FALSE;
 
     if (started) {
@@ -132,6 +270,26 @@ UInt ServiceMgr_start(UInt16 reserved)
         count++;
     }
 
+    /* Disconnected instances are torn down by the reaper, so the service
+     * tasks can go back to their requests right away:
+     */
+    Task_Params_init(&params);
+    params.instance->name = "ServiceMgr_reaper";
+    params.priority = REAPER_PRIORITY;
+
+    if (Task_create(reaperTaskFxn, &params, NULL) == NULL) {
+        System_printf("ServiceMgr_start: could not create reaper task\n");
+    }
+
+    /* a second call would start the tasks and prewarm pass again */
+    started = TRUE;
+
+    /* Build the prewarmed instances only after the service tasks have run
+     * up to their first receive; the transport is set up by then.
+     */
+    servicesStarted = TRUE;
+    startPrewarm();
+
     return (count);
 }
 
@@ -170,6 +328,7 @@ Bool ServiceMgr_registerSrvTask(UInt16 reserved, Task_FuncPtr func,
 Bool ServiceMgr_register(String name, RcmServer_Params  *rcmServerParams)
 {
     UInt              i;
+    UInt              slot;
     Bool              found = FALSE;
     struct ServiceDef *sd;
 
@@ -183,6 +342,7 @@ Bool ServiceMgr_register(String name, RcmServer_Params  *rcmServerParams)
             if (!serviceDefs[i].taken) {
                 sd = &serviceDefs[i];
                 strcpy(sd->name, name);
+                sd->hash = nameHash(name);
                 sd->rcmServerParams = *rcmServerParams;
                 sd->taken = TRUE;
                 found = TRUE;
@@ -191,9 +351,138 @@ Bool ServiceMgr_register(String name, RcmServer_Params  *rcmServerParams)
         }
     }
 
+    /* Index it by name; the index has twice the slots of serviceDefs */
+    if (found) {
+        slot = sd->hash & (NAME_SLOTS - 1);
+        while (nameSlots[slot] != 0) {
+            slot = (slot + 1) & (NAME_SLOTS - 1);
+        }
+        nameSlots[slot] = i + 1;
+    }
+
     return(found);
 }
 
+Bool ServiceMgr_setPrewarm(String name, UInt count)
+{
+    IArg              key;
+    struct ServiceDef *sd;
+
+    if (count > ServiceMgr_MAX_PREWARM) {
+        System_printf("ServiceMgr_setPrewarm: count larger than %d\n",
+                       ServiceMgr_MAX_PREWARM);
+        return FALSE;
+    }
+
+    sd = findService(name);
+    if (sd == NULL) {
+        System_printf("ServiceMgr_setPrewarm: unrecognized service name: %s\n",
+                       name);
+        return FALSE;
+    }
+
+    key = GateMutex_enter(prewarmGate);
+    sd->prewarm = count;
+    GateMutex_leave(prewarmGate, key);
+
+    if (servicesStarted) {
+        startPrewarm();
+    }
+
+    return TRUE;
+}
+
+/* Prewarm task: build and start instances until each service type has
+ * as many ready as it asked for, and drop any beyond that.
+ */
+static Void prewarmTaskFxn(UArg arg0, UArg arg1)
+{
+    UInt              i;
+    IArg              key;
+    Int               status;
+    UInt              need;
+    struct ServiceDef *sd;
+    RcmServer_Handle  rcmSrvHandle;
+
+    while (TRUE) {
+        Semaphore_pend(prewarmSem, BIOS_WAIT_FOREVER);
+
+        for (i = 0; i < ServiceMgr_NUMSERVICETYPES; i++) {
+            sd = &serviceDefs[i];
+
+            if (!sd->taken) {
+                continue;
+            }
+
+            do {
+                rcmSrvHandle = NULL;
+
+                key = GateMutex_enter(prewarmGate);
+                if (sd->numReady > sd->prewarm) {
+                    rcmSrvHandle = sd->ready[--sd->numReady];
+                }
+                need = (sd->numReady < sd->prewarm);
+                GateMutex_leave(prewarmGate, key);
+
+                if (rcmSrvHandle != NULL) {
+                    RcmServer_delete(&rcmSrvHandle);
+                    need = TRUE;  /* check again */
+                    continue;
+                }
+
+                if (!need) {
+                    break;
+                }
+
+                /* create and start the instance outside of the gate */
+                status = RcmServer_create(sd->name, &sd->rcmServerParams,
+                                          &rcmSrvHandle);
+
+                if (status < 0) {
+                    System_printf("prewarm: RcmServer_create() returned error"
+                                  " %d\n", status);
+                    break;
+                }
+
+                RcmServer_start(rcmSrvHandle);
+
+                key = GateMutex_enter(prewarmGate);
+                if (sd->numReady < sd->prewarm) {
+                    sd->ready[sd->numReady++] = rcmSrvHandle;
+                    rcmSrvHandle = NULL;
+                }
+                GateMutex_leave(prewarmGate, key);
+
+                /* the count was lowered meanwhile */
+                if (rcmSrvHandle != NULL) {
+                    RcmServer_delete(&rcmSrvHandle);
+                }
+            } while (need);
+        }
+    }
+}
+
+/* Create the prewarm task on first use, and have it check all services */
+static Void startPrewarm()
+{
+    Task_Params       params;
+
+    if (prewarmTask == NULL) {
+        Task_Params_init(&params);
+        params.instance->name = "ServiceMgr_prewarm";
+        params.priority = PREWARM_PRIORITY;
+
+        prewarmTask = Task_create(prewarmTaskFxn, &params, NULL);
+
+        if (prewarmTask == NULL) {
+            System_printf("ServiceMgr: could not create prewarm task\n");
+            return;
+        }
+    }
+
+    Semaphore_post(prewarmSem);
+}
+
 Void ServiceMgr_send(Service_Handle srvc, Ptr data, UInt16 len)
 {
     UInt32 local;
@@ -218,113 +507,381 @@ Void ServiceMgr_send(Service_Handle srvc, Ptr data, UInt16 len)
 Bool ServiceMgr_registerDisconnectFxn(Service_Handle srvc, Ptr data,
                                       ServiceMgr_disconnectFuncPtr func)
 {
+    IArg                  key;
+    struct DisconnectHook *hook;
+    struct DisconnectHook **last;
+
     if (func == NULL) {
         System_printf("ServiceMgr_registerDisconnectFxn: Invalid function.\n");
         return FALSE;
     }
 
-    /* Register the user-supplied function */
-    if (!ServiceMgr_disconnectUserFxn) {
-        ServiceMgr_disconnectUserFxn = func;
+    hook = Memory_alloc(NULL, sizeof(struct DisconnectHook), 0, NULL);
+    if (hook == NULL) {
+        System_printf("ServiceMgr_registerDisconnectFxn: out of memory.\n");
+        return FALSE;
+    }
+
+    hook->next = NULL;
+    hook->srvc = srvc;
+    hook->data = data;
+    hook->fxn = func;
+
+    /* Add the user-supplied function at the end of the list */
+    key = GateMutex_enter(tupleGate);
+    for (last = &disconnectHooks; *last != NULL; last = &(*last)->next) {
     }
+    *last = hook;
+    GateMutex_leave(tupleGate, key);
+
     return TRUE;
 }
 
 /* Tuple store/retrieve fxns:  */
 
-static Bool storeTuple(UInt32 key, UInt32 value)
+/* Endpoint addresses are handed out in sequence, so the low bits spread
+ * them evenly over the buckets.
+ */
+#define tupleBucket(key)  (&tupleBuckets[(key) & (numBuckets - 1)])
+
+/* Double the bucket count, called with tupleGate entered. On failure the
+ * table simply keeps its size, with longer chains.
+ */
+static Void growTuples()
 {
     UInt              i;
-    Bool              stored = FALSE;
+    UInt              oldNum = numBuckets;
+    struct Tuple      **oldBuckets = tupleBuckets;
+    struct Tuple      **buckets;
+    struct Tuple      *t;
+    struct Tuple      **b;
+
+    buckets = Memory_alloc(NULL, 2 * oldNum * sizeof(struct Tuple *), 0, NULL);
+    if (buckets == NULL) {
+        return;
+    }
+
+    tupleBuckets = buckets;
+    numBuckets = 2 * oldNum;
+    for (i = 0; i < numBuckets; i++) {
+        tupleBuckets[i] = NULL;
+    }
 
-    if (key == FREE_TUPLE_KEY) {
-        System_printf("storeTuple: reserved key %d\n", key);
+    for (i = 0; i < oldNum; i++) {
+        while ((t = oldBuckets[i]) != NULL) {
+            oldBuckets[i] = t->next;
+            b = tupleBucket(t->key);
+            t->next = *b;
+            *b = t;
+        }
+    }
+
+    Memory_free(NULL, oldBuckets, oldNum * sizeof(struct Tuple *));
+}
+
+static Bool storeTuple(UInt32 key, UInt32 value, struct ServiceDef *sd)
+{
+    IArg              gateKey;
+    struct Tuple      *t;
+    struct Tuple      **b;
+
+    if (numBuckets == 0) {
+        return (FALSE);
+    }
+
+    gateKey = GateMutex_enter(tupleGate);
+
+    if ((t = freeTuples) != NULL) {
+        freeTuples = t->next;
     }
     else {
-        /* Search the array for a free slot: */
-        for (i = 0; (i < MAX_TUPLES) && (stored == FALSE); i++) {
-           if (Tuples[i].key == FREE_TUPLE_KEY) {
-               Tuples[i].key = key;
-               Tuples[i].value = value;
-               stored = TRUE;
-               break;
-           }
+        t = Memory_alloc(NULL, sizeof(struct Tuple), 0, NULL);
+    }
+
+    if (t != NULL) {
+        t->key = key;
+        t->value = value;
+        t->sd = sd;
+        sd->numActive++;
+        b = tupleBucket(key);
+        t->next = *b;
+        *b = t;
+
+        if (++numTuples > 2 * numBuckets) {
+            growTuples();
         }
     }
 
-    return(stored);
+    GateMutex_leave(tupleGate, gateKey);
+
+    return (t != NULL);
 }
 
+/* Take the tuple of an instance out of the table, and queue it for the
+ * reaper task, which puts it on the free list once the instance is gone.
+ */
 static Bool removeTuple(UInt32 key, UInt32 * value)
 {
-    UInt              i;
+    IArg              gateKey;
     Bool              found = FALSE;
+    struct Tuple      *t;
+    struct Tuple      **b;
 
-    /* Search the array for tuple matching key: */
-    for (i = 0; (i < MAX_TUPLES) && (found == FALSE); i++) {
-       if (Tuples[i].key == key) {
-           found = TRUE;
-           *value = Tuples[i].value;
-           /* and free it... */
-           Tuples[i].value = 0;
-           Tuples[i].key = FREE_TUPLE_KEY;
-           break;
-       }
+    if (numBuckets == 0) {
+        return (FALSE);
+    }
+
+    gateKey = GateMutex_enter(tupleGate);
+
+    /* Search the chain for the tuple matching key: */
+    for (b = tupleBucket(key); (t = *b) != NULL; b = &t->next) {
+        if (t->key == key) {
+            found = TRUE;
+            *value = t->value;
+            /* and hand it to the reaper... */
+            *b = t->next;
+            t->next = NULL;
+            if (reapTail != NULL) {
+                reapTail->next = t;
+            }
+            else {
+                reapHead = t;
+            }
+            reapTail = t;
+            t->sd->numActive--;
+            numTuples--;
+            break;
+        }
+    }
+
+    GateMutex_leave(tupleGate, gateKey);
+
+    if (found) {
+        Semaphore_post(reapSem);
     }
 
     return(found);
 }
 
-UInt32 ServiceMgr_createService(Char * name, UInt32 * endpt)
+/* Run the disconnect hooks of an instance, and drop those registered for
+ * it alone. Only the reaper removes hooks, so the list can be walked
+ * outside the gate; new hooks are only ever appended.
+ */
+static Void runDisconnectHooks(Service_Handle srvc)
 {
-    Int i;
-    Int status = 0;
-    struct ServiceDef *sd;
+    IArg                  key;
+    struct DisconnectHook *hook;
+    struct DisconnectHook **prev;
+    struct DisconnectHook *own = NULL;
+    struct DisconnectHook **ownTail = &own;
+
+    key = GateMutex_enter(tupleGate);
+    prev = &disconnectHooks;
+    while ((hook = *prev) != NULL) {
+        if (hook->srvc == srvc) {
+            *prev = hook->next;
+            hook->next = NULL;
+            *ownTail = hook;
+            ownTail = &hook->next;
+        }
+        else {
+            prev = &hook->next;
+        }
+    }
+    GateMutex_leave(tupleGate, key);
+
+    /* hooks of this instance first, then those for any instance */
+    while ((hook = own) != NULL) {
+        own = hook->next;
+        hook->fxn(srvc, hook->data);
+        Memory_free(NULL, hook, sizeof(struct DisconnectHook));
+    }
+
+    for (hook = disconnectHooks; hook != NULL; hook = hook->next) {
+        if (hook->srvc == NULL) {
+            hook->fxn(srvc, hook->data);
+        }
+    }
+}
+
+/* Reaper task: tear down disconnected instances in the background */
+static Void reaperTaskFxn(UArg arg0, UArg arg1)
+{
+    IArg              key;
+    Int               status;
+    UInt32            addr;
+    struct Tuple      *t;
     RcmServer_Handle  rcmSrvHandle;
 
-    for (i = 0; i < ServiceMgr_NUMSERVICETYPES; i++) {
-       if (!strcmp(name, serviceDefs[i].name)) {
-           sd = &serviceDefs[i];
-           break;
-       }
+    while (TRUE) {
+        Semaphore_pend(reapSem, BIOS_WAIT_FOREVER);
+
+        key = GateMutex_enter(tupleGate);
+        if ((t = reapHead) != NULL) {
+            reapHead = t->next;
+            if (reapHead == NULL) {
+                reapTail = NULL;
+            }
+        }
+        GateMutex_leave(tupleGate, key);
+
+        if (t == NULL) {
+            continue;
+        }
+
+        addr = t->key;
+        rcmSrvHandle = (RcmServer_Handle)t->value;
+
+        /* Notify ServiceMgr clients of disconnection.
+         * rcmSrvHandle is same as the ServiceMgr handle
+         */
+        runDisconnectHooks(rcmSrvHandle);
+
+        /* Destroy the RcmServer instance. */
+        status = RcmServer_delete(&rcmSrvHandle);
+        if (status < 0) {
+            System_printf("reaper: RcmServer_delete() returned error %d\n",
+                           status);
+        }
+        else {
+            System_printf("reaper: removed RcmServer at endpoint: %d\n",
+                           addr);
+        }
+
+        /* the endpoint is free now, the tuple can be reused */
+        key = GateMutex_enter(tupleGate);
+        t->next = freeTuples;
+        freeTuples = t;
+        GateMutex_leave(tupleGate, key);
+    }
+}
+
+Void ServiceMgr_getLoad(String name, ServiceMgr_Load *load)
+{
+    UInt              i;
+    IArg              gateKey;
+    UInt32            count;
+    UInt32            ticks;
+    UInt32            percent;
+    struct Tuple      *t;
+    struct ServiceDef *sd = NULL;
+    struct ServiceDef *loadSd = findService(ServiceMgr_LOAD_SERVICE);
+
+    if ((name != NULL) && (name[0] != '\0')) {
+        sd = findService(name);
+    }
+
+    load->instances = 0;
+    load->typeInstances = 0;
+    load->queueDepth = 0;
+
+    if (numBuckets == 0) {
+        load->idlePercent = idlePercent;
+        return;
+    }
+
+    gateKey = GateMutex_enter(tupleGate);
+
+    for (i = 0; i < numBuckets; i++) {
+        for (t = tupleBuckets[i]; t != NULL; t = t->next) {
+            load->queueDepth +=
+                RcmServer_getQueueDepth((RcmServer_Handle)t->value);
+        }
+    }
+
+    load->instances = numTuples - (loadSd != NULL ? loadSd->numActive : 0);
+    load->typeInstances = (sd != NULL ? sd->numActive : 0);
+
+    /* Start a new idle window once the last one is long enough: */
+    count = IpcPower_getIdleCount();
+    ticks = Clock_getTicks();
+
+    if ((ticks - idleTicks) >= ServiceMgr_LOAD_WINDOW) {
+        percent = (count - idleCount) * 100 /
+            ((ticks - idleTicks) * IDLE_CORES);
+        idlePercent = (percent > 100 ? 100 : percent);
+        idleCount = count;
+        idleTicks = ticks;
+    }
+
+    load->idlePercent = idlePercent;
+
+    GateMutex_leave(tupleGate, gateKey);
+}
+
+/* Function 0 of the load service, see ServiceMgr_LoadArgs */
+static Int32 ServiceMgr_loadFxn(UInt32 size, UInt32 *data)
+{
+    ServiceMgr_LoadArgs *args = (ServiceMgr_LoadArgs *)data;
+
+    if (size < sizeof(ServiceMgr_LoadArgs)) {
+        return (-1);
     }
 
-    if (i >= ServiceMgr_NUMSERVICETYPES) {
+    args->name[sizeof(args->name) - 1] = '\0';
+    ServiceMgr_getLoad(args->name, &args->load);
+
+    return (0);
+}
+
+UInt32 ServiceMgr_createService(Char * name, UInt32 * endpt)
+{
+    Int status = 0;
+    IArg key;
+    struct ServiceDef *sd;
+    RcmServer_Handle  rcmSrvHandle = NULL;
+
+    sd = findService(name);
+    if (sd == NULL) {
        System_printf("createService: unrecognized service name: %s\n", name);
        return OMX_NOTSUPP;
     }
 
-    /* Create the RcmServer instance. */
+    /* Take a prewarmed instance if one is ready, and have it replaced: */
+    key = GateMutex_enter(prewarmGate);
+    if (sd->numReady > 0) {
+        rcmSrvHandle = sd->ready[--sd->numReady];
+    }
+    GateMutex_leave(prewarmGate, key);
+
+    if (rcmSrvHandle != NULL) {
+        Semaphore_post(prewarmSem);
+    }
+
+    /* Otherwise create the RcmServer instance. */
+    else {
 #if 0
-    System_printf("createService: Calling RcmServer_create with name = %s\n"
-                  "priority = %d\n"
-                  "osPriority = %d\n"
-                  "rcmServerParams.fxns.length = %d\n",
-                  sd->name, sd->rcmServerParams.priority,
-                  sd->rcmServerParams.osPriority,
-                  sd->rcmServerParams.fxns.length);
+        System_printf("createService: Calling RcmServer_create with name = %s\n"
+                      "priority = %d\n"
+                      "osPriority = %d\n"
+                      "rcmServerParams.fxns.length = %d\n",
+                      sd->name, sd->rcmServerParams.priority,
+                      sd->rcmServerParams.osPriority,
+                      sd->rcmServerParams.fxns.length);
 #endif
-    status = RcmServer_create(sd->name, &sd->rcmServerParams, &rcmSrvHandle);
+        status = RcmServer_create(sd->name, &sd->rcmServerParams,
+                                  &rcmSrvHandle);
 
-    if (status < 0) {
-        System_printf("createService: RcmServer_create() returned error %d\n",
-                       status);
-        return OMX_FAIL;
+        if (status < 0) {
+            System_printf("createService: RcmServer_create() returned error"
+                          " %d\n", status);
+            return OMX_FAIL;
+        }
+
+        /* start the server */
+        RcmServer_start(rcmSrvHandle);
     }
 
     /* Get endpoint allowing clients to send messages to this new server: */
     *endpt = RcmServer_getLocalAddress(rcmSrvHandle);
 
     /* Store Server's endpoint with handle so we can cleanup on disconnect: */
-    if (!storeTuple(*endpt, (UInt32)rcmSrvHandle))  {
-        System_printf("createService: Limit reached on max instances!\n");
+    if (!storeTuple(*endpt, (UInt32)rcmSrvHandle, sd))  {
+        System_printf("createService: out of memory for instance table!\n");
         RcmServer_delete(&rcmSrvHandle);
         return OMX_FAIL;
     }
 
-    /* start the server */
-    RcmServer_start(rcmSrvHandle);
-
     System_printf("createService: new OMX Service at endpoint: %d\n", *endpt);
 
     return OMX_SUCCESS;
@@ -333,32 +890,14 @@ UInt32 ServiceMgr_createService(Char * name, UInt32 * endpt)
 
 UInt32 ServiceMgr_deleteService(UInt32 addr)
 {
-    Int status = 0;
     RcmServer_Handle  rcmSrvHandle;
 
+    /* The reaper task runs the disconnect hooks and deletes the instance */
     if (!removeTuple(addr, (UInt32 *)&rcmSrvHandle))  {
        System_printf("deleteService: could not find service instance at"
                      " address: 0x%x\n", addr);
        return OMX_FAIL;
     }
 
-    /* Notify a ServiceMgr client of disconnection.
-     * rcmSrvHandle is same as the ServiceMgr handle
-     */
-    if (ServiceMgr_disconnectUserFxn) {
-        /* Pass NULL data for the moment */
-        ServiceMgr_disconnectUserFxn(rcmSrvHandle, NULL);
-    }
-
-    /* Destroy the RcmServer instance. */
-    status = RcmServer_delete(&rcmSrvHandle);
-    if (status < 0) {
-        System_printf("deleteService: RcmServer_delete() returned error %d\n",
-                       status);
-        return OMX_FAIL;
-    }
-
-    System_printf("deleteService: removed RcmServer at endpoint: %d\n", addr);
-
     return OMX_SUCCESS;
 }
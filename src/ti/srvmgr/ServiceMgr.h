@@ -53,6 +53,15 @@ extern "C" {
 /* Max number of known service types: */
 #define ServiceMgr_NUMSERVICETYPES         16
 
+/* Max number of prewarmed instances kept per service type: */
+#define ServiceMgr_MAX_PREWARM             8
+
+/* Min number of clock ticks between two idle percentage samples: */
+#define ServiceMgr_LOAD_WINDOW             100
+
+/* Name of the service reporting the load of this core: */
+#define ServiceMgr_LOAD_SERVICE            "ServiceMgr_Load"
+
 /*!
  *  @brief Service instance object handle
  */
@@ -63,6 +72,27 @@ typedef RcmServer_Handle  Service_Handle;
  */
 typedef Void (*ServiceMgr_disconnectFuncPtr)(Service_Handle srvc, Ptr data);
 
+/*!
+ *  @brief Load of this core, as reported by ServiceMgr_getLoad
+ */
+typedef struct ServiceMgr_Load {
+    UInt32  instances;      /*!< Service instances of all types */
+    UInt32  typeInstances;  /*!< Instances of the service type asked about */
+    UInt32  queueDepth;     /*!< Messages waiting for a worker thread */
+    UInt32  idlePercent;    /*!< Estimated idle time, 0 to 100 */
+} ServiceMgr_Load;
+
+/*!
+ *  @brief Payload of a call to the load service
+ *
+ *  The ServiceMgr_LOAD_SERVICE service has one function, at index 0. It
+ *  takes the name of a service type and fills in the load.
+ */
+typedef struct ServiceMgr_LoadArgs {
+    Char             name[48];  /*!< in: service type, may be empty */
+    ServiceMgr_Load  load;      /*!< out: load of this core */
+} ServiceMgr_LoadArgs;
+
 /*
  *  ======== ServiceMgr_init ========
  */
@@ -133,6 +163,50 @@ UInt ServiceMgr_start(UInt16 reserved);
  */
 Bool ServiceMgr_register(String name, RcmServer_Params  *rcmServerParams);
 
+/*
+ *  ======== ServiceMgr_setPrewarm ========
+ */
+/*!
+ *  @brief Keep a number of service instances created and started ahead of
+ *         time.
+ *
+ *  ServiceMgr_createService hands out one of these instances when it has
+ *  one, instead of creating the RcmServer instance on the connect path.
+ *  A background task, created by ServiceMgr_start at the lowest priority,
+ *  builds the instances and replaces each one handed out.
+ *
+ *  Each prewarmed instance holds its threads, tables and endpoint while
+ *  it waits, so keep the count small.
+ *
+ *  @param[in] name    Name of a registered service.
+ *  @param[in] count   Number of instances to keep ready, 0 to
+ *                     ServiceMgr_MAX_PREWARM. 0 turns prewarming off.
+ *
+ *  @sa ServiceMgr_register
+ */
+Bool ServiceMgr_setPrewarm(String name, UInt count);
+
+/*
+ *  ======== ServiceMgr_getLoad ========
+ */
+/*!
+ *  @brief Get the load of this core, for placing new service instances.
+ *
+ *  The same figures are published to the host by the
+ *  ServiceMgr_LOAD_SERVICE service, which ServiceMgr_init registers. Its
+ *  own instances are not counted.
+ *
+ *  The idle percentage is estimated from the IpcPower idle count: an
+ *  idle core sleeps and is woken up about once per timer tick, so the
+ *  ratio of idle passes to clock ticks, capped at 100, approximates the
+ *  share of ticks the core had nothing to run. It is refreshed at most
+ *  every ServiceMgr_LOAD_WINDOW clock ticks.
+ *
+ *  @param[in]  name    Service type to count instances of, or NULL.
+ *  @param[out] load    Load of this core.
+ */
+Void ServiceMgr_getLoad(String name, ServiceMgr_Load *load);
+
 /*
  *  ======== ServiceMgr_send ========
  */
@@ -158,8 +232,17 @@ Void ServiceMgr_send(Service_Handle srvc, Ptr data, UInt16 len);
 /*!
  *  @brief Registers a application-specific service disconnect callback function
  *
+ *  Any number of functions can be registered. A function registered with
+ *  a service handle is called once, when that service instance
+ *  disconnects, and then dropped; one registered with a NULL handle is
+ *  called on every disconnect. The functions of the instance run first,
+ *  then the others, each in registration order.
+ *
+ *  The functions run on the ServiceMgr reaper task, at the lowest
+ *  priority, before the instance is deleted.
+ *
  *  @param[in]  srvc           Handle to a service, passed into every service
- *                             function
+ *                             function, or NULL for all service instances
  *  @param[in]  data           Pointer to application-specific data passed back
  *                             to the disconnect hook function
  *  @param[in]  func           Hook function to be called on a service disconnect
@@ -192,6 +275,10 @@ UInt32 ServiceMgr_createService(Char * name, UInt32 * endPt);
  *  Deletes the RCM Servver instance associated with a particular endpoint
  *  address.
  *
+ *  The instance is only taken out of the ServiceMgr tables here; running
+ *  the disconnect hooks and deleting the instance is left to the reaper
+ *  task, so the caller can serve its next request right away.
+ *
  *  @param[in]  addr          EndPoint pointer address associated with the
  *                            service to delete.
  *
@@ -38,6 +38,7 @@
 #include <ti/sysbios/BIOS.h>
 #include <ti/sysbios/knl/Semaphore.h>
 #include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/gates/GateMutex.h>
 
 #include <ti/grcm/RcmTypes.h>
 #include <ti/grcm/RcmServer.h>
@@ -52,6 +53,22 @@
 
 #include "OmapRpc.h"
 
+/* Instance creation and destruction run on a pool of worker tasks, so a
+ * slow create does not hold up the requests queued behind it. The host
+ * matches the out of order replies by the id in msgFlags. */
+#define OMAPRPC_NUM_WORKERS     2
+#define OMAPRPC_NUM_REQUESTS    (OMAPRPC_NUM_WORKERS + 2)
+
+/* maximum rpmsg size is probably smaller, but we need to be cautious */
+#define OMAPRPC_MSG_SIZE        512
+
+typedef struct OmapRpc_Request {
+    struct OmapRpc_Request *next;
+    UInt32                  remote;
+    UInt16                  len;
+    UInt8                   msg[OMAPRPC_MSG_SIZE];
+} OmapRpc_Request;
+
 typedef struct OmapRpc_Object {
     Char                    channelName[OMAPRPC_MAX_CHANNEL_NAMELEN];
     UInt16                  dstProc;
@@ -62,81 +79,125 @@ typedef struct OmapRpc_Object {
     Bool                    shutdown;
     Semaphore_Handle        exitSem;
     OmapRpc_SrvDelNotifyFxn srvDelCB;
+    OmapRpc_Request        *requests;
+    OmapRpc_Request        *freeList;   /* protected by queueGate */
+    OmapRpc_Request        *workHead;   /* protected by queueGate */
+    OmapRpc_Request        *workTail;
+    GateMutex_Handle        queueGate;
+    Semaphore_Handle        freeSem;    /* counts freeList */
+    Semaphore_Handle        workSem;    /* counts the work queue */
+    Task_Handle             workers[OMAPRPC_NUM_WORKERS];
 } OmapRpc_Object;
 
 
-static Void omapRpcTask(UArg arg0, UArg arg1)
+static Void putFree(OmapRpc_Object *obj, OmapRpc_Request *req)
 {
-    OmapRpc_Object *obj = (OmapRpc_Object *)arg0;
-    UInt32 local;
-    UInt32 remote;
-    Int status;
-    UInt16 len;
-    UInt8  msg[512]; /* maximum rpmsg size is probably smaller, but we need to
-                      * be cautious */
-    OmapRpc_MsgHeader *hdr = (OmapRpc_MsgHeader *)&msg[0];
+    IArg key;
 
-    if (obj == NULL) {
-        System_printf("OMAPRPC: Failed to start task as arguments are NULL!\n");
-        return;
-    }
+    key = GateMutex_enter(obj->queueGate);
+    req->next = obj->freeList;
+    obj->freeList = req;
+    GateMutex_leave(obj->queueGate, key);
 
-    if (obj->msgq == NULL) {
-        System_printf("OMAPRPC: Failed to start task as MessageQ was NULL!\n");
-        return;
-    }
+    Semaphore_post(obj->freeSem);
+}
 
-    /* get the local endpoint we are to use */
-    local = obj->localEndPt;
-    System_printf("OMAPRPC: connecting from local endpoint %u to port %u\n",
-                        obj->localEndPt, obj->port);
+static OmapRpc_Request *getFree(OmapRpc_Object *obj)
+{
+    OmapRpc_Request *req;
+    IArg key;
 
-    NameMap_register("omaprpc", obj->port);
+    Semaphore_pend(obj->freeSem, BIOS_WAIT_FOREVER);
 
-    System_printf("OMAPRPC: started channel on port: %d\n", obj->port);
+    key = GateMutex_enter(obj->queueGate);
+    req = obj->freeList;
+    obj->freeList = req->next;
+    GateMutex_leave(obj->queueGate, key);
 
-    while (!obj->shutdown) {
+    return req;
+}
 
-        /* clear out the message and our message vars */
-        _memset(msg, 0, sizeof(msg));
-        len = 0;
-        remote = 0;
+static Void putWork(OmapRpc_Object *obj, OmapRpc_Request *req)
+{
+    IArg key;
 
-        /* receive the message */
-        status = MessageQCopy_recv(obj->msgq, (Ptr)msg, &len, &remote,
-                                        MessageQCopy_FOREVER);
+    req->next = NULL;
+    key = GateMutex_enter(obj->queueGate);
+    if (obj->workTail == NULL) {
+        obj->workHead = req;
+    }
+    else {
+        obj->workTail->next = req;
+    }
+    obj->workTail = req;
+    GateMutex_leave(obj->queueGate, key);
 
-        if (status == MessageQCopy_E_UNBLOCKED) {
-            System_printf("OMAPRPC: unblocked while waiting for messages\n");
-            continue;
+    Semaphore_post(obj->workSem);
+}
+
+/* Returns NULL when the channel is being deleted */
+static OmapRpc_Request *getWork(OmapRpc_Object *obj)
+{
+    OmapRpc_Request *req;
+    IArg key;
+
+    Semaphore_pend(obj->workSem, BIOS_WAIT_FOREVER);
+
+    key = GateMutex_enter(obj->queueGate);
+    req = obj->workHead;
+    if (req != NULL) {
+        obj->workHead = req->next;
+        if (obj->workHead == NULL) {
+            obj->workTail = NULL;
         }
+    }
+    GateMutex_leave(obj->queueGate, key);
+
+    return req;
+}
+
+/* The reply keeps msgFlags, the correlation id of the request */
+static Void reply(OmapRpc_Object *obj, OmapRpc_Request *req)
+{
+    OmapRpc_MsgHeader *hdr = (OmapRpc_MsgHeader *)&req->msg[0];
+
+    /* compute the length of the return message. */
+    req->len = sizeof(struct OmapRpc_MsgHeader) + hdr->msgLen;
+
+    /* send the response. All messages get responses! */
+    MessageQCopy_send(obj->dstProc, req->remote, obj->localEndPt, req->msg,
+                      req->len);
+}
+
+static Void omapRpcWorker(UArg arg0, UArg arg1)
+{
+    OmapRpc_Object *obj = (OmapRpc_Object *)arg0;
+    OmapRpc_Request *req;
+    OmapRpc_MsgHeader *hdr;
+
+    while ((req = getWork(obj)) != NULL) {
+        hdr = (OmapRpc_MsgHeader *)&req->msg[0];
 
-        System_printf("OMAPRPC: received msg type: %d len: %d from addr: %d\n",
-                             hdr->msgType, len, remote);
         switch (hdr->msgType) {
             case OmapRpc_MsgType_CREATE_INSTANCE:
             {
                 /* temp pointer to payload */
                 OmapRpc_CreateInstance *create =
-                                OmapRpc_PAYLOAD(msg, OmapRpc_CreateInstance);
+                            OmapRpc_PAYLOAD(req->msg, OmapRpc_CreateInstance);
                 /* local copy of name */
                 Char name[sizeof(create->name)];
                 /* return structure */
                 OmapRpc_InstanceHandle *handle =
-                                OmapRpc_PAYLOAD(msg, OmapRpc_InstanceHandle);
+                            OmapRpc_PAYLOAD(req->msg, OmapRpc_InstanceHandle);
                 /* save a copy of the input structure data */
-                _strcpy(name, create->name);
-                /* clear out the old data */
-                _memset(msg, 0, sizeof(msg));
+                strncpy(name, create->name, sizeof(name) - 1);
+                name[sizeof(name) - 1] = '\0';
 
                 /* create a new instance of the service */
+                handle->endpointAddress = 0;
                 handle->status = ServiceMgr_createService(name,
                                                 &handle->endpointAddress);
 
-                System_printf("OMAPRPC: created service instance named: %s "
-                              "(status=%d) addr: %d\n", name, handle->status,
-                                handle->endpointAddress);
-
                 hdr->msgType = OmapRpc_MsgType_INSTANCE_CREATED;
                 hdr->msgLen  = sizeof(OmapRpc_InstanceHandle);
                 break;
@@ -145,15 +206,13 @@ static Void omapRpcTask(UArg arg0, UArg arg1)
             {
                 /* temp pointer to payload */
                 OmapRpc_InstanceHandle *handle =
-                                OmapRpc_PAYLOAD(msg, OmapRpc_InstanceHandle);
+                            OmapRpc_PAYLOAD(req->msg, OmapRpc_InstanceHandle);
 
                 if (obj->srvDelCB != NULL) {
                     obj->srvDelCB();
                 }
 
                 /* don't clear out the old data... */
-                System_printf("OMAPRPC: destroying instance addr: %d\n",
-                                                    handle->endpointAddress);
                 handle->status = ServiceMgr_deleteService(
                                                     handle->endpointAddress);
                 hdr->msgType = OmapRpc_MsgType_INSTANCE_DESTROYED;
@@ -161,14 +220,76 @@ static Void omapRpcTask(UArg arg0, UArg arg1)
                 /* leave the endpoint address alone. */
                 break;
             }
+        }
+
+        reply(obj, req);
+        putFree(obj, req);
+    }
+
+    Semaphore_post(obj->exitSem);
+}
+
+static Void omapRpcTask(UArg arg0, UArg arg1)
+{
+    OmapRpc_Object *obj = (OmapRpc_Object *)arg0;
+    OmapRpc_Request *req;
+    OmapRpc_MsgHeader *hdr;
+    Int status;
+
+    if (obj == NULL) {
+        System_printf("OMAPRPC: Failed to start task as arguments are NULL!\n");
+        return;
+    }
+
+    if (obj->msgq == NULL) {
+        System_printf("OMAPRPC: Failed to start task as MessageQ was NULL!\n");
+        return;
+    }
+
+    System_printf("OMAPRPC: connecting from local endpoint %u to port %u\n",
+                        obj->localEndPt, obj->port);
+
+    NameMap_register("omaprpc", obj->port);
+
+    System_printf("OMAPRPC: started channel on port: %d\n", obj->port);
+
+    while (!obj->shutdown) {
+
+        /* wait for a free request, the workers hand them back */
+        req = getFree(obj);
+        hdr = (OmapRpc_MsgHeader *)&req->msg[0];
+        req->len = 0;
+        req->remote = 0;
+
+        /* receive the message */
+        status = MessageQCopy_recv(obj->msgq, (Ptr)req->msg, &req->len,
+                                   &req->remote, MessageQCopy_FOREVER);
+
+        if (status == MessageQCopy_E_UNBLOCKED) {
+            System_printf("OMAPRPC: unblocked while waiting for messages\n");
+            putFree(obj, req);
+            continue;
+        }
+
+        if (req->len < sizeof(OmapRpc_MsgHeader)) {
+            hdr->msgType = OmapRpc_MsgType_MAX;
+            hdr->msgFlags = 0;
+        }
+
+        switch (hdr->msgType) {
+            case OmapRpc_MsgType_CREATE_INSTANCE:
+            case OmapRpc_MsgType_DESTROY_INSTANCE:
+            {
+                /* the worker replies and frees the request */
+                putWork(obj, req);
+                continue;
+            }
             case OmapRpc_MsgType_QUERY_CHAN_INFO:
             {
                 OmapRpc_ChannelInfo *chanInfo =
-                                      OmapRpc_PAYLOAD(msg, OmapRpc_ChannelInfo);
+                                OmapRpc_PAYLOAD(req->msg, OmapRpc_ChannelInfo);
 
                 _strcpy(chanInfo->name, obj->channelName);
-                System_printf("OMAPRPC: channel info query - name %s\n",
-                                                                chanInfo->name);
                 hdr->msgType = OmapRpc_MsgType_CHAN_INFO;
                 hdr->msgLen = sizeof(OmapRpc_ChannelInfo);
                 break;
@@ -176,30 +297,21 @@ static Void omapRpcTask(UArg arg0, UArg arg1)
             default:
             {
                 /* temp pointer to payload */
-                OmapRpc_Error *err = OmapRpc_PAYLOAD(msg, OmapRpc_Error);
+                OmapRpc_Error *err = OmapRpc_PAYLOAD(req->msg, OmapRpc_Error);
 
-                /* the debugging message before we clear */
                 System_printf("OMAPRPC: unexpected msg type: %d\n",
                                                                 hdr->msgType);
 
-                /* clear out the old data */
-                _memset(msg, 0, sizeof(msg));
-
                 hdr->msgType = OmapRpc_MsgType_ERROR;
-                err->endpointAddress = local;
+                hdr->msgLen = sizeof(OmapRpc_Error);
+                err->endpointAddress = obj->localEndPt;
                 err->status = OmapRpc_ErrorType_NOT_SUPPORTED;
                 break;
             }
        }
 
-       /* compute the length of the return message. */
-       len = sizeof(struct OmapRpc_MsgHeader) + hdr->msgLen;
-
-       System_printf("OMAPRPC: Replying with msg type: %d to addr: %d "
-                      " from: %d len: %u\n", hdr->msgType, remote, local, len);
-
-       /* send the response. All messages get responses! */
-       MessageQCopy_send(obj->dstProc, remote, local, msg, len);
+       reply(obj, req);
+       putFree(obj, req);
     }
 
     System_printf("OMAPRPC: destroying channel on port: %d\n", obj->port);
@@ -216,6 +328,7 @@ OmapRpc_Handle OmapRpc_createChannel(String channelName, UInt16 dstProc,
 
 {
     Task_Params taskParams;
+    Int i;
     OmapRpc_Object *obj = Memory_alloc(NULL, sizeof(OmapRpc_Object), 0, NULL);
     if (obj == NULL) {
         System_printf("OMAPRPC: Failed to allocate memory for object!\n");
@@ -246,6 +359,24 @@ OmapRpc_Handle OmapRpc_createChannel(String channelName, UInt16 dstProc,
         if (obj->exitSem == NULL) {
             goto unload;
         }
+        obj->queueGate = GateMutex_create(NULL, NULL);
+        obj->freeSem = Semaphore_create(0, NULL, NULL);
+        obj->workSem = Semaphore_create(0, NULL, NULL);
+        obj->requests = Memory_alloc(NULL,
+                OMAPRPC_NUM_REQUESTS * sizeof(OmapRpc_Request), 0, NULL);
+        if (obj->queueGate == NULL || obj->freeSem == NULL ||
+            obj->workSem == NULL || obj->requests == NULL) {
+            goto unload;
+        }
+        for (i = 0; i < OMAPRPC_NUM_REQUESTS; i++) {
+            putFree(obj, &obj->requests[i]);
+        }
+        for (i = 0; i < OMAPRPC_NUM_WORKERS; i++) {
+            obj->workers[i] = Task_create(omapRpcWorker, &taskParams, NULL);
+            if (obj->workers[i] == NULL) {
+                goto unload;
+            }
+        }
         obj->taskHandle = Task_create(omapRpcTask, &taskParams, NULL);
         if (obj->taskHandle == NULL) {
             goto unload;
@@ -265,6 +396,7 @@ unload:
 Int OmapRpc_deleteChannel(OmapRpc_Handle handle)
 {
     OmapRpc_Object *obj = (OmapRpc_Object *)handle;
+    Int i;
 
     if (obj == NULL) {
         return OmapRpc_E_FAIL;
@@ -272,18 +404,45 @@ Int OmapRpc_deleteChannel(OmapRpc_Handle handle)
 
     System_printf("OMAPRPC: deleting channel %s\n", obj->channelName);
     obj->shutdown = TRUE;
-    if (obj->msgq) {
+    if (obj->msgq && obj->taskHandle) {
         MessageQCopy_unblock(obj->msgq);
-        if (obj->exitSem) {
-            Semaphore_pend(obj->exitSem, BIOS_WAIT_FOREVER);
-            MessageQCopy_delete(&obj->msgq);
-            Semaphore_delete(&obj->exitSem);
+        Semaphore_pend(obj->exitSem, BIOS_WAIT_FOREVER);
+        Task_delete(&obj->taskHandle);
+    }
+
+    /* the workers finish the queued requests, then see an empty queue */
+    for (i = 0; i < OMAPRPC_NUM_WORKERS; i++) {
+        if (obj->workers[i]) {
+            Semaphore_post(obj->workSem);
         }
-        if (obj->taskHandle) {
-            Task_delete(&obj->taskHandle);
+    }
+    for (i = 0; i < OMAPRPC_NUM_WORKERS; i++) {
+        if (obj->workers[i]) {
+            Semaphore_pend(obj->exitSem, BIOS_WAIT_FOREVER);
+            Task_delete(&obj->workers[i]);
         }
     }
 
+    if (obj->msgq) {
+        MessageQCopy_delete(&obj->msgq);
+    }
+    if (obj->exitSem) {
+        Semaphore_delete(&obj->exitSem);
+    }
+    if (obj->freeSem) {
+        Semaphore_delete(&obj->freeSem);
+    }
+    if (obj->workSem) {
+        Semaphore_delete(&obj->workSem);
+    }
+    if (obj->queueGate) {
+        GateMutex_delete(&obj->queueGate);
+    }
+    if (obj->requests) {
+        Memory_free(NULL, obj->requests,
+                    OMAPRPC_NUM_REQUESTS * sizeof(OmapRpc_Request));
+    }
+
     Memory_free(NULL, obj, sizeof(*obj));
     return OmapRpc_S_SUCCESS;
 }
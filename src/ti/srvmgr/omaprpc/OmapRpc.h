@@ -131,6 +131,13 @@ typedef enum OmapRpc_MsgType {
     OmapRpc_MsgType_QUERY_CHAN_INFO = 9,
     /** The return message from OMAPRPC_MSG_QUERY_CHAN_INFO*/
     OmapRpc_MsgType_CHAN_INFO = 10,
+    /** Ask the Service Instance to call a function, without the RCM
+     * packet: an RcmServer_CallMsg with typed parameters and pointer
+     * translations (see ti/grcm/RcmTypes.h, RcmServer_HDR_CALL) */
+    OmapRpc_MsgType_CALL_DIRECT = 11,
+    /** The return message from OMAPRPC_CALL_DIRECT, the RcmServer_CallMsg
+     * header with the result, and the status in msgFlags */
+    OmapRpc_MsgType_DIRECT_RETURN = 12,
 
     /** \hidden used to define the max msg enum, not an actual message */
     OmapRpc_MsgType_MAX
@@ -189,7 +196,11 @@ typedef struct OmapRpc_InstanceInfo {
  * (actually a copy of omx_msg_hdr which is a copy of an RCM header) */
 typedef struct OmapRpc_MsgHeader {
     UInt32 msgType;    /**< @see OmapRpc_MsgType */
-    UInt32 msgFlags;   /**< Unused */
+    UInt32 msgFlags;   /**< Correlation id chosen by the sender of a
+                        *   request and returned unchanged in its reply.
+                        *   Creates and destroys complete out of order,
+                        *   so a host with several outstanding requests
+                        *   on the channel matches replies by it. */
     UInt32 msgLen;     /**< The length of the message data in bytes */
 } OmapRpc_MsgHeader;
 
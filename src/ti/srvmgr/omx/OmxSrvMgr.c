@@ -128,7 +128,9 @@ Void OmxSrvMgr_taskFxn(UArg arg0, UArg arg1)
             break;
 
            case OMX_DISC_REQ:
-            /* Destroy the service instance at given service addr: */
+            /* Destroy the service instance at given service addr (the
+             * ServiceMgr reaper task does the actual teardown):
+             */
             System_printf("OmxSrvMgr: OMX_DISCONNECT: len %d, addr: %d\n",
                  hdr->len, disc_req->addr);
 
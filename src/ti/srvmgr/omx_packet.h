@@ -51,7 +51,7 @@
  *
  *  Bits    Description
  *  --------------------------------------------------------------------
- *  [15:12] reserved
+ *  [15:12] message priority, 0 (normal) to 3 (highest), worker pools only
  *  [11:8]  omx message type
  *  [7:0]   omx client protocol version
  *
@@ -70,8 +70,12 @@
 #define OMX_DESC_SYM_ADD    0x3       // symbol add message
 #define OMX_DESC_SYM_IDX    0x4       // query symbox index
 #define OMX_DESC_CMD        0x5       // exec non-blocking command.
+#define OMX_DESC_MULTI      0x8       // exec batch of sync commands.
+#define OMX_DESC_BULK       0x9       // exec sync, args by reference.
 #define OMX_DESC_TYPE_MASK  0x0F00    // field mask
 #define OMX_DESC_TYPE_SHIFT 8         // field shift width
+#define OMX_DESC_PRI_MASK   0xF000    // field mask
+#define OMX_DESC_PRI_SHIFT  12        // field shift width
 
 /* omx server status codes must be 0 - 15, it has to fit in a 4-bit field */
 #define OMXSERVER_STATUS_SUCCESS          ((uint16_t)0) // success
@@ -81,6 +85,9 @@
 #define OMXSERVER_STATUS_MSG_FXN_ERR      ((uint16_t)4) // msg function error
 #define OMXSERVER_STATUS_ERROR            ((uint16_t)5) // general failure
 #define OMXSERVER_STATUS_UNPROCESSED      ((uint16_t)6) // unprocessed message
+#define OMXSERVER_STATUS_JOB_NOT_FOUND    ((uint16_t)7) // job id not found
+#define OMXSERVER_STATUS_POOL_NOT_FOUND   ((uint16_t)8) // pool id not found
+#define OMXSERVER_STATUS_INVALID_BULK     ((uint16_t)9) // bad bulk buffer
 
 /* the packet structure (actual message sent to omx service) */
 struct omx_packet {
@@ -96,6 +103,36 @@ struct omx_packet {
 /* define this here to remove size of data[1] field. */
 #define OMXPACKETSIZE (5 * sizeof(UInt32))
 
+/*
+ * An OMX_DESC_MULTI packet carries a batch of calls in one message. The
+ * packet's fxn_idx is ignored. data[0] is the map info word the rpmsg_omx
+ * driver reads from every packet and must be RPC_OMX_MAP_INFO_NONE, as the
+ * driver would otherwise translate buffers in the records. data[1] holds the
+ * record count, followed by that many omx_multi_rec records packed
+ * back-to-back, each padded to a word boundary. The server executes the
+ * records in order, returns each call's result in its record, and returns
+ * the number of records executed in the packet's result field.
+ */
+struct omx_multi_rec {
+    UInt32      fxn_idx;     // Index into OMX service's fxn table.
+    Int32       result;      // The OMX function's return value is here.
+    UInt32      data_size;   // Size of this record's payload in bytes.
+    UInt32      data[1];     // Payload of data_size char's passed to fxn.
+};
+
+/* define this here to remove size of data[1] field. */
+#define OMXMULTIRECSIZE (3 * sizeof(UInt32))
+
+struct omx_bulk_desc {
+    UInt32      addr;        // buffer device (or physical) address
+    UInt32      size;        // buffer size in bytes
+    UInt32      flags;       // OMX_BULK_* flags
+};
+
+#define OMX_BULK_IN         0x1       // remote reads the buffer
+#define OMX_BULK_OUT        0x2       // remote writes the buffer
+#define OMX_BULK_PHYS       0x4       // addr is a physical address
+
 #define OMX_POOLID_JOBID_NONE (0x00008000)
 #define OMX_INVALIDFXNIDX ((UInt32)(0xFFFFFFFF))
 
@@ -16,13 +16,18 @@
 
 #include <xdc/runtime/Startup.h>
 #include <xdc/runtime/Gate.h>
+#include <xdc/runtime/System.h>
+#include <xdc/runtime/Timestamp.h>
+#include <xdc/runtime/Types.h>
 
-#ifdef SMP
 #include <ti/sysbios/BIOS.h>
+#ifdef SMP
 #include <ti/sysbios/hal/Core.h>
 #include <ti/sysbios/hal/Hwi.h>
 #endif
 #include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/knl/Swi.h>
+#include <ti/sysbios/knl/Task.h>
 
 #include <string.h>
 #include <stdlib.h>
@@ -30,13 +35,39 @@
 
 #include "package/internal/SysMin.xdc.h"
 
+/*
+ * Binary trace records, see SysMin.binaryMode. All fields are 32-bit words:
+ *   [0]  0x1E | type << 8 | number of words after [2] << 16 | core << 24
+ *   [1]  Timestamp_get64() low word
+ *   [2]  Timestamp_get64() high word
+ *   SYNC:  [3] frequency low word, [4] frequency high word
+ *   TRACE: [3] format string address, [4..7] arguments
+ *   EVENT: [3] event name address, [4] phase | thread type << 8,
+ *          [5] Swi or Task handle, 0 for Hwi and main
+ * core is 0 on non-SMP builds and the core id + 1 on SMP builds.
+ * Keep in sync with src/host/sysmin_trace.h.
+ */
+#define SysMin_REC_MARKER       0x1E
+#define SysMin_REC_SYNC         0
+#define SysMin_REC_TRACE        1
+#define SysMin_REC_EVENT        2
+#define SysMin_REC_HDRWORDS     3
+
+/* EVENT record phases and thread types */
+#define SysMin_EVENT_BEGIN      0
+#define SysMin_EVENT_END        1
+#define SysMin_THREAD_HWI       0
+#define SysMin_THREAD_SWI       1
+#define SysMin_THREAD_TASK      2
+#define SysMin_THREAD_MAIN      3
+
 /*
  *  ======== SysMin_Module_startup ========
  */
 Int SysMin_Module_startup(Int phase)
 {
     if (SysMin_bufSize != 0) {
-        memset(module->outbuf, 0, SysMin_bufSize);
+        memset(module->outbuf, 0, module->numRings * SysMin_bufSize);
     }
 
 #ifndef SMP
@@ -78,17 +109,263 @@ Void SysMin_exit(Int stat)
     }
 }
 
+/*
+ *  ======== SysMin_ring ========
+ *  Output ring of a core. The rings are bufSize bytes long and follow each
+ *  other in outbuf; the last 8 bytes of each hold its writeidx/readidx.
+ */
+static inline Char *SysMin_ring(UInt core)
+{
+    return (module->outbuf + core * SysMin_bufSize);
+}
+
+/*
+ *  ======== SysMin_writeIdx ========
+ *  The last ring ends where outbuf does, its indices are the writeidx and
+ *  readidx arrays placed right after it.
+ */
+static inline UInt *SysMin_writeIdx(UInt core)
+{
+    if (core + 1 < module->numRings) {
+        return ((UInt *)(SysMin_ring(core + 1) - 8));
+    }
+
+    return (module->writeidx);
+}
+
 /*
  *  ======== SysMin_output ========
  *  Common output function to write a character
- *  into the circular buffer
+ *  into the circular buffer of a core
  */
-static inline Void SysMin_output(Char ch)
+static inline Void SysMin_output(UInt core, Char ch)
 {
-    module->outbuf[module->outidx++] = ch;
+    SysMin_LineBuffer *lb = &module->lineBuffers[core];
+
+    SysMin_ring(core)[lb->outidx++] = ch;
     /* Last 8 bytes are used for writeIdx/readIdx fields */
-    if (module->outidx == SysMin_bufSize - 8) {
-        module->outidx = 0;
+    if (lb->outidx == SysMin_bufSize - 8) {
+        lb->outidx = 0;
+        lb->synced = FALSE;
+    }
+}
+
+/*
+ *  ======== SysMin_align ========
+ *  Pad with NULs up to the next word boundary, or to the end of the ring
+ *  if 'bytes' do not fit before it, so that records are never split by
+ *  the wrap. Call with the ring locked.
+ */
+static Void SysMin_align(UInt core, UInt bytes)
+{
+    SysMin_LineBuffer *lb = &module->lineBuffers[core];
+    Char *ring = SysMin_ring(core);
+    UInt end = SysMin_bufSize - 8;
+    UInt idx = (lb->outidx + 3) & ~3;
+
+    if (idx + bytes > end) {
+        idx = end;
+    }
+    while (lb->outidx < idx) {
+        ring[lb->outidx++] = '\0';
+    }
+    if (lb->outidx == end) {
+        lb->outidx = 0;
+        lb->synced = FALSE;
+    }
+}
+
+/*
+ *  ======== SysMin_reserve ========
+ *  Return the slot for a record of 'words' words after the header, with
+ *  the header filled in. Call with the ring locked.
+ */
+static UInt32 *SysMin_reserve(UInt core, UInt type, UInt words)
+{
+    SysMin_LineBuffer   *lb = &module->lineBuffers[core];
+    UInt32              *rec;
+    UInt                tag = 0;
+    Types_Timestamp64   ts;
+
+#ifdef SMP
+    tag = core + 1;
+#endif
+
+    SysMin_align(core, (SysMin_REC_HDRWORDS + words) * sizeof(UInt32));
+
+    Timestamp_get64(&ts);
+    rec = (UInt32 *)&SysMin_ring(core)[lb->outidx];
+    rec[0] = SysMin_REC_MARKER | (type << 8) | (words << 16) | (tag << 24);
+    rec[1] = ts.lo;
+    rec[2] = ts.hi;
+    lb->outidx += (SysMin_REC_HDRWORDS + words) * sizeof(UInt32);
+    if (lb->outidx == SysMin_bufSize - 8) {
+        lb->outidx = 0;
+        lb->synced = FALSE;
+    }
+
+    return (rec);
+}
+
+/*
+ *  ======== SysMin_lockRing ========
+ *  Lock the ring of the calling core and return it in 'core'. Each core
+ *  owns its ring on SMP, keeping local interrupts off is enough there.
+ */
+static inline IArg SysMin_lockRing(UInt *core)
+{
+#ifndef SMP
+    *core = 0;
+    return (Gate_enterSystem());
+#else
+    IArg key = (IArg)Hwi_disableCoreInts();
+
+    *core = Core_getCoreId();
+    return (key);
+#endif
+}
+
+/*
+ *  ======== SysMin_unlockRing ========
+ *  Publish what was written to the ring through its writeidx and unlock it.
+ */
+static inline Void SysMin_unlockRing(UInt core, IArg key)
+{
+    *SysMin_writeIdx(core) = module->lineBuffers[core].outidx;
+#ifndef SMP
+    Gate_leaveSystem(key);
+#else
+    Hwi_restoreCoreInts((UInt)key);
+#endif
+}
+
+/*
+ *  ======== SysMin_record ========
+ *  Like SysMin_reserve, but preceded by a SYNC record if the ring wrapped
+ *  since the last one, so that the decoder can convert the timestamps.
+ *  Call with the ring locked.
+ */
+static UInt32 *SysMin_record(UInt core, UInt type, UInt words)
+{
+    SysMin_LineBuffer   *lb = &module->lineBuffers[core];
+    UInt32              *rec;
+    Types_FreqHz        freq;
+
+    /* Make room for both records first, a wrap asks for a new SYNC */
+    SysMin_align(core, ((lb->synced ? 0 : SysMin_REC_HDRWORDS + 2) +
+                        SysMin_REC_HDRWORDS + words) * sizeof(UInt32));
+
+    if (!lb->synced) {
+        Timestamp_getFreq(&freq);
+        rec = SysMin_reserve(core, SysMin_REC_SYNC, 2);
+        rec[3] = freq.lo;
+        rec[4] = freq.hi;
+        lb->synced = TRUE;
+    }
+
+    return (SysMin_reserve(core, type, words));
+}
+
+/*
+ *  ======== SysMin_trace ========
+ */
+Void SysMin_trace(String fmt, UInt nargs, IArg a0, IArg a1, IArg a2, IArg a3)
+{
+    IArg                key;
+    UInt                core;
+    UInt32              *rec;
+
+    if (SysMin_bufSize == 0) {
+        return;
+    }
+
+    if (!SysMin_binaryMode) {
+        System_printf(fmt, a0, a1, a2, a3);
+        return;
+    }
+
+    if (nargs > 4) {
+        nargs = 4;
+    }
+
+    key = SysMin_lockRing(&core);
+
+    rec = SysMin_record(core, SysMin_REC_TRACE, 1 + nargs);
+    rec[3] = (UInt32)fmt;
+    switch (nargs) {
+        case 4:
+            rec[7] = (UInt32)a3;
+        case 3:
+            rec[6] = (UInt32)a2;
+        case 2:
+            rec[5] = (UInt32)a1;
+        case 1:
+            rec[4] = (UInt32)a0;
+        default:
+            break;
+    }
+
+    SysMin_unlockRing(core, key);
+}
+
+/*
+ *  ======== SysMin_event ========
+ *  Common part of SysMin_eventBegin and SysMin_eventEnd
+ */
+static Void SysMin_event(String name, UInt phase)
+{
+    IArg                key;
+    UInt                core;
+    UInt                thread;
+    UInt32              handle;
+    UInt32              *rec;
+
+    switch (BIOS_getThreadType()) {
+        case BIOS_ThreadType_Hwi:
+            thread = SysMin_THREAD_HWI;
+            handle = 0;
+            break;
+        case BIOS_ThreadType_Swi:
+            thread = SysMin_THREAD_SWI;
+            handle = (UInt32)Swi_self();
+            break;
+        case BIOS_ThreadType_Task:
+            thread = SysMin_THREAD_TASK;
+            handle = (UInt32)Task_self();
+            break;
+        default:
+            thread = SysMin_THREAD_MAIN;
+            handle = 0;
+            break;
+    }
+
+    key = SysMin_lockRing(&core);
+
+    rec = SysMin_record(core, SysMin_REC_EVENT, 3);
+    rec[3] = (UInt32)name;
+    rec[4] = phase | (thread << 8);
+    rec[5] = handle;
+
+    SysMin_unlockRing(core, key);
+}
+
+/*
+ *  ======== SysMin_eventBegin ========
+ */
+Void SysMin_eventBegin(String name)
+{
+    if (SysMin_events && SysMin_bufSize != 0) {
+        SysMin_event(name, SysMin_EVENT_BEGIN);
+    }
+}
+
+/*
+ *  ======== SysMin_eventEnd ========
+ */
+Void SysMin_eventEnd(String name)
+{
+    if (SysMin_events && SysMin_bufSize != 0) {
+        SysMin_event(name, SysMin_EVENT_END);
     }
 }
 
@@ -158,48 +435,43 @@ Void SysMin_putch(Char ch)
         module->lineBuffers[coreId].lineidx = lineIdx;
 
 #ifdef SMP
-        /* Copy line buffer to shared output buffer at EOL or when filled up */
+        /* Copy line buffer to the core's ring at EOL or when filled up */
         if ((ch == '\n') || (lineIdx >= SysMin_LINEBUFSIZE)) {
-            Gate_enterSystem();
-
             /* Tag core number */
-            SysMin_output('[');
-            SysMin_output(0x30 + coreId);
-            SysMin_output(']');
+            SysMin_output(coreId, '[');
+            SysMin_output(coreId, 0x30 + coreId);
+            SysMin_output(coreId, ']');
 #else
         if (module->getTime == TRUE) {
 #endif
             uSec  = Clock_getTicks() * Clock_tickPeriod;
-            SysMin_output('[');
+            SysMin_output(coreId, '[');
             if (uSec) {
                 sprintf(timeStamp, "%17llu\0", uSec);
             }
             for (index = startIdx; index < endIdx; index++) {
                 if (index == decPtIdx) {
-                    SysMin_output('.');
+                    SysMin_output(coreId, '.');
                 }
                 if (timeStamp[index] == ' ' && index >= leftSpaceIdx) {
-                    SysMin_output('0');
+                    SysMin_output(coreId, '0');
                 }
                 else {
-                    SysMin_output(timeStamp[index]);
+                    SysMin_output(coreId, timeStamp[index]);
                 }
             }
-            SysMin_output(']');
-            SysMin_output(' ');
+            SysMin_output(coreId, ']');
+            SysMin_output(coreId, ' ');
 #ifdef SMP
             for (i = 0; i < lineIdx; i++) {
-                SysMin_output(lineBuf[i]);
+                SysMin_output(coreId, lineBuf[i]);
             }
-            module->writeidx[0] =  module->outidx;
+            *SysMin_writeIdx(coreId) = module->lineBuffers[coreId].outidx;
             module->lineBuffers[coreId].lineidx = 0;
-
-            Gate_leaveSystem(key);
-        }
-        else {
-            /* restore local interrupts */
-            Hwi_restoreCoreInts((UInt)key);
         }
+
+        /* restore local interrupts */
+        Hwi_restoreCoreInts((UInt)key);
 #else
             module->getTime = FALSE;
         }
@@ -207,11 +479,11 @@ Void SysMin_putch(Char ch)
         /* Copy line buffer to shared output buffer at EOL or when filled up */
         if ((ch == '\n') || (lineIdx >= SysMin_LINEBUFSIZE)) {
             for (i = 0; i < lineIdx; i++) {
-                SysMin_output(lineBuf[i]);
+                SysMin_output(coreId, lineBuf[i]);
             }
             module->lineBuffers[coreId].lineidx = 0;
             module->getTime = TRUE;
-            module->writeidx[0] = module->outidx;
+            *SysMin_writeIdx(coreId) = module->lineBuffers[coreId].outidx;
         }
 
         Gate_leaveSystem(key);
@@ -25,11 +25,19 @@ function module$static$init(obj, params)
     var segname = Program.sectMap[".tracebuf"];
     var segment = Program.cpu.memoryMap[segname];
 
-    if (params.bufSize > segment.len) {
+    /* SMP builds get one ring per core */
+    if (Program.platformName.match(/ipu/)) {
+        obj.numRings = Core.numCores;
+    }
+    else {
+        obj.numRings = 1;
+    }
+
+    if (params.bufSize * obj.numRings > segment.len) {
         this.$logError("bufSize 0x" + Number(params.bufSize).toString(16) +
                        " configured is too large, maximum bufSize allowed is " +
-                       "0x" + Number(segment.len).toString(16) + ". Decrement" +
-                       " the bufSize appropriately.", this);
+                       "0x" + Number(segment.len / obj.numRings).toString(16) +
+                       ". Decrement the bufSize appropriately.", this);
     }
 
     if (params.bufSize - 8 < this.LINEBUFSIZE) {
@@ -37,20 +45,18 @@ function module$static$init(obj, params)
                        + " = 0x" + Number(this.LINEBUFSIZE).toString(16), this);
     }
 
-    if (Program.platformName.match(/ipu/)) {
-        obj.lineBuffers.length = Core.numCores;
-    }
-    else {
-        obj.lineBuffers.length = 1;
-    }
+    obj.lineBuffers.length = obj.numRings;
     for (var i = 0; i < obj.lineBuffers.length; i++) {
         obj.lineBuffers[i].lineidx = 0;
         for (var j = 0; j < this.LINEBUFSIZE; j++) {
             obj.lineBuffers[i].linebuf[j] = 0;
         }
+        obj.lineBuffers[i].outidx = 0;
+        obj.lineBuffers[i].synced = false;
     }
 
-    obj.outbuf.length = params.bufSize - 8;
+    /* the last ring's writeidx/readidx are placed right after outbuf */
+    obj.outbuf.length = params.bufSize * obj.numRings - 8;
     obj.writeidx.length = 0x1;
     obj.readidx.length = 0x1;
     if (params.bufSize != 0) {
@@ -60,7 +66,6 @@ function module$static$init(obj, params)
         Memory.staticPlace(obj.readidx, 0x4, params.sectionName);
     }
 
-    obj.outidx = 0;
     obj.getTime = false;
     obj.wrapped = false;
 }
@@ -81,8 +86,12 @@ function module$use(obj, params)
  */
 function viewInitModule(view, mod)
 {
+    var Program = xdc.useModule('xdc.rov.Program');
+    var lineBuffers = Program.fetchArray(mod.lineBuffers$fetchDesc,
+                                         mod.lineBuffers, mod.numRings);
+
     view.outBuf = mod.outbuf;
-    view.outBufIndex = mod.outidx;
+    view.outBufIndex = lineBuffers[0].outidx;
     view.wrapped = mod.wrapped;
 }
 
@@ -100,28 +109,15 @@ function viewInitOutputBuffer(view)
      */
     var rawView = Program.scanRawView('ti.trace.SysMin');
 
-    /*
-     * If the buffer has not wrapped and the index of the next character to
-     * write is 0, then the buffer is empty, and we can just return.
-     */
-    if (!rawView.modState.wrapped && (rawView.modState.outidx == 0)) {
-        view.elements = new Array();
-        return;
-    }
+    var modState = rawView.modState;
 
     /* Get the buffer size from the configuration. */
     var bufSize = Program.getModuleConfig('ti.trace.SysMin').bufSize;
 
-    /* Read in the outbuf */
-    var outbuf = null;
-    try {
-        outbuf = Program.fetchArray(rawView.modState.outbuf$fetchDesc,
-                                    rawView.modState.outbuf, bufSize);
-    }
-    /* If there's a problem, just re-throw the exception. */
-    catch (e) {
-        throw ("Problem reading output buffer: " + e.toString());
-    }
+    /* Each ring's write index is in the line buffer of its core */
+    var lineBuffers = Program.fetchArray(modState.lineBuffers$fetchDesc,
+                                         modState.lineBuffers,
+                                         modState.numRings);
 
     /*
      * We will create a new view element for each string terminated in a
@@ -129,29 +125,52 @@ function viewInitOutputBuffer(view)
      */
     var elements = new Array();
 
-    /* Leftover characters from each read which did not end in a newline. */
-    var leftover = "";
+    for (var ring = 0; ring < modState.numRings; ring++) {
+        var outidx = lineBuffers[ring].outidx;
 
-    /* If the output buffer has wrapped... */
-    if (rawView.modState.wrapped) {
-        /* Read from outidx to the end of the buffer. */
-        var leftover = readChars("", outbuf, rawView.modState.outidx,
-                                 outbuf.length - 1, elements);
-    }
+        /*
+         * If the buffer has not wrapped and the index of the next character
+         * to write is 0, then the ring is empty, and we can skip it.
+         */
+        if (!modState.wrapped && (outidx == 0)) {
+            continue;
+        }
 
-    /* Read from the beginning of the buffer to outidx */
-    leftover = readChars(leftover, outbuf, 0, rawView.modState.outidx - 1,
-                         elements);
+        /* Read in the ring, without its writeidx/readidx */
+        var outbuf = null;
+        try {
+            outbuf = Program.fetchArray(modState.outbuf$fetchDesc,
+                                        modState.outbuf + ring * bufSize,
+                                        bufSize - 8);
+        }
+        /* If there's a problem, just re-throw the exception. */
+        catch (e) {
+            throw ("Problem reading output buffer: " + e.toString());
+        }
 
-    /*
-     * If there are any leftover characters not terminated in a newline,
-     * create an element for these and display them.
-     */
-    if (leftover != "") {
-        var elem = Program.newViewStruct('ti.trace.SysMin',
-                                         'OutputBuffer');
-        elem.entry = leftover;
-        elements[elements.length] = elem;
+        /* Leftover characters from each read which did not end in a newline. */
+        var leftover = "";
+
+        /* If the output buffer has wrapped... */
+        if (modState.wrapped) {
+            /* Read from outidx to the end of the buffer. */
+            leftover = readChars("", outbuf, outidx, outbuf.length - 1,
+                                 elements);
+        }
+
+        /* Read from the beginning of the buffer to outidx */
+        leftover = readChars(leftover, outbuf, 0, outidx - 1, elements);
+
+        /*
+         * If there are any leftover characters not terminated in a newline,
+         * create an element for these and display them.
+         */
+        if (leftover != "") {
+            var elem = Program.newViewStruct('ti.trace.SysMin',
+                                             'OutputBuffer');
+            elem.entry = leftover;
+            elements[elements.length] = elem;
+        }
     }
 
     view.elements = elements;